@@ -0,0 +1,57 @@
+#include "IpIpoptApplication.hpp"
+#include "hs071_arena_solver.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Ipopt;
+
+// Steady-state solve loop on solve arenas. The replacement operator new of arena_operator_new.cpp counts every
+// allocation that reaches the system heap; the loop must not add to that count once warmed up, otherwise the
+// program fails. Optional argument: number of solves.
+//
+// Only the C++ operator new traffic is covered; memory the linear solver takes with malloc (e.g. MUMPS) is not.
+int main(
+        int    argc,
+        char** argv
+)
+{
+    const Index solves = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+    // the solver owns the application: the objects Ipopt keeps from the last solve live in its arenas
+    HS071_ArenaSolver solver([](const SmartPtr<IpoptApplication> &app) {
+        app->Options()->SetNumericValue("tol", 1e-7);
+        app->Options()->SetStringValue("mu_strategy", "adaptive");
+    });
+    ApplicationReturnStatus status;
+    status = solver.initialize();
+    if( status != Solve_Succeeded )
+    {
+        std::printf("\n\n*** Error during initialization!\n");
+        return (int) status;
+    }
+
+    // the first arena solves still release objects of the warmup solves onto the system heap
+    solver.solve(25.0, 40.0);
+    solver.solve(25.0, 40.0);
+
+    const std::size_t before = solve_arena_system_allocations();
+    Index failed = 0;
+    for( Index k = 0; k < solves; k++ )
+    {
+        status = solver.solve(25.0, 40.0 + (k % 10));
+        failed += status == Solve_Succeeded ? 0 : 1;
+    }
+    const std::size_t system = solve_arena_system_allocations() - before;
+
+    // printf rather than iostream, nothing in the report may allocate before the count has been taken
+    std::printf("%d solves, %d failed, arena high water %zu bytes\n", solves, failed, solver.high_water());
+    std::printf("system allocations in the steady state: %zu (overflows %zu, blocked resets %d)\n", system,
+                solve_arena_overflows(), solver.blocked_resets());
+    if( system != 0 )
+    {
+        std::printf("\n\n*** The steady-state solve loop allocated from the system heap!\n");
+        return 1;
+    }
+    return failed == 0 ? 0 : 1;
+}
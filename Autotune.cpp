@@ -0,0 +1,39 @@
+#include "hs071_autotune.hpp"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace Ipopt;
+
+// Tunes the Ipopt options on the default HS071 instances and writes the best configuration to the options file
+// given as first argument (default hs071_tuned.opt), which MyExample accepts as its argument.
+int main(
+        int    argc,
+        char** argv
+)
+{
+    const std::string path = argc > 1 ? argv[1] : "hs071_tuned.opt";
+    HS071_AutotuneOptions options;
+    if( argc > 2 )
+    {
+        options.num_threads = (unsigned) std::atoi(argv[2]);
+    }
+
+    HS071_Autotuner tuner(options);
+    Index robust = tuner.run();
+    const std::vector<HS071_TunedConfig> &results = tuner.results();
+    std::cout << results.size() << " configurations, " << robust << " solved every instance" << std::endl;
+    for( size_t c = 0; c < results.size() && c < 5; c++ )
+    {
+        std::cout << std::endl << "#" << c + 1 << ": " << results[c].solved << "/" << results[c].attempted
+                  << " solved, " << results[c].iterations << " iterations, " << results[c].wall_time << " s"
+                  << std::endl << results[c].options;
+    }
+    if( !tuner.write_options_file(path) )
+    {
+        std::cout << std::endl << "*** could not write " << path << std::endl;
+        return 1;
+    }
+    std::cout << std::endl << "tuned options written to " << path << std::endl;
+    return robust > 0 ? 0 : 1;
+}
@@ -0,0 +1,285 @@
+#include "IpIpoptApplication.hpp"
+#include "benchmark_stats.hpp"
+#include "hs071_nlp.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+
+using namespace Ipopt;
+
+// a benchmark runs batch operations per sample; samples are reported in nanoseconds per operation
+struct Benchmark {
+    std::string name;
+    Index batch;
+    std::function<void()> run;
+};
+
+// sink for the results of the benchmarked calls, so that the calls cannot be dropped
+static volatile Number sink;
+
+static SmartPtr<IpoptApplication> create_application() {
+    SmartPtr<IpoptApplication> app = IpoptApplicationFactory();
+    app->Options()->SetNumericValue("tol", 1e-7);
+    app->Options()->SetStringValue("mu_strategy", "adaptive");
+    app->Options()->SetIntegerValue("print_level", 0);
+    return app;
+}
+
+// Benchmark suite of HS071_NLP: every callback, at a fixed set of random points within the bounds, and full solves,
+// cold (a new application and problem from the default starting point) and warm (one application, warm started
+// primal-dual from the previous solution). Runs pinned to one CPU; the first samples of each benchmark are discarded
+// as warmup, the others are reported as the median time per operation with its 95% confidence interval.
+// The results are compared with the baselines in a file: a benchmark that is statistically slower (disjoint
+// intervals, median more than the tolerance above) fails the run with exit code 1. "update" rewrites the baselines
+// from this run; without a baseline file the run writes one, and benchmarks missing from the file are added to it.
+// Optional arguments: baseline file (bench_baseline.txt by default), "check" (the default) or "update", cpu,
+// tolerance (0.1); other modes exit with code 2.
+int main(
+        int    argc,
+        char** argv
+)
+{
+    const std::string path = argc > 1 ? argv[1] : "bench_baseline.txt";
+    const std::string mode = argc > 2 ? argv[2] : "check";
+    if( mode != "check" && mode != "update" )
+    {
+        std::cout << "unknown mode " << mode << std::endl
+                  << "usage: " << argv[0] << " [baseline file] [check|update] [cpu] [tolerance]" << std::endl;
+        return 2;
+    }
+    const bool update = mode == "update";
+    const Index cpu = argc > 3 ? std::atoi(argv[3]) : 0;
+    const Number tolerance = argc > 4 ? std::atof(argv[4]) : 0.1;
+    const Index warmup = 5;
+    const Index samples = 31;
+
+    if( !pin_thread_to_cpu(cpu) )
+    {
+        std::cout << "could not pin to cpu " << cpu << ", timings may be noisier" << std::endl;
+    }
+
+    // callbacks cycle through these points, every call with new_x so that no cache serves it
+    const Index num_points = 64;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<Number> uniform(1., 5.);
+    std::vector<Number> points(4 * num_points), multipliers(2 * num_points);
+    for( size_t k = 0; k < points.size(); k++ )
+    {
+        points[k] = uniform(rng);
+    }
+    for( size_t k = 0; k < multipliers.size(); k++ )
+    {
+        multipliers[k] = uniform(rng) - 3.;
+    }
+    Index next = 0;
+    std::function<const Number *()> point = [&points, &next, num_points]() {
+        next = (next + 1) % num_points;
+        return points.data() + 4 * next;
+    };
+
+    HS071_NLP nlp;
+    nlp.set_verbose(false);
+    Number out[12];
+    Index rows[HS071_HessianComponents::NNZ], cols[HS071_HessianComponents::NNZ];
+    const Number zeros[4] = {0., 0., 0., 0.};
+    const Index calls = 1000;
+
+    std::vector<Benchmark> benchmarks;
+    benchmarks.push_back({"get_nlp_info", calls, [&]() {
+        for( Index k = 0; k < calls; k++ )
+        {
+            Index n, m, nnz_jac, nnz_h;
+            TNLP::IndexStyleEnum style;
+            nlp.get_nlp_info(n, m, nnz_jac, nnz_h, style);
+            sink = nnz_h;
+        }
+    }});
+    benchmarks.push_back({"get_bounds_info", calls, [&]() {
+        for( Index k = 0; k < calls; k++ )
+        {
+            nlp.get_bounds_info(4, out, out + 4, 2, out + 8, out + 10);
+            sink = out[0];
+        }
+    }});
+    benchmarks.push_back({"get_starting_point", calls, [&]() {
+        for( Index k = 0; k < calls; k++ )
+        {
+            nlp.get_starting_point(4, true, out, false, NULL, NULL, 2, false, NULL);
+            sink = out[0];
+        }
+    }});
+    benchmarks.push_back({"eval_f", calls, [&]() {
+        for( Index k = 0; k < calls; k++ )
+        {
+            nlp.eval_f(4, point(), true, out[0]);
+            sink = out[0];
+        }
+    }});
+    benchmarks.push_back({"eval_grad_f", calls, [&]() {
+        for( Index k = 0; k < calls; k++ )
+        {
+            nlp.eval_grad_f(4, point(), true, out);
+            sink = out[0];
+        }
+    }});
+    benchmarks.push_back({"eval_g", calls, [&]() {
+        for( Index k = 0; k < calls; k++ )
+        {
+            nlp.eval_g(4, point(), true, 2, out);
+            sink = out[0];
+        }
+    }});
+    benchmarks.push_back({"eval_jac_g_structure", calls, [&]() {
+        for( Index k = 0; k < calls; k++ )
+        {
+            nlp.eval_jac_g(4, NULL, false, 2, HS071_FirstOrder::NNZ_JAC, rows, cols, NULL);
+            sink = rows[0];
+        }
+    }});
+    benchmarks.push_back({"eval_jac_g", calls, [&]() {
+        for( Index k = 0; k < calls; k++ )
+        {
+            nlp.eval_jac_g(4, point(), true, 2, HS071_FirstOrder::NNZ_JAC, NULL, NULL, out);
+            sink = out[0];
+        }
+    }});
+    benchmarks.push_back({"eval_h_structure", calls, [&]() {
+        for( Index k = 0; k < calls; k++ )
+        {
+            nlp.eval_h(4, NULL, false, 0., 2, NULL, false, HS071_HessianComponents::NNZ, rows, cols, NULL);
+            sink = rows[0];
+        }
+    }});
+    benchmarks.push_back({"eval_h", calls, [&]() {
+        for( Index k = 0; k < calls; k++ )
+        {
+            nlp.eval_h(4, point(), true, 1., 2, multipliers.data() + 2 * next, true, HS071_HessianComponents::NNZ,
+                       NULL, NULL, out);
+            sink = out[0];
+        }
+    }});
+    // new multipliers at the same x, as in the line search: only recombines the cached component Hessians
+    benchmarks.push_back({"eval_h_same_x", calls, [&]() {
+        const Number *x = point();
+        for( Index k = 0; k < calls; k++ )
+        {
+            nlp.eval_h(4, x, false, 1., 2, multipliers.data() + 2 * (k % num_points), true,
+                       HS071_HessianComponents::NNZ, NULL, NULL, out);
+            sink = out[0];
+        }
+    }});
+    benchmarks.push_back({"intermediate_callback", calls, [&]() {
+        for( Index k = 0; k < calls; k++ )
+        {
+            sink = nlp.intermediate_callback(RegularMode, k, 17., 1e-3, 1e-3, 1e-2, 0.1, 0., 1., 1., 0, NULL, NULL);
+        }
+    }});
+    benchmarks.push_back({"finalize_solution", calls, [&]() {
+        for( Index k = 0; k < calls; k++ )
+        {
+            nlp.finalize_solution(SUCCESS, 4, point(), zeros, zeros, 2, out, out + 2, 17., NULL, NULL);
+            sink = nlp.solution().obj_value;
+        }
+    }});
+
+    bool initialized = true;
+    benchmarks.push_back({"solve_cold", 1, [&]() {
+        SmartPtr<IpoptApplication> app = create_application();
+        if( app->Initialize() != Solve_Succeeded )
+        {
+            initialized = false;
+            return;
+        }
+        SmartPtr<HS071_NLP> problem = new HS071_NLP();
+        problem->set_verbose(false);
+        app->OptimizeTNLP(problem);
+        sink = problem->solution().obj_value;
+    }});
+    SmartPtr<IpoptApplication> warm_app = create_application();
+    if( warm_app->Initialize() != Solve_Succeeded )
+    {
+        std::cout << std::endl << std::endl << "*** Error during initialization!" << std::endl;
+        return 1;
+    }
+    HS071_set_warm_start_options(warm_app, true);
+    SmartPtr<HS071_NLP> warm = new HS071_NLP();
+    warm->set_verbose(false);
+    warm_app->OptimizeTNLP(warm);
+    benchmarks.push_back({"solve_warm", 1, [&]() {
+        warm->set_warm_start(warm->solution());
+        warm_app->OptimizeTNLP(warm);
+        sink = warm->solution().obj_value;
+    }});
+
+    BenchmarkBaselines baselines, results;
+    const bool have_baselines = !update && read_baselines(path, baselines);
+    std::printf("%-22s %12s %25s %12s %8s\n", "benchmark", "median ns", "95% interval", "baseline", "change");
+    Index regressions = 0, added = 0;
+    for( size_t b = 0; b < benchmarks.size(); b++ )
+    {
+        const Benchmark &benchmark = benchmarks[b];
+        std::vector<Number> times;
+        for( Index s = 0; s < warmup + samples; s++ )
+        {
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            benchmark.run();
+            const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+            if( s >= warmup )
+            {
+                times.push_back(std::chrono::duration<Number, std::nano>(end - start).count() / benchmark.batch);
+            }
+        }
+        if( !initialized )
+        {
+            std::cout << std::endl << std::endl << "*** Error during initialization!" << std::endl;
+            return 1;
+        }
+        const BenchmarkSummary summary = summarize_samples(times);
+        results[benchmark.name] = summary;
+        std::printf("%-22s %12.1f   [%10.1f, %10.1f]", benchmark.name.c_str(), summary.median, summary.ci_low,
+                    summary.ci_high);
+        BenchmarkBaselines::const_iterator base = baselines.find(benchmark.name);
+        if( base != baselines.end() )
+        {
+            const bool slower = is_regression(summary, base->second, tolerance);
+            regressions += slower ? 1 : 0;
+            std::printf(" %12.1f %+7.1f%%%s", base->second.median,
+                        100. * (summary.median / base->second.median - 1.), slower ? "  SLOWER" : "");
+        }
+        else if( have_baselines )
+        {
+            // not in the file yet: nothing to compare with, its result becomes the baseline
+            std::printf(" %12s %8s", "-", "new");
+            baselines[benchmark.name] = summary;
+            added++;
+        }
+        std::printf("\n");
+    }
+
+    if( !have_baselines )
+    {
+        if( !write_baselines(path, results) )
+        {
+            std::cout << "cannot write " << path << std::endl;
+            return 1;
+        }
+        std::cout << "wrote baselines to " << path << std::endl;
+        return 0;
+    }
+    if( added > 0 )
+    {
+        if( !write_baselines(path, baselines) )
+        {
+            std::cout << "cannot write " << path << std::endl;
+            return 1;
+        }
+        std::cout << "added " << added << " new baselines to " << path << std::endl;
+    }
+    std::cout << regressions << " of " << benchmarks.size() - added << " benchmarks slower than the baselines in "
+              << path << std::endl;
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,70 @@
+#include "hs071_branch_bound.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+using namespace Ipopt;
+
+// Solves HS071 with integer restrictions by parallel branch-and-bound with 1, 2, 4, ... threads and reports node
+// throughput and speedup over one thread.
+// Optional arguments: mask of the integer variables (e.g. 1010 for x1 and x3, default 1111), largest number of
+// threads (default: hardware threads), g1 right hand side.
+int main(
+        int    argc,
+        char** argv
+)
+{
+    HS071_BranchBoundOptions options;
+    if( argc > 1 )
+    {
+        options.integer_vars.clear();
+        for( Index i = 0; i < 4 && i < (Index) std::strlen(argv[1]); i++ )
+        {
+            if( argv[1][i] == '1' )
+            {
+                options.integer_vars.push_back(i);
+            }
+        }
+    }
+    const unsigned max_threads = argc > 2 ? std::atoi(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+    if( argc > 3 )
+    {
+        options.g1_rhs = std::atof(argv[3]);
+    }
+
+    std::cout << "threads  nodes  pruned  infeasible  time[ms]  nodes/s  speedup  objective" << std::endl;
+    Number serial_time = 0.;
+    HS071_Solution best;
+    for( unsigned threads = 1; threads <= max_threads; threads *= 2 )
+    {
+        options.num_threads = threads;
+        HS071_BranchBound bb(options);
+        const bool found = bb.run();
+        if( threads == 1 )
+        {
+            serial_time = bb.wall_time();
+        }
+        std::cout << threads << "\t" << bb.nodes_solved() << "\t" << bb.nodes_pruned() << "\t"
+                  << bb.nodes_infeasible() << "\t" << bb.wall_time() * 1e3 << "\t" << bb.nodes_per_second() << "\t"
+                  << serial_time / bb.wall_time() << "\t";
+        if( found )
+        {
+            std::cout << bb.incumbent().obj_value << std::endl;
+            best = bb.incumbent();
+        }
+        else
+        {
+            std::cout << "none" << std::endl;
+        }
+    }
+
+    if( !best.x.empty() )
+    {
+        std::cout << std::endl << "x = (" << best.x[0] << ", " << best.x[1] << ", " << best.x[2] << ", " << best.x[3]
+                  << ")" << std::endl;
+    }
+    return best.x.empty() ? 1 : 0;
+}
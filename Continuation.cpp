@@ -0,0 +1,63 @@
+#include "IpIpoptApplication.hpp"
+#include "hs071_continuation.hpp"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace Ipopt;
+
+// Traces the HS071 solution while the right hand side of the equality constraint moves from 40 to the value given
+// on the command line (default 60), and compares the iterations spent with independent cold solves at the same
+// parameter values.
+int main(
+        int    argc,
+        char** argv
+)
+{
+    Number begin = 40.0;
+    Number end = argc > 1 ? std::atof(argv[1]) : 60.0;
+
+    SmartPtr<IpoptApplication> app = IpoptApplicationFactory();
+    app->Options()->SetNumericValue("tol", 1e-7);
+    app->Options()->SetStringValue("mu_strategy", "adaptive");
+    app->Options()->SetIntegerValue("print_level", 0);
+    ApplicationReturnStatus status;
+    status = app->Initialize();
+    if( status != Solve_Succeeded )
+    {
+        std::cout << std::endl << std::endl << "*** Error during initialization!" << std::endl;
+        return (int) status;
+    }
+
+    HS071_Continuation continuation(app);
+    bool reached = continuation.trace(begin, end);
+    const std::vector<HS071_ContinuationPoint> &path = continuation.path();
+
+    std::cout << "parameter        step   iter  active  f(x*)" << std::endl;
+    for( size_t k = 0; k < path.size(); k++ )
+    {
+        std::cout << path[k].parameter << "\t" << path[k].step << "\t" << path[k].solution.iter_count << "\t"
+                  << (path[k].active_set_changed ? "changed" : "") << "\t" << path[k].solution.obj_value << std::endl;
+    }
+
+    // the same parameter values solved independently from the default starting point
+    Index independent = 0;
+    SmartPtr<HS071_NLP> nlp = new HS071_NLP();
+    nlp->set_verbose(false);
+    for( size_t k = 0; k < path.size(); k++ )
+    {
+        nlp->set_parameter(HS071_G1_RHS, path[k].parameter);
+        app->OptimizeTNLP(nlp);
+        independent += nlp->solution().iter_count;
+    }
+
+    std::cout << std::endl << "continuation: " << path.size() << " points, " << continuation.total_iterations()
+              << " iterations (" << continuation.rejected_steps() << " rejected steps)" << std::endl;
+    std::cout << "independent solves: " << independent << " iterations" << std::endl;
+    if( !reached )
+    {
+        std::cout << std::endl << "*** The continuation stopped before reaching " << end << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include "hs071_nlp.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+using namespace Ipopt;
+
+// Microbenchmark of the HS071 first-order evaluation at a set of random points, in three ways:
+//  - separate: eval_f, eval_grad_f, eval_g and eval_jac_g in the order Ipopt calls them, each with its own formulas,
+//  - fused callbacks: the same calls served from one fused evaluation per point,
+//  - fused kernel: HS071_eval_first_order writing all four results directly.
+// Reports the time per point and the largest difference to the separate results.
+// Optional arguments: number of points, repetitions.
+int main(
+        int    argc,
+        char** argv
+)
+{
+    const Index num_points = argc > 1 ? std::atoi(argv[1]) : 4096;
+    const Index reps = argc > 2 ? std::atoi(argv[2]) : 1000;
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<Number> uniform(1., 5.);
+    std::vector<Number> points(4 * (size_t) num_points);
+    for( size_t k = 0; k < points.size(); k++ )
+    {
+        points[k] = uniform(rng);
+    }
+
+    // f, grad f (4), g (2) and the Jacobian (8) per point
+    const Index outputs = 1 + 4 + 2 + HS071_FirstOrder::NNZ_JAC;
+    const char *names[3] = {"separate:        ", "fused callbacks: ", "fused kernel:    "};
+    std::vector<Number> results[3];
+    Number time[3] = {0., 0., 0.};
+    for( Index mode = 0; mode < 3; mode++ )
+    {
+        HS071_NLP nlp;
+        nlp.set_fused_evaluation(mode == 1);
+        results[mode].resize((size_t) outputs * num_points);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for( Index r = 0; r < reps; r++ )
+        {
+            for( Index p = 0; p < num_points; p++ )
+            {
+                const Number *x = points.data() + 4 * (size_t) p;
+                Number *out = results[mode].data() + (size_t) outputs * p;
+                if( mode == 2 )
+                {
+                    HS071_eval_first_order(x, out[0], out + 1, out + 5, out + 7);
+                    continue;
+                }
+                nlp.eval_f(4, x, true, out[0]);
+                nlp.eval_grad_f(4, x, false, out + 1);
+                nlp.eval_g(4, x, false, 2, out + 5);
+                nlp.eval_jac_g(4, x, false, 2, HS071_FirstOrder::NNZ_JAC, NULL, NULL, out + 7);
+            }
+        }
+        time[mode] = std::chrono::duration<Number>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    const Number evaluations = (Number) num_points * reps;
+    for( Index mode = 0; mode < 3; mode++ )
+    {
+        Number max_diff = 0.;
+        for( size_t k = 0; k < results[mode].size(); k++ )
+        {
+            const Number reference = results[0][k];
+            max_diff = std::max(max_diff, std::fabs(results[mode][k] - reference) / std::max(1., std::fabs(reference)));
+        }
+        std::cout << names[mode] << time[mode] / evaluations * 1e9 << " ns per point, speedup " << time[0] / time[mode]
+                  << ", largest relative difference " << max_diff << std::endl;
+    }
+    return 0;
+}
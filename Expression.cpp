@@ -0,0 +1,143 @@
+#include "IpIpoptApplication.hpp"
+#include "expression_nlp.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+using namespace Ipopt;
+
+// Loads a model (hs071.model by default, which CMake copies into the build directory), prints the size of its tape
+// and solves it. When the model has the shape of HS071 (4 variables, 2 constraints) it is then compared with the
+// hand-written HS071_NLP: the solutions, and the time of f, grad f, g, the Jacobian and the Hessian of the Lagrangian
+// at a set of random points in [1,5]^4, together with the largest difference between the two.
+// Optional arguments: model file, number of points, repetitions.
+int main(
+        int    argc,
+        char** argv
+)
+{
+    const std::string path = argc > 1 ? argv[1] : "hs071.model";
+    const Index num_points = argc > 2 ? std::atoi(argv[2]) : 4096;
+    const Index reps = argc > 3 ? std::atoi(argv[3]) : 200;
+
+    ExpressionModel model;
+    std::string error;
+    if( !model.load(path, error) )
+    {
+        std::cout << path << ": " << error << std::endl;
+        return 1;
+    }
+    std::cout << path << ": " << model.num_variables() << " variables, " << model.num_constraints() << " constraints, "
+              << model.num_parameters() << " parameters, " << model.tape().size() << " instructions, "
+              << model.jacobian_nonzeros() << " Jacobian and " << model.hessian_rows().size()
+              << " Hessian nonzeros" << std::endl;
+
+    SmartPtr<IpoptApplication> app = IpoptApplicationFactory();
+    app->Options()->SetNumericValue("tol", 1e-7);
+    app->Options()->SetStringValue("mu_strategy", "adaptive");
+    app->Options()->SetIntegerValue("print_level", 0);
+    if( app->Initialize() != Solve_Succeeded )
+    {
+        std::cout << std::endl << std::endl << "*** Error during initialization!" << std::endl;
+        return 1;
+    }
+    SmartPtr<ExpressionNLP> nlp = new ExpressionNLP(model);
+    nlp->set_verbose(false);
+    app->OptimizeTNLP(nlp);
+    const HS071_Solution &sol = nlp->solution();
+    std::cout << "status " << sol.status << ", " << sol.iter_count << " iterations, f(x*) = " << sol.obj_value
+              << std::endl;
+    for( size_t i = 0; i < sol.x.size(); i++ )
+    {
+        std::cout << "  " << model.variable_name((Index) i) << " = " << sol.x[i] << std::endl;
+    }
+    if( model.num_variables() != 4 || model.num_constraints() != 2 )
+    {
+        return 0;
+    }
+
+    SmartPtr<HS071_NLP> hs071 = new HS071_NLP();
+    hs071->set_verbose(false);
+    app->OptimizeTNLP(hs071);
+    Number max_x_diff = 0.;
+    for( size_t i = 0; i < sol.x.size() && i < hs071->solution().x.size(); i++ )
+    {
+        max_x_diff = std::max(max_x_diff, std::fabs(sol.x[i] - hs071->solution().x[i]));
+    }
+    std::cout << "HS071_NLP: " << hs071->solution().iter_count << " iterations, f(x*) = "
+              << hs071->solution().obj_value << ", largest difference in x " << max_x_diff << std::endl;
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<Number> uniform(1., 5.);
+    std::vector<Number> points(4 * (size_t) num_points);
+    for( size_t k = 0; k < points.size(); k++ )
+    {
+        points[k] = uniform(rng);
+    }
+
+    // the Hessian patterns differ in order, so both are scattered into a dense lower triangle to compare
+    const Index nnz_jac = model.jacobian_nonzeros(), nnz_h = (Index) model.hessian_rows().size();
+    const Index outputs = 1 + 4 + 2 + 8 + 10;
+    const char *names[2] = {"hand-written: ", "interpreter:  "};
+    TNLP *problems[2] = {GetRawPtr(hs071), GetRawPtr(nlp)};
+    std::vector<Number> results[2];
+    Number time[2] = {0., 0.};
+    const Number lambda[2] = {0.5, -0.25};
+    for( Index mode = 0; mode < 2; mode++ )
+    {
+        TNLP &problem = *problems[mode];
+        const Index nnz_jac_mode = mode == 0 ? 8 : nnz_jac, nnz_h_mode = mode == 0 ? 10 : nnz_h;
+        std::vector<Index> jac_rows(nnz_jac_mode), jac_cols(nnz_jac_mode), h_rows(nnz_h_mode), h_cols(nnz_h_mode);
+        problem.eval_jac_g(4, NULL, false, 2, nnz_jac_mode, jac_rows.data(), jac_cols.data(), NULL);
+        problem.eval_h(4, NULL, false, 1., 2, NULL, false, nnz_h_mode, h_rows.data(), h_cols.data(), NULL);
+        std::vector<Number> jac(nnz_jac_mode), h(nnz_h_mode);
+        results[mode].assign((size_t) outputs * num_points, 0.);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for( Index r = 0; r < reps; r++ )
+        {
+            for( Index p = 0; p < num_points; p++ )
+            {
+                const Number *x = points.data() + 4 * (size_t) p;
+                Number *out = results[mode].data() + (size_t) outputs * p;
+                problem.eval_f(4, x, true, out[0]);
+                problem.eval_grad_f(4, x, false, out + 1);
+                problem.eval_g(4, x, false, 2, out + 5);
+                problem.eval_jac_g(4, x, false, 2, nnz_jac_mode, NULL, NULL, jac.data());
+                problem.eval_h(4, x, false, 1., 2, lambda, true, nnz_h_mode, NULL, NULL, h.data());
+                if( r == 0 )
+                {
+                    for( Index k = 0; k < nnz_jac_mode; k++ )
+                    {
+                        out[7 + 4 * jac_rows[k] + jac_cols[k]] = jac[k];
+                    }
+                    for( Index k = 0; k < nnz_h_mode; k++ )
+                    {
+                        out[15 + h_rows[k] * (h_rows[k] + 1) / 2 + h_cols[k]] = h[k];
+                    }
+                }
+            }
+        }
+        time[mode] = std::chrono::duration<Number>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    const Number evaluations = (Number) num_points * reps;
+    Number max_diff = 0.;
+    for( size_t k = 0; k < results[0].size(); k++ )
+    {
+        const Number reference = results[0][k];
+        max_diff = std::max(max_diff, std::fabs(results[1][k] - reference) / std::max(1., std::fabs(reference)));
+    }
+    for( Index mode = 0; mode < 2; mode++ )
+    {
+        std::cout << names[mode] << time[mode] / evaluations * 1e9 << " ns per point (f, grad f, g, Jacobian, Hessian)"
+                  << std::endl;
+    }
+    std::cout << "interpreter / hand-written: " << time[1] / time[0] << ", largest relative difference " << max_diff
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "IpIpoptApplication.hpp"
+#include "finite_difference_tnlp.hpp"
+#include "hs071_horizon_nlp.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace Ipopt;
+
+// Solves the horizon HS071 once with its analytic derivatives and once with finite-difference derivatives from f and
+// g alone, colored and evaluated on a thread pool, and reports colors, function evaluations, iterations and time.
+// Optional arguments: horizon length, number of threads (0 = hardware threads).
+int main(
+        int    argc,
+        char** argv
+)
+{
+    const Index horizon = argc > 1 ? std::atoi(argv[1]) : 50;
+    const unsigned num_threads = argc > 2 ? std::atoi(argv[2]) : 0;
+
+    SmartPtr<IpoptApplication> app = IpoptApplicationFactory();
+    app->Options()->SetNumericValue("tol", 1e-7);
+    app->Options()->SetStringValue("mu_strategy", "adaptive");
+    app->Options()->SetIntegerValue("print_level", 0);
+    if( app->Initialize() != Solve_Succeeded )
+    {
+        std::cout << std::endl << std::endl << "*** Error during initialization!" << std::endl;
+        return 1;
+    }
+
+    std::shared_ptr<WorkStealingPool> pool = std::make_shared<WorkStealingPool>(num_threads);
+    for( Index mode = 0; mode < 2; mode++ )
+    {
+        SmartPtr<HS071_HorizonNLP> nlp = new HS071_HorizonNLP(horizon);
+        SmartPtr<FiniteDifferenceTNLP> fd;
+        SmartPtr<TNLP> solved = GetRawPtr(nlp);
+        if( mode == 1 )
+        {
+            fd = new FiniteDifferenceTNLP(solved, pool);
+            solved = GetRawPtr(fd);
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        ApplicationReturnStatus status = app->OptimizeTNLP(solved);
+        const Number time = std::chrono::duration<Number>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << (mode == 0 ? "analytic:          " : "finite differences: ") << "status " << status << ", "
+                  << nlp->solution().iter_count << " iterations, objective " << nlp->solution().obj_value << ", "
+                  << time * 1e3 << " ms" << std::endl;
+        if( mode == 1 )
+        {
+            std::cout << "  " << fd->num_jacobian_colors() << " Jacobian colors, " << fd->num_hessian_colors()
+                      << " Hessian colors, " << fd->num_f_evaluations() << " f and " << fd->num_g_evaluations()
+                      << " g evaluations on " << pool->size() << " threads" << std::endl;
+        }
+    }
+    return 0;
+}
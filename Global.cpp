@@ -0,0 +1,51 @@
+#include "hs071_global.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+using namespace Ipopt;
+
+// Certifies the global minimum of HS071 by spatial branch-and-bound with interval bounds and reports the bounds and
+// the search statistics.
+// Optional arguments: relative gap, number of threads (0 = hardware threads), g1 right hand side.
+int main(
+        int    argc,
+        char** argv
+)
+{
+    HS071_GlobalOptions options;
+    if( argc > 1 )
+    {
+        options.rel_gap = std::atof(argv[1]);
+    }
+    if( argc > 2 )
+    {
+        options.num_threads = std::atoi(argv[2]);
+    }
+    if( argc > 3 )
+    {
+        options.g1_rhs = std::atof(argv[3]);
+    }
+
+    HS071_GlobalSolver solver(options);
+    const bool certified = solver.run();
+
+    std::cout << std::setprecision(10);
+    std::cout << "lower bound       " << solver.lower_bound() << std::endl;
+    std::cout << "upper bound       " << solver.upper_bound() << std::endl;
+    std::cout << "certified         " << (certified ? "yes" : "no") << std::endl;
+    std::cout << "rounds            " << solver.rounds() << std::endl;
+    std::cout << "boxes evaluated   " << solver.boxes_evaluated() << std::endl;
+    std::cout << "boxes infeasible  " << solver.boxes_infeasible() << std::endl;
+    std::cout << "boxes pruned      " << solver.boxes_pruned() << std::endl;
+    std::cout << "local solves      " << solver.local_solves() << std::endl;
+    std::cout << "time [ms]         " << solver.wall_time() * 1e3 << std::endl;
+    if( solver.has_incumbent() )
+    {
+        const HS071_Solution &sol = solver.incumbent();
+        std::cout << std::endl << "x = (" << sol.x[0] << ", " << sol.x[1] << ", " << sol.x[2] << ", " << sol.x[3]
+                  << ")" << std::endl;
+    }
+    return certified ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+#include "IpIpoptApplication.hpp"
+#include "block_tridiag_solver.hpp"
+#include "parallel_block_solver.hpp"
+#include "hs071_horizon_nlp.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+using namespace Ipopt;
+
+// Solves HS071_HorizonNLP for growing horizons with the linear solver Ipopt is configured with, the serial
+// block-tridiagonal solver and its parallel-in-time variant, and reports iterations, wall time and time per
+// iteration. The block solvers should scale linearly in the horizon length, the parallel one divided by the cores.
+// Optional arguments: largest horizon, minimum block size of the block solvers, threads of the parallel solver.
+int main(
+        int    argc,
+        char** argv
+)
+{
+    const Index max_horizon = argc > 1 ? std::atoi(argv[1]) : 320;
+    const Index min_block_size = argc > 2 ? std::atoi(argv[2]) : 8;
+    const unsigned num_threads = argc > 3 ? std::atoi(argv[3]) : 0;
+    const char *names[3] = {"default", "block", "parallel"};
+
+    SmartPtr<IpoptApplication> app = IpoptApplicationFactory();
+    app->Options()->SetNumericValue("tol", 1e-7);
+    app->Options()->SetStringValue("mu_strategy", "adaptive");
+    app->Options()->SetIntegerValue("print_level", 0);
+    if( app->Initialize() != Solve_Succeeded )
+    {
+        std::cout << std::endl << std::endl << "*** Error during initialization!" << std::endl;
+        return 1;
+    }
+
+    std::cout << "horizon  solver  status  iter  time[ms]  ms/iter" << std::endl;
+    for( Index horizon = 10; horizon <= max_horizon; horizon *= 2 )
+    {
+        for( Index mode = 0; mode < 3; mode++ )
+        {
+            SmartPtr<HS071_HorizonNLP> nlp = new HS071_HorizonNLP(horizon);
+            for( Index t = 0; t < horizon; t++ )
+            {
+                nlp->set_stage_parameter(t, HS071_G1_RHS, 40.0 + 3.0 * std::sin(0.2 * t));
+            }
+
+            SmartPtr<AlgorithmBuilder> builder;
+            if( mode == 1 )
+            {
+                builder = new BlockTridiagAlgorithmBuilder(min_block_size);
+            }
+            else if( mode == 2 )
+            {
+                builder = new ParallelBlockAlgorithmBuilder(num_threads, 0, min_block_size);
+            }
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            ApplicationReturnStatus status;
+            if( IsValid(builder) )
+            {
+                status = app->OptimizeTNLP(nlp, builder);
+            }
+            else
+            {
+                status = app->OptimizeTNLP(nlp);
+            }
+            const Number time = std::chrono::duration<Number>(std::chrono::steady_clock::now() - start).count();
+
+            const Index iterations = nlp->solution().iter_count;
+            std::cout << horizon << "\t" << names[mode] << "\t" << status << "\t" << iterations
+                      << "\t" << time * 1e3 << "\t" << time * 1e3 / std::max(iterations, 1) << std::endl;
+        }
+    }
+    return 0;
+}
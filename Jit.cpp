@@ -0,0 +1,138 @@
+#include "IpIpoptApplication.hpp"
+#include "expression_nlp.hpp"
+#include "model_compiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+using namespace Ipopt;
+
+// Compiles a model (hs071.model by default, which CMake copies into the build directory) to native code twice, the
+// second time from the cache, and solves it with the compiled callbacks. Then times f, grad f, g, the Jacobian and the
+// Hessian of the Lagrangian at a set of random points within the variable bounds (clipped to [-10,10]) for the
+// interpreter and the compiled code, and for HS071_NLP when the model has the shape of HS071, and reports the largest
+// difference between interpreter and compiled code.
+// Optional arguments: model file, cache directory, number of points, repetitions.
+int main(
+        int    argc,
+        char** argv
+)
+{
+    const std::string path = argc > 1 ? argv[1] : "hs071.model";
+    ModelCompilerOptions options;
+    if( argc > 2 )
+    {
+        options.cache_dir = argv[2];
+    }
+    const Index num_points = argc > 3 ? std::atoi(argv[3]) : 4096;
+    const Index reps = argc > 4 ? std::atoi(argv[4]) : 200;
+
+    ExpressionModel model;
+    std::string error;
+    if( !model.load(path, error) )
+    {
+        std::cout << path << ": " << error << std::endl;
+        return 1;
+    }
+    std::shared_ptr<CompiledModel> compiled;
+    for( Index attempt = 0; attempt < 2; attempt++ )
+    {
+        compiled = std::make_shared<CompiledModel>();
+        if( !compiled->compile(model, options, error) )
+        {
+            std::cout << error << std::endl;
+            return 1;
+        }
+        std::cout << (compiled->cache_hit() ? "loaded " : "compiled ") << compiled->library_path() << " in "
+                  << compiled->compile_time() << " s" << std::endl;
+    }
+
+    SmartPtr<IpoptApplication> app = IpoptApplicationFactory();
+    app->Options()->SetNumericValue("tol", 1e-7);
+    app->Options()->SetStringValue("mu_strategy", "adaptive");
+    app->Options()->SetIntegerValue("print_level", 0);
+    if( app->Initialize() != Solve_Succeeded )
+    {
+        std::cout << std::endl << std::endl << "*** Error during initialization!" << std::endl;
+        return 1;
+    }
+    SmartPtr<ExpressionNLP> nlp = new ExpressionNLP(model);
+    nlp->set_verbose(false);
+    nlp->set_compiled(compiled);
+    app->OptimizeTNLP(nlp);
+    std::cout << "status " << nlp->solution().status << ", " << nlp->solution().iter_count << " iterations, f(x*) = "
+              << nlp->solution().obj_value << std::endl;
+
+    const Index n = model.num_variables(), m = model.num_constraints();
+    std::vector<Number> x_l(n), x_u(n), g_l(m), g_u(m);
+    model.bounds(x_l.data(), x_u.data(), g_l.data(), g_u.data());
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<Number> uniform(0., 1.);
+    std::vector<Number> points((size_t) n * num_points);
+    for( size_t k = 0; k < points.size(); k++ )
+    {
+        const Number lower = std::max(x_l[k % n], -10.), upper = std::min(x_u[k % n], 10.);
+        points[k] = lower + (upper - lower) * uniform(rng);
+    }
+    std::vector<Number> lambda(m);
+    for( Index j = 0; j < m; j++ )
+    {
+        lambda[j] = uniform(rng) - 0.5;
+    }
+
+    const Index nnz_jac = model.jacobian_nonzeros(), nnz_h = (Index) model.hessian_rows().size();
+    const Index outputs = 1 + n + m + nnz_jac + nnz_h;
+    const char *names[3] = {"interpreter:  ", "compiled:     ", "hand-written: "};
+    SmartPtr<ExpressionNLP> interpreted = new ExpressionNLP(model);
+    SmartPtr<HS071_NLP> hs071 = new HS071_NLP();
+    TNLP *problems[3] = {GetRawPtr(interpreted), GetRawPtr(nlp), GetRawPtr(hs071)};
+    const Index modes = n == 4 && m == 2 ? 3 : 2;
+    std::vector<Number> results[2];
+    Number time[3] = {0., 0., 0.};
+    for( Index mode = 0; mode < modes; mode++ )
+    {
+        TNLP &problem = *problems[mode];
+        const Index nnz_jac_mode = mode == 2 ? 8 : nnz_jac, nnz_h_mode = mode == 2 ? 10 : nnz_h;
+        std::vector<Number> scratch((size_t) outputs);
+        if( mode < 2 )
+        {
+            results[mode].resize((size_t) outputs * num_points);
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for( Index r = 0; r < reps; r++ )
+        {
+            for( Index p = 0; p < num_points; p++ )
+            {
+                const Number *x = points.data() + (size_t) n * p;
+                Number *out = mode < 2 ? results[mode].data() + (size_t) outputs * p : scratch.data();
+                problem.eval_f(n, x, true, out[0]);
+                problem.eval_grad_f(n, x, false, out + 1);
+                problem.eval_g(n, x, false, m, out + 1 + n);
+                problem.eval_jac_g(n, x, false, m, nnz_jac_mode, NULL, NULL, out + 1 + n + m);
+                problem.eval_h(n, x, false, 1., m, lambda.data(), true, nnz_h_mode, NULL, NULL,
+                               out + 1 + n + m + nnz_jac_mode);
+            }
+        }
+        time[mode] = std::chrono::duration<Number>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    const Number evaluations = (Number) num_points * reps;
+    Number max_diff = 0.;
+    for( size_t k = 0; k < results[0].size(); k++ )
+    {
+        const Number reference = results[0][k];
+        max_diff = std::max(max_diff, std::fabs(results[1][k] - reference) / std::max(1., std::fabs(reference)));
+    }
+    for( Index mode = 0; mode < modes; mode++ )
+    {
+        std::cout << names[mode] << time[mode] / evaluations * 1e9 << " ns per point (f, grad f, g, Jacobian, Hessian)"
+                  << std::endl;
+    }
+    std::cout << "largest relative difference between interpreter and compiled code " << max_diff << std::endl;
+    return 0;
+}
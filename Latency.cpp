@@ -0,0 +1,116 @@
+#include "IpIpoptApplication.hpp"
+#include "hs071_multistart.hpp"
+#include "hs071_realtime.hpp"
+#include "solve_latency.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+using namespace Ipopt;
+
+static void print_row(const std::string &label, const LatencyHistogram &h) {
+    std::printf("%-48s %8llu %10.1f %10.1f %10.1f %10.1f %10.1f\n", label.c_str(), (unsigned long long) h.count(),
+                1e6 * h.quantile(0.5), 1e6 * h.quantile(0.9), 1e6 * h.quantile(0.99), 1e6 * h.quantile(0.999),
+                1e-3 * (Number) h.max());
+}
+
+// Records the wall time of every OptimizeTNLP call in two modes and reports the latency percentiles, over all solves
+// and by return status and iteration count:
+//  - batch: a multi-start search, the local solves spread over a thread pool,
+//  - service: a number of threads each serving a stream of deadline solves of drifting HS071 instances (see
+//    RealTime), as a solve service would.
+// Each mode writes its histograms as a Prometheus text file.
+// Optional arguments: number of starts, number of solves per service thread, number of threads (0 for all hardware
+// threads), deadline in microseconds, directory of the Prometheus files (the current one by default).
+int main(
+        int    argc,
+        char** argv
+)
+{
+    const Index starts = argc > 1 ? std::atoi(argv[1]) : 512;
+    const Index requests = argc > 2 ? std::atoi(argv[2]) : 1000;
+    unsigned threads = argc > 3 ? (unsigned) std::atoi(argv[3]) : 0;
+    const long budget_us = argc > 4 ? std::atol(argv[4]) : 2000;
+    const std::string directory = argc > 5 ? argv[5] : ".";
+    if( threads == 0 )
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    SolveLatencyRecorder batch;
+    HS071_MultiStartOptions options;
+    options.max_starts = starts;
+    // every start runs, the latency of the whole batch is wanted
+    options.stall_starts = starts;
+    options.num_threads = threads;
+    options.latency = &batch;
+    options.configure = [](const SmartPtr<IpoptApplication> &app) {
+        app->Options()->SetNumericValue("tol", 1e-7);
+        app->Options()->SetStringValue("mu_strategy", "adaptive");
+    };
+    HS071_MultiStart search(options);
+    search.run();
+
+    SolveLatencyRecorder service;
+    std::vector<std::thread> workers;
+    std::atomic<bool> initialized(true);
+    for( unsigned t = 0; t < threads; t++ )
+    {
+        workers.push_back(std::thread([t, requests, budget_us, &service, &initialized]() {
+            SmartPtr<IpoptApplication> app = IpoptApplicationFactory();
+            app->Options()->SetNumericValue("tol", 1e-7);
+            app->Options()->SetStringValue("mu_strategy", "adaptive");
+            app->Options()->SetIntegerValue("print_level", 0);
+            if( app->Initialize() != Solve_Succeeded )
+            {
+                initialized = false;
+                return;
+            }
+            SmartPtr<HS071_RealTimeNLP> nlp = new HS071_RealTimeNLP();
+            nlp->set_verbose(false);
+            for( Index k = 0; k < requests; k++ )
+            {
+                nlp->set_parameter(HS071_G1_RHS, 40.0 + 5.0 * ((k + 7 * t) % 20) / 20.0);
+                HS071_solve_with_deadline(app, nlp, HS071_Clock::now() + std::chrono::microseconds(budget_us),
+                                          &service);
+            }
+        }));
+    }
+    for( size_t t = 0; t < workers.size(); t++ )
+    {
+        workers[t].join();
+    }
+    if( !initialized )
+    {
+        std::cout << std::endl << std::endl << "*** Error during initialization!" << std::endl;
+        return 1;
+    }
+
+    const char *modes[2] = {"batch", "service"};
+    const SolveLatencyRecorder *recorders[2] = {&batch, &service};
+    bool written = true;
+    for( Index mode = 0; mode < 2; mode++ )
+    {
+        const SolveLatencyReport report = recorders[mode]->report();
+        std::printf("\n%-48s %8s %10s %10s %10s %10s %10s\n", modes[mode], "solves", "p50 us", "p90 us", "p99 us",
+                    "p999 us", "max us");
+        print_row("all", report.all);
+        for( std::map<std::pair<Index, Index>, LatencyHistogram>::const_iterator it = report.by_outcome.begin();
+             it != report.by_outcome.end(); ++it )
+        {
+            print_row(std::string(SolveLatencyRecorder::status_name(it->first.first)) + ", "
+                      + SolveLatencyRecorder::iteration_class_label(it->first.second) + " iterations", it->second);
+        }
+        const std::string path = directory + "/hs071_" + modes[mode] + "_latency.prom";
+        if( !recorders[mode]->write_prometheus(path, std::string("hs071_") + modes[mode] + "_solve_latency_seconds") )
+        {
+            std::cout << "cannot write " << path << std::endl;
+            written = false;
+        }
+    }
+    return written ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+#include "IpIpoptApplication.hpp"
+#include "hs071_mpc.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+using namespace Ipopt;
+
+// Tracks a sinusoidal reference for the right hand side of g1 with a receding horizon, once warm started by
+// shifting the previous trajectory and once cold, and reports iterations and cycle time per step.
+// Optional arguments: horizon length, number of cycles.
+int main(
+        int    argc,
+        char** argv
+)
+{
+    const Index horizon = argc > 1 ? std::atoi(argv[1]) : 10;
+    const Index cycles = argc > 2 ? std::atoi(argv[2]) : 40;
+
+    std::vector<Number> reference;
+    for( Index k = 0; k < cycles + horizon; k++ )
+    {
+        reference.push_back(40.0 + 3.0 * std::sin(0.2 * k));
+    }
+
+    Index iterations[2] = {0, 0};
+    Number time[2] = {0., 0.};
+    for( Index mode = 0; mode < 2; mode++ )
+    {
+        SmartPtr<IpoptApplication> app = IpoptApplicationFactory();
+        app->Options()->SetNumericValue("tol", 1e-7);
+        app->Options()->SetStringValue("mu_strategy", "adaptive");
+        app->Options()->SetIntegerValue("print_level", 0);
+        if( app->Initialize() != Solve_Succeeded )
+        {
+            std::cout << std::endl << std::endl << "*** Error during initialization!" << std::endl;
+            return 1;
+        }
+        const bool warm = mode == 0;
+        HS071_MPC mpc(app, horizon, warm);
+        std::vector<HS071_MPCStep> steps = mpc.run(reference, cycles);
+
+        std::cout << (warm ? "shift warm start" : "cold start") << std::endl << "cycle  iter  time[ms]  status"
+                  << std::endl;
+        for( size_t k = 0; k < steps.size(); k++ )
+        {
+            std::cout << k << "\t" << steps[k].iterations << "\t" << steps[k].cycle_time * 1e3 << "\t"
+                      << steps[k].status << std::endl;
+            iterations[mode] += steps[k].iterations;
+            time[mode] += steps[k].cycle_time;
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "warm: " << iterations[0] << " iterations, " << time[0] * 1e3 << " ms" << std::endl;
+    std::cout << "cold: " << iterations[1] << " iterations, " << time[1] * 1e3 << " ms" << std::endl;
+    return 0;
+}
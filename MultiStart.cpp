@@ -0,0 +1,41 @@
+#include "IpIpoptApplication.hpp"
+#include "hs071_multistart.hpp"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace Ipopt;
+
+// Multi-start search over the HS071 box. Optional arguments: number of starts, number of threads.
+int main(
+        int    argc,
+        char** argv
+)
+{
+    HS071_MultiStartOptions options;
+    options.max_starts = argc > 1 ? std::atoi(argv[1]) : 64;
+    options.num_threads = argc > 2 ? (unsigned) std::atoi(argv[2]) : 0;
+    options.configure = [](const SmartPtr<IpoptApplication> &app) {
+        app->Options()->SetNumericValue("tol", 1e-7);
+        app->Options()->SetStringValue("mu_strategy", "adaptive");
+    };
+
+    HS071_MultiStart search(options);
+    search.run();
+
+    std::cout << search.starts_solved() << " starts solved, " << search.starts_failed() << " failed, "
+              << search.total_iterations() << " iterations" << (search.stopped_early() ? " (stopped early)" : "")
+              << std::endl;
+    const std::vector<HS071_LocalMinimum> &minima = search.minima();
+    for( size_t i = 0; i < minima.size(); i++ )
+    {
+        const HS071_Solution &sol = minima[i].solution;
+        std::cout << std::endl << "minimum " << i << ": f(x*) = " << sol.obj_value << ", found " << minima[i].hits
+                  << " times, first from start " << minima[i].first_start << std::endl;
+        for( size_t j = 0; j < sol.x.size(); j++ )
+        {
+            std::cout << "x[" << j << "] = " << sol.x[j] << std::endl;
+        }
+    }
+    return minima.empty() ? 1 : 0;
+}
@@ -6,8 +6,8 @@
 using namespace Ipopt;
 
 int main(
-        int    /*argv*/,
-        char** /*argc*/
+        int    argc,
+        char** argv
 )
 {
     // Create a new instance of your nlp
@@ -26,9 +26,11 @@ int main(
     app->Options()->SetStringValue("output_file", "ipopt.out");
     // The following overwrites the default name (ipopt.opt) of the options file
     // app->Options()->SetStringValue("option_file_name", "hs071.opt");
-    // Initialize the IpoptApplication and process the options
+    // Initialize the IpoptApplication and process the options. An options file
+    // given on the command line (e.g. written by Autotune) takes precedence over
+    // the choices above.
     ApplicationReturnStatus status;
-    status = app->Initialize();
+    status = argc > 1 ? app->Initialize(argv[1], true) : app->Initialize();
     if( status != Solve_Succeeded )
     {
         std::cout << std::endl << std::endl << "*** Error during initialization!" << std::endl;
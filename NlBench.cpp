@@ -0,0 +1,176 @@
+#include "IpIpoptApplication.hpp"
+#include "expression_nlp.hpp"
+#include "nl_reader.hpp"
+#include "work_stealing_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+
+#include <dirent.h>
+
+using namespace Ipopt;
+
+// ExpressionNLP that adds up the time spent in the evaluation callbacks
+class TimedNLP: public ExpressionNLP {
+
+public:
+    explicit TimedNLP(const ExpressionModel &model) : ExpressionNLP(model), eval_time_(0.) {}
+
+    Number eval_time() const { return eval_time_; }
+
+    bool eval_f(Index n, const Number *x, bool new_x, Number &obj_value) {
+        const Clock::time_point start = Clock::now();
+        const bool ok = ExpressionNLP::eval_f(n, x, new_x, obj_value);
+        add(start);
+        return ok;
+    }
+    bool eval_grad_f(Index n, const Number *x, bool new_x, Number *grad_f) {
+        const Clock::time_point start = Clock::now();
+        const bool ok = ExpressionNLP::eval_grad_f(n, x, new_x, grad_f);
+        add(start);
+        return ok;
+    }
+    bool eval_g(Index n, const Number *x, bool new_x, Index m, Number *g) {
+        const Clock::time_point start = Clock::now();
+        const bool ok = ExpressionNLP::eval_g(n, x, new_x, m, g);
+        add(start);
+        return ok;
+    }
+    bool eval_jac_g(Index n, const Number *x, bool new_x, Index m, Index nele_jac, Index *iRow, Index *jCol,
+                    Number *values) {
+        const Clock::time_point start = Clock::now();
+        const bool ok = ExpressionNLP::eval_jac_g(n, x, new_x, m, nele_jac, iRow, jCol, values);
+        add(start);
+        return ok;
+    }
+    bool eval_h(Index n, const Number *x, bool new_x, Number obj_factor, Index m, const Number *lambda, bool new_lambda,
+                Index nele_hess, Index *iRow, Index *jCol, Number *values) {
+        const Clock::time_point start = Clock::now();
+        const bool ok = ExpressionNLP::eval_h(n, x, new_x, obj_factor, m, lambda, new_lambda, nele_hess, iRow, jCol,
+                                              values);
+        add(start);
+        return ok;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void add(const Clock::time_point &start) {
+        eval_time_ += std::chrono::duration<Number>(Clock::now() - start).count();
+    }
+
+    Number eval_time_;
+
+};
+
+struct NlRun {
+    std::string name;
+    std::string error;
+    Index n, m;
+    Index status, iterations;
+    Number objective;
+    Number read_time, eval_time, solver_time;
+};
+
+// Solves every .nl file in a directory (write them from the AMPL ports of the HS or CUTE sets with ampl -og) through
+// ExpressionNLP, one task per file on a WorkStealingPool, and reports per model the time to read the file, the time in
+// the evaluation callbacks and the time in Ipopt itself (the solve minus the callbacks).
+// Optional arguments: directory (nl by default), number of threads (0 for all hardware threads, the default).
+int main(
+        int    argc,
+        char** argv
+)
+{
+    const std::string directory = argc > 1 ? argv[1] : "nl";
+    const Index num_threads = argc > 2 ? std::atoi(argv[2]) : 0;
+
+    std::vector<NlRun> runs;
+    DIR *dir = opendir(directory.c_str());
+    if( dir == NULL )
+    {
+        std::cout << "cannot open directory " << directory << std::endl;
+        return 1;
+    }
+    for( struct dirent *entry = readdir(dir); entry != NULL; entry = readdir(dir) )
+    {
+        const std::string name = entry->d_name;
+        if( name.size() > 3 && name.compare(name.size() - 3, 3, ".nl") == 0 )
+        {
+            runs.push_back(NlRun());
+            runs.back().name = name;
+        }
+    }
+    closedir(dir);
+    std::sort(runs.begin(), runs.end(), [](const NlRun &a, const NlRun &b) { return a.name < b.name; });
+
+    std::mutex mutex;
+    bool initialized = true;
+    WorkStealingPool pool(num_threads);
+    for( size_t r = 0; r < runs.size(); r++ )
+    {
+        pool.submit([&runs, r, &directory, &mutex, &initialized]() {
+            typedef std::chrono::steady_clock Clock;
+            NlRun &run = runs[r];
+            ExpressionModel model;
+            const Clock::time_point start = Clock::now();
+            const bool read = read_nl_model(directory + "/" + run.name, model, run.error);
+            run.read_time = std::chrono::duration<Number>(Clock::now() - start).count();
+            if( !read )
+            {
+                return;
+            }
+            run.n = model.num_variables();
+            run.m = model.num_constraints();
+
+            SmartPtr<IpoptApplication> app = IpoptApplicationFactory();
+            app->Options()->SetNumericValue("tol", 1e-7);
+            app->Options()->SetStringValue("mu_strategy", "adaptive");
+            app->Options()->SetIntegerValue("print_level", 0);
+            if( app->Initialize() != Solve_Succeeded )
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                initialized = false;
+                return;
+            }
+            SmartPtr<TimedNLP> nlp = new TimedNLP(model);
+            nlp->set_verbose(false);
+            const Clock::time_point solve = Clock::now();
+            app->OptimizeTNLP(nlp);
+            const Number elapsed = std::chrono::duration<Number>(Clock::now() - solve).count();
+            run.status = nlp->solution().status;
+            run.iterations = nlp->solution().iter_count;
+            run.objective = nlp->solution().obj_value;
+            run.eval_time = nlp->eval_time();
+            run.solver_time = elapsed - run.eval_time;
+        });
+    }
+    pool.wait();
+    if( !initialized )
+    {
+        std::cout << std::endl << std::endl << "*** Error during initialization!" << std::endl;
+        return 1;
+    }
+
+    std::printf("%-20s %7s %7s %6s %6s %16s %10s %10s %10s\n", "model", "n", "m", "status", "iter", "objective",
+                "read ms", "eval ms", "solver ms");
+    Index failed = 0;
+    for( size_t r = 0; r < runs.size(); r++ )
+    {
+        const NlRun &run = runs[r];
+        if( !run.error.empty() )
+        {
+            std::printf("%-20s %s\n", run.name.c_str(), run.error.c_str());
+            failed++;
+            continue;
+        }
+        std::printf("%-20s %7d %7d %6d %6d %16.8e %10.3f %10.3f %10.3f\n", run.name.c_str(), (int) run.n,
+                    (int) run.m, (int) run.status, (int) run.iterations, run.objective, 1e3 * run.read_time,
+                    1e3 * run.eval_time, 1e3 * run.solver_time);
+    }
+    std::cout << runs.size() << " models, " << failed << " not read" << std::endl;
+    return 0;
+}
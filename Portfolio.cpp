@@ -0,0 +1,53 @@
+#include "IpIpoptApplication.hpp"
+#include "hs071_portfolio.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+using namespace Ipopt;
+
+// Races the default portfolio on a sweep of HS071 instances (right hand side of the equality from 30 to 60) and
+// prints the win statistics. Optional arguments: number of instances, statistics file to accumulate into.
+int main(
+        int    argc,
+        char** argv
+)
+{
+    const Index instances = argc > 1 ? std::atoi(argv[1]) : 16;
+    HS071_Portfolio portfolio(HS071_Portfolio::default_portfolio());
+    if( argc > 2 )
+    {
+        portfolio.read_statistics(argv[2]);
+    }
+
+    Index solved = 0;
+    for( Index i = 0; i < instances; i++ )
+    {
+        Number rhs = 30.0 + 30.0 * i / std::max(1, instances - 1);
+        HS071_RaceResult result = portfolio.race(25.0, rhs);
+        if( result.solved )
+        {
+            solved++;
+            std::cout << "rhs " << rhs << ": " << portfolio.configs()[result.winner].name << " won after "
+                      << result.wall_time << " s, f(x*) = " << result.solution.obj_value << std::endl;
+        }
+        else
+        {
+            std::cout << "rhs " << rhs << ": no configuration succeeded" << std::endl;
+        }
+    }
+
+    std::cout << std::endl << "configuration          races  wins  failed  cancelled" << std::endl;
+    for( size_t k = 0; k < portfolio.configs().size(); k++ )
+    {
+        const HS071_ConfigStats &s = portfolio.statistics()[k];
+        std::cout << portfolio.configs()[k].name << "\t" << s.races << "\t" << s.wins << "\t" << s.failures << "\t"
+                  << s.cancelled << std::endl;
+    }
+    if( argc > 2 && !portfolio.write_statistics(argv[2]) )
+    {
+        std::cout << "*** could not write " << argv[2] << std::endl;
+    }
+    return solved == instances ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+#include "IpIpoptApplication.hpp"
+#include "hs071_presolve.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace Ipopt;
+
+// Sweeps a grid of HS071 parameter sets (g0 lower bound, g1 right hand side), many of them infeasible, once solving
+// every set directly and once after the interval presolve, and compares solves, iterations and time.
+// Optional argument: grid points per parameter.
+int main(
+        int    argc,
+        char** argv
+)
+{
+    const Index grid = argc > 1 ? std::atoi(argv[1]) : 20;
+
+    SmartPtr<IpoptApplication> app = IpoptApplicationFactory();
+    app->Options()->SetNumericValue("tol", 1e-7);
+    app->Options()->SetIntegerValue("print_level", 0);
+    if( app->Initialize() != Solve_Succeeded )
+    {
+        std::cout << std::endl << std::endl << "*** Error during initialization!" << std::endl;
+        return 1;
+    }
+
+    for( Index mode = 0; mode < 2; mode++ )
+    {
+        const bool presolve = mode == 1;
+        Index solves = 0, rejected = 0, infeasible = 0, tightened = 0, iterations = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for( Index a = 0; a < grid; a++ )
+        {
+            for( Index b = 0; b < grid; b++ )
+            {
+                // g0 over [5, 700] and g1 over [2, 110], beyond the ranges [1, 625] and [4, 100] the box allows
+                SmartPtr<HS071_NLP> nlp = new HS071_NLP(5.0 + 695.0 * a / (grid - 1), 2.0 + 108.0 * b / (grid - 1));
+                nlp->set_verbose(false);
+                ApplicationReturnStatus status;
+                if( presolve )
+                {
+                    HS071_PresolveResult result;
+                    status = HS071_presolve_and_solve(app, nlp, &result);
+                    rejected += result.infeasible;
+                    tightened += result.tightened > 0;
+                    if( result.infeasible )
+                    {
+                        infeasible++;
+                        continue;
+                    }
+                }
+                else
+                {
+                    status = app->OptimizeTNLP(nlp);
+                }
+                solves++;
+                iterations += nlp->solution().iter_count;
+                infeasible += status == Infeasible_Problem_Detected;
+            }
+        }
+        const Number time = std::chrono::duration<Number>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << (presolve ? "with presolve" : "without presolve") << std::endl;
+        std::cout << "  parameter sets     " << grid * grid << std::endl;
+        std::cout << "  Ipopt solves       " << solves << std::endl;
+        std::cout << "  infeasible         " << infeasible << std::endl;
+        if( presolve )
+        {
+            std::cout << "  rejected           " << rejected << std::endl;
+            std::cout << "  boxes tightened    " << tightened << std::endl;
+        }
+        std::cout << "  iterations         " << iterations << std::endl;
+        std::cout << "  time [ms]          " << time * 1e3 << std::endl;
+    }
+    return 0;
+}
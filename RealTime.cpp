@@ -0,0 +1,54 @@
+#include "IpIpoptApplication.hpp"
+#include "hs071_realtime.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+using namespace Ipopt;
+
+// Simulates a control loop: every cycle solves HS071 with a drifting right hand side under a hard budget,
+// warm started from the previous cycle. Optional arguments: budget per cycle in microseconds, number of cycles.
+int main(
+        int    argc,
+        char** argv
+)
+{
+    const long budget_us = argc > 1 ? std::atol(argv[1]) : 500;
+    const Index cycles = argc > 2 ? std::atoi(argv[2]) : 100;
+
+    SmartPtr<IpoptApplication> app = IpoptApplicationFactory();
+    app->Options()->SetNumericValue("tol", 1e-7);
+    app->Options()->SetStringValue("mu_strategy", "adaptive");
+    app->Options()->SetIntegerValue("print_level", 0);
+    ApplicationReturnStatus status;
+    status = app->Initialize();
+    if( status != Solve_Succeeded )
+    {
+        std::cout << std::endl << std::endl << "*** Error during initialization!" << std::endl;
+        return (int) status;
+    }
+
+    SmartPtr<HS071_RealTimeNLP> nlp = new HS071_RealTimeNLP();
+    nlp->set_verbose(false);
+    Index counts[4] = {0, 0, 0, 0};
+    Number worst = 0.;
+    for( Index k = 0; k < cycles; k++ )
+    {
+        nlp->set_parameter(HS071_G1_RHS, 40.0 + 5.0 * (k % 20) / 20.0);
+        HS071_Clock::time_point deadline = HS071_Clock::now() + std::chrono::microseconds(budget_us);
+        HS071_RealTimeResult result = HS071_solve_with_deadline(app, nlp, deadline);
+        counts[result.status]++;
+        worst = std::max(worst, result.wall_time);
+        if( result.status == HS071_RT_CONVERGED || result.status == HS071_RT_BEST_ITERATE )
+        {
+            nlp->set_starting_point(result.x);
+        }
+    }
+
+    std::cout << "budget " << budget_us << " us, worst cycle " << worst * 1e6 << " us" << std::endl;
+    std::cout << "converged: " << counts[HS071_RT_CONVERGED] << ", best iterate: " << counts[HS071_RT_BEST_ITERATE]
+              << ", infeasible iterate: " << counts[HS071_RT_INFEASIBLE_ITERATE] << ", failed: "
+              << counts[HS071_RT_FAILED] << std::endl;
+    return counts[HS071_RT_FAILED] == 0 ? 0 : 1;
+}
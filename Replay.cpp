@@ -0,0 +1,90 @@
+#include "IpIpoptApplication.hpp"
+#include "callback_trace.hpp"
+#include "hs071_nlp.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+using namespace Ipopt;
+
+// Records the callbacks of an HS071_NLP solve to a trace file, then replays the trace against fresh HS071_NLP
+// instances without Ipopt, once per evaluation mode (separate and fused, see HS071_NLP::set_fused_evaluation): the
+// time of the whole sequence, the calls and the time per call of every method, and the largest difference to the
+// recorded outputs. With "replay" as the third argument, an existing trace is replayed without solving.
+// Optional arguments: trace file (hs071.trace by default), repetitions, "replay".
+int main(
+        int    argc,
+        char** argv
+)
+{
+    const std::string path = argc > 1 ? argv[1] : "hs071.trace";
+    const Index reps = argc > 2 ? std::atoi(argv[2]) : 10000;
+    const bool record = argc <= 3 || std::string(argv[3]) != "replay";
+
+    if( record )
+    {
+        SmartPtr<IpoptApplication> app = IpoptApplicationFactory();
+        app->Options()->SetNumericValue("tol", 1e-7);
+        app->Options()->SetStringValue("mu_strategy", "adaptive");
+        app->Options()->SetIntegerValue("print_level", 0);
+        if( app->Initialize() != Solve_Succeeded )
+        {
+            std::cout << std::endl << std::endl << "*** Error during initialization!" << std::endl;
+            return 1;
+        }
+        SmartPtr<HS071_NLP> nlp = new HS071_NLP();
+        nlp->set_verbose(false);
+        SmartPtr<CallbackRecorder> recorder = new CallbackRecorder(GetRawPtr(nlp), path);
+        app->OptimizeTNLP(recorder);
+        recorder->flush();
+        if( !recorder->ok() )
+        {
+            std::cout << "cannot write " << path << std::endl;
+            return 1;
+        }
+        std::cout << "recorded " << recorder->num_records() << " callbacks of a solve with status "
+                  << nlp->solution().status << " to " << path << std::endl;
+    }
+
+    CallbackTrace trace;
+    std::string error;
+    if( !trace.load(path, error) )
+    {
+        std::cout << error << std::endl;
+        return 1;
+    }
+
+    const char *modes[2] = {"separate", "fused"};
+    for( Index mode = 0; mode < 2; mode++ )
+    {
+        // the sequence alone, then once more with every call timed for the breakdown
+        CallbackReplayStats total, methods;
+        for( Index r = 0; r < reps; r++ )
+        {
+            HS071_NLP nlp;
+            nlp.set_verbose(false);
+            nlp.set_fused_evaluation(mode == 1);
+            replay_callbacks(trace, nlp, false, total);
+        }
+        for( Index r = 0; r < reps; r++ )
+        {
+            HS071_NLP nlp;
+            nlp.set_verbose(false);
+            nlp.set_fused_evaluation(mode == 1);
+            replay_callbacks(trace, nlp, true, methods);
+        }
+        std::printf("%s: %zu calls in %.3f us per replay, max difference %g, %d mismatches\n", modes[mode],
+                    trace.records.size(), 1e6 * total.total_seconds / reps, total.max_difference,
+                    (int) total.mismatches);
+        for( Index k = 0; k < CALLBACK_NUM_METHODS; k++ )
+        {
+            if( methods.calls[k] > 0 )
+            {
+                std::printf("  %-22s %6d calls %10.1f ns per call\n", callback_method_name(k),
+                            (int) (methods.calls[k] / reps), 1e9 * methods.seconds[k] / methods.calls[k]);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "IpIpoptApplication.hpp"
+#include "hs071_sensitivity.hpp"
+
+#include <iostream>
+
+using namespace Ipopt;
+
+// Solves HS071 once and prints d(x*, lambda*)/dp from the implicit differentiation of the KKT conditions next to
+// central finite differences, which need two additional solves per parameter.
+int main(
+        int    /*argv*/,
+        char** /*argc*/
+)
+{
+    SmartPtr<IpoptApplication> app = IpoptApplicationFactory();
+    app->Options()->SetNumericValue("tol", 1e-10);
+    app->Options()->SetStringValue("mu_strategy", "adaptive");
+    app->Options()->SetIntegerValue("print_level", 0);
+    ApplicationReturnStatus status;
+    status = app->Initialize();
+    if( status != Solve_Succeeded )
+    {
+        std::cout << std::endl << std::endl << "*** Error during initialization!" << std::endl;
+        return (int) status;
+    }
+
+    SmartPtr<HS071_NLP> nlp = new HS071_NLP();
+    nlp->set_verbose(false);
+    status = app->OptimizeTNLP(nlp);
+    HS071_Sensitivity sens;
+    if( !sens.factorize(*nlp) )
+    {
+        std::cout << std::endl << std::endl << "*** No sensitivities at this solution!" << std::endl;
+        return 1;
+    }
+    if( !sens.second_order_sufficient() )
+    {
+        std::cout << "warning: the solution does not satisfy the second order sufficient conditions" << std::endl;
+    }
+
+    const Index n = 4, m = 2, P = HS071_NUM_PARAMETERS;
+    Number dx_dp[n * P], dlambda_dp[m * P];
+    sens.jacobian(dx_dp, dlambda_dp);
+
+    const Number h = 1e-4;
+    for( Index p = 0; p < P; p++ )
+    {
+        const Number p0 = nlp->get_parameter(p);
+        nlp->set_parameter(p, p0 + h);
+        app->OptimizeTNLP(nlp);
+        HS071_Solution plus = nlp->solution();
+        nlp->set_parameter(p, p0 - h);
+        app->OptimizeTNLP(nlp);
+        HS071_Solution minus = nlp->solution();
+        nlp->set_parameter(p, p0);
+
+        std::cout << std::endl << "parameter " << p << ": implicit / finite differences" << std::endl;
+        for( Index i = 0; i < n; i++ )
+        {
+            std::cout << "dx[" << i << "]/dp = " << dx_dp[p * n + i] << "\t" << (plus.x[i] - minus.x[i]) / (2 * h)
+                      << std::endl;
+        }
+        for( Index i = 0; i < m; i++ )
+        {
+            std::cout << "dlambda[" << i << "]/dp = " << dlambda_dp[p * m + i] << "\t"
+                      << (plus.lambda[i] - minus.lambda[i]) / (2 * h) << std::endl;
+        }
+    }
+    return 0;
+}
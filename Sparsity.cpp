@@ -0,0 +1,94 @@
+#include "hs071_horizon_nlp.hpp"
+#include "sparsity_detector.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+
+using namespace Ipopt;
+
+typedef std::set<std::pair<Index, Index> > Entries;
+
+// the entries declared by a TNLP, lower triangle for symmetric
+static Entries declared(const Index *rows, const Index *cols, Index nnz, bool symmetric) {
+    Entries entries;
+    for( Index k = 0; k < nnz; k++ )
+    {
+        entries.insert(symmetric ? std::make_pair(std::max(rows[k], cols[k]), std::min(rows[k], cols[k]))
+                                 : std::make_pair(rows[k], cols[k]));
+    }
+    return entries;
+}
+
+static void compare(const char *name, const Entries &declared, const std::vector<Index> &rows,
+                    const std::vector<Index> &cols) {
+    Entries detected;
+    for( size_t k = 0; k < rows.size(); k++ )
+    {
+        detected.insert(std::make_pair(rows[k], cols[k]));
+    }
+    Index missing = 0, spurious = 0;
+    for( Entries::const_iterator it = detected.begin(); it != detected.end(); ++it )
+    {
+        missing += declared.count(*it) == 0 ? 1 : 0;
+    }
+    for( Entries::const_iterator it = declared.begin(); it != declared.end(); ++it )
+    {
+        spurious += detected.count(*it) == 0 ? 1 : 0;
+    }
+    std::cout << "  " << name << ": " << declared.size() << " declared, " << detected.size() << " detected, "
+              << missing << " missing from the declaration, " << spurious << " declared but structurally zero"
+              << std::endl;
+}
+
+// Detects the Jacobian and Hessian patterns of HS071 and of the horizon HS071 by tracing f and g with
+// DependencyScalar, and compares them with the hand-written patterns of eval_jac_g and eval_h.
+// Optional argument: horizon length.
+int main(
+        int    argc,
+        char** argv
+)
+{
+    const Index horizon = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+    for( Index p = 0; p < 2; p++ )
+    {
+        SmartPtr<HS071_NLP> hs071 = new HS071_NLP();
+        SmartPtr<HS071_HorizonNLP> horizon_nlp = new HS071_HorizonNLP(horizon);
+        SmartPtr<TNLP> nlp = p == 0 ? SmartPtr<TNLP>(GetRawPtr(hs071)) : SmartPtr<TNLP>(GetRawPtr(horizon_nlp));
+
+        Index n, m, nnz_jac, nnz_h;
+        TNLP::IndexStyleEnum index_style;
+        nlp->get_nlp_info(n, m, nnz_jac, nnz_h, index_style);
+        std::vector<Number> x(n);
+        nlp->get_starting_point(n, true, x.data(), false, NULL, NULL, m, false, NULL);
+        std::vector<Index> rows(std::max(nnz_jac, nnz_h)), cols(rows.size());
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        SparsityPattern pattern;
+        if( p == 0 )
+        {
+            pattern = detect_sparsity(n, m, x.data(),
+                                      [](const DependencyScalar *x) { return HS071_objective(x); },
+                                      [](const DependencyScalar *x, DependencyScalar *g) { HS071_constraints(x, g); });
+        }
+        else
+        {
+            const HS071_HorizonNLP &h = *horizon_nlp;
+            pattern = detect_sparsity(n, m, x.data(),
+                                      [&h](const DependencyScalar *x) { return h.objective(x); },
+                                      [&h](const DependencyScalar *x, DependencyScalar *g) { h.constraints(x, g); });
+        }
+        const Number time = std::chrono::duration<Number>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << (p == 0 ? "HS071" : "horizon HS071") << " (" << n << " variables, " << m << " constraints), traced in "
+                  << time * 1e3 << " ms" << std::endl;
+        nlp->eval_jac_g(n, NULL, false, m, nnz_jac, rows.data(), cols.data(), NULL);
+        compare("Jacobian", declared(rows.data(), cols.data(), nnz_jac, false), pattern.jac_rows, pattern.jac_cols);
+        nlp->eval_h(n, NULL, false, 1., m, NULL, false, nnz_h, rows.data(), cols.data(), NULL);
+        compare("Hessian", declared(rows.data(), cols.data(), nnz_h, true), pattern.h_rows, pattern.h_cols);
+    }
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include "IpIpoptApplication.hpp"
+#include "hs071_stochastic_nlp.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace Ipopt;
+
+// Solves the sample average HS071 with S sampled scenarios, once with scenario-parallel callbacks and once serially,
+// and checks that both give the bitwise identical solution.
+// Optional arguments: number of scenarios, number of threads (0 = hardware threads), seed.
+int main(
+        int    argc,
+        char** argv
+)
+{
+    const Index num_scenarios = argc > 1 ? std::atoi(argv[1]) : 1000;
+    const unsigned num_threads = argc > 2 ? std::atoi(argv[2]) : 0;
+    const unsigned seed = argc > 3 ? std::atoi(argv[3]) : 1;
+
+    SmartPtr<IpoptApplication> app = IpoptApplicationFactory();
+    app->Options()->SetNumericValue("tol", 1e-7);
+    app->Options()->SetStringValue("mu_strategy", "adaptive");
+    app->Options()->SetIntegerValue("print_level", 0);
+    if( app->Initialize() != Solve_Succeeded )
+    {
+        std::cout << std::endl << std::endl << "*** Error during initialization!" << std::endl;
+        return 1;
+    }
+
+    std::shared_ptr<WorkStealingPool> pool = std::make_shared<WorkStealingPool>(num_threads);
+    HS071_Solution solutions[2];
+    for( Index mode = 0; mode < 2; mode++ )
+    {
+        SmartPtr<HS071_StochasticNLP> nlp
+                = new HS071_StochasticNLP(num_scenarios, mode == 0 ? pool : std::shared_ptr<WorkStealingPool>());
+        nlp->sample_scenarios(seed, 1.0, 2.0);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        ApplicationReturnStatus status = app->OptimizeTNLP(nlp);
+        const Number time = std::chrono::duration<Number>(std::chrono::steady_clock::now() - start).count();
+
+        solutions[mode] = nlp->solution();
+        std::cout << (mode == 0 ? "parallel (" : "serial (") << (mode == 0 ? pool->size() : 1) << " threads): status "
+                  << status << ", " << solutions[mode].iter_count << " iterations, " << time * 1e3 << " ms"
+                  << std::endl;
+    }
+
+    const HS071_Solution &sol = solutions[0];
+    std::cout << std::endl << "first stage x = (" << sol.x[0] << ", " << sol.x[1] << ", " << sol.x[2] << ", "
+              << sol.x[3] << ")" << std::endl << "expected cost = " << sol.obj_value << std::endl;
+    const bool identical = solutions[0].x == solutions[1].x && solutions[0].obj_value == solutions[1].obj_value;
+    std::cout << "parallel and serial solutions bitwise identical: " << (identical ? "yes" : "NO") << std::endl;
+    return identical ? 0 : 1;
+}
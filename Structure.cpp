@@ -0,0 +1,83 @@
+#include "IpIpoptApplication.hpp"
+#include "hs071_horizon_nlp.hpp"
+#include "hs071_stochastic_nlp.hpp"
+#include "structure_analysis.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace Ipopt;
+
+// the structure analysis of a problem that provides f and g as the templates objective and constraints
+template<class P>
+static SmartPtr<StructureAnalyzedTNLP> analyze_traced(const SmartPtr<P> &nlp) {
+    const P *problem = GetRawPtr(nlp);
+    return new StructureAnalyzedTNLP(GetRawPtr(nlp),
+                                     [problem](const DependencyScalar *x) { return problem->objective(x); },
+                                     [problem](const DependencyScalar *x, DependencyScalar *g) {
+                                         problem->constraints(x, g);
+                                     });
+}
+
+// Prints the structure traced in HS071, the stochastic HS071 and the horizon HS071, then solves the stochastic problem
+// with a limited-memory Hessian once as is and once through the structure analysis, which restricts the quasi-Newton
+// update to the four first stage variables, the only ones that enter nonlinearly.
+// Optional argument: number of scenarios.
+int main(
+        int    argc,
+        char** argv
+)
+{
+    const Index num_scenarios = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+    const char *names[3] = {"HS071", "stochastic HS071", "horizon HS071"};
+    SmartPtr<StructureAnalyzedTNLP> problems[3] = {
+        new StructureAnalyzedTNLP(new HS071_NLP(), [](const DependencyScalar *x) { return HS071_objective(x); },
+                                  [](const DependencyScalar *x, DependencyScalar *g) { HS071_constraints(x, g); }),
+        analyze_traced(SmartPtr<HS071_StochasticNLP>(
+                new HS071_StochasticNLP(num_scenarios, std::shared_ptr<WorkStealingPool>()))),
+        analyze_traced(SmartPtr<HS071_HorizonNLP>(new HS071_HorizonNLP(20)))};
+    for( Index p = 0; p < 3; p++ )
+    {
+        if( !problems[p]->analyze() )
+        {
+            std::cout << names[p] << ": analysis failed" << std::endl << std::endl;
+            continue;
+        }
+        std::cout << names[p] << std::endl << problems[p]->structure() << std::endl;
+    }
+
+    for( Index mode = 0; mode < 2; mode++ )
+    {
+        SmartPtr<IpoptApplication> app = IpoptApplicationFactory();
+        app->Options()->SetNumericValue("tol", 1e-7);
+        app->Options()->SetStringValue("mu_strategy", "adaptive");
+        app->Options()->SetStringValue("hessian_approximation", "limited-memory");
+        app->Options()->SetIntegerValue("print_level", 0);
+        if( app->Initialize() != Solve_Succeeded )
+        {
+            std::cout << std::endl << std::endl << "*** Error during initialization!" << std::endl;
+            return 1;
+        }
+
+        SmartPtr<HS071_StochasticNLP> nlp
+                = new HS071_StochasticNLP(num_scenarios, std::shared_ptr<WorkStealingPool>());
+        nlp->sample_scenarios(1, 1.0, 2.0);
+        SmartPtr<TNLP> solved = GetRawPtr(nlp);
+        if( mode == 1 )
+        {
+            SmartPtr<StructureAnalyzedTNLP> analyzed = analyze_traced(nlp);
+            analyzed->set_options(app);
+            solved = GetRawPtr(analyzed);
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        ApplicationReturnStatus status = app->OptimizeTNLP(solved);
+        const Number time = std::chrono::duration<Number>(std::chrono::steady_clock::now() - start).count();
+        std::cout << (mode == 0 ? "as is:    " : "analyzed: ") << "status " << status << ", "
+                  << nlp->solution().iter_count << " iterations, objective " << nlp->solution().obj_value << ", "
+                  << time * 1e3 << " ms" << std::endl;
+    }
+    return 0;
+}
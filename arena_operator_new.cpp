@@ -0,0 +1,56 @@
+//
+// Replacement of the global operator new / delete that allocates from the calling thread's SolveArena while one
+// is active (see solve_arena.hpp) and from the system heap otherwise.
+//
+// The replacement is program wide, so this file is only compiled into executables that want it (ArenaSolve);
+// it must not go into the hs071 library.
+//
+
+#include "solve_arena.hpp"
+
+#include <new>
+
+void *operator new(std::size_t size) {
+    void *ptr = solve_arena_operator_new(size);
+    if( ptr == NULL )
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return solve_arena_operator_new(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return solve_arena_operator_new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    solve_arena_operator_delete(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    solve_arena_operator_delete(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    solve_arena_operator_delete(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+    solve_arena_operator_delete(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+    solve_arena_operator_delete(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+    solve_arena_operator_delete(ptr);
+}
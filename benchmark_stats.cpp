@@ -0,0 +1,85 @@
+//
+// Benchmark statistics and baselines, see benchmark_stats.hpp
+//
+
+#include "benchmark_stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+BenchmarkSummary summarize_samples(std::vector<Number> &samples) {
+    BenchmarkSummary summary;
+    const Index n = (Index) samples.size();
+    summary.samples = n;
+    if( n == 0 )
+    {
+        return summary;
+    }
+    std::sort(samples.begin(), samples.end());
+    summary.median = n % 2 == 1 ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+    // 1-based ranks of the interval ends, clamped to the samples
+    const Number half_width = 0.98 * std::sqrt((Number) n);
+    const Index j = std::max((Index) 1, (Index) std::floor(0.5 * n - half_width));
+    const Index k = std::min(n, (Index) std::ceil(0.5 * n + 1. + half_width));
+    summary.ci_low = samples[j - 1];
+    summary.ci_high = samples[k - 1];
+    return summary;
+}
+
+bool is_regression(const BenchmarkSummary &current, const BenchmarkSummary &baseline, Number tolerance) {
+    return current.ci_low > baseline.ci_high && current.median > (1. + tolerance) * baseline.median;
+}
+
+bool read_baselines(const std::string &path, BenchmarkBaselines &baselines) {
+    std::ifstream in(path.c_str());
+    if( !in )
+    {
+        return false;
+    }
+    baselines.clear();
+    std::string line;
+    while( std::getline(in, line) )
+    {
+        std::istringstream fields(line);
+        std::string name;
+        BenchmarkSummary summary;
+        if( fields >> name >> summary.median >> summary.ci_low >> summary.ci_high >> summary.samples )
+        {
+            baselines[name] = summary;
+        }
+    }
+    return true;
+}
+
+bool write_baselines(const std::string &path, const BenchmarkBaselines &baselines) {
+    std::ofstream out(path.c_str());
+    out.precision(17);
+    for( BenchmarkBaselines::const_iterator it = baselines.begin(); it != baselines.end(); ++it )
+    {
+        out << it->first << " " << it->second.median << " " << it->second.ci_low << " " << it->second.ci_high << " "
+            << it->second.samples << "\n";
+    }
+    return (bool) out;
+}
+
+bool pin_thread_to_cpu(Index cpu) {
+#ifdef __linux__
+    if( cpu < 0 || cpu >= CPU_SETSIZE )
+    {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,42 @@
+//
+// Statistics for the benchmark suite (Bench): the median of a set of timing samples with a distribution-free 95%
+// confidence interval from order statistics (no normality assumed, timings are skewed), a text file of baselines,
+// and the regression test against them. A benchmark counts as slower when its interval lies entirely above the
+// baseline's and its median grew by more than a tolerance, so noise alone does not fail a run. Also pins the calling
+// thread to one CPU, which keeps the samples of a run on one core and its caches.
+//
+
+#ifndef __BENCHMARK_STATS_HPP
+#define __BENCHMARK_STATS_HPP
+
+#include "IpTypes.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace Ipopt;
+
+struct BenchmarkSummary {
+    Number median = 0.;
+    Number ci_low = 0.;
+    Number ci_high = 0.;
+    Index samples = 0;
+};
+
+// median and 95% interval of samples (reordered); the interval is [x_(j), x_(k)] with j, k = n/2 -+ 0.98 sqrt(n),
+// the normal approximation of the binomial distribution of the number of samples below the median
+BenchmarkSummary summarize_samples(std::vector<Number> &samples);
+
+// whether current is slower than baseline: disjoint intervals and a median more than tolerance (relative) above
+bool is_regression(const BenchmarkSummary &current, const BenchmarkSummary &baseline, Number tolerance);
+
+// one line per benchmark, "name median ci_low ci_high samples"; names must not contain white space
+typedef std::map<std::string, BenchmarkSummary> BenchmarkBaselines;
+bool read_baselines(const std::string &path, BenchmarkBaselines &baselines);
+bool write_baselines(const std::string &path, const BenchmarkBaselines &baselines);
+
+// binds the calling thread to cpu; false where that is not supported or cpu does not exist
+bool pin_thread_to_cpu(Index cpu);
+
+#endif //__BENCHMARK_STATS_HPP
@@ -0,0 +1,408 @@
+//
+// Block-tridiagonal KKT linear solver plugin, see block_tridiag_solver.hpp
+//
+
+#include "block_tridiag_solver.hpp"
+
+#include "IpTSymLinearSolver.hpp"
+
+#include <algorithm>
+#include <deque>
+
+BlockTridiagSolverInterface::BlockTridiagSolverInterface(Index min_block_size, Number pivot_tol)
+        : min_block_size_(std::max(1, min_block_size)), pivot_tol_(pivot_tol), dim_(0), neg_evals_(0) {
+}
+
+bool BlockTridiagSolverInterface::InitializeImpl(const OptionsList &options, const std::string &prefix) {
+    return true;
+}
+
+Index BlockTridiagSolverInterface::max_block_size() const {
+    Index size = 0;
+    for( Index k = 0; k < num_blocks(); k++ )
+    {
+        size = std::max(size, block_start_[k + 1] - block_start_[k]);
+    }
+    return size;
+}
+
+void BlockTridiagSolverInterface::order() {
+    // adjacency of the matrix graph
+    std::vector<std::vector<Index> > adj(dim_);
+    for( size_t k = 0; k < rows_.size(); k++ )
+    {
+        if( rows_[k] != cols_[k] )
+        {
+            adj[rows_[k]].push_back(cols_[k]);
+            adj[cols_[k]].push_back(rows_[k]);
+        }
+    }
+    for( Index i = 0; i < dim_; i++ )
+    {
+        std::sort(adj[i].begin(), adj[i].end());
+        adj[i].erase(std::unique(adj[i].begin(), adj[i].end()), adj[i].end());
+    }
+
+    // BFS levels of node root within the unplaced nodes
+    std::vector<Index> level(dim_, -1);
+    std::vector<char> placed(dim_, 0);
+    std::vector<Index> touched;
+    std::vector<std::vector<Index> > levels;
+    auto bfs = [&](Index root) {
+        for( size_t i = 0; i < touched.size(); i++ )
+        {
+            level[touched[i]] = -1;
+        }
+        touched.assign(1, root);
+        levels.assign(1, std::vector<Index>(1, root));
+        level[root] = 0;
+        for( size_t l = 0; l < levels.size(); l++ )
+        {
+            std::vector<Index> next;
+            for( size_t i = 0; i < levels[l].size(); i++ )
+            {
+                const std::vector<Index> &nbrs = adj[levels[l][i]];
+                for( size_t j = 0; j < nbrs.size(); j++ )
+                {
+                    if( level[nbrs[j]] < 0 && !placed[nbrs[j]] )
+                    {
+                        level[nbrs[j]] = (Index) l + 1;
+                        touched.push_back(nbrs[j]);
+                        next.push_back(nbrs[j]);
+                    }
+                }
+            }
+            if( !next.empty() )
+            {
+                levels.push_back(next);
+            }
+        }
+    };
+
+    perm_.clear();
+    block_start_.assign(1, 0);
+    for( Index seed = 0; seed < dim_; seed++ )
+    {
+        if( placed[seed] )
+        {
+            continue;
+        }
+        // pseudo-peripheral root (George-Liu): restart from a minimum degree node of the last level as long as
+        // that makes the level structure deeper, which makes the levels (and blocks) thin
+        Index root = seed;
+        bfs(root);
+        for( ;; )
+        {
+            const std::vector<Index> &last = levels.back();
+            Index candidate = last[0];
+            for( size_t i = 1; i < last.size(); i++ )
+            {
+                if( adj[last[i]].size() < adj[candidate].size() )
+                {
+                    candidate = last[i];
+                }
+            }
+            size_t depth = levels.size();
+            bfs(candidate);
+            if( levels.size() <= depth )
+            {
+                bfs(root);
+                break;
+            }
+            root = candidate;
+        }
+        // merge consecutive levels into blocks; merging neighbours keeps the structure block tridiagonal
+        Index size = 0;
+        for( size_t l = 0; l < levels.size(); l++ )
+        {
+            for( size_t i = 0; i < levels[l].size(); i++ )
+            {
+                perm_.push_back(levels[l][i]);
+                placed[levels[l][i]] = 1;
+            }
+            size += (Index) levels[l].size();
+            if( size >= min_block_size_ || l + 1 == levels.size() )
+            {
+                block_start_.push_back((Index) perm_.size());
+                size = 0;
+            }
+        }
+    }
+}
+
+ESymSolverStatus BlockTridiagSolverInterface::InitializeStructure(Index dim, Index nonzeros, const Index *ia,
+                                                                  const Index *ja) {
+    // triplets come 1-based, one triangle, possibly with duplicates that have to be summed
+    dim_ = dim;
+    rows_.resize(nonzeros);
+    cols_.resize(nonzeros);
+    for( Index k = 0; k < nonzeros; k++ )
+    {
+        rows_[k] = ia[k] - 1;
+        cols_[k] = ja[k] - 1;
+    }
+    values_.assign(nonzeros, 0.);
+
+    order();
+    const Index K = num_blocks();
+    std::vector<Index> pos(dim_);
+    block_of_.resize(dim_);
+    for( Index k = 0; k < K; k++ )
+    {
+        for( Index p = block_start_[k]; p < block_start_[k + 1]; p++ )
+        {
+            pos[perm_[p]] = p;
+            block_of_[p] = k;
+        }
+    }
+
+    block_offset_.resize(K);
+    coupling_offset_.resize(K);
+    Index offset = 0;
+    for( Index k = 0; k < K; k++ )
+    {
+        const Index size = block_start_[k + 1] - block_start_[k];
+        block_offset_[k] = offset;
+        offset += size * size;
+        coupling_offset_[k] = offset;
+        if( k > 0 )
+        {
+            offset += size * (block_start_[k] - block_start_[k - 1]);
+        }
+    }
+    blocks_.assign(offset, 0.);
+
+    dest_.resize(nonzeros);
+    dest_mirror_.assign(nonzeros, -1);
+    for( Index k = 0; k < nonzeros; k++ )
+    {
+        Index r = pos[rows_[k]], c = pos[cols_[k]];
+        if( block_of_[r] < block_of_[c] )
+        {
+            std::swap(r, c);
+        }
+        const Index br = block_of_[r], bc = block_of_[c];
+        const Index lr = r - block_start_[br], lc = c - block_start_[bc];
+        const Index size = block_start_[br + 1] - block_start_[br];
+        if( br == bc )
+        {
+            dest_[k] = block_offset_[br] + lc * size + lr;
+            if( lr != lc )
+            {
+                dest_mirror_[k] = block_offset_[br] + lr * size + lc;
+            }
+        }
+        else if( br == bc + 1 )
+        {
+            dest_[k] = coupling_offset_[br] + lc * size + lr;
+        }
+        else
+        {
+            // cannot happen for a level structure
+            return SYMSOLVER_FATAL_ERROR;
+        }
+    }
+    return SYMSOLVER_SUCCESS;
+}
+
+Number *BlockTridiagSolverInterface::GetValuesArrayPtr() {
+    return values_.data();
+}
+
+void BlockTridiagSolverInterface::assemble() {
+    std::fill(blocks_.begin(), blocks_.end(), 0.);
+    for( size_t k = 0; k < values_.size(); k++ )
+    {
+        blocks_[dest_[k]] += values_[k];
+        if( dest_mirror_[k] >= 0 )
+        {
+            blocks_[dest_mirror_[k]] += values_[k];
+        }
+    }
+}
+
+ESymSolverStatus BlockTridiagSolverInterface::factor_chain(Index first, Index last_block, std::vector<Pivot> &pivots,
+                                                           Index &neg_evals) const {
+    pivots.clear();
+    neg_evals = 0;
+    bool singular = false;
+
+    // S is the Schur complement of the blocks from start up to block k, whose last block_size(k) rows couple to
+    // block k + 1 through B_{k+1}
+    Index start = block_start_[first];
+    std::vector<Number> S(blocks_.begin() + block_offset_[first], blocks_.begin() + coupling_offset_[first]);
+    Index size = block_start_[first + 1] - block_start_[first];
+    for( Index k = first; k < last_block; k++ )
+    {
+        const Index next = k + 1 < last_block ? block_start_[k + 2] - block_start_[k + 1] : 0;
+        const Index last = block_start_[k + 1] - block_start_[k];
+        // B_{k+1}^T padded with zero rows for the merged blocks before block k
+        std::vector<Number> Bt((size_t) size * next, 0.);
+        for( Index j = 0; j < next; j++ )
+        {
+            for( Index i = 0; i < last; i++ )
+            {
+                Bt[(size_t) j * size + size - last + i] = blocks_[coupling_offset_[k + 1] + i * next + j];
+            }
+        }
+
+        pivots.push_back(Pivot());
+        Pivot &pivot = pivots.back();
+        const bool regular = pivot.ldlt.factor(size, S.data(), next > 0 ? pivot_tol_ : 0.);
+        if( !regular && next > 0 )
+        {
+            // S is (nearly) singular: eliminate it together with the next block, [S B^T; B A_{k+1,k+1}]
+            pivots.pop_back();
+            const Index merged = size + next;
+            std::vector<Number> M((size_t) merged * merged, 0.);
+            for( Index j = 0; j < size; j++ )
+            {
+                std::copy(S.begin() + (size_t) j * size, S.begin() + (size_t) (j + 1) * size, M.begin() + (size_t) j * merged);
+                for( Index i = 0; i < next; i++ )
+                {
+                    M[(size_t) j * merged + size + i] = Bt[(size_t) i * size + j];
+                    M[(size_t) (size + i) * merged + j] = Bt[(size_t) i * size + j];
+                }
+            }
+            for( Index j = 0; j < next; j++ )
+            {
+                for( Index i = 0; i < next; i++ )
+                {
+                    M[(size_t) (size + j) * merged + size + i] = blocks_[block_offset_[k + 1] + j * next + i];
+                }
+            }
+            S.swap(M);
+            size = merged;
+            continue;
+        }
+        singular = singular || !regular;
+        neg_evals += pivot.ldlt.num_negative();
+        pivot.start = start;
+        pivot.size = size;
+        pivot.next_size = next;
+        if( next == 0 )
+        {
+            break;
+        }
+
+        // S_{k+1} = A_{k+1,k+1} - B S^{-1} B^T
+        pivot.Y = Bt;
+        pivot.ldlt.solve(next, pivot.Y.data());
+        std::vector<Number> T(blocks_.begin() + block_offset_[k + 1], blocks_.begin() + coupling_offset_[k + 1]);
+        for( Index j = 0; j < next; j++ )
+        {
+            for( Index i = 0; i < next; i++ )
+            {
+                Number s = 0.;
+                for( Index l = size - last; l < size; l++ )
+                {
+                    s += Bt[(size_t) i * size + l] * pivot.Y[(size_t) j * size + l];
+                }
+                T[(size_t) j * next + i] -= s;
+            }
+        }
+        pivot.Bt.swap(Bt);
+        S.swap(T);
+        start += size;
+        size = next;
+    }
+    return singular ? SYMSOLVER_SINGULAR : SYMSOLVER_SUCCESS;
+}
+
+void BlockTridiagSolverInterface::solve_chain(const std::vector<Pivot> &pivots, Index nrhs, Number *x, Index ldx,
+                                              Index offset) const {
+    // forward: u_p = S_p^{-1} z_p, z_{p+1} -= B^T' u_p; backward: x_p = u_p - Y_p x_{p+1}
+    for( Index r = 0; r < nrhs; r++ )
+    {
+        Number *z = x + (size_t) r * ldx - offset;
+        for( size_t p = 0; p < pivots.size(); p++ )
+        {
+            const Pivot &pivot = pivots[p];
+            Number *u = z + pivot.start;
+            pivot.ldlt.solve(1, u);
+            for( Index j = 0; j < pivot.next_size; j++ )
+            {
+                Number s = 0.;
+                for( Index i = 0; i < pivot.size; i++ )
+                {
+                    s += pivot.Bt[(size_t) j * pivot.size + i] * u[i];
+                }
+                u[pivot.size + j] -= s;
+            }
+        }
+        for( size_t p = pivots.size(); p-- > 0; )
+        {
+            const Pivot &pivot = pivots[p];
+            Number *u = z + pivot.start;
+            for( Index j = 0; j < pivot.next_size; j++ )
+            {
+                const Number xn = u[pivot.size + j];
+                for( Index i = 0; i < pivot.size; i++ )
+                {
+                    u[i] -= pivot.Y[(size_t) j * pivot.size + i] * xn;
+                }
+            }
+        }
+    }
+}
+
+ESymSolverStatus BlockTridiagSolverInterface::factor() {
+    assemble();
+    return factor_chain(0, num_blocks(), pivots_, neg_evals_);
+}
+
+void BlockTridiagSolverInterface::solve(Index nrhs, Number *rhs) {
+    work_.resize(dim_);
+    for( Index r = 0; r < nrhs; r++ )
+    {
+        Number *b = rhs + (size_t) r * dim_;
+        for( Index p = 0; p < dim_; p++ )
+        {
+            work_[p] = b[perm_[p]];
+        }
+        solve_chain(pivots_, 1, work_.data(), dim_, 0);
+        for( Index p = 0; p < dim_; p++ )
+        {
+            b[perm_[p]] = work_[p];
+        }
+    }
+}
+
+ESymSolverStatus BlockTridiagSolverInterface::MultiSolve(bool new_matrix, const Index *ia, const Index *ja,
+                                                         Index nrhs, Number *rhs_vals, bool check_NegEVals,
+                                                         Index numberOfNegEVals) {
+    if( new_matrix )
+    {
+        ESymSolverStatus status = factor();
+        if( status != SYMSOLVER_SUCCESS )
+        {
+            return status;
+        }
+        if( check_NegEVals && neg_evals_ != numberOfNegEVals )
+        {
+            return SYMSOLVER_WRONG_INERTIA;
+        }
+    }
+    solve(nrhs, rhs_vals);
+    return SYMSOLVER_SUCCESS;
+}
+
+Index BlockTridiagSolverInterface::NumberOfNegEVals() const {
+    return neg_evals_;
+}
+
+bool BlockTridiagSolverInterface::IncreaseQuality() {
+    // the block pivots are already chosen by Bunch-Kaufman, there is no threshold left to tighten
+    return false;
+}
+
+BlockTridiagAlgorithmBuilder::BlockTridiagAlgorithmBuilder(Index min_block_size, Number pivot_tol)
+        : AlgorithmBuilder(), min_block_size_(min_block_size), pivot_tol_(pivot_tol) {
+}
+
+SmartPtr<SymLinearSolver> BlockTridiagAlgorithmBuilder::SymLinearSolverFactory(const Journalist &jnlst,
+                                                                               const OptionsList &options,
+                                                                               const std::string &prefix) {
+    SmartPtr<SparseSymLinearSolverInterface> solver = new BlockTridiagSolverInterface(min_block_size_, pivot_tol_);
+    return new TSymLinearSolver(solver, NULL);
+}
@@ -0,0 +1,112 @@
+//
+// Ipopt linear solver plugin for KKT matrices with block-tridiagonal (banded) structure, e.g. from
+// HS071_HorizonNLP. The structure is recovered from the triplets with a breadth-first level structure: the
+// levels of a BFS from a pseudo-peripheral node only couple to neighbouring levels, so ordering the unknowns by
+// level makes the matrix block tridiagonal. It is then factored with the block recursion
+//     S_0 = A_00,  S_k = A_kk - B_k S_{k-1}^{-1} B_k^T
+// whose cost is linear in the number of blocks. The inertia is the sum of the inertias of the S_k.
+//
+
+#ifndef __BLOCK_TRIDIAG_SOLVER_HPP
+#define __BLOCK_TRIDIAG_SOLVER_HPP
+
+#include "IpAlgBuilder.hpp"
+#include "IpSparseSymLinearSolverInterface.hpp"
+
+#include "dense_ldlt.hpp"
+
+#include <vector>
+
+using namespace Ipopt;
+
+class BlockTridiagSolverInterface: public SparseSymLinearSolverInterface {
+
+public:
+    // consecutive levels are merged until a block has at least min_block_size unknowns; a Schur complement
+    // whose pivots fall below pivot_tol (relative) is merged with the next block instead of being inverted
+    explicit BlockTridiagSolverInterface(Index min_block_size = 8, Number pivot_tol = 1e-10);
+
+    bool InitializeImpl(const OptionsList &options, const std::string &prefix);
+
+    ESymSolverStatus InitializeStructure(Index dim, Index nonzeros, const Index *ia, const Index *ja);
+    Number *GetValuesArrayPtr();
+    ESymSolverStatus MultiSolve(bool new_matrix, const Index *ia, const Index *ja, Index nrhs, Number *rhs_vals,
+                                bool check_NegEVals, Index numberOfNegEVals);
+    Index NumberOfNegEVals() const;
+    bool IncreaseQuality();
+    bool ProvidesInertia() const { return true; }
+    EMatrixFormat MatrixFormat() const { return Triplet_Format; }
+
+    // structure found by InitializeStructure
+    Index num_blocks() const { return (Index) block_start_.size() - 1; }
+    Index max_block_size() const;
+
+protected:
+    // a factored Schur complement covering the (merged) blocks starting at position start of the ordering
+    struct Pivot {
+        Index start;
+        Index size;
+        Index next_size;             // size of the following block, 0 for the last pivot
+        DenseLDLT ldlt;
+        std::vector<Number> Bt;      // coupling to the following block, B^T (size x next_size)
+        std::vector<Number> Y;       // S^{-1} B^T (size x next_size)
+    };
+
+    // factors the assembled matrix and solves with the factors; nrhs right hand sides in the original ordering
+    virtual ESymSolverStatus factor();
+    virtual void solve(Index nrhs, Number *rhs);
+
+    // sums the values into the dense blocks
+    void assemble();
+    // Factors blocks [first, last) as a chain on their own, ignoring the couplings to first - 1 and last. Safe to
+    // call concurrently for disjoint ranges.
+    ESymSolverStatus factor_chain(Index first, Index last, std::vector<Pivot> &pivots, Index &neg_evals) const;
+    // solves with the factors of a chain for nrhs columns of x (leading dimension ldx) in the block ordering,
+    // where x[0] is position offset
+    void solve_chain(const std::vector<Pivot> &pivots, Index nrhs, Number *x, Index ldx, Index offset) const;
+
+    Index min_block_size_;
+    Number pivot_tol_;
+
+    Index dim_;
+    std::vector<Index> rows_;         // 0-based triplets as handed to InitializeStructure
+    std::vector<Index> cols_;
+    std::vector<Number> values_;
+
+    std::vector<Index> perm_;         // perm_[new] = old
+    std::vector<Index> block_start_;  // first position of every block in the ordering, plus dim_
+    std::vector<Index> block_of_;     // block of every position
+    std::vector<Index> block_offset_;     // offset of A_kk in blocks_
+    std::vector<Index> coupling_offset_;  // offset of B_k (size_k x size_{k-1}) in blocks_
+    // destination of every triplet in blocks_ (column major), and a second destination for the mirrored
+    // off-diagonal entries of diagonal blocks, -1 if none
+    std::vector<Index> dest_;
+    std::vector<Index> dest_mirror_;
+    std::vector<Number> blocks_;
+
+    std::vector<Pivot> pivots_;
+    Index neg_evals_;
+    std::vector<Number> work_;
+
+private:
+    void order();
+
+};
+
+// AlgorithmBuilder that hands Ipopt a BlockTridiagSolverInterface for every symmetric linear system; pass it to
+// IpoptApplication::OptimizeTNLP(tnlp, alg_builder)
+class BlockTridiagAlgorithmBuilder: public AlgorithmBuilder {
+
+public:
+    explicit BlockTridiagAlgorithmBuilder(Index min_block_size = 8, Number pivot_tol = 1e-10);
+
+    SmartPtr<SymLinearSolver> SymLinearSolverFactory(const Journalist &jnlst, const OptionsList &options,
+                                                     const std::string &prefix);
+
+private:
+    Index min_block_size_;
+    Number pivot_tol_;
+
+};
+
+#endif //__BLOCK_TRIDIAG_SOLVER_HPP
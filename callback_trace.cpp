@@ -0,0 +1,504 @@
+//
+// Record and replay of TNLP callbacks, see callback_trace.hpp
+//
+
+#include "callback_trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+// the magic string, then the widths of Number and Index
+static const char TRACE_MAGIC[8] = {'T', 'N', 'L', 'P', 'T', 'R', 'C', '1'};
+static const Index NUM_INTERMEDIATE_NUMBERS = 8;
+
+const char *callback_method_name(Index method) {
+    static const char *names[CALLBACK_NUM_METHODS] = {"get_nlp_info", "get_bounds_info", "get_starting_point",
+                                                      "eval_f", "eval_grad_f", "eval_g", "eval_jac_g", "eval_h",
+                                                      "intermediate_callback", "finalize_solution"};
+    return method >= 0 && method < CALLBACK_NUM_METHODS ? names[method] : "unknown";
+}
+
+CallbackRecorder::CallbackRecorder(const SmartPtr<TNLP> &nlp, const std::string &path)
+        : nlp_(nlp), file_(path.c_str(), std::ios::binary | std::ios::trunc), num_records_(0) {
+    const unsigned char widths[2] = {(unsigned char) sizeof(Number), (unsigned char) sizeof(Index)};
+    file_.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    file_.write((const char *) widths, sizeof(widths));
+}
+
+void CallbackRecorder::flush() {
+    file_.flush();
+}
+
+void CallbackRecorder::begin(Index method, unsigned flags, const Number *x, Index n, const Number *lambda, Index m) {
+    const bool store_x = x != NULL && ((Index) last_x_.size() != n || !std::equal(x, x + n, last_x_.begin()));
+    const bool store_lambda = lambda != NULL
+                              && ((Index) last_lambda_.size() != m || !std::equal(lambda, lambda + m,
+                                                                                  last_lambda_.begin()));
+    const uint32_t header = (uint32_t) method | (flags | (store_x ? CALLBACK_X_STORED : 0)
+                                                 | (store_lambda ? CALLBACK_LAMBDA_STORED : 0)) << 8;
+    file_.write((const char *) &header, sizeof(header));
+    if( store_x )
+    {
+        last_x_.assign(x, x + n);
+        write_numbers(x, n);
+    }
+    if( store_lambda )
+    {
+        last_lambda_.assign(lambda, lambda + m);
+        write_numbers(lambda, m);
+    }
+    num_records_++;
+}
+
+void CallbackRecorder::write_numbers(const Number *values, Index count) {
+    file_.write((const char *) values, (std::streamsize) (count * sizeof(Number)));
+}
+
+void CallbackRecorder::write_indices(const Index *values, Index count) {
+    file_.write((const char *) values, (std::streamsize) (count * sizeof(Index)));
+}
+
+bool CallbackRecorder::get_nlp_info(Index &n, Index &m, Index &nnz_jac_g, Index &nnz_h_lag,
+                                    IndexStyleEnum &index_style) {
+    const bool ok = nlp_->get_nlp_info(n, m, nnz_jac_g, nnz_h_lag, index_style);
+    begin(CALLBACK_NLP_INFO, ok ? CALLBACK_RESULT : 0, NULL, 0, NULL, 0);
+    const Index info[5] = {n, m, nnz_jac_g, nnz_h_lag, (Index) index_style};
+    write_indices(info, 5);
+    return ok;
+}
+
+bool CallbackRecorder::get_bounds_info(Index n, Number *x_l, Number *x_u, Index m, Number *g_l, Number *g_u) {
+    const bool ok = nlp_->get_bounds_info(n, x_l, x_u, m, g_l, g_u);
+    begin(CALLBACK_BOUNDS, ok ? CALLBACK_RESULT : 0, NULL, 0, NULL, 0);
+    write_numbers(x_l, n);
+    write_numbers(x_u, n);
+    write_numbers(g_l, m);
+    write_numbers(g_u, m);
+    return ok;
+}
+
+bool CallbackRecorder::get_starting_point(Index n, bool init_x, Number *x, bool init_z, Number *z_L, Number *z_U,
+                                          Index m, bool init_lambda, Number *lambda) {
+    const bool ok = nlp_->get_starting_point(n, init_x, x, init_z, z_L, z_U, m, init_lambda, lambda);
+    begin(CALLBACK_STARTING_POINT, (ok ? CALLBACK_RESULT : 0) | (init_x ? CALLBACK_INIT_X : 0)
+                                   | (init_z ? CALLBACK_INIT_Z : 0) | (init_lambda ? CALLBACK_INIT_LAMBDA : 0),
+          NULL, 0, NULL, 0);
+    if( init_x )
+    {
+        write_numbers(x, n);
+    }
+    if( init_z )
+    {
+        write_numbers(z_L, n);
+        write_numbers(z_U, n);
+    }
+    if( init_lambda )
+    {
+        write_numbers(lambda, m);
+    }
+    return ok;
+}
+
+bool CallbackRecorder::eval_f(Index n, const Number *x, bool new_x, Number &obj_value) {
+    const bool ok = nlp_->eval_f(n, x, new_x, obj_value);
+    begin(CALLBACK_F, (ok ? CALLBACK_RESULT : 0) | (new_x ? CALLBACK_NEW_X : 0), x, n, NULL, 0);
+    write_numbers(&obj_value, 1);
+    return ok;
+}
+
+bool CallbackRecorder::eval_grad_f(Index n, const Number *x, bool new_x, Number *grad_f) {
+    const bool ok = nlp_->eval_grad_f(n, x, new_x, grad_f);
+    begin(CALLBACK_GRAD_F, (ok ? CALLBACK_RESULT : 0) | (new_x ? CALLBACK_NEW_X : 0), x, n, NULL, 0);
+    write_numbers(grad_f, n);
+    return ok;
+}
+
+bool CallbackRecorder::eval_g(Index n, const Number *x, bool new_x, Index m, Number *g) {
+    const bool ok = nlp_->eval_g(n, x, new_x, m, g);
+    begin(CALLBACK_G, (ok ? CALLBACK_RESULT : 0) | (new_x ? CALLBACK_NEW_X : 0), x, n, NULL, 0);
+    write_numbers(g, m);
+    return ok;
+}
+
+bool CallbackRecorder::eval_jac_g(Index n, const Number *x, bool new_x, Index m, Index nele_jac, Index *iRow,
+                                  Index *jCol, Number *values) {
+    const bool ok = nlp_->eval_jac_g(n, x, new_x, m, nele_jac, iRow, jCol, values);
+    const bool structure = values == NULL;
+    begin(CALLBACK_JAC_G, (ok ? CALLBACK_RESULT : 0) | (new_x ? CALLBACK_NEW_X : 0)
+                          | (structure ? CALLBACK_STRUCTURE : 0), structure ? NULL : x, n, NULL, 0);
+    if( structure )
+    {
+        write_indices(iRow, nele_jac);
+        write_indices(jCol, nele_jac);
+    }
+    else
+    {
+        write_numbers(values, nele_jac);
+    }
+    return ok;
+}
+
+bool CallbackRecorder::eval_h(Index n, const Number *x, bool new_x, Number obj_factor, Index m, const Number *lambda,
+                              bool new_lambda, Index nele_hess, Index *iRow, Index *jCol, Number *values) {
+    const bool ok = nlp_->eval_h(n, x, new_x, obj_factor, m, lambda, new_lambda, nele_hess, iRow, jCol, values);
+    const bool structure = values == NULL;
+    begin(CALLBACK_H, (ok ? CALLBACK_RESULT : 0) | (new_x ? CALLBACK_NEW_X : 0)
+                      | (new_lambda ? CALLBACK_NEW_LAMBDA : 0) | (structure ? CALLBACK_STRUCTURE : 0),
+          structure ? NULL : x, n, structure ? NULL : lambda, m);
+    if( structure )
+    {
+        write_indices(iRow, nele_hess);
+        write_indices(jCol, nele_hess);
+    }
+    else
+    {
+        write_numbers(&obj_factor, 1);
+        write_numbers(values, nele_hess);
+    }
+    return ok;
+}
+
+void CallbackRecorder::finalize_solution(SolverReturn status, Index n, const Number *x, const Number *z_L,
+                                         const Number *z_U, Index m, const Number *g, const Number *lambda,
+                                         Number obj_value, const IpoptData *ip_data,
+                                         IpoptCalculatedQuantities *ip_cq) {
+    nlp_->finalize_solution(status, n, x, z_L, z_U, m, g, lambda, obj_value, ip_data, ip_cq);
+    begin(CALLBACK_FINALIZE, CALLBACK_RESULT, NULL, 0, NULL, 0);
+    const Index code = (Index) status;
+    write_indices(&code, 1);
+    write_numbers(&obj_value, 1);
+    write_numbers(x, n);
+    write_numbers(z_L, n);
+    write_numbers(z_U, n);
+    write_numbers(g, m);
+    write_numbers(lambda, m);
+    file_.flush();
+}
+
+bool CallbackRecorder::intermediate_callback(AlgorithmMode mode, Index iter, Number obj_value, Number inf_pr,
+                                             Number inf_du, Number mu, Number d_norm, Number regularization_size,
+                                             Number alpha_du, Number alpha_pr, Index ls_trials,
+                                             const IpoptData *ip_data, IpoptCalculatedQuantities *ip_cq) {
+    const bool ok = nlp_->intermediate_callback(mode, iter, obj_value, inf_pr, inf_du, mu, d_norm, regularization_size,
+                                                alpha_du, alpha_pr, ls_trials, ip_data, ip_cq);
+    begin(CALLBACK_INTERMEDIATE, ok ? CALLBACK_RESULT : 0, NULL, 0, NULL, 0);
+    const Index ints[3] = {(Index) mode, iter, ls_trials};
+    const Number numbers[NUM_INTERMEDIATE_NUMBERS] = {obj_value, inf_pr, inf_du, mu, d_norm, regularization_size,
+                                                      alpha_du, alpha_pr};
+    write_indices(ints, 3);
+    write_numbers(numbers, NUM_INTERMEDIATE_NUMBERS);
+    return ok;
+}
+
+// reads the file contents in order, failing once it runs past the end
+class TraceReader {
+
+public:
+    explicit TraceReader(const std::vector<char> &data) : data_(data), pos_(0) {}
+
+    bool at_end() const { return pos_ == data_.size(); }
+
+    template<class T>
+    bool read(T *values, Index count) {
+        const size_t bytes = (size_t) count * sizeof(T);
+        if( count < 0 || data_.size() - pos_ < bytes )
+        {
+            return false;
+        }
+        std::memcpy(values, data_.data() + pos_, bytes);
+        pos_ += bytes;
+        return true;
+    }
+
+    // appends count values to v and returns the offset of the first; count comes from the file, so it is checked
+    // against the bytes left (and the offsets against Index) before anything is allocated
+    template<class T>
+    Index append(std::vector<T> &v, int64_t count, bool &ok) {
+        const Index offset = (Index) v.size();
+        if( !ok || count < 0 || (uint64_t) count > (data_.size() - pos_) / sizeof(T)
+            || (uint64_t) count > (uint64_t) std::numeric_limits<Index>::max() - v.size() )
+        {
+            ok = false;
+            return offset;
+        }
+        v.resize(v.size() + (size_t) count);
+        ok = read(v.data() + offset, (Index) count);
+        return offset;
+    }
+
+private:
+    const std::vector<char> &data_;
+    size_t pos_;
+
+};
+
+bool CallbackTrace::load(const std::string &path, std::string &error) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if( !in )
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    TraceReader reader(data);
+    char magic[sizeof(TRACE_MAGIC)];
+    unsigned char widths[2];
+    if( !reader.read(magic, sizeof(magic)) || std::memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0
+        || !reader.read(widths, 2) )
+    {
+        error = path + ": not a callback trace";
+        return false;
+    }
+    if( widths[0] != sizeof(Number) || widths[1] != sizeof(Index) )
+    {
+        error = path + ": written with other widths of Number and Index";
+        return false;
+    }
+
+    records.clear();
+    numbers.clear();
+    indices.clear();
+    n = m = nnz_jac_g = nnz_h_lag = 0;
+    bool have_info = false;
+    Index x = -1, lambda = -1;
+    while( !reader.at_end() )
+    {
+        uint32_t header = 0;
+        bool ok = reader.read(&header, 1);
+        CallbackRecord r;
+        r.method = (Index) (header & 0xff);
+        r.flags = header >> 8;
+        r.inputs = r.outputs = r.int_values = -1;
+        if( r.method >= CALLBACK_NUM_METHODS || (r.method != CALLBACK_NLP_INFO && !have_info) )
+        {
+            error = path + ": malformed record";
+            return false;
+        }
+        if( r.flags & CALLBACK_X_STORED )
+        {
+            x = reader.append(numbers, n, ok);
+        }
+        if( r.flags & CALLBACK_LAMBDA_STORED )
+        {
+            lambda = reader.append(numbers, m, ok);
+        }
+        r.x = x;
+        r.lambda = lambda;
+        const bool structure = (r.flags & CALLBACK_STRUCTURE) != 0;
+        switch( r.method )
+        {
+            case CALLBACK_NLP_INFO:
+                r.int_values = reader.append(indices, 5, ok);
+                if( ok && !have_info )
+                {
+                    // the counts below are formed in 64 bits from these, so they cannot overflow; the largest must
+                    // still fit an Index, as replay_callbacks sizes its buffers with them
+                    const Index *info = indices.data() + r.int_values;
+                    const int64_t max_index = std::numeric_limits<Index>::max();
+                    if( *std::min_element(info, info + 4) < 0
+                        || 1 + 3 * (int64_t) info[0] + 2 * (int64_t) info[1] > max_index
+                        || 2 * (int64_t) std::max(info[2], info[3]) > max_index )
+                    {
+                        ok = false;
+                        break;
+                    }
+                    n = info[0];
+                    m = info[1];
+                    nnz_jac_g = info[2];
+                    nnz_h_lag = info[3];
+                    have_info = true;
+                }
+                break;
+            case CALLBACK_BOUNDS:
+                r.outputs = reader.append(numbers, 2 * (int64_t) n + 2 * (int64_t) m, ok);
+                break;
+            case CALLBACK_STARTING_POINT:
+                r.outputs = reader.append(numbers, (int64_t) (r.flags & CALLBACK_INIT_X ? n : 0)
+                                                   + (r.flags & CALLBACK_INIT_Z ? 2 * (int64_t) n : 0)
+                                                   + (r.flags & CALLBACK_INIT_LAMBDA ? m : 0), ok);
+                break;
+            case CALLBACK_F:
+                r.outputs = reader.append(numbers, 1, ok);
+                break;
+            case CALLBACK_GRAD_F:
+                r.outputs = reader.append(numbers, n, ok);
+                break;
+            case CALLBACK_G:
+                r.outputs = reader.append(numbers, m, ok);
+                break;
+            case CALLBACK_JAC_G:
+            case CALLBACK_H:
+            {
+                const Index nnz = r.method == CALLBACK_JAC_G ? nnz_jac_g : nnz_h_lag;
+                if( structure )
+                {
+                    r.int_values = reader.append(indices, 2 * (int64_t) nnz, ok);
+                }
+                else
+                {
+                    r.inputs = r.method == CALLBACK_H ? reader.append(numbers, 1, ok) : -1;
+                    r.outputs = reader.append(numbers, nnz, ok);
+                }
+                break;
+            }
+            case CALLBACK_INTERMEDIATE:
+                r.int_values = reader.append(indices, 3, ok);
+                r.inputs = reader.append(numbers, NUM_INTERMEDIATE_NUMBERS, ok);
+                break;
+            case CALLBACK_FINALIZE:
+                r.int_values = reader.append(indices, 1, ok);
+                r.inputs = reader.append(numbers, 1 + 3 * (int64_t) n + 2 * (int64_t) m, ok);
+                break;
+        }
+        // an evaluation needs a point; without constraints the recorder never stores multipliers
+        ok = ok && (structure || r.x >= 0 || r.method < CALLBACK_F || r.method > CALLBACK_H)
+             && (structure || r.lambda >= 0 || m == 0 || r.method != CALLBACK_H);
+        if( !ok )
+        {
+            error = path + ": truncated or malformed record";
+            return false;
+        }
+        records.push_back(r);
+    }
+    return true;
+}
+
+// largest difference of values from recorded, relative to max(1, |recorded|)
+static Number difference(const Number *values, const Number *recorded, Index count) {
+    Number d = 0.;
+    for( Index k = 0; k < count; k++ )
+    {
+        d = std::max(d, std::fabs(values[k] - recorded[k]) / std::max(1., std::fabs(recorded[k])));
+    }
+    return d;
+}
+
+void replay_callbacks(const CallbackTrace &trace, TNLP &nlp, bool time_methods, CallbackReplayStats &stats) {
+    typedef std::chrono::steady_clock Clock;
+    const Index n = trace.n, m = trace.m;
+    // large enough for the bounds, a full starting point (x, z_L, z_U, lambda) and the Jacobian or Hessian values
+    std::vector<Number> out(
+            (size_t) std::max(std::max(std::max(2 * n + 2 * m, 3 * n + m), trace.nnz_jac_g), trace.nnz_h_lag) + 1);
+    std::vector<Index> rows((size_t) std::max(trace.nnz_jac_g, trace.nnz_h_lag) + 1);
+    std::vector<Index> cols(rows.size());
+    const Number *numbers = trace.numbers.data();
+    const Index *indices = trace.indices.data();
+    Number *o = out.data();
+
+    const Clock::time_point begin = Clock::now();
+    for( size_t k = 0; k < trace.records.size(); k++ )
+    {
+        const CallbackRecord &r = trace.records[k];
+        const Number *x = r.x >= 0 ? numbers + r.x : NULL;
+        const Number *lambda = r.lambda >= 0 ? numbers + r.lambda : NULL;
+        const bool new_x = (r.flags & CALLBACK_NEW_X) != 0;
+        const bool structure = (r.flags & CALLBACK_STRUCTURE) != 0;
+        const Clock::time_point start = time_methods ? Clock::now() : Clock::time_point();
+        bool ok = true;
+        // number of outputs in out to compare with the record
+        Index count = 0;
+        bool same_structure = true;
+        switch( r.method )
+        {
+            case CALLBACK_NLP_INFO:
+            {
+                Index info[4];
+                TNLP::IndexStyleEnum style;
+                ok = nlp.get_nlp_info(info[0], info[1], info[2], info[3], style);
+                same_structure = std::equal(info, info + 4, indices + r.int_values)
+                                 && (Index) style == indices[r.int_values + 4];
+                break;
+            }
+            case CALLBACK_BOUNDS:
+                ok = nlp.get_bounds_info(n, o, o + n, m, o + 2 * n, o + 2 * n + m);
+                count = 2 * n + 2 * m;
+                break;
+            case CALLBACK_STARTING_POINT:
+            {
+                const bool init_x = (r.flags & CALLBACK_INIT_X) != 0, init_z = (r.flags & CALLBACK_INIT_Z) != 0;
+                const bool init_lambda = (r.flags & CALLBACK_INIT_LAMBDA) != 0;
+                Number *z = init_x ? o + n : o;
+                Number *l = init_z ? z + 2 * n : z;
+                ok = nlp.get_starting_point(n, init_x, o, init_z, z, z + n, m, init_lambda, l);
+                count = (Index) (l - o) + (init_lambda ? m : 0);
+                break;
+            }
+            case CALLBACK_F:
+                ok = nlp.eval_f(n, x, new_x, *o);
+                count = 1;
+                break;
+            case CALLBACK_GRAD_F:
+                ok = nlp.eval_grad_f(n, x, new_x, o);
+                count = n;
+                break;
+            case CALLBACK_G:
+                ok = nlp.eval_g(n, x, new_x, m, o);
+                count = m;
+                break;
+            case CALLBACK_JAC_G:
+                if( structure )
+                {
+                    ok = nlp.eval_jac_g(n, NULL, new_x, m, trace.nnz_jac_g, rows.data(), cols.data(), NULL);
+                    same_structure = std::equal(rows.begin(), rows.begin() + trace.nnz_jac_g, indices + r.int_values)
+                                     && std::equal(cols.begin(), cols.begin() + trace.nnz_jac_g,
+                                                   indices + r.int_values + trace.nnz_jac_g);
+                }
+                else
+                {
+                    ok = nlp.eval_jac_g(n, x, new_x, m, trace.nnz_jac_g, NULL, NULL, o);
+                    count = trace.nnz_jac_g;
+                }
+                break;
+            case CALLBACK_H:
+                if( structure )
+                {
+                    ok = nlp.eval_h(n, NULL, new_x, 0., m, NULL, false, trace.nnz_h_lag, rows.data(), cols.data(),
+                                    NULL);
+                    same_structure = std::equal(rows.begin(), rows.begin() + trace.nnz_h_lag, indices + r.int_values)
+                                     && std::equal(cols.begin(), cols.begin() + trace.nnz_h_lag,
+                                                   indices + r.int_values + trace.nnz_h_lag);
+                }
+                else
+                {
+                    ok = nlp.eval_h(n, x, new_x, numbers[r.inputs], m, lambda, (r.flags & CALLBACK_NEW_LAMBDA) != 0,
+                                    trace.nnz_h_lag, NULL, NULL, o);
+                    count = trace.nnz_h_lag;
+                }
+                break;
+            case CALLBACK_INTERMEDIATE:
+            {
+                const Number *v = numbers + r.inputs;
+                const Index *i = indices + r.int_values;
+                ok = nlp.intermediate_callback((AlgorithmMode) i[0], i[1], v[0], v[1], v[2], v[3], v[4], v[5], v[6],
+                                               v[7], i[2], NULL, NULL);
+                break;
+            }
+            case CALLBACK_FINALIZE:
+            {
+                const Number *v = numbers + r.inputs;
+                nlp.finalize_solution((SolverReturn) indices[r.int_values], n, v + 1, v + 1 + n, v + 1 + 2 * n, m,
+                                      v + 1 + 3 * n, v + 1 + 3 * n + m, v[0], NULL, NULL);
+                break;
+            }
+        }
+        if( time_methods )
+        {
+            stats.seconds[r.method] += std::chrono::duration<Number>(Clock::now() - start).count();
+        }
+        stats.calls[r.method]++;
+        if( ok != ((r.flags & CALLBACK_RESULT) != 0) || !same_structure )
+        {
+            stats.mismatches++;
+        }
+        if( count > 0 )
+        {
+            stats.max_difference = std::max(stats.max_difference, difference(o, numbers + r.outputs, count));
+        }
+    }
+    stats.total_seconds += std::chrono::duration<Number>(Clock::now() - begin).count();
+}
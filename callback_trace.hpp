@@ -0,0 +1,147 @@
+//
+// Record and replay of the callback traffic between Ipopt and a TNLP, so that the evaluation code can be profiled and
+// tuned on the call sequence of a real solve without running the solver. CallbackRecorder wraps a TNLP (HS071_NLP in
+// the Replay driver), forwards every callback to it and appends one record per call to a binary file: the method, the
+// flags (new_x, new_lambda, init_*, whether the call asked for a sparsity structure, the return value), the inputs
+// and the outputs. x and lambda are only written when they differ from the last ones written, which is what new_x and
+// new_lambda promise most of the time, so a record of an HS071 solve is a few kilobytes.
+// CallbackTrace loads such a file into flat arrays and replay_callbacks drives the callbacks of another TNLP with it,
+// in the recorded order and with the recorded arguments, and compares the outputs with the recorded ones.
+//
+// The file is a magic string followed by the records, in the byte order and Number width of the machine that wrote
+// it; the reader checks the magic, which carries the width, and rejects truncated records. The dimensions are those of
+// the first get_nlp_info record, which Ipopt always calls first.
+//
+
+#ifndef __CALLBACK_TRACE_HPP
+#define __CALLBACK_TRACE_HPP
+
+#include "IpTNLP.hpp"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace Ipopt;
+
+enum CallbackMethod {
+    CALLBACK_NLP_INFO = 0,
+    CALLBACK_BOUNDS,
+    CALLBACK_STARTING_POINT,
+    CALLBACK_F,
+    CALLBACK_GRAD_F,
+    CALLBACK_G,
+    CALLBACK_JAC_G,
+    CALLBACK_H,
+    CALLBACK_INTERMEDIATE,
+    CALLBACK_FINALIZE,
+    CALLBACK_NUM_METHODS
+};
+
+// name of a CallbackMethod, e.g. "eval_jac_g"
+const char *callback_method_name(Index method);
+
+// bits of CallbackRecord::flags
+enum CallbackFlag {
+    CALLBACK_NEW_X = 1,
+    CALLBACK_NEW_LAMBDA = 2,
+    // the call asked for the sparsity structure (values == NULL)
+    CALLBACK_STRUCTURE = 4,
+    CALLBACK_INIT_X = 8,
+    CALLBACK_INIT_Z = 16,
+    CALLBACK_INIT_LAMBDA = 32,
+    // the return value of the callback
+    CALLBACK_RESULT = 64,
+    // x or lambda follow in the record
+    CALLBACK_X_STORED = 128,
+    CALLBACK_LAMBDA_STORED = 256
+};
+
+class CallbackRecorder: public TNLP {
+
+public:
+    // appends the records to path, which is truncated; see ok() for whether it could be opened
+    CallbackRecorder(const SmartPtr<TNLP> &nlp, const std::string &path);
+
+    // whether every record so far was written
+    bool ok() const { return file_.good(); }
+    Index num_records() const { return num_records_; }
+    // flushes the records written so far
+    void flush();
+
+    // methods from Ipopt::TNLP
+    bool get_nlp_info(Index &n, Index &m, Index &nnz_jac_g, Index &nnz_h_lag, IndexStyleEnum &index_style);
+    bool get_bounds_info(Index n, Number *x_l, Number *x_u, Index m, Number *g_l, Number *g_u);
+    bool get_starting_point(Index n, bool init_x, Number *x, bool init_z, Number *z_L, Number *z_U, Index m,
+                            bool init_lambda, Number *lambda);
+    bool eval_f(Index n, const Number *x, bool new_x, Number &obj_value);
+    bool eval_grad_f(Index n, const Number *x, bool new_x, Number *grad_f);
+    bool eval_g(Index n, const Number *x, bool new_x, Index m, Number *g);
+    bool eval_jac_g(Index n, const Number *x, bool new_x, Index m, Index nele_jac, Index *iRow, Index *jCol,
+                    Number *values);
+    bool eval_h(Index n, const Number *x, bool new_x, Number obj_factor, Index m, const Number *lambda, bool new_lambda,
+                Index nele_hess, Index *iRow, Index *jCol, Number *values);
+    void finalize_solution(SolverReturn status, Index n, const Number *x, const Number *z_L, const Number *z_U, Index m,
+                           const Number *g, const Number *lambda, Number obj_value, const IpoptData *ip_data,
+                           IpoptCalculatedQuantities *ip_cq);
+    bool intermediate_callback(AlgorithmMode mode, Index iter, Number obj_value, Number inf_pr, Number inf_du, Number mu,
+                               Number d_norm, Number regularization_size, Number alpha_du, Number alpha_pr,
+                               Index ls_trials, const IpoptData *ip_data, IpoptCalculatedQuantities *ip_cq);
+
+private:
+    // starts a record; x and lambda (either may be NULL) are stored unless they equal the last stored ones
+    void begin(Index method, unsigned flags, const Number *x, Index n, const Number *lambda, Index m);
+    void write_numbers(const Number *values, Index count);
+    void write_indices(const Index *values, Index count);
+
+    SmartPtr<TNLP> nlp_;
+    std::ofstream file_;
+    Index num_records_;
+    std::vector<Number> last_x_;
+    std::vector<Number> last_lambda_;
+
+};
+
+// one recorded call; the offsets point into CallbackTrace::numbers and CallbackTrace::indices, -1 when absent
+struct CallbackRecord {
+    Index method;
+    unsigned flags;
+    // x and lambda in effect for the call: the last ones stored up to this record
+    Index x;
+    Index lambda;
+    // further inputs in numbers: obj_factor for eval_h; obj_value, inf_pr, inf_du, mu, d_norm, regularization_size,
+    // alpha_du, alpha_pr for intermediate_callback; obj_value, x, z_L, z_U, g, lambda for finalize_solution
+    Index inputs;
+    // recorded outputs in numbers, in the order of the callback's arguments
+    Index outputs;
+    // in indices: the outputs of get_nlp_info, the rows then the columns of a structure, mode, iter and ls_trials of
+    // intermediate_callback, the status of finalize_solution
+    Index int_values;
+};
+
+struct CallbackTrace {
+    Index n = 0, m = 0, nnz_jac_g = 0, nnz_h_lag = 0;
+    std::vector<CallbackRecord> records;
+    std::vector<Number> numbers;
+    std::vector<Index> indices;
+
+    // replaces the trace by the file at path; returns false with the reason in error
+    bool load(const std::string &path, std::string &error);
+};
+
+struct CallbackReplayStats {
+    Index calls[CALLBACK_NUM_METHODS] = {0};
+    // seconds per method, only with time_methods (each call then pays for two clock reads)
+    Number seconds[CALLBACK_NUM_METHODS] = {0.};
+    // wall time of the whole replay
+    Number total_seconds = 0.;
+    // largest difference between replayed and recorded outputs, relative to max(1, |recorded|)
+    Number max_difference = 0.;
+    // calls whose return value or sparsity structure differs from the record
+    Index mismatches = 0;
+};
+
+// calls the callbacks of nlp as recorded in trace; nlp must have the dimensions of the trace. Accumulates into stats.
+void replay_callbacks(const CallbackTrace &trace, TNLP &nlp, bool time_methods, CallbackReplayStats &stats);
+
+#endif //__CALLBACK_TRACE_HPP
@@ -0,0 +1,256 @@
+//
+// Dense symmetric indefinite LDL^T factorization, see dense_ldlt.hpp
+//
+
+#include "dense_ldlt.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+DenseLDLT::DenseLDLT() : n_(0), n_pos_(0), n_neg_(0), n_zero_(0) {
+}
+
+bool DenseLDLT::factor(Index n, const Number *a, Number pivot_tol) {
+    // Right looking Bunch-Kaufman: the whole symmetric matrix is kept and swapped so that the rows of L computed
+    // so far follow every interchange, which keeps the solve a plain sequence of swaps and triangular sweeps.
+    n_ = n;
+    n_pos_ = n_neg_ = n_zero_ = 0;
+    lu_.assign(a, a + (size_t) n * n);
+    ipiv_.assign(n, 0);
+    two_.assign(n, 0);
+    Number *A = lu_.data();
+#define LDLT_A(i, j) A[(size_t) (j) * n + (i)]
+    // mirror the lower triangle
+    Number norm = 0.;
+    for( Index j = 0; j < n; j++ )
+    {
+        for( Index i = j; i < n; i++ )
+        {
+            LDLT_A(j, i) = LDLT_A(i, j);
+            norm = std::max(norm, std::fabs(LDLT_A(i, j)));
+        }
+    }
+    const Number alpha = (1. + std::sqrt(17.)) / 8.;
+    const Number tiny = std::max(std::max(norm, 1.) * n * std::numeric_limits<Number>::epsilon(), pivot_tol * norm);
+    bool regular = true;
+
+    Index k = 0;
+    while( k < n )
+    {
+        Index kstep = 1;
+        Index kp = k;
+        const Number absakk = std::fabs(LDLT_A(k, k));
+        Index imax = k;
+        Number colmax = 0.;
+        for( Index i = k + 1; i < n; i++ )
+        {
+            if( std::fabs(LDLT_A(i, k)) > colmax )
+            {
+                colmax = std::fabs(LDLT_A(i, k));
+                imax = i;
+            }
+        }
+        if( absakk < alpha * colmax )
+        {
+            Number rowmax = 0.;
+            for( Index j = k; j < n; j++ )
+            {
+                if( j != imax )
+                {
+                    rowmax = std::max(rowmax, std::fabs(LDLT_A(imax, j)));
+                }
+            }
+            if( absakk * rowmax >= alpha * colmax * colmax )
+            {
+                kp = k;
+            }
+            else if( std::fabs(LDLT_A(imax, imax)) >= alpha * rowmax )
+            {
+                kp = imax;
+            }
+            else
+            {
+                kp = imax;
+                kstep = 2;
+            }
+        }
+
+        const Index kk = k + kstep - 1;
+        ipiv_[k] = kp;
+        if( kp != kk )
+        {
+            for( Index j = 0; j < n; j++ )
+            {
+                std::swap(LDLT_A(kk, j), LDLT_A(kp, j));
+            }
+            for( Index i = 0; i < n; i++ )
+            {
+                std::swap(LDLT_A(i, kk), LDLT_A(i, kp));
+            }
+        }
+
+        if( kstep == 1 )
+        {
+            const Number d = LDLT_A(k, k);
+            if( std::fabs(d) <= tiny )
+            {
+                // zero pivot: count it, leave its column alone and continue to get the full inertia
+                n_zero_++;
+                regular = false;
+                for( Index i = k + 1; i < n; i++ )
+                {
+                    LDLT_A(i, k) = LDLT_A(k, i) = 0.;
+                }
+                k++;
+                continue;
+            }
+            (d > 0. ? n_pos_ : n_neg_)++;
+            for( Index i = k + 1; i < n; i++ )
+            {
+                LDLT_A(i, k) /= d;
+            }
+            for( Index j = k + 1; j < n; j++ )
+            {
+                const Number akj = LDLT_A(k, j);
+                for( Index i = k + 1; i < n; i++ )
+                {
+                    LDLT_A(i, j) -= LDLT_A(i, k) * akj;
+                }
+            }
+            for( Index i = k + 1; i < n; i++ )
+            {
+                LDLT_A(k, i) = LDLT_A(i, k);
+            }
+        }
+        else
+        {
+            const Number d11 = LDLT_A(k, k);
+            const Number d21 = LDLT_A(k + 1, k);
+            const Number d22 = LDLT_A(k + 1, k + 1);
+            const Number det = d11 * d22 - d21 * d21;
+            two_[k] = 1;
+            // the smaller eigenvalue of the block is about det over its largest entry
+            if( std::fabs(det) <= tiny * std::max(std::fabs(d21), std::max(std::fabs(d11), std::fabs(d22))) )
+            {
+                n_zero_ += 2;
+                regular = false;
+                for( Index i = k + 2; i < n; i++ )
+                {
+                    LDLT_A(i, k) = LDLT_A(k, i) = LDLT_A(i, k + 1) = LDLT_A(k + 1, i) = 0.;
+                }
+                k += 2;
+                continue;
+            }
+            if( det < 0. )
+            {
+                n_pos_++;
+                n_neg_++;
+            }
+            else
+            {
+                (d11 > 0. ? n_pos_ : n_neg_) += 2;
+            }
+            for( Index i = k + 2; i < n; i++ )
+            {
+                const Number w1 = LDLT_A(i, k);
+                const Number w2 = LDLT_A(i, k + 1);
+                LDLT_A(i, k) = (d22 * w1 - d21 * w2) / det;
+                LDLT_A(i, k + 1) = (d11 * w2 - d21 * w1) / det;
+            }
+            for( Index j = k + 2; j < n; j++ )
+            {
+                const Number akj = LDLT_A(k, j);
+                const Number ak1j = LDLT_A(k + 1, j);
+                for( Index i = k + 2; i < n; i++ )
+                {
+                    LDLT_A(i, j) -= LDLT_A(i, k) * akj + LDLT_A(i, k + 1) * ak1j;
+                }
+            }
+            for( Index i = k + 2; i < n; i++ )
+            {
+                LDLT_A(k, i) = LDLT_A(i, k);
+                LDLT_A(k + 1, i) = LDLT_A(i, k + 1);
+            }
+        }
+        k += kstep;
+    }
+#undef LDLT_A
+    return regular;
+}
+
+void DenseLDLT::solve(Index nrhs, Number *b) const {
+    const Index n = n_;
+    const Number *A = lu_.data();
+#define LDLT_A(i, j) A[(size_t) (j) * n + (i)]
+    for( Index r = 0; r < nrhs; r++ )
+    {
+        Number *x = b + (size_t) r * n;
+        // P b; factor() kept the rows of L in their final order, so all interchanges go first
+        for( Index k = 0; k < n; k += two_[k] ? 2 : 1 )
+        {
+            const Index kk = k + (two_[k] ? 1 : 0);
+            if( ipiv_[k] != kk )
+            {
+                std::swap(x[kk], x[ipiv_[k]]);
+            }
+        }
+        // forward sweep with L and D^{-1}
+        for( Index k = 0; k < n; )
+        {
+            const Index kstep = two_[k] ? 2 : 1;
+            for( Index i = k + kstep; i < n; i++ )
+            {
+                x[i] -= LDLT_A(i, k) * x[k] + (kstep == 2 ? LDLT_A(i, k + 1) * x[k + 1] : 0.);
+            }
+            k += kstep;
+        }
+        for( Index k = 0; k < n; )
+        {
+            if( two_[k] )
+            {
+                const Number d11 = LDLT_A(k, k);
+                const Number d21 = LDLT_A(k + 1, k);
+                const Number d22 = LDLT_A(k + 1, k + 1);
+                const Number det = d11 * d22 - d21 * d21;
+                const Number x1 = x[k];
+                const Number x2 = x[k + 1];
+                // factor() zeroes only the L columns of a singular block and keeps its D entries, so only an
+                // exactly singular block gives zero here; a nearly singular one is inverted as it is
+                x[k] = det != 0. ? (d22 * x1 - d21 * x2) / det : 0.;
+                x[k + 1] = det != 0. ? (d11 * x2 - d21 * x1) / det : 0.;
+                k += 2;
+            }
+            else
+            {
+                x[k] = LDLT_A(k, k) != 0. ? x[k] / LDLT_A(k, k) : 0.;
+                k++;
+            }
+        }
+        // backward sweep with L^T, then P^T with the interchanges in reverse order
+        for( Index c = n - 1; c >= 0; c-- )
+        {
+            // the second column of a 2x2 block has no L entry in the first one
+            const Index first = (c > 0 && two_[c - 1]) ? c + 1 : (two_[c] ? c + 2 : c + 1);
+            Number s = 0.;
+            for( Index i = first; i < n; i++ )
+            {
+                s += LDLT_A(i, c) * x[i];
+            }
+            x[c] -= s;
+        }
+        for( Index k = n - 1; k >= 0; k-- )
+        {
+            if( k > 0 && two_[k - 1] )
+            {
+                continue;
+            }
+            const Index kk = k + (two_[k] ? 1 : 0);
+            if( ipiv_[k] != kk )
+            {
+                std::swap(x[kk], x[ipiv_[k]]);
+            }
+        }
+    }
+#undef LDLT_A
+}
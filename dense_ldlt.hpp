@@ -0,0 +1,46 @@
+//
+// Dense symmetric indefinite LDL^T factorization with Bunch-Kaufman (1x1 / 2x2) pivoting.
+// Small enough to be used on the reduced KKT systems of HS071 and on the blocks of structured KKT matrices.
+//
+
+#ifndef __DENSE_LDLT_HPP
+#define __DENSE_LDLT_HPP
+
+#include "IpTypes.hpp"
+
+#include <vector>
+
+using namespace Ipopt;
+
+class DenseLDLT {
+
+public:
+    DenseLDLT();
+
+    // Factors the n x n symmetric matrix a (column major, only the lower triangle is read).
+    // Returns false if the matrix is numerically singular, i.e. a pivot is below n * eps or pivot_tol times the
+    // largest entry; the inertia is still available in that case, with those pivots counted as zero.
+    bool factor(Index n, const Number *a, Number pivot_tol = 0.);
+
+    // Solves A X = B in place for nrhs right hand sides stored column major in b (leading dimension n).
+    void solve(Index nrhs, Number *b) const;
+
+    // inertia of the last factored matrix: number of positive, negative and zero eigenvalues
+    Index num_positive() const { return n_pos_; }
+    Index num_negative() const { return n_neg_; }
+    Index num_zero() const { return n_zero_; }
+
+    Index dim() const { return n_; }
+
+private:
+    Index n_;
+    std::vector<Number> lu_;     // L below the diagonal, D on the diagonal (and first subdiagonal for 2x2 pivots)
+    std::vector<Index> ipiv_;    // row/column interchanged with the last row of the pivot block at step k
+    std::vector<char> two_;      // two_[k] is set for the first column of a 2x2 pivot block
+    Index n_pos_;
+    Index n_neg_;
+    Index n_zero_;
+
+};
+
+#endif //__DENSE_LDLT_HPP
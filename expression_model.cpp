@@ -0,0 +1,1071 @@
+//
+// Runtime models compiled to a bytecode tape, see expression_model.hpp
+//
+
+#include "expression_model.hpp"
+#include "finite_difference_tnlp.hpp"
+#include "sparsity_detector.hpp"
+
+#include <algorithm>
+#include <assert.h>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <tuple>
+
+// bounds written as inf
+static const Number INFINITE_BOUND = 2e19;
+
+// Compiles model text into an ExpressionModel: the statements are read line by line, then the objective and the
+// constraints are compiled by recursive descent, each into its own segment.
+class ExpressionParser {
+
+public:
+    explicit ExpressionParser(ExpressionModel &model) : model_(model) {}
+
+    bool parse(const std::string &text, std::string &error);
+
+private:
+    struct Token {
+        char kind;          // 'n' number, 'a' name, or the operator character
+        Number number;
+        std::string name;
+    };
+    struct Function {
+        Index line;
+        std::string text;
+    };
+
+    bool fail(Index line, const std::string &reason);
+    bool value(const std::string &word, ExpressionModel::Value &v);
+    bool tokenize(const std::string &text);
+    bool compile(const Function &function);
+
+    // recursive descent; each returns the instruction of the parsed expression or -1 with error_ set
+    Index expression();
+    Index term();
+    Index unary();
+    Index power();
+    Index primary();
+
+    Index error(const std::string &reason);
+
+    ExpressionModel &model_;
+    std::map<std::string, Index> var_index_;
+    std::map<std::string, Index> param_index_;
+    ExpressionBuilder *builder_;
+
+    std::vector<Token> tokens_;
+    size_t pos_;
+    std::string error_;
+
+};
+
+bool ExpressionParser::fail(Index line, const std::string &reason) {
+    std::ostringstream os;
+    os << "line " << line << ": " << reason;
+    error_ = os.str();
+    return false;
+}
+
+Index ExpressionParser::error(const std::string &reason) {
+    if( error_.empty() )
+    {
+        error_ = reason;
+    }
+    return -1;
+}
+
+bool ExpressionParser::value(const std::string &word, ExpressionModel::Value &v) {
+    v.param = -1;
+    if( word == "inf" || word == "+inf" )
+    {
+        v.number = INFINITE_BOUND;
+        return true;
+    }
+    if( word == "-inf" )
+    {
+        v.number = -INFINITE_BOUND;
+        return true;
+    }
+    char *end;
+    v.number = std::strtod(word.c_str(), &end);
+    if( !word.empty() && *end == '\0' )
+    {
+        return true;
+    }
+    std::map<std::string, Index>::const_iterator it = param_index_.find(word);
+    if( it == param_index_.end() )
+    {
+        return false;
+    }
+    v.number = 0.;
+    v.param = it->second;
+    return true;
+}
+
+bool ExpressionParser::tokenize(const std::string &text) {
+    tokens_.clear();
+    size_t i = 0;
+    while( i < text.size() )
+    {
+        const char c = text[i];
+        Token token;
+        if( std::isspace((unsigned char) c) )
+        {
+            i++;
+            continue;
+        }
+        if( std::isdigit((unsigned char) c) || c == '.' )
+        {
+            char *end;
+            token.kind = 'n';
+            token.number = std::strtod(text.c_str() + i, &end);
+            i = end - text.c_str();
+        }
+        else if( std::isalpha((unsigned char) c) || c == '_' )
+        {
+            token.kind = 'a';
+            while( i < text.size() && (std::isalnum((unsigned char) text[i]) || text[i] == '_') )
+            {
+                token.name += text[i++];
+            }
+        }
+        else if( std::string("+-*/^()").find(c) != std::string::npos )
+        {
+            token.kind = c;
+            i++;
+        }
+        else
+        {
+            error_ = std::string("unexpected character '") + c + "'";
+            return false;
+        }
+        tokens_.push_back(token);
+    }
+    return true;
+}
+
+Index ExpressionParser::expression() {
+    Index left = term();
+    while( left >= 0 && pos_ < tokens_.size() && (tokens_[pos_].kind == '+' || tokens_[pos_].kind == '-') )
+    {
+        const char kind = tokens_[pos_++].kind;
+        const Index right = term();
+        if( right < 0 )
+        {
+            return -1;
+        }
+        left = builder_->emit(kind == '+' ? ExpressionModel::OP_ADD : ExpressionModel::OP_SUB, left, right);
+    }
+    return left;
+}
+
+Index ExpressionParser::term() {
+    Index left = unary();
+    while( left >= 0 && pos_ < tokens_.size() && (tokens_[pos_].kind == '*' || tokens_[pos_].kind == '/') )
+    {
+        const char kind = tokens_[pos_++].kind;
+        const Index right = unary();
+        if( right < 0 )
+        {
+            return -1;
+        }
+        left = builder_->emit(kind == '*' ? ExpressionModel::OP_MUL : ExpressionModel::OP_DIV, left, right);
+    }
+    return left;
+}
+
+Index ExpressionParser::unary() {
+    if( pos_ < tokens_.size() && (tokens_[pos_].kind == '-' || tokens_[pos_].kind == '+') )
+    {
+        const char kind = tokens_[pos_++].kind;
+        const Index operand = unary();
+        if( operand < 0 || kind == '+' )
+        {
+            return operand;
+        }
+        return builder_->emit(ExpressionModel::OP_NEG, operand);
+    }
+    return power();
+}
+
+Index ExpressionParser::power() {
+    const Index base = primary();
+    if( base < 0 || pos_ >= tokens_.size() || tokens_[pos_].kind != '^' )
+    {
+        return base;
+    }
+    pos_++;
+    const Index exponent = unary();
+    if( exponent < 0 )
+    {
+        return -1;
+    }
+    if( !builder_->is_constant(exponent) )
+    {
+        return error("the exponent of ^ must be constant");
+    }
+    return builder_->power(base, builder_->constant_value(exponent));
+}
+
+Index ExpressionParser::primary() {
+    if( pos_ >= tokens_.size() )
+    {
+        return error("unexpected end of expression");
+    }
+    const Token &token = tokens_[pos_++];
+    if( token.kind == 'n' )
+    {
+        return builder_->constant(token.number);
+    }
+    if( token.kind == '(' )
+    {
+        const Index inner = expression();
+        if( inner < 0 )
+        {
+            return -1;
+        }
+        if( pos_ >= tokens_.size() || tokens_[pos_].kind != ')' )
+        {
+            return error("missing ')'");
+        }
+        pos_++;
+        return inner;
+    }
+    if( token.kind != 'a' )
+    {
+        return error(std::string("unexpected '") + token.kind + "'");
+    }
+
+    static const char *functions[] = {"sqrt", "exp", "log", "sin", "cos"};
+    static const Index function_ops[] = {ExpressionModel::OP_SQRT, ExpressionModel::OP_EXP, ExpressionModel::OP_LOG,
+                                         ExpressionModel::OP_SIN, ExpressionModel::OP_COS};
+    for( Index f = 0; f < 5; f++ )
+    {
+        if( token.name == functions[f] )
+        {
+            if( pos_ >= tokens_.size() || tokens_[pos_].kind != '(' )
+            {
+                return error("missing '(' after " + token.name);
+            }
+            const Index argument = primary();
+            return argument < 0 ? -1 : builder_->emit(function_ops[f], argument);
+        }
+    }
+    std::map<std::string, Index>::const_iterator it = var_index_.find(token.name);
+    if( it != var_index_.end() )
+    {
+        return builder_->emit(ExpressionModel::OP_VAR, it->second);
+    }
+    it = param_index_.find(token.name);
+    if( it != param_index_.end() )
+    {
+        return builder_->emit(ExpressionModel::OP_PARAM, it->second);
+    }
+    return error("unknown name '" + token.name + "'");
+}
+
+bool ExpressionParser::compile(const Function &function) {
+    error_.clear();
+    pos_ = 0;
+    if( !tokenize(function.text) )
+    {
+        return fail(function.line, error_);
+    }
+    const Index result = expression();
+    if( result < 0 )
+    {
+        return fail(function.line, error_);
+    }
+    if( pos_ != tokens_.size() )
+    {
+        return fail(function.line, "unexpected tokens after the expression");
+    }
+    builder_->end_function(result);
+    return true;
+}
+
+bool ExpressionParser::parse(const std::string &text, std::string &error) {
+    model_ = ExpressionModel();
+    std::istringstream lines(text);
+    std::string line;
+    Function objective = {-1, ""};
+    std::vector<Function> constraints;
+    for( Index number = 1; std::getline(lines, line); number++ )
+    {
+        const size_t comment = line.find('#');
+        if( comment != std::string::npos )
+        {
+            line.erase(comment);
+        }
+        std::istringstream words(line);
+        std::string keyword;
+        if( !(words >> keyword) )
+        {
+            continue;
+        }
+        if( keyword == "param" )
+        {
+            std::string name, word;
+            ExpressionModel::Value v;
+            if( !(words >> name >> word) || !value(word, v) || v.param >= 0 )
+            {
+                error = (fail(number, "expected: param <name> <number>"), error_);
+                return false;
+            }
+            param_index_[name] = (Index) model_.params_.size();
+            model_.param_names_.push_back(name);
+            model_.params_.push_back(v.number);
+        }
+        else if( keyword == "var" )
+        {
+            std::string name, lower, upper, start;
+            ExpressionModel::Value l, u, s;
+            if( !(words >> name >> lower >> upper >> start) || !value(lower, l) || !value(upper, u)
+                || !value(start, s) )
+            {
+                error = (fail(number, "expected: var <name> <lower> <upper> <start>"), error_);
+                return false;
+            }
+            var_index_[name] = (Index) model_.var_names_.size();
+            model_.var_names_.push_back(name);
+            model_.var_lower_.push_back(l);
+            model_.var_upper_.push_back(u);
+            model_.var_start_.push_back(s);
+        }
+        else if( keyword == "minimize" )
+        {
+            if( objective.line >= 0 )
+            {
+                error = (fail(number, "second objective"), error_);
+                return false;
+            }
+            objective.line = number;
+            std::getline(words, objective.text);
+        }
+        else if( keyword == "constraint" )
+        {
+            std::string lower, upper;
+            ExpressionModel::Value l, u;
+            if( !(words >> lower >> upper) || !value(lower, l) || !value(upper, u) )
+            {
+                error = (fail(number, "expected: constraint <lower> <upper> <expression>"), error_);
+                return false;
+            }
+            Function constraint = {number, ""};
+            std::getline(words, constraint.text);
+            constraints.push_back(constraint);
+            model_.con_lower_.push_back(l);
+            model_.con_upper_.push_back(u);
+        }
+        else
+        {
+            error = (fail(number, "unknown statement '" + keyword + "'"), error_);
+            return false;
+        }
+    }
+    if( objective.line < 0 )
+    {
+        error = "no objective";
+        return false;
+    }
+
+    ExpressionBuilder builder(model_);
+    builder_ = &builder;
+    bool ok = compile(objective);
+    for( size_t j = 0; ok && j < constraints.size(); j++ )
+    {
+        ok = compile(constraints[j]);
+    }
+    if( !ok )
+    {
+        error = error_;
+        model_ = ExpressionModel();
+        return false;
+    }
+    builder.finish();
+    return true;
+}
+
+ExpressionBuilder::ExpressionBuilder(ExpressionModel &model) : model_(model) {
+    model_.tape_.clear();
+    model_.constants_.clear();
+    model_.segment_start_.assign(1, 0);
+}
+
+bool ExpressionBuilder::is_constant(Index instr) const {
+    return model_.tape_[instr].op == ExpressionModel::OP_CONST;
+}
+
+Number ExpressionBuilder::constant_value(Index instr) const {
+    return model_.constants_[model_.tape_[instr].a];
+}
+
+Index ExpressionBuilder::constant_slot(Number number) {
+    std::map<Number, Index>::const_iterator it = constant_index_.find(number);
+    if( it != constant_index_.end() )
+    {
+        return it->second;
+    }
+    const Index index = (Index) model_.constants_.size();
+    model_.constants_.push_back(number);
+    constant_index_[number] = index;
+    return index;
+}
+
+Index ExpressionBuilder::constant(Number number) {
+    return emit(ExpressionModel::OP_CONST, constant_slot(number));
+}
+
+Index ExpressionBuilder::emit(Index op, Index a, Index b) {
+    // fold operations on constants
+    const bool binary = op == ExpressionModel::OP_ADD || op == ExpressionModel::OP_SUB || op == ExpressionModel::OP_MUL
+                        || op == ExpressionModel::OP_DIV;
+    const bool unary = op >= ExpressionModel::OP_NEG;
+    if( (binary && is_constant(a) && is_constant(b)) || (unary && is_constant(a)) )
+    {
+        const Number x = constant_value(a), y = binary ? constant_value(b) : 0.;
+        switch( op )
+        {
+            case ExpressionModel::OP_ADD:
+                return constant(x + y);
+            case ExpressionModel::OP_SUB:
+                return constant(x - y);
+            case ExpressionModel::OP_MUL:
+                return constant(x * y);
+            case ExpressionModel::OP_DIV:
+                return constant(x / y);
+            case ExpressionModel::OP_NEG:
+                return constant(-x);
+            case ExpressionModel::OP_SQR:
+                return constant(x * x);
+            case ExpressionModel::OP_POW:
+                return constant(std::pow(x, model_.constants_[b]));
+            case ExpressionModel::OP_SQRT:
+                return constant(std::sqrt(x));
+            case ExpressionModel::OP_EXP:
+                return constant(std::exp(x));
+            case ExpressionModel::OP_LOG:
+                return constant(std::log(x));
+            case ExpressionModel::OP_SIN:
+                return constant(std::sin(x));
+            case ExpressionModel::OP_COS:
+                return constant(std::cos(x));
+        }
+    }
+
+    // x + 0, x - 0, x * 1 and x / 1, as the .nl linear parts produce them
+    if( (op == ExpressionModel::OP_ADD || op == ExpressionModel::OP_SUB) && is_constant(b) && constant_value(b) == 0. )
+    {
+        return a;
+    }
+    if( op == ExpressionModel::OP_ADD && is_constant(a) && constant_value(a) == 0. )
+    {
+        return b;
+    }
+    if( (op == ExpressionModel::OP_MUL || op == ExpressionModel::OP_DIV) && is_constant(b) && constant_value(b) == 1. )
+    {
+        return a;
+    }
+    if( op == ExpressionModel::OP_MUL && is_constant(a) && constant_value(a) == 1. )
+    {
+        return b;
+    }
+
+    const std::tuple<Index, Index, Index> key(op, a, b);
+    std::map<std::tuple<Index, Index, Index>, Index>::const_iterator it = cse_.find(key);
+    if( it != cse_.end() )
+    {
+        return it->second;
+    }
+    ExpressionModel::Instruction instr = {op, a, b};
+    model_.tape_.push_back(instr);
+    const Index index = (Index) model_.tape_.size() - 1;
+    cse_[key] = index;
+    return index;
+}
+
+Index ExpressionBuilder::power(Index base, Number exponent) {
+    if( exponent == 1. )
+    {
+        return base;
+    }
+    if( exponent == 2. )
+    {
+        return emit(ExpressionModel::OP_SQR, base);
+    }
+    if( exponent == 0.5 )
+    {
+        return emit(ExpressionModel::OP_SQRT, base);
+    }
+    return emit(ExpressionModel::OP_POW, base, constant_slot(exponent));
+}
+
+void ExpressionBuilder::end_function(Index result) {
+    if( result != (Index) model_.tape_.size() - 1 || model_.tape_[result].op < ExpressionModel::OP_ADD )
+    {
+        // the value must be the last instruction of the segment and an operation, which a bare variable or constant
+        // or a subexpression computed earlier is not
+        ExpressionModel::Instruction copy = {ExpressionModel::OP_ADD, result, constant(0.)};
+        model_.tape_.push_back(copy);
+    }
+    order_segment(model_.segment_start_.back());
+    model_.segment_start_.push_back((Index) model_.tape_.size());
+    cse_.clear();
+}
+
+void ExpressionBuilder::finish() {
+    assert(model_.num_constraints() == (Index) model_.con_lower_.size());
+    model_.analyze();
+}
+
+void ExpressionBuilder::order_segment(Index begin) {
+    std::vector<ExpressionModel::Instruction> &tape = model_.tape_;
+    const Index end = (Index) tape.size();
+    // instructions the value depends on; folding leaves others behind, e.g. the exponent of x^2
+    std::vector<char> live(end - begin, 0);
+    live[end - 1 - begin] = 1;
+    for( Index i = end - 1; i >= begin; i-- )
+    {
+        if( live[i - begin] && tape[i].op >= ExpressionModel::OP_ADD )
+        {
+            live[tape[i].a - begin] = 1;
+            if( tape[i].op <= ExpressionModel::OP_DIV )
+            {
+                live[tape[i].b - begin] = 1;
+            }
+        }
+    }
+    std::vector<Index> order, vars;
+    for( Index i = begin; i < end; i++ )
+    {
+        if( !live[i - begin] )
+        {
+            continue;
+        }
+        if( tape[i].op == ExpressionModel::OP_CONST || tape[i].op == ExpressionModel::OP_PARAM )
+        {
+            order.push_back(i);
+        }
+        else if( tape[i].op == ExpressionModel::OP_VAR )
+        {
+            vars.push_back(i);
+        }
+    }
+    std::sort(vars.begin(), vars.end(), [&tape](Index a, Index b) { return tape[a].a < tape[b].a; });
+    order.insert(order.end(), vars.begin(), vars.end());
+    for( Index i = begin; i < end; i++ )
+    {
+        if( live[i - begin] && tape[i].op >= ExpressionModel::OP_ADD )
+        {
+            order.push_back(i);
+        }
+    }
+
+    // operations keep their order, so the operands still come first
+    const Index length = (Index) order.size();
+    std::vector<Index> position(end - begin);
+    for( Index p = 0; p < length; p++ )
+    {
+        position[order[p] - begin] = begin + p;
+    }
+    std::vector<ExpressionModel::Instruction> segment(length);
+    for( Index p = 0; p < length; p++ )
+    {
+        ExpressionModel::Instruction in = tape[order[p]];
+        if( in.op >= ExpressionModel::OP_ADD )
+        {
+            in.a = position[in.a - begin];
+        }
+        if( in.op == ExpressionModel::OP_ADD || in.op == ExpressionModel::OP_SUB || in.op == ExpressionModel::OP_MUL
+            || in.op == ExpressionModel::OP_DIV )
+        {
+            in.b = position[in.b - begin];
+        }
+        segment[p] = in;
+    }
+    tape.resize(begin);
+    tape.insert(tape.end(), segment.begin(), segment.end());
+}
+
+Index ExpressionModel::add_variable(const std::string &name, Number lower, Number upper, Number start) {
+    const Value l = {lower, -1}, u = {upper, -1}, s = {start, -1};
+    var_names_.push_back(name);
+    var_lower_.push_back(l);
+    var_upper_.push_back(u);
+    var_start_.push_back(s);
+    return num_variables() - 1;
+}
+
+void ExpressionModel::add_constraint(Number lower, Number upper) {
+    const Value l = {lower, -1}, u = {upper, -1};
+    con_lower_.push_back(l);
+    con_upper_.push_back(u);
+}
+
+ExpressionModel::ExpressionModel() : segment_start_(1, 0), max_segment_(0), nnz_jac_(0), hessian_scratch_(0) {
+}
+
+bool ExpressionModel::parse(const std::string &text, std::string &error) {
+    ExpressionParser parser(*this);
+    return parser.parse(text, error);
+}
+
+bool ExpressionModel::load(const std::string &path, std::string &error) {
+    std::ifstream file(path.c_str());
+    if( !file )
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    return parse(text.str(), error);
+}
+
+Index ExpressionModel::parameter_index(const std::string &name) const {
+    std::vector<std::string>::const_iterator it = std::find(param_names_.begin(), param_names_.end(), name);
+    return it == param_names_.end() ? -1 : (Index) (it - param_names_.begin());
+}
+
+void ExpressionModel::bounds(Number *x_l, Number *x_u, Number *g_l, Number *g_u) const {
+    for( Index i = 0; i < num_variables(); i++ )
+    {
+        x_l[i] = var_lower_[i].param >= 0 ? params_[var_lower_[i].param] : var_lower_[i].number;
+        x_u[i] = var_upper_[i].param >= 0 ? params_[var_upper_[i].param] : var_upper_[i].number;
+    }
+    for( Index j = 0; j < num_constraints(); j++ )
+    {
+        g_l[j] = con_lower_[j].param >= 0 ? params_[con_lower_[j].param] : con_lower_[j].number;
+        g_u[j] = con_upper_[j].param >= 0 ? params_[con_upper_[j].param] : con_upper_[j].number;
+    }
+}
+
+void ExpressionModel::starting_point(Number *x) const {
+    for( Index i = 0; i < num_variables(); i++ )
+    {
+        x[i] = var_start_[i].param >= 0 ? params_[var_start_[i].param] : var_start_[i].number;
+    }
+}
+
+template<class T>
+void ExpressionModel::forward_segment(Index k, const T *x, T *v) const {
+    using std::cos;
+    using std::exp;
+    using std::log;
+    using std::pow;
+    using std::sin;
+    using std::sqrt;
+    const Index end = segment_start_[k + 1];
+    Index i = segment_start_[k];
+    for( ; i < var_begin_[k]; i++ )
+    {
+        v[i] = T(tape_[i].op == OP_CONST ? constants_[tape_[i].a] : params_[tape_[i].a]);
+    }
+    for( ; i < op_begin_[k]; i++ )
+    {
+        v[i] = x[tape_[i].a];
+    }
+    for( ; i < end; i++ )
+    {
+        const Instruction &in = tape_[i];
+        switch( in.op )
+        {
+            case OP_ADD:
+                v[i] = v[in.a] + v[in.b];
+                break;
+            case OP_SUB:
+                v[i] = v[in.a] - v[in.b];
+                break;
+            case OP_MUL:
+                v[i] = v[in.a] * v[in.b];
+                break;
+            case OP_DIV:
+                v[i] = v[in.a] / v[in.b];
+                break;
+            case OP_NEG:
+                v[i] = -v[in.a];
+                break;
+            case OP_SQR:
+                v[i] = v[in.a] * v[in.a];
+                break;
+            case OP_POW:
+                v[i] = pow(v[in.a], constants_[in.b]);
+                break;
+            case OP_SQRT:
+                v[i] = sqrt(v[in.a]);
+                break;
+            case OP_EXP:
+                v[i] = exp(v[in.a]);
+                break;
+            case OP_LOG:
+                v[i] = log(v[in.a]);
+                break;
+            case OP_SIN:
+                v[i] = sin(v[in.a]);
+                break;
+            case OP_COS:
+                v[i] = cos(v[in.a]);
+                break;
+        }
+    }
+}
+
+void ExpressionModel::forward(const Number *x, Number *values) const {
+    for( Index k = 0; k < num_functions(); k++ )
+    {
+        forward_segment(k, x, values);
+    }
+}
+
+void ExpressionModel::analyze() {
+    const Index n = num_variables();
+    const Index num_f = num_functions();
+    vars_.assign(num_f, std::vector<Index>());
+    var_begin_.assign(num_f, 0);
+    op_begin_.assign(num_f, 0);
+    max_segment_ = 0;
+    nnz_jac_ = 0;
+    std::vector<std::vector<std::pair<Index, Index> > > pairs(num_f);
+    std::vector<std::pair<Index, Index> > all_pairs;
+
+    std::vector<Number> x0(n);
+    starting_point(x0.data());
+    DependencyRecorder recorder;
+    std::vector<DependencyScalar> x(n), v(tape_.size());
+    for( Index i = 0; i < n; i++ )
+    {
+        x[i] = DependencyScalar(x0[i], i, &recorder);
+    }
+    for( Index k = 0; k < num_f; k++ )
+    {
+        max_segment_ = std::max(max_segment_, segment_end(k) - segment_begin(k));
+        Index i = segment_begin(k);
+        while( i < segment_end(k) && tape_[i].op != OP_VAR && tape_[i].op < OP_ADD )
+        {
+            i++;
+        }
+        var_begin_[k] = i;
+        for( ; i < segment_end(k) && tape_[i].op == OP_VAR; i++ )
+        {
+            vars_[k].push_back(tape_[i].a);
+        }
+        op_begin_[k] = i;
+        if( k > 0 )
+        {
+            nnz_jac_ += (Index) vars_[k].size();
+        }
+
+        recorder.pairs.clear();
+        forward_segment(k, x.data(), v.data());
+        pairs[k] = recorder.pairs;
+        std::sort(pairs[k].begin(), pairs[k].end());
+        pairs[k].erase(std::unique(pairs[k].begin(), pairs[k].end()), pairs[k].end());
+        all_pairs.insert(all_pairs.end(), pairs[k].begin(), pairs[k].end());
+    }
+    std::sort(all_pairs.begin(), all_pairs.end());
+    all_pairs.erase(std::unique(all_pairs.begin(), all_pairs.end()), all_pairs.end());
+    h_rows_.resize(all_pairs.size());
+    h_cols_.resize(all_pairs.size());
+    for( size_t s = 0; s < all_pairs.size(); s++ )
+    {
+        h_rows_[s] = all_pairs[s].first;
+        h_cols_[s] = all_pairs[s].second;
+    }
+
+    // the Hessian columns of every function, colored in its own variables; a direction per color
+    num_directions_.assign(num_f, 0);
+    var_direction_.assign(tape_.size(), -1);
+    read_start_.assign(1, 0);
+    reads_.clear();
+    hessian_scratch_ = 0;
+    for( Index k = 0; k < num_f; k++ )
+    {
+        const std::vector<Index> &vars = vars_[k];
+        std::vector<Index> rows, cols, color;
+        for( size_t s = 0; s < pairs[k].size(); s++ )
+        {
+            const Index r = (Index) (std::lower_bound(vars.begin(), vars.end(), pairs[k][s].first) - vars.begin());
+            const Index c = (Index) (std::lower_bound(vars.begin(), vars.end(), pairs[k][s].second) - vars.begin());
+            rows.push_back(r);
+            cols.push_back(c);
+            if( r != c )
+            {
+                rows.push_back(c);
+                cols.push_back(r);
+            }
+        }
+        num_directions_[k] = color_columns((Index) vars.size(), (Index) vars.size(), rows, cols, color);
+        // a column without entries (a variable entering f_k linearly) is not seeded
+        for( size_t s = 0; s < cols.size(); s++ )
+        {
+            var_direction_[var_begin_[k] + cols[s]] = color[cols[s]];
+        }
+        for( size_t s = 0; s < pairs[k].size(); s++ )
+        {
+            const Index r = (Index) (std::lower_bound(vars.begin(), vars.end(), pairs[k][s].first) - vars.begin());
+            const Index c = (Index) (std::lower_bound(vars.begin(), vars.end(), pairs[k][s].second) - vars.begin());
+            const HessianRead read = {var_begin_[k] + r, color[c],
+                                      (Index) (std::lower_bound(all_pairs.begin(), all_pairs.end(), pairs[k][s])
+                                               - all_pairs.begin())};
+            reads_.push_back(read);
+        }
+        read_start_.push_back((Index) reads_.size());
+        hessian_scratch_ = std::max(hessian_scratch_,
+                                    (segment_end(k) - segment_begin(k)) * (1 + 2 * num_directions_[k]));
+    }
+}
+
+void ExpressionModel::gradient(Index k, const Number *v, Number *adjoint, Number *grad) const {
+    const Index begin = segment_begin(k), end = segment_end(k);
+    Number *a = adjoint - begin;
+    std::fill(adjoint, adjoint + (end - begin), 0.);
+    a[end - 1] = 1.;
+    for( Index i = end - 1; i >= op_begin_[k]; i-- )
+    {
+        const Number ai = a[i];
+        if( ai == 0. )
+        {
+            continue;
+        }
+        const Instruction &in = tape_[i];
+        switch( in.op )
+        {
+            case OP_ADD:
+                a[in.a] += ai;
+                a[in.b] += ai;
+                break;
+            case OP_SUB:
+                a[in.a] += ai;
+                a[in.b] -= ai;
+                break;
+            case OP_MUL:
+                a[in.a] += ai * v[in.b];
+                a[in.b] += ai * v[in.a];
+                break;
+            case OP_DIV:
+                a[in.a] += ai / v[in.b];
+                a[in.b] -= ai * v[i] / v[in.b];
+                break;
+            case OP_NEG:
+                a[in.a] -= ai;
+                break;
+            case OP_SQR:
+                a[in.a] += 2. * ai * v[in.a];
+                break;
+            case OP_POW:
+                a[in.a] += ai * constants_[in.b] * std::pow(v[in.a], constants_[in.b] - 1.);
+                break;
+            case OP_SQRT:
+                a[in.a] += 0.5 * ai / v[i];
+                break;
+            case OP_EXP:
+                a[in.a] += ai * v[i];
+                break;
+            case OP_LOG:
+                a[in.a] += ai / v[in.a];
+                break;
+            case OP_SIN:
+                a[in.a] += ai * std::cos(v[in.a]);
+                break;
+            case OP_COS:
+                a[in.a] -= ai * std::sin(v[in.a]);
+                break;
+        }
+    }
+    // the variables are in the order of variables(k)
+    std::copy(a + var_begin_[k], a + op_begin_[k], grad);
+}
+
+void ExpressionModel::add_hessian(Index k, const Number *v, Number weight, Number *scratch, Number *h) const {
+    const Index begin = segment_begin(k), end = segment_end(k), length = end - begin, D = num_directions_[k];
+    if( D == 0 )
+    {
+        return;
+    }
+    // per instruction: the tangents (D), the adjoint and its tangents (D)
+    Number *t = scratch - (size_t) begin * D;
+    Number *a = scratch + (size_t) length * D - begin;
+    Number *at = scratch + (size_t) length * (D + 1) - (size_t) begin * D;
+
+    // forward: the tangents of every direction, seeded at the variables
+    std::fill(t + (size_t) begin * D, t + (size_t) op_begin_[k] * D, 0.);
+    for( Index i = var_begin_[k]; i < op_begin_[k]; i++ )
+    {
+        if( var_direction_[i] >= 0 )
+        {
+            t[(size_t) i * D + var_direction_[i]] = 1.;
+        }
+    }
+    for( Index i = op_begin_[k]; i < end; i++ )
+    {
+        const Instruction &in = tape_[i];
+        Number *ti = t + (size_t) i * D;
+        const Number *ta = t + (size_t) in.a * D, *tb = t + (size_t) in.b * D;
+        Number d1;
+        switch( in.op )
+        {
+            case OP_ADD:
+                for( Index d = 0; d < D; d++ )
+                {
+                    ti[d] = ta[d] + tb[d];
+                }
+                continue;
+            case OP_SUB:
+                for( Index d = 0; d < D; d++ )
+                {
+                    ti[d] = ta[d] - tb[d];
+                }
+                continue;
+            case OP_MUL:
+                for( Index d = 0; d < D; d++ )
+                {
+                    ti[d] = ta[d] * v[in.b] + v[in.a] * tb[d];
+                }
+                continue;
+            case OP_DIV:
+                for( Index d = 0; d < D; d++ )
+                {
+                    ti[d] = (ta[d] - v[i] * tb[d]) / v[in.b];
+                }
+                continue;
+            case OP_NEG:
+                d1 = -1.;
+                break;
+            case OP_SQR:
+                d1 = 2. * v[in.a];
+                break;
+            case OP_POW:
+                d1 = constants_[in.b] * std::pow(v[in.a], constants_[in.b] - 1.);
+                break;
+            case OP_SQRT:
+                d1 = 0.5 / v[i];
+                break;
+            case OP_EXP:
+                d1 = v[i];
+                break;
+            case OP_LOG:
+                d1 = 1. / v[in.a];
+                break;
+            case OP_SIN:
+                d1 = std::cos(v[in.a]);
+                break;
+            case OP_COS:
+                d1 = -std::sin(v[in.a]);
+                break;
+            default:
+                d1 = 0.;
+        }
+        for( Index d = 0; d < D; d++ )
+        {
+            ti[d] = d1 * ta[d];
+        }
+    }
+
+    // reverse: the adjoints and their tangents
+    std::fill(scratch + (size_t) length * D, scratch + (size_t) length * (2 * D + 1), 0.);
+    a[end - 1] = 1.;
+    for( Index i = end - 1; i >= op_begin_[k]; i-- )
+    {
+        const Instruction &in = tape_[i];
+        const Number ai = a[i];
+        const Number *ati = at + (size_t) i * D, *ti = t + (size_t) i * D;
+        Number *ata = at + (size_t) in.a * D, *atb = at + (size_t) in.b * D;
+        const Number *ta = t + (size_t) in.a * D, *tb = t + (size_t) in.b * D;
+        // first and second derivative of a unary operation
+        Number d1, d2;
+        switch( in.op )
+        {
+            case OP_ADD:
+                a[in.a] += ai;
+                a[in.b] += ai;
+                for( Index d = 0; d < D; d++ )
+                {
+                    ata[d] += ati[d];
+                    atb[d] += ati[d];
+                }
+                continue;
+            case OP_SUB:
+                a[in.a] += ai;
+                a[in.b] -= ai;
+                for( Index d = 0; d < D; d++ )
+                {
+                    ata[d] += ati[d];
+                    atb[d] -= ati[d];
+                }
+                continue;
+            case OP_MUL:
+                a[in.a] += ai * v[in.b];
+                a[in.b] += ai * v[in.a];
+                for( Index d = 0; d < D; d++ )
+                {
+                    ata[d] += ati[d] * v[in.b] + ai * tb[d];
+                    atb[d] += ati[d] * v[in.a] + ai * ta[d];
+                }
+                continue;
+            case OP_DIV:
+            {
+                // d/da = 1 / b, d/db = -c / b
+                const Number inv = 1. / v[in.b], db = -v[i] * inv;
+                a[in.a] += ai * inv;
+                a[in.b] += ai * db;
+                for( Index d = 0; d < D; d++ )
+                {
+                    ata[d] += ati[d] * inv - ai * tb[d] * inv * inv;
+                    atb[d] += ati[d] * db - ai * (ti[d] - v[i] * tb[d] * inv) * inv;
+                }
+                continue;
+            }
+            case OP_NEG:
+                d1 = -1.;
+                d2 = 0.;
+                break;
+            case OP_SQR:
+                d1 = 2. * v[in.a];
+                d2 = 2.;
+                break;
+            case OP_POW:
+            {
+                const Number p = constants_[in.b];
+                d1 = p * std::pow(v[in.a], p - 1.);
+                d2 = p * (p - 1.) * std::pow(v[in.a], p - 2.);
+                break;
+            }
+            case OP_SQRT:
+                d1 = 0.5 / v[i];
+                d2 = -0.25 / (v[i] * v[in.a]);
+                break;
+            case OP_EXP:
+                d1 = d2 = v[i];
+                break;
+            case OP_LOG:
+                d1 = 1. / v[in.a];
+                d2 = -d1 * d1;
+                break;
+            case OP_SIN:
+                d1 = std::cos(v[in.a]);
+                d2 = -v[i];
+                break;
+            case OP_COS:
+                d1 = -std::sin(v[in.a]);
+                d2 = -v[i];
+                break;
+            default:
+                d1 = d2 = 0.;
+        }
+        a[in.a] += ai * d1;
+        const Number ai_d2 = ai * d2;
+        for( Index d = 0; d < D; d++ )
+        {
+            ata[d] += ati[d] * d1 + ai_d2 * ta[d];
+        }
+    }
+
+    for( Index r = read_start_[k]; r < read_start_[k + 1]; r++ )
+    {
+        h[reads_[r].slot] += weight * at[(size_t) reads_[r].instr * D + reads_[r].direction];
+    }
+}
@@ -0,0 +1,194 @@
+//
+// Optimization models given as text at runtime and compiled to a bytecode tape. Model text has one statement per
+// line, '#' starts a comment:
+//     param <name> <value>
+//     var <name> <lower> <upper> <start>
+//     minimize <expression>
+//     constraint <lower> <upper> <expression>
+// Bounds and starts are numbers, parameter names, -inf or inf. Expressions use + - * /, ^ with a constant exponent,
+// parentheses, sqrt, exp, log, sin and cos of numbers, variables and parameters declared further up. See hs071.model.
+// Other front ends build models with ExpressionBuilder.
+//
+// The objective and every constraint are compiled into their own contiguous segment of the tape, with common
+// subexpressions shared and constant operations folded. An instruction is three Indexes: the opcode and two operands,
+// which are earlier instructions of the segment or the index of a constant, variable or parameter. A segment starts
+// with its leaves, the constants and parameters and then the variables in ascending order, so that they are loaded
+// without dispatch and the adjoints of the variables are the gradient as they stand; the operations follow. forward
+// evaluates every instruction in one pass; the derivatives of a function are sweeps over its segment only:
+//  - gradient, one reverse sweep,
+//  - add_hessian, one forward sweep of tangents and one reverse sweep of the adjoints and their tangents (forward over
+//    reverse), both vectors with an element per direction. A direction seeds a group of Hessian columns without a
+//    common row (colored by color_columns), so every entry is read off the adjoint tangent of its row.
+// The Hessian pattern of every function is found by running the segment on DependencyScalar.
+//
+
+#ifndef __EXPRESSION_MODEL_HPP
+#define __EXPRESSION_MODEL_HPP
+
+#include "IpTypes.hpp"
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace Ipopt;
+
+class ExpressionModel {
+
+public:
+    enum Op {
+        OP_CONST, OP_VAR, OP_PARAM, OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_NEG, OP_SQR, OP_POW, OP_SQRT, OP_EXP, OP_LOG,
+        OP_SIN, OP_COS
+    };
+
+    struct Instruction {
+        Index op;
+        Index a;    // first operand; constant, variable or parameter index for OP_CONST, OP_VAR, OP_PARAM
+        Index b;    // second operand; constant index of the exponent for OP_POW
+    };
+
+    // a Hessian entry of a function: the variable instruction of its row, the direction of its column and the
+    // position in h
+    struct HessianRead {
+        Index instr;
+        Index direction;
+        Index slot;
+    };
+
+    ExpressionModel();
+
+    // Replaces the model by the one in text (or in the file at path); returns false with the line and reason in error
+    // if it is malformed.
+    bool parse(const std::string &text, std::string &error);
+    bool load(const std::string &path, std::string &error);
+
+    // declarations for other front ends, which then add the functions with an ExpressionBuilder
+    Index add_variable(const std::string &name, Number lower, Number upper, Number start);
+    void add_constraint(Number lower, Number upper);
+
+    Index num_variables() const { return (Index) var_names_.size(); }
+    Index num_constraints() const { return num_functions() - 1; }
+    Index num_parameters() const { return (Index) params_.size(); }
+    // functions are numbered 0 for the objective and 1 + j for constraint j
+    Index num_functions() const { return (Index) segment_start_.size() - 1; }
+
+    const std::string &variable_name(Index i) const { return var_names_[i]; }
+    const std::string &parameter_name(Index p) const { return param_names_[p]; }
+    // -1 if there is no such parameter
+    Index parameter_index(const std::string &name) const;
+    Number parameter(Index p) const { return params_[p]; }
+    const std::vector<Number> &parameters() const { return params_; }
+    void set_parameter(Index p, Number value) { params_[p] = value; }
+
+    void bounds(Number *x_l, Number *x_u, Number *g_l, Number *g_u) const;
+    void starting_point(Number *x) const;
+
+    // the tape, function k occupying [segment_begin(k), segment_end(k)) with its value in the last instruction
+    const std::vector<Instruction> &tape() const { return tape_; }
+    const std::vector<Number> &constants() const { return constants_; }
+    Index segment_begin(Index k) const { return segment_start_[k]; }
+    Index segment_end(Index k) const { return segment_start_[k + 1]; }
+    Index max_segment_length() const { return max_segment_; }
+    // the variables of function k are [variable_begin(k), operation_begin(k)), its operations from there on
+    Index variable_begin(Index k) const { return var_begin_[k]; }
+    Index operation_begin(Index k) const { return op_begin_[k]; }
+
+    // variables function k depends on, ascending: the gradient pattern of f and the Jacobian row of a constraint
+    const std::vector<Index> &variables(Index k) const { return vars_[k]; }
+    Index jacobian_nonzeros() const { return nnz_jac_; }
+    // lower triangle of the Hessian of the Lagrangian, sorted by row, then column
+    const std::vector<Index> &hessian_rows() const { return h_rows_; }
+    const std::vector<Index> &hessian_cols() const { return h_cols_; }
+
+    // values of all instructions at x
+    void forward(const Number *x, Number *values) const;
+    // grad[s] = d f_k / d x_i for i = variables(k)[s], from the forward values; adjoint holds max_segment_length()
+    void gradient(Index k, const Number *values, Number *adjoint, Number *grad) const;
+    // adds weight times the Hessian of f_k to h, laid out as hessian_rows / hessian_cols; scratch holds
+    // hessian_scratch_size()
+    void add_hessian(Index k, const Number *values, Number weight, Number *scratch, Number *h) const;
+    Index hessian_scratch_size() const { return hessian_scratch_; }
+    // directions of the Hessian sweeps of function k, the direction a variable instruction seeds (-1 for none) and the
+    // entries of function k: hessian_reads()[hessian_read_begin(k) .. hessian_read_end(k))
+    Index hessian_directions(Index k) const { return num_directions_[k]; }
+    Index hessian_seed(Index instr) const { return var_direction_[instr]; }
+    const std::vector<HessianRead> &hessian_reads() const { return reads_; }
+    Index hessian_read_begin(Index k) const { return read_start_[k]; }
+    Index hessian_read_end(Index k) const { return read_start_[k + 1]; }
+
+private:
+    // a bound or start: a number or a parameter
+    struct Value {
+        Number number;
+        Index param;
+    };
+
+    template<class T>
+    void forward_segment(Index k, const T *x, T *values) const;
+    // derives the patterns and sweeps from the compiled tape
+    void analyze();
+
+    std::vector<std::string> var_names_;
+    std::vector<Value> var_lower_, var_upper_, var_start_;
+    std::vector<std::string> param_names_;
+    std::vector<Number> params_;
+    std::vector<Value> con_lower_, con_upper_;
+
+    std::vector<Instruction> tape_;
+    std::vector<Number> constants_;
+    std::vector<Index> segment_start_;
+    Index max_segment_;
+
+    // per function, its first variable and its first operation instruction
+    std::vector<Index> var_begin_, op_begin_;
+    std::vector<std::vector<Index> > vars_;
+    Index nnz_jac_;
+    std::vector<Index> h_rows_, h_cols_;
+    std::vector<Index> num_directions_;
+    std::vector<Index> var_direction_;     // per variable instruction, the direction it seeds or -1
+    std::vector<Index> read_start_;        // entries of function k: reads_[read_start_[k] .. read_start_[k + 1])
+    std::vector<HessianRead> reads_;
+    Index hessian_scratch_;
+
+    friend class ExpressionParser;
+    friend class ExpressionBuilder;
+
+};
+
+// Appends the functions of a model to its tape, the objective first and then the constraints in order, with common
+// subexpressions shared within a function and operations on constants folded. A front end declares the variables,
+// parameters and constraint bounds on the model, then builds every function from leaves up and ends it.
+class ExpressionBuilder {
+
+public:
+    // removes the functions of model, keeping its declarations
+    explicit ExpressionBuilder(ExpressionModel &model);
+
+    // instructions of the current function
+    Index constant(Number number);
+    Index variable(Index i) { return emit(ExpressionModel::OP_VAR, i); }
+    Index parameter(Index p) { return emit(ExpressionModel::OP_PARAM, p); }
+    // an operation on earlier instructions of the function, except OP_POW, see power
+    Index emit(Index op, Index a, Index b = 0);
+    Index power(Index base, Number exponent);
+    bool is_constant(Index instr) const;
+    Number constant_value(Index instr) const;
+
+    // ends the current function with its value in instruction result
+    void end_function(Index result);
+    // derives the patterns and sweeps once every function is added
+    void finish();
+
+private:
+    Index constant_slot(Number number);
+    // drops the dead instructions of the function and moves its leaves to the front, see ExpressionModel
+    void order_segment(Index begin);
+
+    ExpressionModel &model_;
+    std::map<Number, Index> constant_index_;
+    std::map<std::tuple<Index, Index, Index>, Index> cse_;    // instructions of the current function
+
+};
+
+#endif //__EXPRESSION_MODEL_HPP
@@ -0,0 +1,180 @@
+//
+// TNLP for an ExpressionModel, see expression_nlp.hpp
+//
+
+#include "expression_nlp.hpp"
+
+#include "IpIpoptData.hpp"
+
+#include <algorithm>
+
+ExpressionNLP::ExpressionNLP(const ExpressionModel &model)
+        : model_(model), verbose_(true), values_(model.tape().size()), valid_(false),
+          scratch_(std::max(model.max_segment_length(), model.hessian_scratch_size())), grad_(model.num_variables()) {
+}
+
+void ExpressionNLP::update(const Number *x, bool new_x) {
+    if( new_x || !valid_ )
+    {
+        model_.forward(x, values_.data());
+        valid_ = true;
+    }
+}
+
+bool ExpressionNLP::get_nlp_info(Index &n, Index &m, Index &nnz_jac_g, Index &nnz_h_lag, IndexStyleEnum &index_style) {
+    n = model_.num_variables();
+    m = model_.num_constraints();
+    nnz_jac_g = model_.jacobian_nonzeros();
+    nnz_h_lag = (Index) model_.hessian_rows().size();
+    index_style = TNLP::C_STYLE;
+    return true;
+}
+
+bool ExpressionNLP::get_bounds_info(Index n, Number *x_l, Number *x_u, Index m, Number *g_l, Number *g_u) {
+    assert(n == model_.num_variables());
+    assert(m == model_.num_constraints());
+    model_.bounds(x_l, x_u, g_l, g_u);
+    return true;
+}
+
+bool ExpressionNLP::get_starting_point(Index n, bool init_x, Number *x, bool init_z, Number *z_L, Number *z_U, Index m,
+                                       bool init_lambda, Number *lambda) {
+    assert(init_x);
+    assert(!init_z);
+    assert(!init_lambda);
+    if( (Index) start_.size() == n )
+    {
+        std::copy(start_.begin(), start_.end(), x);
+    }
+    else
+    {
+        model_.starting_point(x);
+    }
+    return true;
+}
+
+bool ExpressionNLP::eval_f(Index n, const Number *x, bool new_x, Number &obj_value) {
+    if( compiled_ )
+    {
+        compiled_->eval_f(x, model_.parameters().data(), obj_value);
+        return true;
+    }
+    update(x, new_x);
+    obj_value = value(0);
+    return true;
+}
+
+bool ExpressionNLP::eval_grad_f(Index n, const Number *x, bool new_x, Number *grad_f) {
+    if( compiled_ )
+    {
+        compiled_->eval_grad_f(x, model_.parameters().data(), grad_f);
+        return true;
+    }
+    update(x, new_x);
+    std::fill(grad_f, grad_f + n, 0.);
+    model_.gradient(0, values_.data(), scratch_.data(), grad_.data());
+    const std::vector<Index> &vars = model_.variables(0);
+    for( size_t s = 0; s < vars.size(); s++ )
+    {
+        grad_f[vars[s]] = grad_[s];
+    }
+    return true;
+}
+
+bool ExpressionNLP::eval_g(Index n, const Number *x, bool new_x, Index m, Number *g) {
+    if( compiled_ )
+    {
+        compiled_->eval_g(x, model_.parameters().data(), g);
+        return true;
+    }
+    update(x, new_x);
+    for( Index j = 0; j < m; j++ )
+    {
+        g[j] = value(1 + j);
+    }
+    return true;
+}
+
+bool ExpressionNLP::eval_jac_g(Index n, const Number *x, bool new_x, Index m, Index nele_jac, Index *iRow, Index *jCol,
+                               Number *values) {
+    assert(nele_jac == model_.jacobian_nonzeros());
+    if( values == NULL )
+    {
+        for( Index j = 0, k = 0; j < m; j++ )
+        {
+            const std::vector<Index> &vars = model_.variables(1 + j);
+            for( size_t s = 0; s < vars.size(); s++, k++ )
+            {
+                iRow[k] = j;
+                jCol[k] = vars[s];
+            }
+        }
+        return true;
+    }
+    if( compiled_ )
+    {
+        compiled_->eval_jac_g(x, model_.parameters().data(), values);
+        return true;
+    }
+    update(x, new_x);
+    for( Index j = 0; j < m; j++ )
+    {
+        // the gradient of a constraint is laid out like its Jacobian row
+        model_.gradient(1 + j, values_.data(), scratch_.data(), values);
+        values += model_.variables(1 + j).size();
+    }
+    return true;
+}
+
+bool ExpressionNLP::eval_h(Index n, const Number *x, bool new_x, Number obj_factor, Index m, const Number *lambda,
+                           bool new_lambda, Index nele_hess, Index *iRow, Index *jCol, Number *values) {
+    assert(nele_hess == (Index) model_.hessian_rows().size());
+    if( values == NULL )
+    {
+        std::copy(model_.hessian_rows().begin(), model_.hessian_rows().end(), iRow);
+        std::copy(model_.hessian_cols().begin(), model_.hessian_cols().end(), jCol);
+        return true;
+    }
+    if( compiled_ )
+    {
+        compiled_->eval_h(x, model_.parameters().data(), obj_factor, lambda, values);
+        return true;
+    }
+    update(x, new_x);
+    std::fill(values, values + nele_hess, 0.);
+    if( obj_factor != 0. )
+    {
+        model_.add_hessian(0, values_.data(), obj_factor, scratch_.data(), values);
+    }
+    for( Index j = 0; j < m; j++ )
+    {
+        if( lambda[j] != 0. )
+        {
+            model_.add_hessian(1 + j, values_.data(), lambda[j], scratch_.data(), values);
+        }
+    }
+    return true;
+}
+
+void ExpressionNLP::finalize_solution(SolverReturn status, Index n, const Number *x, const Number *z_L,
+                                      const Number *z_U, Index m, const Number *g, const Number *lambda,
+                                      Number obj_value, const IpoptData *ip_data, IpoptCalculatedQuantities *ip_cq) {
+    solution_.status = status;
+    solution_.obj_value = obj_value;
+    solution_.iter_count = ip_data != NULL ? ip_data->iter_count() : 0;
+    solution_.x.assign(x, x + n);
+    solution_.z_L.assign(z_L, z_L + n);
+    solution_.z_U.assign(z_U, z_U + n);
+    solution_.g.assign(g, g + m);
+    solution_.lambda.assign(lambda, lambda + m);
+    if( !verbose_ )
+    {
+        return;
+    }
+    std::cout << std::endl << "Solution of the primal variables, x" << std::endl;
+    for( Index i = 0; i < n; i++ )
+    {
+        std::cout << model_.variable_name(i) << " = " << x[i] << std::endl;
+    }
+    std::cout << std::endl << "Objective value" << std::endl << "f(x*) = " << obj_value << std::endl;
+}
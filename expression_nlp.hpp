@@ -0,0 +1,81 @@
+//
+// TNLP for an ExpressionModel, shaped like HS071_NLP: runtime parameters, a starting point, the solution of the last
+// solve. All callbacks share one forward sweep per x (Ipopt's new_x), so they are not safe to call concurrently on one
+// instance. The Jacobian is the gradient of every constraint in turn, the Hessian of the Lagrangian the weighted sum of
+// the function Hessians. With a CompiledModel set, the callbacks call its native code instead.
+//
+
+#ifndef __EXPRESSION_NLP_HPP
+#define __EXPRESSION_NLP_HPP
+
+#include "expression_model.hpp"
+#include "hs071_nlp.hpp"
+#include "model_compiler.hpp"
+
+#include "IpTNLP.hpp"
+
+#include <memory>
+#include <vector>
+
+using namespace Ipopt;
+
+class ExpressionNLP: public TNLP {
+
+public:
+    // works on its own copy of model
+    explicit ExpressionNLP(const ExpressionModel &model);
+
+    const ExpressionModel &model() const { return model_; }
+
+    // runtime parameters of the model, by index; see ExpressionModel::parameter_index for names
+    void set_parameter(Index p, Number value) { model_.set_parameter(p, value); }
+    Number get_parameter(Index p) const { return model_.parameter(p); }
+
+    // replaces the starting point of the model; an empty x restores it
+    void set_starting_point(const std::vector<Number> &x) { start_ = x; }
+
+    // native code of the model (see CompiledModel::compile) used by the callbacks; empty for the interpreter
+    void set_compiled(const std::shared_ptr<const CompiledModel> &compiled) { compiled_ = compiled; }
+
+    // whether finalize_solution writes the solution to the console
+    void set_verbose(bool verbose) { verbose_ = verbose; }
+
+    // the outcome of the last solve
+    const HS071_Solution &solution() const { return solution_; }
+
+    // methods from Ipopt::TNLP
+    bool get_nlp_info(Index &n, Index &m, Index &nnz_jac_g, Index &nnz_h_lag, IndexStyleEnum &index_style);
+    bool get_bounds_info(Index n, Number *x_l, Number *x_u, Index m, Number *g_l, Number *g_u);
+    bool get_starting_point(Index n, bool init_x, Number *x, bool init_z, Number *z_L, Number *z_U, Index m,
+                            bool init_lambda, Number *lambda);
+    bool eval_f(Index n, const Number *x, bool new_x, Number &obj_value);
+    bool eval_grad_f(Index n, const Number *x, bool new_x, Number *grad_f);
+    bool eval_g(Index n, const Number *x, bool new_x, Index m, Number *g);
+    bool eval_jac_g(Index n, const Number *x, bool new_x, Index m, Index nele_jac, Index *iRow, Index *jCol,
+                    Number *values);
+    bool eval_h(Index n, const Number *x, bool new_x, Number obj_factor, Index m, const Number *lambda, bool new_lambda,
+                Index nele_hess, Index *iRow, Index *jCol, Number *values);
+    void finalize_solution(SolverReturn status, Index n, const Number *x, const Number *z_L, const Number *z_U, Index m,
+                           const Number *g, const Number *lambda, Number obj_value, const IpoptData *ip_data,
+                           IpoptCalculatedQuantities *ip_cq);
+
+private:
+    // runs the forward sweep at x unless it is the point of the last one
+    void update(const Number *x, bool new_x);
+    // the value of function k after update
+    Number value(Index k) const { return values_[model_.segment_end(k) - 1]; }
+
+    ExpressionModel model_;
+    std::vector<Number> start_;
+    bool verbose_;
+    HS071_Solution solution_;
+
+    std::vector<Number> values_;
+    bool valid_;
+    std::vector<Number> scratch_;
+    std::vector<Number> grad_;
+    std::shared_ptr<const CompiledModel> compiled_;
+
+};
+
+#endif //__EXPRESSION_NLP_HPP
@@ -0,0 +1,442 @@
+//
+// Finite-difference derivatives with column coloring, see finite_difference_tnlp.hpp
+//
+
+#include "finite_difference_tnlp.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+// variables per gradient task
+static const Index GRADIENT_BLOCK = 64;
+
+// step of size rel relative to x (absolute below |x| = 1), rounded so that x + h is exact
+static Number step(Number x, Number rel) {
+    const Number h = rel * std::max(1., std::fabs(x));
+    return (x + h) - x;
+}
+
+Index color_columns(Index num_rows, Index num_cols, const std::vector<Index> &rows, const std::vector<Index> &cols,
+                    std::vector<Index> &color) {
+    std::vector<std::vector<Index> > row_cols(num_rows), col_rows(num_cols);
+    for( size_t k = 0; k < rows.size(); k++ )
+    {
+        row_cols[rows[k]].push_back(cols[k]);
+        col_rows[cols[k]].push_back(rows[k]);
+    }
+    std::vector<Index> order(num_cols);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&col_rows](Index a, Index b) { return col_rows[a].size() > col_rows[b].size(); });
+
+    // forbidden[c] == j: a column sharing a row with j has color c
+    color.assign(num_cols, -1);
+    std::vector<Index> forbidden(num_cols, -1);
+    Index num_colors = 0;
+    for( Index k = 0; k < num_cols; k++ )
+    {
+        const Index j = order[k];
+        for( size_t a = 0; a < col_rows[j].size(); a++ )
+        {
+            const std::vector<Index> &neighbours = row_cols[col_rows[j][a]];
+            for( size_t b = 0; b < neighbours.size(); b++ )
+            {
+                if( color[neighbours[b]] >= 0 )
+                {
+                    forbidden[color[neighbours[b]]] = j;
+                }
+            }
+        }
+        Index c = 0;
+        while( c < num_colors && forbidden[c] == j )
+        {
+            c++;
+        }
+        color[j] = c;
+        num_colors = std::max(num_colors, c + 1);
+    }
+    return num_colors;
+}
+
+FiniteDifferenceTNLP::FiniteDifferenceTNLP(const SmartPtr<TNLP> &nlp, const std::shared_ptr<WorkStealingPool> &pool)
+        : nlp_(nlp), pool_(pool), initialized_(false), n_(0), m_(0), nnz_jac_(0), nnz_h_(0),
+          index_style_(TNLP::C_STYLE), has_hessian_(false), jac_colors_(0), h_colors_(0), h_valid_(false),
+          perturbed_(false), f_evals_(0), g_evals_(0) {
+}
+
+bool FiniteDifferenceTNLP::setup() {
+    initialized_ = true;
+    if( !nlp_->get_nlp_info(n_, m_, nnz_jac_, nnz_h_, index_style_) )
+    {
+        return false;
+    }
+    const Index offset = index_style_ == TNLP::FORTRAN_STYLE ? 1 : 0;
+
+    // Jacobian: CPR coloring of the columns that have entries
+    jac_row_.resize(nnz_jac_);
+    jac_col_.resize(nnz_jac_);
+    if( !nlp_->eval_jac_g(n_, NULL, false, m_, nnz_jac_, jac_row_.data(), jac_col_.data(), NULL) )
+    {
+        return false;
+    }
+    std::vector<bool> has_entry(n_, false);
+    std::vector<std::vector<Index> > var_cons(n_);
+    for( Index k = 0; k < nnz_jac_; k++ )
+    {
+        jac_row_[k] -= offset;
+        jac_col_[k] -= offset;
+        has_entry[jac_col_[k]] = true;
+        var_cons[jac_col_[k]].push_back(jac_row_[k]);
+    }
+    std::vector<Index> color;
+    jac_colors_ = color_columns(m_, n_, jac_row_, jac_col_, color);
+    jac_color_cols_.assign(jac_colors_, std::vector<Index>());
+    jac_color_entries_.assign(jac_colors_, std::vector<Index>());
+    for( Index j = 0; j < n_; j++ )
+    {
+        if( has_entry[j] )
+        {
+            jac_color_cols_[color[j]].push_back(j);
+        }
+    }
+    for( Index k = 0; k < nnz_jac_; k++ )
+    {
+        jac_color_entries_[color[jac_col_[k]]].push_back(k);
+    }
+
+    // Hessian: distance-2 coloring, i.e. CPR coloring of the full symmetric pattern with the diagonal
+    h_row_.resize(nnz_h_);
+    h_col_.resize(nnz_h_);
+    has_hessian_ = nlp_->eval_h(n_, NULL, false, 1., m_, NULL, false, nnz_h_, h_row_.data(), h_col_.data(), NULL);
+    if( !has_hessian_ )
+    {
+        return true;
+    }
+    std::vector<Index> rows, cols;
+    has_entry.assign(n_, false);
+    for( Index k = 0; k < nnz_h_; k++ )
+    {
+        h_row_[k] -= offset;
+        h_col_[k] -= offset;
+        rows.push_back(h_row_[k]);
+        cols.push_back(h_col_[k]);
+        rows.push_back(h_col_[k]);
+        cols.push_back(h_row_[k]);
+        has_entry[h_row_[k]] = has_entry[h_col_[k]] = true;
+    }
+    for( Index i = 0; i < n_; i++ )
+    {
+        if( has_entry[i] )
+        {
+            rows.push_back(i);
+            cols.push_back(i);
+        }
+    }
+    h_colors_ = color_columns(n_, n_, rows, cols, color);
+    h_color_cols_.assign(h_colors_, std::vector<Index>());
+    for( Index j = 0; j < n_; j++ )
+    {
+        if( has_entry[j] )
+        {
+            h_color_cols_[color[j]].push_back(j);
+        }
+    }
+
+    // entry (i, j) is read at the point of row i in the color of j
+    h_color_rows_.assign(h_colors_, std::vector<Index>());
+    h_entry_color_.resize(nnz_h_);
+    h_row_slot_.assign(n_, -1);
+    h_rows_used_.clear();
+    for( Index k = 0; k < nnz_h_; k++ )
+    {
+        h_entry_color_[k] = color[h_col_[k]];
+        h_color_rows_[h_entry_color_[k]].push_back(h_row_[k]);
+        h_row_slot_[h_row_[k]] = 0;
+    }
+    for( Index i = 0; i < n_; i++ )
+    {
+        if( h_row_slot_[i] == 0 )
+        {
+            h_row_slot_[i] = (Index) h_rows_used_.size();
+            h_rows_used_.push_back(i);
+        }
+    }
+    h_point_start_.assign(1, 0);
+    for( Index c = 0; c < h_colors_; c++ )
+    {
+        std::vector<Index> &r = h_color_rows_[c];
+        std::sort(r.begin(), r.end());
+        r.erase(std::unique(r.begin(), r.end()), r.end());
+        h_point_start_.push_back(h_point_start_.back() + (Index) r.size());
+    }
+    h_entry_point_.resize(nnz_h_);
+    for( Index k = 0; k < nnz_h_; k++ )
+    {
+        const std::vector<Index> &r = h_color_rows_[h_entry_color_[k]];
+        h_entry_point_[k] = h_point_start_[h_entry_color_[k]]
+                            + (Index) (std::lower_bound(r.begin(), r.end(), h_row_[k]) - r.begin());
+    }
+
+    // the constraints of every entry
+    for( Index i = 0; i < n_; i++ )
+    {
+        std::sort(var_cons[i].begin(), var_cons[i].end());
+        var_cons[i].erase(std::unique(var_cons[i].begin(), var_cons[i].end()), var_cons[i].end());
+    }
+    h_cons_start_.assign(1, 0);
+    h_cons_.clear();
+    for( Index k = 0; k < nnz_h_; k++ )
+    {
+        const std::vector<Index> &a = var_cons[h_row_[k]], &b = var_cons[h_col_[k]];
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(h_cons_));
+        h_cons_start_.push_back((Index) h_cons_.size());
+    }
+    h_x_.resize(n_);
+    h_valid_ = false;
+    h_df_.resize(nnz_h_);
+    h_dg_.resize(h_cons_.size());
+    return true;
+}
+
+void FiniteDifferenceTNLP::run_tasks(Index count, const std::function<void(Index)> &body) {
+    for( Index t = 0; t < count; t++ )
+    {
+        if( pool_ )
+        {
+            pool_->submit([&body, t]() { body(t); });
+        }
+        else
+        {
+            body(t);
+        }
+    }
+    if( pool_ )
+    {
+        pool_->wait();
+    }
+}
+
+bool FiniteDifferenceTNLP::eval_point(const Number *x, Number &f, Number *g) {
+    f_evals_++;
+    g_evals_++;
+    return nlp_->eval_f(n_, x, true, f) && nlp_->eval_g(n_, x, true, m_, g);
+}
+
+bool FiniteDifferenceTNLP::get_nlp_info(Index &n, Index &m, Index &nnz_jac_g, Index &nnz_h_lag,
+                                        IndexStyleEnum &index_style) {
+    if( !initialized_ && !setup() )
+    {
+        return false;
+    }
+    return nlp_->get_nlp_info(n, m, nnz_jac_g, nnz_h_lag, index_style);
+}
+
+bool FiniteDifferenceTNLP::get_bounds_info(Index n, Number *x_l, Number *x_u, Index m, Number *g_l, Number *g_u) {
+    return nlp_->get_bounds_info(n, x_l, x_u, m, g_l, g_u);
+}
+
+bool FiniteDifferenceTNLP::get_starting_point(Index n, bool init_x, Number *x, bool init_z, Number *z_L, Number *z_U,
+                                              Index m, bool init_lambda, Number *lambda) {
+    return nlp_->get_starting_point(n, init_x, x, init_z, z_L, z_U, m, init_lambda, lambda);
+}
+
+bool FiniteDifferenceTNLP::eval_f(Index n, const Number *x, bool new_x, Number &obj_value) {
+    new_x = new_x || perturbed_;
+    perturbed_ = false;
+    return nlp_->eval_f(n, x, new_x, obj_value);
+}
+
+bool FiniteDifferenceTNLP::eval_g(Index n, const Number *x, bool new_x, Index m, Number *g) {
+    new_x = new_x || perturbed_;
+    perturbed_ = false;
+    return nlp_->eval_g(n, x, new_x, m, g);
+}
+
+bool FiniteDifferenceTNLP::eval_grad_f(Index n, const Number *x, bool new_x, Number *grad_f) {
+    perturbed_ = true;
+    Number f0;
+    f_evals_++;
+    if( !nlp_->eval_f(n, x, true, f0) )
+    {
+        return false;
+    }
+    const Number rel = std::sqrt(std::numeric_limits<Number>::epsilon());
+    std::atomic<bool> ok(true);
+    run_tasks((n + GRADIENT_BLOCK - 1) / GRADIENT_BLOCK, [this, n, x, grad_f, f0, rel, &ok](Index b) {
+        std::vector<Number> xp(x, x + n);
+        for( Index j = b * GRADIENT_BLOCK; j < std::min(n, (b + 1) * GRADIENT_BLOCK); j++ )
+        {
+            const Number h = step(x[j], rel);
+            Number f;
+            xp[j] = x[j] + h;
+            f_evals_++;
+            if( !nlp_->eval_f(n, xp.data(), true, f) )
+            {
+                ok = false;
+            }
+            grad_f[j] = (f - f0) / h;
+            xp[j] = x[j];
+        }
+    });
+    return ok;
+}
+
+bool FiniteDifferenceTNLP::eval_jac_g(Index n, const Number *x, bool new_x, Index m, Index nele_jac, Index *iRow,
+                                      Index *jCol, Number *values) {
+    if( values == NULL )
+    {
+        return nlp_->eval_jac_g(n, x, new_x, m, nele_jac, iRow, jCol, values);
+    }
+    perturbed_ = true;
+    std::vector<Number> g0(m);
+    g_evals_++;
+    if( !nlp_->eval_g(n, x, true, m, g0.data()) )
+    {
+        return false;
+    }
+    const Number rel = std::sqrt(std::numeric_limits<Number>::epsilon());
+    std::atomic<bool> ok(true);
+    run_tasks(jac_colors_, [this, n, x, m, values, rel, &g0, &ok](Index c) {
+        std::vector<Number> xp(x, x + n), g(m), h(n);
+        const std::vector<Index> &cols = jac_color_cols_[c];
+        for( size_t a = 0; a < cols.size(); a++ )
+        {
+            h[cols[a]] = step(x[cols[a]], rel);
+            xp[cols[a]] = x[cols[a]] + h[cols[a]];
+        }
+        g_evals_++;
+        if( !nlp_->eval_g(n, xp.data(), true, m, g.data()) )
+        {
+            ok = false;
+            return;
+        }
+        // every row sees a single column of the color
+        const std::vector<Index> &entries = jac_color_entries_[c];
+        for( size_t a = 0; a < entries.size(); a++ )
+        {
+            const Index k = entries[a];
+            values[k] = (g[jac_row_[k]] - g0[jac_row_[k]]) / h[jac_col_[k]];
+        }
+    });
+    return ok;
+}
+
+bool FiniteDifferenceTNLP::update_hessian(const Number *x) {
+    if( h_valid_ && std::equal(x, x + n_, h_x_.begin()) )
+    {
+        return true;
+    }
+    perturbed_ = true;
+    h_valid_ = false;
+    const Number rel = std::cbrt(std::numeric_limits<Number>::epsilon());
+    std::vector<Number> h(n_);
+    for( Index i = 0; i < n_; i++ )
+    {
+        h[i] = step(x[i], rel);
+    }
+
+    const Index num_rows = (Index) h_rows_used_.size();
+    const Index num_points = h_point_start_.back();
+    Number f0;
+    std::vector<Number> g0(m_);
+    std::vector<Number> f_row(num_rows), g_row((size_t) num_rows * m_);
+    std::vector<Number> f_color(h_colors_), g_color((size_t) h_colors_ * m_);
+    std::vector<Number> f_point(num_points), g_point((size_t) num_points * m_);
+    if( !eval_point(x, f0, g0.data()) )
+    {
+        return false;
+    }
+    std::atomic<bool> ok(true);
+    run_tasks(h_colors_ + num_rows, [&](Index t) {
+        std::vector<Number> xp(x, x + n_);
+        if( t >= h_colors_ )
+        {
+            // x + h_i e_i
+            const Index r = t - h_colors_, i = h_rows_used_[r];
+            xp[i] = x[i] + h[i];
+            ok = eval_point(xp.data(), f_row[r], g_row.data() + (size_t) r * m_) && ok;
+            return;
+        }
+        // x + D_c, then x + h_i e_i + D_c for every row of the color
+        const Index c = t;
+        const std::vector<Index> &cols = h_color_cols_[c], &rows = h_color_rows_[c];
+        for( size_t a = 0; a < cols.size(); a++ )
+        {
+            xp[cols[a]] = x[cols[a]] + h[cols[a]];
+        }
+        ok = eval_point(xp.data(), f_color[c], g_color.data() + (size_t) c * m_) && ok;
+        for( size_t a = 0; a < rows.size(); a++ )
+        {
+            const Index i = rows[a], p = h_point_start_[c] + (Index) a;
+            const Number saved = xp[i];
+            xp[i] = saved + h[i];
+            ok = eval_point(xp.data(), f_point[p], g_point.data() + (size_t) p * m_) && ok;
+            xp[i] = saved;
+        }
+    });
+    if( !ok )
+    {
+        return false;
+    }
+
+    for( Index k = 0; k < nnz_h_; k++ )
+    {
+        const Index i = h_row_[k], j = h_col_[k];
+        const Index c = h_entry_color_[k], p = h_entry_point_[k], r = h_row_slot_[i];
+        const Number scale = 1. / (h[i] * h[j]);
+        h_df_[k] = (f_point[p] - f_row[r] - f_color[c] + f0) * scale;
+        for( Index q = h_cons_start_[k]; q < h_cons_start_[k + 1]; q++ )
+        {
+            const Index con = h_cons_[q];
+            h_dg_[q] = (g_point[(size_t) p * m_ + con] - g_row[(size_t) r * m_ + con]
+                        - g_color[(size_t) c * m_ + con] + g0[con]) * scale;
+        }
+    }
+    std::copy(x, x + n_, h_x_.begin());
+    h_valid_ = true;
+    return true;
+}
+
+bool FiniteDifferenceTNLP::eval_h(Index n, const Number *x, bool new_x, Number obj_factor, Index m,
+                                  const Number *lambda, bool new_lambda, Index nele_hess, Index *iRow, Index *jCol,
+                                  Number *values) {
+    if( !has_hessian_ )
+    {
+        return false;
+    }
+    if( values == NULL )
+    {
+        return nlp_->eval_h(n, x, new_x, obj_factor, m, lambda, new_lambda, nele_hess, iRow, jCol, values);
+    }
+    if( !update_hessian(x) )
+    {
+        return false;
+    }
+    for( Index k = 0; k < nele_hess; k++ )
+    {
+        Number v = obj_factor * h_df_[k];
+        for( Index q = h_cons_start_[k]; q < h_cons_start_[k + 1]; q++ )
+        {
+            v += lambda[h_cons_[q]] * h_dg_[q];
+        }
+        values[k] = v;
+    }
+    return true;
+}
+
+void FiniteDifferenceTNLP::finalize_solution(SolverReturn status, Index n, const Number *x, const Number *z_L,
+                                             const Number *z_U, Index m, const Number *g, const Number *lambda,
+                                             Number obj_value, const IpoptData *ip_data,
+                                             IpoptCalculatedQuantities *ip_cq) {
+    nlp_->finalize_solution(status, n, x, z_L, z_U, m, g, lambda, obj_value, ip_data, ip_cq);
+}
+
+bool FiniteDifferenceTNLP::intermediate_callback(AlgorithmMode mode, Index iter, Number obj_value, Number inf_pr,
+                                                 Number inf_du, Number mu, Number d_norm, Number regularization_size,
+                                                 Number alpha_du, Number alpha_pr, Index ls_trials,
+                                                 const IpoptData *ip_data, IpoptCalculatedQuantities *ip_cq) {
+    return nlp_->intermediate_callback(mode, iter, obj_value, inf_pr, inf_du, mu, d_norm, regularization_size,
+                                       alpha_du, alpha_pr, ls_trials, ip_data, ip_cq);
+}
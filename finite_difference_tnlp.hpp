@@ -0,0 +1,121 @@
+//
+// Finite-difference derivatives for a TNLP that only evaluates f and g. FiniteDifferenceTNLP wraps such a problem and
+// takes the sparsity patterns, without duplicate entries, from its eval_jac_g and eval_h (called with values == NULL
+// only); the values come from function evaluations:
+//  - grad f by forward differences, one f evaluation per variable,
+//  - the Jacobian by Curtis-Powell-Reid: columns without a common row get the same color and are perturbed together,
+//    one g evaluation per color,
+//  - the Hessian of the Lagrangian by second differences of f and g, with the columns colored so that no row has
+//    nonzeros in two columns of a color (distance-2 coloring of the symmetric pattern, the diagonal included):
+//    entry (i, j) is [L(x + h_i e_i + D_c) - L(x + h_i e_i) - L(x + D_c) + L(x)] / (h_i h_j), where D_c perturbs every
+//    column of the color c of j, so each color costs one evaluation per row it touches.
+// A constraint only enters the Hessian entries whose two variables are both in its Jacobian row. The second
+// differences of f and of every constraint are kept per x, so new multipliers only recombine them.
+// The perturbations run as tasks on a WorkStealingPool, one per color group (Jacobian, Hessian) or block of variables
+// (gradient), so the wrapped eval_f and eval_g must be safe to call concurrently. Steps are not clipped to the bounds.
+//
+
+#ifndef __FINITE_DIFFERENCE_TNLP_HPP
+#define __FINITE_DIFFERENCE_TNLP_HPP
+
+#include "IpTNLP.hpp"
+#include "work_stealing_pool.hpp"
+
+#include <assert.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+using namespace Ipopt;
+
+// Greedy coloring of the columns of a sparse pattern (entries (rows[k], cols[k]), zero based) in order of decreasing
+// column count such that no two columns of a color share a row; color[j] in [0, number of colors), which is returned.
+Index color_columns(Index num_rows, Index num_cols, const std::vector<Index> &rows, const std::vector<Index> &cols,
+                    std::vector<Index> &color);
+
+class FiniteDifferenceTNLP: public TNLP {
+
+public:
+    // pool may be empty, then everything is evaluated on the calling thread
+    FiniteDifferenceTNLP(const SmartPtr<TNLP> &nlp, const std::shared_ptr<WorkStealingPool> &pool);
+
+    Index num_jacobian_colors() const { return jac_colors_; }
+    Index num_hessian_colors() const { return h_colors_; }
+    // function evaluations of the wrapped problem made for derivatives so far
+    Index num_f_evaluations() const { return f_evals_; }
+    Index num_g_evaluations() const { return g_evals_; }
+
+    // methods from Ipopt::TNLP
+    bool get_nlp_info(Index &n, Index &m, Index &nnz_jac_g, Index &nnz_h_lag, IndexStyleEnum &index_style);
+    bool get_bounds_info(Index n, Number *x_l, Number *x_u, Index m, Number *g_l, Number *g_u);
+    bool get_starting_point(Index n, bool init_x, Number *x, bool init_z, Number *z_L, Number *z_U, Index m,
+                            bool init_lambda, Number *lambda);
+    bool eval_f(Index n, const Number *x, bool new_x, Number &obj_value);
+    bool eval_grad_f(Index n, const Number *x, bool new_x, Number *grad_f);
+    bool eval_g(Index n, const Number *x, bool new_x, Index m, Number *g);
+    bool eval_jac_g(Index n, const Number *x, bool new_x, Index m, Index nele_jac, Index *iRow, Index *jCol,
+                    Number *values);
+    bool eval_h(Index n, const Number *x, bool new_x, Number obj_factor, Index m, const Number *lambda, bool new_lambda,
+                Index nele_hess, Index *iRow, Index *jCol, Number *values);
+    void finalize_solution(SolverReturn status, Index n, const Number *x, const Number *z_L, const Number *z_U, Index m,
+                           const Number *g, const Number *lambda, Number obj_value, const IpoptData *ip_data,
+                           IpoptCalculatedQuantities *ip_cq);
+    bool intermediate_callback(AlgorithmMode mode, Index iter, Number obj_value, Number inf_pr, Number inf_du, Number mu,
+                               Number d_norm, Number regularization_size, Number alpha_du, Number alpha_pr,
+                               Index ls_trials, const IpoptData *ip_data, IpoptCalculatedQuantities *ip_cq);
+
+private:
+    // reads the patterns and colors them, on the first get_nlp_info
+    bool setup();
+    // calls body(task) for task in [0, count), on the pool if there is one
+    void run_tasks(Index count, const std::function<void(Index)> &body);
+    // f and g at x, counted
+    bool eval_point(const Number *x, Number &f, Number *g);
+    // the second differences of the Hessian at x
+    bool update_hessian(const Number *x);
+
+    SmartPtr<TNLP> nlp_;
+    std::shared_ptr<WorkStealingPool> pool_;
+    bool initialized_;
+
+    Index n_, m_, nnz_jac_, nnz_h_;
+    IndexStyleEnum index_style_;
+    bool has_hessian_;
+
+    // Jacobian: pattern (zero based) and the entries of every color
+    std::vector<Index> jac_row_, jac_col_;
+    Index jac_colors_;
+    std::vector<std::vector<Index> > jac_color_cols_;
+    std::vector<std::vector<Index> > jac_color_entries_;
+
+    // Hessian: lower triangle pattern (zero based). The points are x + D_c per color c and x + h_i e_i + D_c per row i
+    // with an entry in a column of c, the latter numbered per color from h_point_start_[c] on.
+    std::vector<Index> h_row_, h_col_;
+    Index h_colors_;
+    std::vector<std::vector<Index> > h_color_cols_;
+    std::vector<std::vector<Index> > h_color_rows_;
+    std::vector<Index> h_point_start_;
+    std::vector<Index> h_entry_color_;
+    std::vector<Index> h_entry_point_;
+    std::vector<Index> h_rows_used_;                // rows with an entry, ascending; points x + h_i e_i
+    std::vector<Index> h_row_slot_;                 // per variable, its position in h_rows_used_
+    // constraints whose Jacobian row has both variables of entry k: h_cons_[h_cons_start_[k] .. h_cons_start_[k + 1])
+    std::vector<Index> h_cons_start_;
+    std::vector<Index> h_cons_;
+
+    // at h_x_: the second differences of f per entry and of the constraints per (entry, constraint), already divided
+    // by h_i h_j
+    std::vector<Number> h_x_;
+    bool h_valid_;
+    std::vector<Number> h_df_;
+    std::vector<Number> h_dg_;
+
+    // the wrapped problem was evaluated at other points since Ipopt's last call, so its new_x cannot be passed on
+    bool perturbed_;
+    std::atomic<Index> f_evals_;
+    std::atomic<Index> g_evals_;
+
+};
+
+#endif //__FINITE_DIFFERENCE_TNLP_HPP
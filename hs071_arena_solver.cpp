@@ -0,0 +1,79 @@
+//
+// Heap-free steady-state solves of HS071, see hs071_arena_solver.hpp
+//
+
+#include "hs071_arena_solver.hpp"
+
+#include <algorithm>
+#include <assert.h>
+
+HS071_ArenaSolver::HS071_ArenaSolver(const std::function<void(const SmartPtr<IpoptApplication> &)> &configure,
+                                     std::size_t arena_bytes)
+        : even_arena_(arena_bytes), odd_arena_(arena_bytes), app_(IpoptApplicationFactory()), nlp_(new HS071_NLP()),
+          solves_(0), blocked_resets_(0) {
+    app_->Options()->SetIntegerValue("print_level", 0);
+    if( configure )
+    {
+        configure(app_);
+    }
+    nlp_->set_verbose(false);
+    solution_.x.resize(4);
+    solution_.z_L.resize(4);
+    solution_.z_U.resize(4);
+    solution_.g.resize(2);
+    solution_.lambda.resize(2);
+}
+
+HS071_ArenaSolver::~HS071_ArenaSolver() {
+    // every block of the arenas is released to them here, while they are still alive
+    app_ = NULL;
+    nlp_ = NULL;
+    assert(even_arena_.live() == 0 && odd_arena_.live() == 0);
+}
+
+ApplicationReturnStatus HS071_ArenaSolver::initialize(Index warmup) {
+    ApplicationReturnStatus status = app_->Initialize();
+    if( status != Solve_Succeeded )
+    {
+        return status;
+    }
+    for( Index k = 0; k < warmup; k++ )
+    {
+        app_->OptimizeTNLP(nlp_);
+    }
+    return status;
+}
+
+std::size_t HS071_ArenaSolver::high_water() const {
+    return std::max(even_arena_.high_water(), odd_arena_.high_water());
+}
+
+ApplicationReturnStatus HS071_ArenaSolver::solve(Number g0_lower, Number g1_rhs) {
+    nlp_->set_parameter(HS071_G0_LOWER, g0_lower);
+    nlp_->set_parameter(HS071_G1_RHS, g1_rhs);
+
+    SolveArena &arena = solves_++ % 2 == 0 ? even_arena_ : odd_arena_;
+    ApplicationReturnStatus status;
+    if( arena.reset() )
+    {
+        SolveArenaScope scope(arena);
+        status = app_->OptimizeTNLP(nlp_);
+    }
+    else
+    {
+        blocked_resets_++;
+        status = app_->OptimizeTNLP(nlp_);
+    }
+
+    // same sizes as the preallocated buffers, so the copies do not allocate
+    const HS071_Solution &sol = nlp_->solution();
+    solution_.status = sol.status;
+    solution_.obj_value = sol.obj_value;
+    solution_.iter_count = sol.iter_count;
+    std::copy(sol.x.begin(), sol.x.end(), solution_.x.begin());
+    std::copy(sol.z_L.begin(), sol.z_L.end(), solution_.z_L.begin());
+    std::copy(sol.z_U.begin(), sol.z_U.end(), solution_.z_U.begin());
+    std::copy(sol.g.begin(), sol.g.end(), solution_.g.begin());
+    std::copy(sol.lambda.begin(), sol.lambda.end(), solution_.lambda.begin());
+    return status;
+}
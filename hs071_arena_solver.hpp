@@ -0,0 +1,61 @@
+//
+// Heap-free steady-state solves of HS071: the application, the TNLP, the result buffers and two solve arenas are set
+// up once, after which every solve routes the thread's operator new traffic to an arena that is reset instead of
+// freed.
+// Only effective in executables that link arena_operator_new.cpp.
+//
+
+#ifndef __HS071_ARENA_SOLVER_HPP
+#define __HS071_ARENA_SOLVER_HPP
+
+#include "IpIpoptApplication.hpp"
+#include "hs071_nlp.hpp"
+#include "solve_arena.hpp"
+
+#include <functional>
+
+using namespace Ipopt;
+
+class HS071_ArenaSolver {
+
+public:
+    // Creates the application this solver owns, with print_level 0 and then configure (may be empty) applied.
+    explicit HS071_ArenaSolver(const std::function<void(const SmartPtr<IpoptApplication> &)> &configure =
+                                       std::function<void(const SmartPtr<IpoptApplication> &)>(),
+                               std::size_t arena_bytes = 4 << 20);
+    // releases the application, and with it the objects of the last solves, before the arenas they live in
+    ~HS071_ArenaSolver();
+    HS071_ArenaSolver(const HS071_ArenaSolver &) = delete;
+    HS071_ArenaSolver &operator=(const HS071_ArenaSolver &) = delete;
+
+    // Initializes the application and runs the warmup solves, on the system heap, so that lazily created objects
+    // that outlive a solve (static tables, locale facets, ...) are not placed in an arena. Must succeed before solve.
+    ApplicationReturnStatus initialize(Index warmup = 2);
+
+    // Solves HS071 with the given parameters on this thread. The result is copied into solution(), whose
+    // buffers are reused from solve to solve.
+    ApplicationReturnStatus solve(Number g0_lower, Number g1_rhs);
+
+    const HS071_Solution &solution() const { return solution_; }
+
+    // largest arena footprint of a single solve so far
+    std::size_t high_water() const;
+    // solves that ran on the system heap because the arena still had live allocations
+    Index blocked_resets() const { return blocked_resets_; }
+
+private:
+    // Ipopt keeps the objects of a solve in the application until the next solve replaces them, so the arenas
+    // alternate: arena k % 2 is reset before solve k, when the objects of solve k - 2 have been released.
+    // The application is owned here, nobody else may keep those objects alive, and the arenas are declared first so
+    // that they are destroyed last.
+    SolveArena even_arena_;
+    SolveArena odd_arena_;
+    SmartPtr<IpoptApplication> app_;
+    SmartPtr<HS071_NLP> nlp_;
+    Index solves_;
+    Index blocked_resets_;
+    HS071_Solution solution_;
+
+};
+
+#endif //__HS071_ARENA_SOLVER_HPP
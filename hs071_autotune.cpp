@@ -0,0 +1,206 @@
+//
+// Offline option autotuner for HS071, see hs071_autotune.hpp
+//
+
+#include "hs071_autotune.hpp"
+#include "hs071_nlp.hpp"
+#include "work_stealing_pool.hpp"
+
+#include "IpIpoptApplication.hpp"
+#include "IpJournalist.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+std::vector<HS071_TuningDimension> HS071_AutotuneOptions::default_space() {
+    std::vector<HS071_TuningDimension> space;
+    space.push_back({"mu_strategy", {"adaptive", "monotone"}, "", ""});
+    space.push_back({"mu_oracle", {"quality-function", "probing", "loqo"}, "mu_strategy", "adaptive"});
+    // only MUMPS ships with every Ipopt build, add ma27, ma57, ... when they are available
+    space.push_back({"linear_solver", {"mumps"}, "", ""});
+    space.push_back({"nlp_scaling_method", {"gradient-based", "none"}, "", ""});
+    space.push_back({"hessian_approximation", {"exact", "limited-memory"}, "", ""});
+    space.push_back({"line_search_method", {"filter", "penalty"}, "", ""});
+    return space;
+}
+
+std::vector<std::pair<Number, Number> > HS071_AutotuneOptions::default_instances() {
+    std::vector<std::pair<Number, Number> > instances;
+    for( Index i = 0; i < 4; i++ )
+    {
+        for( Index j = 0; j < 4; j++ )
+        {
+            instances.push_back(std::make_pair(20.0 + 10.0 * i / 3, 30.0 + 10.0 * j));
+        }
+    }
+    return instances;
+}
+
+HS071_Autotuner::HS071_Autotuner(const HS071_AutotuneOptions &options) : options_(options) {
+    assert(options_.initial_instances > 0);
+    assert(options_.keep_fraction > 0. && options_.keep_fraction <= 1.);
+}
+
+std::vector<std::string> HS071_Autotuner::enumerate() const {
+    // cartesian product of the dimensions; a dependent dimension only varies when its condition holds
+    std::vector<std::map<std::string, std::string> > configs(1);
+    for( size_t d = 0; d < options_.space.size(); d++ )
+    {
+        const HS071_TuningDimension &dim = options_.space[d];
+        std::vector<std::map<std::string, std::string> > next;
+        for( size_t c = 0; c < configs.size(); c++ )
+        {
+            if( !dim.requires_option.empty() )
+            {
+                std::map<std::string, std::string>::const_iterator it = configs[c].find(dim.requires_option);
+                if( it == configs[c].end() || it->second != dim.requires_value )
+                {
+                    next.push_back(configs[c]);
+                    continue;
+                }
+            }
+            for( size_t v = 0; v < dim.values.size(); v++ )
+            {
+                next.push_back(configs[c]);
+                next.back()[dim.option] = dim.values[v];
+            }
+        }
+        configs.swap(next);
+    }
+    std::vector<std::string> options;
+    for( size_t c = 0; c < configs.size(); c++ )
+    {
+        std::ostringstream text;
+        for( size_t d = 0; d < options_.space.size(); d++ )
+        {
+            std::map<std::string, std::string>::const_iterator it = configs[c].find(options_.space[d].option);
+            if( it != configs[c].end() )
+            {
+                text << it->first << " " << it->second << "\n";
+            }
+        }
+        options.push_back(text.str());
+    }
+    return options;
+}
+
+void HS071_Autotuner::evaluate(std::vector<size_t> &survivors, Index first, Index last) {
+    // every (configuration, instance) pair is a task; each gets its own application since options differ
+    std::mutex mutex;
+    WorkStealingPool pool(options_.num_threads);
+    for( size_t s = 0; s < survivors.size(); s++ )
+    {
+        for( Index i = first; i < last; i++ )
+        {
+            const size_t c = survivors[s];
+            pool.submit([this, c, i, &mutex]() {
+                SmartPtr<IpoptApplication> app = IpoptApplicationFactory();
+                app->Options()->SetIntegerValue("print_level", 0);
+                app->Options()->SetNumericValue("max_wall_time", options_.max_wall_time);
+                std::istringstream base(options_.base_options), config(results_[c].options);
+                app->Options()->ReadFromStream(*app->Jnlst(), base, true);
+                app->Options()->ReadFromStream(*app->Jnlst(), config, true);
+                bool success = false;
+                Index iterations = 0;
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                if( app->Initialize() == Solve_Succeeded )
+                {
+                    SmartPtr<HS071_NLP> nlp = new HS071_NLP(options_.instances[i].first, options_.instances[i].second);
+                    nlp->set_verbose(false);
+                    start = std::chrono::steady_clock::now();
+                    ApplicationReturnStatus status = app->OptimizeTNLP(nlp);
+                    success = status == Solve_Succeeded || status == Solved_To_Acceptable_Level;
+                    iterations = nlp->solution().iter_count;
+                }
+                Number elapsed = std::chrono::duration<Number>(std::chrono::steady_clock::now() - start).count();
+
+                std::lock_guard<std::mutex> lock(mutex);
+                HS071_TunedConfig &r = results_[c];
+                r.attempted++;
+                r.solved += success ? 1 : 0;
+                r.iterations += iterations;
+                // a failure costs the whole time budget, so robust configurations rank first among equals
+                r.wall_time += success ? elapsed : options_.max_wall_time;
+            });
+        }
+    }
+    pool.wait();
+}
+
+Index HS071_Autotuner::run() {
+    std::vector<std::string> configs = enumerate();
+    results_.assign(configs.size(), HS071_TunedConfig());
+    for( size_t c = 0; c < configs.size(); c++ )
+    {
+        results_[c].options = configs[c];
+    }
+
+    const Index num_instances = (Index) options_.instances.size();
+    std::vector<size_t> survivors(configs.size());
+    for( size_t c = 0; c < survivors.size(); c++ )
+    {
+        survivors[c] = c;
+    }
+    Index seen = 0;
+    Index batch = std::min(options_.initial_instances, num_instances);
+    while( seen < num_instances )
+    {
+        evaluate(survivors, seen, seen + batch);
+        seen += batch;
+        batch = std::min(2 * batch, num_instances - seen);
+        std::stable_sort(survivors.begin(), survivors.end(), [this](size_t a, size_t b) {
+            if( results_[a].solved != results_[b].solved )
+            {
+                return results_[a].solved > results_[b].solved;
+            }
+            return results_[a].wall_time < results_[b].wall_time;
+        });
+        if( seen < num_instances )
+        {
+            // successive halving: the weaker part of the field does not see the remaining instances
+            size_t keep = std::max((size_t) 1, (size_t) std::ceil(options_.keep_fraction * survivors.size()));
+            for( size_t s = keep; s < survivors.size(); s++ )
+            {
+                results_[survivors[s]].pruned = true;
+            }
+            survivors.resize(keep);
+        }
+    }
+
+    // configurations that saw every instance first, then by the same criteria
+    std::stable_sort(results_.begin(), results_.end(), [](const HS071_TunedConfig &a, const HS071_TunedConfig &b) {
+        if( a.pruned != b.pruned )
+        {
+            return !a.pruned;
+        }
+        if( a.solved != b.solved )
+        {
+            return a.solved > b.solved;
+        }
+        return a.wall_time < b.wall_time;
+    });
+    Index robust = 0;
+    for( size_t c = 0; c < results_.size(); c++ )
+    {
+        robust += !results_[c].pruned && results_[c].solved == num_instances ? 1 : 0;
+    }
+    return robust;
+}
+
+bool HS071_Autotuner::write_options_file(const std::string &path) const {
+    if( results_.empty() )
+    {
+        return false;
+    }
+    const HS071_TunedConfig &best = results_.front();
+    std::ofstream out(path.c_str());
+    out << "# tuned on " << best.attempted << " HS071 instances: " << best.solved << " solved, " << best.iterations
+        << " iterations, " << best.wall_time << " s\n";
+    out << options_.base_options << best.options;
+    return (bool) out;
+}
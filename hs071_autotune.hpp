@@ -0,0 +1,74 @@
+//
+// Offline option autotuner for HS071: runs a representative set of parameter instances under a grid of Ipopt
+// options, prunes the weak configurations by successive halving and emits the best one as an options file.
+//
+
+#ifndef __HS071_AUTOTUNE_HPP
+#define __HS071_AUTOTUNE_HPP
+
+#include "IpTypes.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Ipopt;
+
+// one searched option with its candidate values; if requires_option is set the option is only varied in
+// configurations where requires_option has the value requires_value (e.g. mu_oracle needs mu_strategy adaptive)
+struct HS071_TuningDimension {
+    std::string option;
+    std::vector<std::string> values;
+    std::string requires_option;
+    std::string requires_value;
+};
+
+struct HS071_AutotuneOptions {
+    std::vector<HS071_TuningDimension> space = default_space();
+    // (lower bound of g0, right hand side of g1) of the representative instances
+    std::vector<std::pair<Number, Number> > instances = default_instances();
+    std::string base_options = "tol 1e-7\n";   // ipopt.opt syntax, applied before every configuration
+    Number max_wall_time = 5.0;               // per solve, slower solves count as failures
+    Index initial_instances = 2;              // instances of the first halving round, doubled every round
+    Number keep_fraction = 0.5;               // share of the configurations that survives a round
+    unsigned num_threads = 0;                 // 0: one per hardware thread
+
+    // mu strategy and oracle, linear solver, scaling, Hessian approximation and line search
+    static std::vector<HS071_TuningDimension> default_space();
+    // equality right hand sides 30..60 with the product bound 20..30
+    static std::vector<std::pair<Number, Number> > default_instances();
+};
+
+struct HS071_TunedConfig {
+    std::string options;     // ipopt.opt syntax, without base_options
+    Index attempted = 0;
+    Index solved = 0;
+    Index iterations = 0;
+    Number wall_time = 0.;   // summed over the attempted instances, in seconds
+    bool pruned = false;     // dropped before seeing every instance
+};
+
+class HS071_Autotuner {
+
+public:
+    explicit HS071_Autotuner(const HS071_AutotuneOptions &options = HS071_AutotuneOptions());
+
+    // Runs the search; returns the number of configurations that solved every instance.
+    Index run();
+
+    // all configurations, best first: most instances solved, then least wall time
+    const std::vector<HS071_TunedConfig> &results() const { return results_; }
+
+    // writes base_options and the best configuration in ipopt.opt syntax, with its statistics as comments
+    bool write_options_file(const std::string &path) const;
+
+private:
+    std::vector<std::string> enumerate() const;
+    void evaluate(std::vector<size_t> &survivors, Index first, Index last);
+
+    HS071_AutotuneOptions options_;
+    std::vector<HS071_TunedConfig> results_;
+
+};
+
+#endif //__HS071_AUTOTUNE_HPP
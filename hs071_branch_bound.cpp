@@ -0,0 +1,189 @@
+//
+// Parallel branch-and-bound for integer-restricted HS071, see hs071_branch_bound.hpp
+//
+
+#include "hs071_branch_bound.hpp"
+#include "hs071_presolve.hpp"
+#include "work_stealing_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+HS071_BranchBound::HS071_BranchBound(const HS071_BranchBoundOptions &options)
+        : options_(options), incumbent_value_(std::numeric_limits<Number>::infinity()), nodes_started_(0),
+          stop_(false), has_incumbent_(false), nodes_solved_(0), nodes_pruned_(0), nodes_infeasible_(0),
+          nodes_failed_(0), integer_solutions_(0), total_iterations_(0), max_depth_(0), wall_time_(0.) {
+    for( size_t k = 0; k < options_.integer_vars.size(); k++ )
+    {
+        assert(options_.integer_vars[k] >= 0 && options_.integer_vars[k] < 4);
+    }
+}
+
+bool HS071_BranchBound::prune(Number bound) const {
+    const Number incumbent = incumbent_value_.load(std::memory_order_relaxed);
+    return bound >= incumbent - std::max(options_.abs_gap, options_.rel_gap * std::fabs(incumbent));
+}
+
+void HS071_BranchBound::update_incumbent(const HS071_Solution &sol) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    integer_solutions_++;
+    if( !has_incumbent_ || sol.obj_value < incumbent_.obj_value )
+    {
+        incumbent_ = sol;
+        has_incumbent_ = true;
+        incumbent_value_ = sol.obj_value;
+    }
+}
+
+void HS071_BranchBound::process(const Node &node, WorkStealingPool &pool,
+                                std::vector<SmartPtr<IpoptApplication> > &apps) {
+    if( stop_ )
+    {
+        return;
+    }
+    if( prune(node.bound) )
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        nodes_pruned_++;
+        return;
+    }
+    if( nodes_started_++ >= options_.max_nodes )
+    {
+        stop_ = true;
+        return;
+    }
+
+    SmartPtr<IpoptApplication> &app = apps[pool.worker_index()];
+    if( IsNull(app) )
+    {
+        // one application per worker thread, created on its first node
+        app = IpoptApplicationFactory();
+        app->Options()->SetIntegerValue("print_level", 0);
+        if( options_.configure )
+        {
+            options_.configure(app);
+        }
+        if( app->Initialize() != Solve_Succeeded )
+        {
+            app = NULL;
+            std::lock_guard<std::mutex> lock(mutex_);
+            nodes_failed_++;
+            return;
+        }
+    }
+
+    SmartPtr<HS071_NLP> nlp = new HS071_NLP(options_.g0_lower, options_.g1_rhs);
+    nlp->set_verbose(false);
+    for( Index i = 0; i < 4; i++ )
+    {
+        nlp->set_variable_bounds(i, node.x_l[i], node.x_u[i]);
+    }
+    const bool warm = options_.warm_start && node.parent;
+    if( warm )
+    {
+        nlp->set_warm_start(*node.parent);
+    }
+    HS071_set_warm_start_options(app, warm);
+    app->OptimizeTNLP(nlp);
+    const HS071_Solution &sol = nlp->solution();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        nodes_solved_++;
+        total_iterations_ += sol.iter_count;
+        max_depth_ = std::max(max_depth_, node.depth);
+        if( sol.status == LOCAL_INFEASIBILITY )
+        {
+            nodes_infeasible_++;
+            return;
+        }
+        if( sol.status != SUCCESS && sol.status != STOP_AT_ACCEPTABLE_POINT )
+        {
+            nodes_failed_++;
+            return;
+        }
+    }
+    if( prune(sol.obj_value) )
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        nodes_pruned_++;
+        return;
+    }
+
+    // most fractional integer variable
+    Index branch = -1;
+    Number fractionality = options_.integrality_tol;
+    for( size_t k = 0; k < options_.integer_vars.size(); k++ )
+    {
+        const Index i = options_.integer_vars[k];
+        const Number f = std::fabs(sol.x[i] - std::floor(sol.x[i] + 0.5));
+        if( f > fractionality )
+        {
+            fractionality = f;
+            branch = i;
+        }
+    }
+    if( branch < 0 )
+    {
+        update_incumbent(sol);
+        return;
+    }
+
+    Node down = node, up = node;
+    down.depth = up.depth = node.depth + 1;
+    down.bound = up.bound = sol.obj_value;
+    down.parent = up.parent = std::make_shared<const HS071_Solution>(sol);
+    down.x_u[branch] = std::floor(sol.x[branch]);
+    up.x_l[branch] = std::ceil(sol.x[branch]);
+    // the deque of this worker is LIFO, so the child submitted last (the side x is closer to) is dived into first
+    const bool down_first = sol.x[branch] - down.x_u[branch] < 0.5;
+    const Node *children[2] = {down_first ? &up : &down, down_first ? &down : &up};
+    for( Index c = 0; c < 2; c++ )
+    {
+        const Node child = *children[c];
+        if( child.x_l[branch] <= child.x_u[branch] )
+        {
+            pool.submit([this, child, &pool, &apps]() { process(child, pool, apps); });
+        }
+    }
+}
+
+bool HS071_BranchBound::run() {
+    incumbent_value_ = std::numeric_limits<Number>::infinity();
+    nodes_started_ = 0;
+    stop_ = false;
+    has_incumbent_ = false;
+    incumbent_ = HS071_Solution();
+    nodes_solved_ = nodes_pruned_ = nodes_infeasible_ = nodes_failed_ = integer_solutions_ = total_iterations_ = 0;
+    max_depth_ = 0;
+
+    // the root box comes from the problem itself, tightened by the interval presolve and rounded inwards for the
+    // integer variables
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    HS071_NLP nlp(options_.g0_lower, options_.g1_rhs);
+    Node root;
+    Number g_l[2], g_u[2];
+    nlp.get_bounds_info(4, root.x_l, root.x_u, 2, g_l, g_u);
+    bool feasible = HS071_contract_box(nlp, root.x_l, root.x_u);
+    for( size_t k = 0; k < options_.integer_vars.size(); k++ )
+    {
+        const Index i = options_.integer_vars[k];
+        root.x_l[i] = std::ceil(root.x_l[i]);
+        root.x_u[i] = std::floor(root.x_u[i]);
+        feasible = feasible && root.x_l[i] <= root.x_u[i];
+    }
+    root.depth = 0;
+    root.bound = -std::numeric_limits<Number>::infinity();
+
+    if( feasible )
+    {
+        WorkStealingPool pool(options_.num_threads);
+        std::vector<SmartPtr<IpoptApplication> > apps(pool.size());
+        pool.submit([this, root, &pool, &apps]() { process(root, pool, apps); });
+        pool.wait();
+    }
+    wall_time_ = std::chrono::duration<Number>(std::chrono::steady_clock::now() - start).count();
+    return has_incumbent_;
+}
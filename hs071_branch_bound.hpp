@@ -0,0 +1,100 @@
+//
+// Parallel nonlinear branch-and-bound for HS071 with some of x restricted to integers in [1,5]. Every node solves
+// the NLP relaxation over its box with Ipopt, warm started from the primal-dual solution of its parent, and branches
+// on the most fractional integer variable. Nodes are tasks on a work stealing pool: a worker pushes the children of
+// its node onto its own deque and takes the nearer child first, so each worker dives depth first while idle workers
+// steal the shallow nodes from the other ends. All workers prune against one shared incumbent.
+// The root box is tightened by the interval presolve before the integer bounds are rounded inwards.
+//
+// HS071 is not convex, so the relaxation solved by a local method is not a guaranteed bound and the search is a
+// heuristic in general; it is exact wherever the node relaxations are solved to global optimality.
+//
+
+#ifndef __HS071_BRANCH_BOUND_HPP
+#define __HS071_BRANCH_BOUND_HPP
+
+#include "IpIpoptApplication.hpp"
+#include "hs071_nlp.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace Ipopt;
+
+class WorkStealingPool;
+
+struct HS071_BranchBoundOptions {
+    std::vector<Index> integer_vars = {0, 1, 2, 3};
+    unsigned num_threads = 0;       // 0: one per hardware thread
+    Number integrality_tol = 1e-6;
+    Number abs_gap = 1e-6;          // nodes whose bound is within the gap of the incumbent are pruned
+    Number rel_gap = 1e-6;
+    Index max_nodes = 100000;
+    bool warm_start = true;         // warm start children from the parent's primal-dual solution
+    Number g0_lower = 25.0;         // HS071 parameters
+    Number g1_rhs = 40.0;
+    // called on every per-thread IpoptApplication before it is initialized, e.g. to set options
+    std::function<void(const SmartPtr<IpoptApplication> &)> configure;
+};
+
+class HS071_BranchBound {
+
+public:
+    explicit HS071_BranchBound(const HS071_BranchBoundOptions &options = HS071_BranchBoundOptions());
+
+    // Searches the tree and returns whether an integer feasible point was found.
+    bool run();
+
+    bool has_incumbent() const { return has_incumbent_; }
+    // best integer feasible solution of the last run
+    const HS071_Solution &incumbent() const { return incumbent_; }
+
+    Index nodes_solved() const { return nodes_solved_; }
+    Index nodes_pruned() const { return nodes_pruned_; }        // by bound, before or after their solve
+    Index nodes_infeasible() const { return nodes_infeasible_; }
+    Index nodes_failed() const { return nodes_failed_; }        // relaxation neither solved nor infeasible
+    Index integer_solutions() const { return integer_solutions_; }
+    Index total_iterations() const { return total_iterations_; }
+    Index max_depth() const { return max_depth_; }
+    bool node_limit_reached() const { return stop_; }
+    Number wall_time() const { return wall_time_; }
+    Number nodes_per_second() const { return wall_time_ > 0. ? nodes_solved_ / wall_time_ : 0.; }
+
+private:
+    struct Node {
+        Number x_l[4];
+        Number x_u[4];
+        Index depth;
+        Number bound;                                   // objective of the parent relaxation
+        std::shared_ptr<const HS071_Solution> parent;   // warm start, NULL at the root
+    };
+
+    void process(const Node &node, WorkStealingPool &pool, std::vector<SmartPtr<IpoptApplication> > &apps);
+    // whether a node with this lower bound cannot improve the incumbent
+    bool prune(Number bound) const;
+    void update_incumbent(const HS071_Solution &sol);
+
+    HS071_BranchBoundOptions options_;
+
+    std::atomic<Number> incumbent_value_;   // read without the lock for pruning
+    std::atomic<Index> nodes_started_;
+    std::atomic<bool> stop_;
+
+    std::mutex mutex_;   // guards everything below
+    bool has_incumbent_;
+    HS071_Solution incumbent_;
+    Index nodes_solved_;
+    Index nodes_pruned_;
+    Index nodes_infeasible_;
+    Index nodes_failed_;
+    Index integer_solutions_;
+    Index total_iterations_;
+    Index max_depth_;
+    Number wall_time_;
+
+};
+
+#endif //__HS071_BRANCH_BOUND_HPP
@@ -0,0 +1,147 @@
+//
+// Continuation (homotopy) driver for HS071, see hs071_continuation.hpp
+//
+
+#include "hs071_continuation.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+HS071_Continuation::HS071_Continuation(const SmartPtr<IpoptApplication> &app, const HS071_ContinuationOptions &options)
+        : app_(app), options_(options), total_iterations_(0), rejected_steps_(0) {
+    assert(options_.initial_step > 0.);
+    assert(options_.min_step > 0. && options_.min_step <= options_.max_step);
+    assert(options_.shrink_factor > 0. && options_.shrink_factor < 1.);
+    assert(options_.grow_factor >= 1.);
+}
+
+std::vector<char> HS071_Continuation::active_set(HS071_NLP &nlp, const HS071_Solution &sol, Number tol) {
+    // A bound counts as active when the solution lies within tol (relative to the size of the bound) of it.
+    // Only the inequality side of g is considered, equality constraints are always active.
+    const Index n = (Index) sol.x.size();
+    const Index m = (Index) sol.g.size();
+    std::vector<Number> x_l(n), x_u(n), g_l(m), g_u(m);
+    nlp.get_bounds_info(n, x_l.data(), x_u.data(), m, g_l.data(), g_u.data());
+
+    std::vector<char> active;
+    active.reserve(2 * n + m);
+    for( Index i = 0; i < n; i++ )
+    {
+        active.push_back(sol.x[i] - x_l[i] <= tol * std::max(1., std::fabs(x_l[i])));
+        active.push_back(x_u[i] - sol.x[i] <= tol * std::max(1., std::fabs(x_u[i])));
+    }
+    for( Index i = 0; i < m; i++ )
+    {
+        if( g_l[i] == g_u[i] )
+        {
+            active.push_back(0);
+            continue;
+        }
+        bool lower = sol.g[i] - g_l[i] <= tol * std::max(1., std::fabs(g_l[i]));
+        bool upper = g_u[i] - sol.g[i] <= tol * std::max(1., std::fabs(g_u[i]));
+        active.push_back(lower || upper);
+    }
+    return active;
+}
+
+bool HS071_Continuation::solve(const SmartPtr<HS071_NLP> &nlp) {
+    // a solve that fails before finalize_solution has no iterations of its own to count
+    nlp->clear_solution();
+    ApplicationReturnStatus status = app_->OptimizeTNLP(nlp);
+    total_iterations_ += nlp->solution().iter_count;
+    return status == Solve_Succeeded || status == Solved_To_Acceptable_Level;
+}
+
+void HS071_Continuation::predict(Number step, std::vector<Number> &x, std::vector<Number> &z_L, std::vector<Number> &z_U,
+                                 std::vector<Number> &lambda) const {
+    // start from the last accepted point and, if there are two of them, move along the secant scaled to the new step
+    const HS071_ContinuationPoint &last = path_.back();
+    x = last.solution.x;
+    z_L = last.solution.z_L;
+    z_U = last.solution.z_U;
+    lambda = last.solution.lambda;
+    if( !options_.predictor || path_.size() < 2 )
+    {
+        return;
+    }
+    const HS071_ContinuationPoint &prev = path_[path_.size() - 2];
+    const Number ratio = step / (last.parameter - prev.parameter);
+    for( size_t i = 0; i < x.size(); i++ )
+    {
+        // the predicted x has to stay inside the box [1,5] for get_starting_point
+        x[i] += ratio * (last.solution.x[i] - prev.solution.x[i]);
+        x[i] = std::min(5., std::max(1., x[i]));
+        z_L[i] = std::max(0., z_L[i] + ratio * (last.solution.z_L[i] - prev.solution.z_L[i]));
+        z_U[i] = std::max(0., z_U[i] + ratio * (last.solution.z_U[i] - prev.solution.z_U[i]));
+    }
+    for( size_t i = 0; i < lambda.size(); i++ )
+    {
+        lambda[i] += ratio * (last.solution.lambda[i] - prev.solution.lambda[i]);
+    }
+}
+
+bool HS071_Continuation::trace(Number begin, Number end) {
+    path_.clear();
+    total_iterations_ = 0;
+    rejected_steps_ = 0;
+
+    SmartPtr<HS071_NLP> nlp = new HS071_NLP();
+    nlp->set_verbose(false);
+
+    // cold solve at the start of the path
+    nlp->set_parameter(options_.parameter, begin);
+    HS071_set_warm_start_options(app_, false);
+    if( !solve(nlp) )
+    {
+        return false;
+    }
+    HS071_ContinuationPoint first = {begin, 0., false, nlp->solution()};
+    path_.push_back(first);
+    std::vector<char> active = active_set(*nlp, nlp->solution(), options_.active_tol);
+
+    const Number direction = end >= begin ? 1. : -1.;
+    Number step = std::min(options_.initial_step, options_.max_step);
+    std::vector<Number> x, z_L, z_U, lambda;
+    bool reached = true;
+
+    HS071_set_warm_start_options(app_, true);
+    while( direction * (end - path_.back().parameter) > 0. )
+    {
+        const Number remaining = std::fabs(end - path_.back().parameter);
+        const Number h = direction * std::min(step, remaining);
+        const Number p = std::fabs(remaining - std::fabs(h)) < 1e-12 ? end : path_.back().parameter + h;
+
+        predict(h, x, z_L, z_U, lambda);
+        nlp->set_parameter(options_.parameter, p);
+        nlp->set_warm_start(x, z_L, z_U, lambda);
+        if( !solve(nlp) )
+        {
+            // retry from the last accepted point with a smaller step
+            rejected_steps_++;
+            step *= options_.shrink_factor;
+            if( step < options_.min_step )
+            {
+                reached = false;
+                break;
+            }
+            continue;
+        }
+
+        std::vector<char> new_active = active_set(*nlp, nlp->solution(), options_.active_tol);
+        HS071_ContinuationPoint point = {p, h, new_active != active, nlp->solution()};
+        path_.push_back(point);
+        active.swap(new_active);
+
+        // adapt the step to how hard this solve was
+        if( point.active_set_changed || point.solution.iter_count > options_.spike_iterations )
+        {
+            step = std::max(options_.min_step, step * options_.shrink_factor);
+        }
+        else if( point.solution.iter_count <= options_.cheap_iterations )
+        {
+            step = std::min(options_.max_step, step * options_.grow_factor);
+        }
+    }
+    HS071_set_warm_start_options(app_, false);
+    return reached;
+}
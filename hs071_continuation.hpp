@@ -0,0 +1,70 @@
+//
+// Continuation (homotopy) driver for HS071: traces the solution path of HS071_NLP while one of its runtime
+// parameters is swept through a range, warm starting every solve from the previous primal-dual solution.
+//
+
+#ifndef __HS071_CONTINUATION_HPP
+#define __HS071_CONTINUATION_HPP
+
+#include "IpIpoptApplication.hpp"
+#include "hs071_nlp.hpp"
+
+#include <vector>
+
+using namespace Ipopt;
+
+struct HS071_ContinuationOptions {
+    Index parameter = HS071_G1_RHS;  // which HS071_Parameter is swept
+    Number initial_step = 1.0;       // first step in the parameter (absolute value)
+    Number min_step = 1e-4;          // give up once a failing step has been shrunk below this
+    Number max_step = 10.0;
+    Number shrink_factor = 0.5;      // applied after an iteration spike, an active set change or a failed solve
+    Number grow_factor = 2.0;        // applied after a cheap solve
+    Index spike_iterations = 12;     // a warm started solve needing more iterations than this is a spike
+    Index cheap_iterations = 5;      // a warm started solve needing at most this many iterations is cheap
+    Number active_tol = 1e-6;        // distance to a bound below which the bound counts as active
+    bool predictor = true;           // extrapolate the starting point along the secant of the last two points
+};
+
+struct HS071_ContinuationPoint {
+    Number parameter;
+    Number step;          // step taken to reach this point, 0 for the first one
+    bool active_set_changed;
+    HS071_Solution solution;
+};
+
+class HS071_Continuation {
+
+public:
+    // app must be initialized; trace sets the warm start options on it and resets warm_start_init_point afterwards
+    HS071_Continuation(const SmartPtr<IpoptApplication> &app,
+                       const HS071_ContinuationOptions &options = HS071_ContinuationOptions());
+
+    // Traces the path from parameter value begin to end. Returns true if end was reached, false if the first solve
+    // failed or the step had to be shrunk below min_step. The accepted points are available through path().
+    bool trace(Number begin, Number end);
+
+    const std::vector<HS071_ContinuationPoint> &path() const { return path_; }
+
+    // Ipopt iterations spent on all solves of the last trace, including rejected steps
+    Index total_iterations() const { return total_iterations_; }
+    Index rejected_steps() const { return rejected_steps_; }
+
+    // active set of a solution as one flag per lower bound, upper bound and inequality bound of g
+    static std::vector<char> active_set(HS071_NLP &nlp, const HS071_Solution &sol, Number tol);
+
+private:
+    bool solve(const SmartPtr<HS071_NLP> &nlp);
+    void predict(Number step, std::vector<Number> &x, std::vector<Number> &z_L, std::vector<Number> &z_U,
+                 std::vector<Number> &lambda) const;
+
+    SmartPtr<IpoptApplication> app_;
+    HS071_ContinuationOptions options_;
+
+    std::vector<HS071_ContinuationPoint> path_;
+    Index total_iterations_;
+    Index rejected_steps_;
+
+};
+
+#endif //__HS071_CONTINUATION_HPP
@@ -0,0 +1,343 @@
+//
+// Spatial branch-and-bound for HS071, see hs071_global.hpp
+//
+
+#include "hs071_global.hpp"
+#include "hs071_presolve.hpp"
+#include "work_stealing_pool.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+// children evaluated per task
+static const Index KERNEL_CHUNK = 1024;
+// relative widening of the kernel results, a bound on the rounding error of the few operations per function
+static const Number ROUNDING = 8 * DBL_EPSILON;
+
+// adds the range of x^2 for x in [lo, hi]
+static inline void add_square(Number lo, Number hi, Number &sq_lo, Number &sq_hi) {
+    const Number m = std::max(0., std::max(lo, -hi));
+    sq_lo += m * m;
+    sq_hi += std::max(lo * lo, hi * hi);
+}
+
+void HS071_interval_bounds(Index count, const Number *const lo[4], const Number *const hi[4], Number *f_lo,
+                           Number *g0_hi, Number *g1_lo, Number *g1_hi) {
+    const Number *lo0 = lo[0], *lo1 = lo[1], *lo2 = lo[2], *lo3 = lo[3];
+    const Number *hi0 = hi[0], *hi1 = hi[1], *hi2 = hi[2], *hi3 = hi[3];
+    for( Index k = 0; k < count; k++ )
+    {
+        // products of intervals take the extremes of the four end point products, squares are clipped at 0
+        // p = x0 x3
+        Number a = lo0[k] * lo3[k], b = lo0[k] * hi3[k], c = hi0[k] * lo3[k], d = hi0[k] * hi3[k];
+        const Number p_lo = std::min(std::min(a, b), std::min(c, d));
+        const Number p_hi = std::max(std::max(a, b), std::max(c, d));
+        // f = p (x0 + x1 + x2) + x2
+        const Number s_lo = lo0[k] + lo1[k] + lo2[k], s_hi = hi0[k] + hi1[k] + hi2[k];
+        a = p_lo * s_lo;
+        b = p_lo * s_hi;
+        c = p_hi * s_lo;
+        d = p_hi * s_hi;
+        const Number f = std::min(std::min(a, b), std::min(c, d)) + lo2[k];
+        f_lo[k] = f - std::fabs(f) * ROUNDING;
+
+        // g0 = (x0 x1) (x2 x3)
+        a = lo0[k] * lo1[k];
+        b = lo0[k] * hi1[k];
+        c = hi0[k] * lo1[k];
+        d = hi0[k] * hi1[k];
+        const Number q_lo = std::min(std::min(a, b), std::min(c, d)), q_hi = std::max(std::max(a, b), std::max(c, d));
+        a = lo2[k] * lo3[k];
+        b = lo2[k] * hi3[k];
+        c = hi2[k] * lo3[k];
+        d = hi2[k] * hi3[k];
+        const Number r_lo = std::min(std::min(a, b), std::min(c, d)), r_hi = std::max(std::max(a, b), std::max(c, d));
+        const Number g0 = std::max(std::max(q_lo * r_lo, q_lo * r_hi), std::max(q_hi * r_lo, q_hi * r_hi));
+        g0_hi[k] = g0 + std::fabs(g0) * ROUNDING;
+
+        // g1 = sum of squares
+        Number sq_lo = 0., sq_hi = 0.;
+        add_square(lo0[k], hi0[k], sq_lo, sq_hi);
+        add_square(lo1[k], hi1[k], sq_lo, sq_hi);
+        add_square(lo2[k], hi2[k], sq_lo, sq_hi);
+        add_square(lo3[k], hi3[k], sq_lo, sq_hi);
+        g1_lo[k] = sq_lo - sq_lo * ROUNDING;
+        g1_hi[k] = sq_hi + sq_hi * ROUNDING;
+    }
+}
+
+void HS071_GlobalSolver::BoxSet::resize(size_t n) {
+    for( Index i = 0; i < 4; i++ )
+    {
+        lo[i].resize(n);
+        hi[i].resize(n);
+    }
+    bound.resize(n);
+}
+
+void HS071_GlobalSolver::BoxSet::reserve(size_t n) {
+    for( Index i = 0; i < 4; i++ )
+    {
+        lo[i].reserve(n);
+        hi[i].reserve(n);
+    }
+    bound.reserve(n);
+}
+
+void HS071_GlobalSolver::BoxSet::push_back(const BoxSet &from, size_t k) {
+    for( Index i = 0; i < 4; i++ )
+    {
+        lo[i].push_back(from.lo[i][k]);
+        hi[i].push_back(from.hi[i][k]);
+    }
+    bound.push_back(from.bound[k]);
+}
+
+HS071_GlobalSolver::HS071_GlobalSolver(const HS071_GlobalOptions &options)
+        : options_(options), lower_bound_(-std::numeric_limits<Number>::infinity()), rounds_(0), boxes_evaluated_(0),
+          boxes_infeasible_(0), boxes_pruned_(0), local_solves_(0), wall_time_(0.) {
+    assert(options_.batch_size > 0);
+}
+
+bool HS071_GlobalSolver::prune(Number bound) const {
+    const Number upper = upper_bound();
+    return bound >= upper - std::max(options_.abs_gap, options_.rel_gap * std::fabs(upper));
+}
+
+bool HS071_GlobalSolver::run() {
+    incumbent_ = HS071_Solution();
+    rounds_ = boxes_evaluated_ = boxes_infeasible_ = boxes_pruned_ = local_solves_ = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    WorkStealingPool pool(options_.num_threads);
+    std::vector<SmartPtr<IpoptApplication> > apps(pool.size());
+    std::mutex mutex;   // guards incumbent_ and local_solves_ during the local solves
+
+    // local solve from x0 (the HS071 starting point if empty) on the calling worker
+    auto polish = [this, &pool, &apps, &mutex](const std::vector<Number> &x0) {
+        SmartPtr<IpoptApplication> &app = apps[pool.worker_index()];
+        if( IsNull(app) )
+        {
+            app = IpoptApplicationFactory();
+            app->Options()->SetIntegerValue("print_level", 0);
+            if( options_.configure )
+            {
+                options_.configure(app);
+            }
+            if( app->Initialize() != Solve_Succeeded )
+            {
+                app = NULL;
+                return;
+            }
+        }
+        SmartPtr<HS071_NLP> nlp = new HS071_NLP(options_.g0_lower, options_.g1_rhs);
+        nlp->set_verbose(false);
+        if( !x0.empty() )
+        {
+            nlp->set_starting_point(x0);
+        }
+        app->OptimizeTNLP(nlp);
+        const HS071_Solution &sol = nlp->solution();
+        std::lock_guard<std::mutex> lock(mutex);
+        local_solves_++;
+        if( (sol.status == SUCCESS || sol.status == STOP_AT_ACCEPTABLE_POINT)
+            && (incumbent_.x.empty() || sol.obj_value < incumbent_.obj_value) )
+        {
+            incumbent_ = sol;
+        }
+    };
+
+    // the root box comes from the problem itself, tightened by the interval presolve; if that proves the problem
+    // infeasible there is nothing to search
+    BoxSet active;
+    {
+        HS071_NLP nlp(options_.g0_lower, options_.g1_rhs);
+        Number x_l[4], x_u[4], g_l[2], g_u[2];
+        nlp.get_bounds_info(4, x_l, x_u, 2, g_l, g_u);
+        if( HS071_contract_box(nlp, x_l, x_u) )
+        {
+            active.resize(1);
+            for( Index i = 0; i < 4; i++ )
+            {
+                active.lo[i][0] = x_l[i];
+                active.hi[i][0] = x_u[i];
+            }
+            active.bound[0] = -std::numeric_limits<Number>::infinity();
+            pool.submit([&polish]() { polish(std::vector<Number>()); });
+            pool.wait();
+        }
+    }
+    const Number g0_min = options_.g0_lower - options_.feasibility_tol * std::max(1., std::fabs(options_.g0_lower));
+    const Number g1_tol = options_.feasibility_tol * std::max(1., std::fabs(options_.g1_rhs));
+    const Index num_polish = options_.polish_per_round > 0 ? options_.polish_per_round : (Index) pool.size();
+    Number leaf_bound = std::numeric_limits<Number>::infinity();
+    // the pruned boxes are only within the gap of the incumbent, their bounds still limit the certified lower bound
+    Number pruned_bound = std::numeric_limits<Number>::infinity();
+
+    std::vector<size_t> order;
+    BoxSet children;
+    std::vector<Chunk> chunks;
+    while( boxes_evaluated_ < options_.max_boxes )
+    {
+        // best first: the boxes with the lowest bounds that the incumbent does not prune
+        order.clear();
+        for( size_t k = 0; k < active.size(); k++ )
+        {
+            if( prune(active.bound[k]) )
+            {
+                boxes_pruned_++;
+                pruned_bound = std::min(pruned_bound, active.bound[k]);
+            }
+            else
+            {
+                order.push_back(k);
+            }
+        }
+        if( order.empty() )
+        {
+            active.resize(0);
+            break;
+        }
+        const size_t batch = std::min(order.size(), (size_t) options_.batch_size);
+        if( batch < order.size() )
+        {
+            std::nth_element(order.begin(), order.begin() + batch, order.end(), [&active](size_t a, size_t b) {
+                return active.bound[a] < active.bound[b];
+            });
+        }
+
+        // bisect along the widest side
+        children.resize(2 * batch);
+        for( size_t j = 0; j < batch; j++ )
+        {
+            const size_t k = order[j];
+            Index widest = 0;
+            for( Index i = 1; i < 4; i++ )
+            {
+                if( active.hi[i][k] - active.lo[i][k] > active.hi[widest][k] - active.lo[widest][k] )
+                {
+                    widest = i;
+                }
+            }
+            for( Index i = 0; i < 4; i++ )
+            {
+                children.lo[i][2 * j] = children.lo[i][2 * j + 1] = active.lo[i][k];
+                children.hi[i][2 * j] = children.hi[i][2 * j + 1] = active.hi[i][k];
+            }
+            const Number mid = 0.5 * (active.lo[widest][k] + active.hi[widest][k]);
+            children.hi[widest][2 * j] = children.lo[widest][2 * j + 1] = mid;
+            children.bound[2 * j] = children.bound[2 * j + 1] = active.bound[k];
+        }
+
+        // evaluate and filter the children chunk by chunk; the survivors of each chunk are appended in chunk order
+        const Index count = (Index) children.size();
+        const Index num_chunks = (count + KERNEL_CHUNK - 1) / KERNEL_CHUNK;
+        chunks.resize(num_chunks);
+        for( Index c = 0; c < num_chunks; c++ )
+        {
+            pool.submit([this, c, count, g0_min, g1_tol, &children, &chunks]() {
+                Chunk &chunk = chunks[c];
+                const Index first = c * KERNEL_CHUNK, n = std::min(KERNEL_CHUNK, count - first);
+                const Number *lo[4], *hi[4];
+                for( Index i = 0; i < 4; i++ )
+                {
+                    lo[i] = children.lo[i].data() + first;
+                    hi[i] = children.hi[i].data() + first;
+                }
+                Number f_lo[KERNEL_CHUNK], g0_hi[KERNEL_CHUNK], g1_lo[KERNEL_CHUNK], g1_hi[KERNEL_CHUNK];
+                HS071_interval_bounds(n, lo, hi, f_lo, g0_hi, g1_lo, g1_hi);
+
+                chunk.boxes.resize(0);
+                chunk.infeasible = chunk.pruned = 0;
+                chunk.leaf_bound = chunk.pruned_bound = std::numeric_limits<Number>::infinity();
+                for( Index j = 0; j < n; j++ )
+                {
+                    const Index k = first + j;
+                    if( g0_hi[j] < g0_min || g1_lo[j] > options_.g1_rhs + g1_tol || g1_hi[j] < options_.g1_rhs - g1_tol )
+                    {
+                        chunk.infeasible++;
+                        continue;
+                    }
+                    children.bound[k] = std::max(children.bound[k], f_lo[j]);
+                    if( prune(children.bound[k]) )
+                    {
+                        chunk.pruned++;
+                        chunk.pruned_bound = std::min(chunk.pruned_bound, children.bound[k]);
+                        continue;
+                    }
+                    Number width = 0.;
+                    for( Index i = 0; i < 4; i++ )
+                    {
+                        width = std::max(width, hi[i][j] - lo[i][j]);
+                    }
+                    if( width < options_.min_width )
+                    {
+                        chunk.leaf_bound = std::min(chunk.leaf_bound, children.bound[k]);
+                        continue;
+                    }
+                    chunk.boxes.push_back(children, k);
+                }
+            });
+        }
+        pool.wait();
+        boxes_evaluated_ += count;
+
+        size_t num_survivors = 0;
+        for( Index c = 0; c < num_chunks; c++ )
+        {
+            num_survivors += chunks[c].boxes.size();
+        }
+        BoxSet next;
+        next.reserve(order.size() - batch + num_survivors);
+        for( size_t j = batch; j < order.size(); j++ )
+        {
+            next.push_back(active, order[j]);
+        }
+        std::vector<size_t> survivors;
+        for( Index c = 0; c < num_chunks; c++ )
+        {
+            const Chunk &chunk = chunks[c];
+            boxes_infeasible_ += chunk.infeasible;
+            boxes_pruned_ += chunk.pruned;
+            leaf_bound = std::min(leaf_bound, chunk.leaf_bound);
+            pruned_bound = std::min(pruned_bound, chunk.pruned_bound);
+            for( size_t k = 0; k < chunk.boxes.size(); k++ )
+            {
+                survivors.push_back(next.size());
+                next.push_back(chunk.boxes, k);
+            }
+        }
+        std::swap(active, next);
+
+        // local solves from the centres of the most promising new boxes
+        const size_t polished = std::min(survivors.size(), (size_t) num_polish);
+        if( polished < survivors.size() )
+        {
+            std::nth_element(survivors.begin(), survivors.begin() + polished, survivors.end(),
+                             [&active](size_t a, size_t b) { return active.bound[a] < active.bound[b]; });
+        }
+        for( size_t j = 0; j < polished; j++ )
+        {
+            std::vector<Number> x0(4);
+            for( Index i = 0; i < 4; i++ )
+            {
+                x0[i] = 0.5 * (active.lo[i][survivors[j]] + active.hi[i][survivors[j]]);
+            }
+            pool.submit([&polish, x0]() { polish(x0); });
+        }
+        pool.wait();
+        rounds_++;
+    }
+
+    lower_bound_ = std::min(std::min(leaf_bound, pruned_bound), upper_bound());
+    for( size_t k = 0; k < active.size(); k++ )
+    {
+        lower_bound_ = std::min(lower_bound_, active.bound[k]);
+    }
+    wall_time_ = std::chrono::duration<Number>(std::chrono::steady_clock::now() - start).count();
+    return has_incumbent() && prune(lower_bound_);
+}
@@ -0,0 +1,103 @@
+//
+// Global optimization of HS071 by spatial branch-and-bound. Boxes of [1,5]^4 are bounded with interval arithmetic:
+// a box is dropped when the interval ranges of g0 or g1 miss their bounds, or when the interval lower bound of f
+// is no better than the incumbent. The surviving boxes are bisected along their widest side. The incumbent comes
+// from local Ipopt solves started at the centres of the most promising surviving boxes.
+//
+// The search runs in rounds: each round takes the batch_size boxes with the lowest bounds, bisects them and
+// evaluates the children with a structure-of-arrays interval kernel. The kernel has no branches, so the compiler
+// vectorizes it. Chunks of children are spread over a work stealing pool, as are the local solves of the round.
+// The root box is tightened by the interval presolve (HS071_contract_box) first. The result is certified when the
+// incumbent is within the gap of the smallest lower bound left.
+//
+
+#ifndef __HS071_GLOBAL_HPP
+#define __HS071_GLOBAL_HPP
+
+#include "IpIpoptApplication.hpp"
+#include "hs071_nlp.hpp"
+
+#include <functional>
+#include <vector>
+
+using namespace Ipopt;
+
+// Interval bounds of the HS071 functions over count boxes [lo, hi] stored as structure of arrays (lo[i][k] is the
+// lower end of x_i in box k): the lower end of f, the upper end of g0 and both ends of g1. Results are widened by a
+// few ulps to cover rounding, which is rigorous on boxes in the positive orthant where no cancellation occurs.
+void HS071_interval_bounds(Index count, const Number *const lo[4], const Number *const hi[4], Number *f_lo,
+                           Number *g0_hi, Number *g1_lo, Number *g1_hi);
+
+struct HS071_GlobalOptions {
+    Number abs_gap = 1e-6;          // boxes whose bound is within the gap of the incumbent are pruned
+    Number rel_gap = 1e-5;
+    Number feasibility_tol = 1e-7;  // boxes whose constraint ranges miss the bounds by less are kept
+    Number min_width = 1e-9;        // boxes narrower than this are not split further
+    Index batch_size = 8192;        // boxes bisected per round
+    Index max_boxes = 10000000;     // limit on the boxes evaluated
+    Index polish_per_round = 0;     // local solves per round, 0: one per thread
+    unsigned num_threads = 0;       // 0: one per hardware thread
+    Number g0_lower = 25.0;         // HS071 parameters
+    Number g1_rhs = 40.0;
+    // called on every per-thread IpoptApplication before it is initialized, e.g. to set options
+    std::function<void(const SmartPtr<IpoptApplication> &)> configure;
+};
+
+class HS071_GlobalSolver {
+
+public:
+    explicit HS071_GlobalSolver(const HS071_GlobalOptions &options = HS071_GlobalOptions());
+
+    // Runs the search and returns whether the incumbent was certified globally optimal within the gap.
+    bool run();
+
+    bool has_incumbent() const { return !incumbent_.x.empty(); }
+    const HS071_Solution &incumbent() const { return incumbent_; }
+    // certified range of the global optimum
+    Number upper_bound() const { return incumbent_.x.empty() ? 2e19 : incumbent_.obj_value; }
+    Number lower_bound() const { return lower_bound_; }
+
+    Index rounds() const { return rounds_; }
+    Index boxes_evaluated() const { return boxes_evaluated_; }
+    Index boxes_infeasible() const { return boxes_infeasible_; }
+    Index boxes_pruned() const { return boxes_pruned_; }
+    Index local_solves() const { return local_solves_; }
+    Number wall_time() const { return wall_time_; }
+
+private:
+    // boxes as structure of arrays with their lower bounds of f
+    struct BoxSet {
+        std::vector<Number> lo[4];
+        std::vector<Number> hi[4];
+        std::vector<Number> bound;
+        size_t size() const { return bound.size(); }
+        void resize(size_t n);
+        void reserve(size_t n);
+        void push_back(const BoxSet &from, size_t k);
+    };
+
+    // survivors and counts of one chunk of children
+    struct Chunk {
+        BoxSet boxes;
+        Index infeasible;
+        Index pruned;
+        Number leaf_bound;
+        Number pruned_bound;
+    };
+
+    bool prune(Number bound) const;
+
+    HS071_GlobalOptions options_;
+
+    HS071_Solution incumbent_;
+    Number lower_bound_;
+    Index rounds_;
+    Index boxes_evaluated_;
+    Index boxes_infeasible_;
+    Index boxes_pruned_;
+    Index local_solves_;
+    Number wall_time_;
+
+};
+
+#endif //__HS071_GLOBAL_HPP
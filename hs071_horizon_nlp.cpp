@@ -0,0 +1,254 @@
+//
+// Horizon-structured NLP built from HS071 stages, see hs071_horizon_nlp.hpp
+//
+
+#include "hs071_horizon_nlp.hpp"
+
+#include "IpIpoptData.hpp"
+
+#include <algorithm>
+
+const Index HS071_HorizonNLP::STAGE_N;
+const Index HS071_HorizonNLP::STAGE_M;
+const Index HS071_HorizonNLP::STAGE_NNZ_JAC;
+const Index HS071_HorizonNLP::STAGE_NNZ_H;
+
+HS071_HorizonNLP::HS071_HorizonNLP(Index horizon, Number rho, Number max_move)
+        : T_(horizon), rho_(rho), max_move_(max_move) {
+    assert(horizon > 0);
+    for( Index t = 0; t < T_; t++ )
+    {
+        stages_.push_back(new HS071_NLP());
+        stages_.back()->set_verbose(false);
+    }
+}
+
+void HS071_HorizonNLP::set_stage_parameter(Index t, Index p, Number value) {
+    stages_[t]->set_parameter(p, value);
+}
+
+Number HS071_HorizonNLP::get_stage_parameter(Index t, Index p) const {
+    return stages_[t]->get_parameter(p);
+}
+
+void HS071_HorizonNLP::set_warm_start(const std::vector<Number> &x, const std::vector<Number> &z_L,
+                                      const std::vector<Number> &z_U, const std::vector<Number> &lambda) {
+    assert((Index) x.size() == STAGE_N * T_);
+    assert((Index) lambda.size() == STAGE_M * T_ + STAGE_N * (T_ - 1));
+    warm_x_ = x;
+    warm_z_L_ = z_L;
+    warm_z_U_ = z_U;
+    warm_lambda_ = lambda;
+}
+
+bool HS071_HorizonNLP::get_nlp_info(Index &n, Index &m, Index &nnz_jac_g, Index &nnz_h_lag,
+                                    IndexStyleEnum &index_style) {
+    // T stages of 4 variables, their 2 HS071 constraints and 4 move limits between consecutive stages
+    n = STAGE_N * T_;
+    m = STAGE_M * T_ + STAGE_N * (T_ - 1);
+    // each stage brings the dense HS071 Jacobian block, each move limit a +1 and a -1
+    nnz_jac_g = STAGE_NNZ_JAC * T_ + 2 * STAGE_N * (T_ - 1);
+    // dense lower triangle of each stage block, plus the diagonal coupling of consecutive stages from the
+    // move suppression term
+    nnz_h_lag = STAGE_NNZ_H * T_ + STAGE_N * (T_ - 1);
+    index_style = TNLP::C_STYLE;
+    return true;
+}
+
+bool HS071_HorizonNLP::get_bounds_info(Index n, Number *x_l, Number *x_u, Index m, Number *g_l, Number *g_u) {
+    assert(n == STAGE_N * T_);
+    for( Index t = 0; t < T_; t++ )
+    {
+        stages_[t]->get_bounds_info(STAGE_N, x_l + var(t, 0), x_u + var(t, 0), STAGE_M, g_l + stage_con(t, 0),
+                                    g_u + stage_con(t, 0));
+    }
+    for( Index t = 0; t + 1 < T_; t++ )
+    {
+        for( Index i = 0; i < STAGE_N; i++ )
+        {
+            g_l[link_con(t, i)] = -max_move_;
+            g_u[link_con(t, i)] = max_move_;
+        }
+    }
+    if( !x_init_.empty() )
+    {
+        // the move limit from the initial state; if it does not meet the box, the nearest point of the box is used
+        for( Index i = 0; i < STAGE_N; i++ )
+        {
+            Number lo = std::max(x_l[i], x_init_[i] - max_move_);
+            Number up = std::min(x_u[i], x_init_[i] + max_move_);
+            if( lo > up )
+            {
+                lo = up = std::min(x_u[i], std::max(x_l[i], x_init_[i]));
+            }
+            x_l[i] = lo;
+            x_u[i] = up;
+        }
+    }
+    return true;
+}
+
+bool HS071_HorizonNLP::get_starting_point(Index n, bool init_x, Number *x, bool init_z, Number *z_L, Number *z_U,
+                                          Index m, bool init_lambda, Number *lambda) {
+    assert(init_x == true);
+    if( !has_warm_start() )
+    {
+        if( init_z || init_lambda )
+        {
+            return false;
+        }
+        // every stage starts from the HS071 starting point
+        for( Index t = 0; t < T_; t++ )
+        {
+            stages_[t]->get_starting_point(STAGE_N, true, x + var(t, 0), false, NULL, NULL, STAGE_M, false, NULL);
+        }
+        return true;
+    }
+    std::copy(warm_x_.begin(), warm_x_.end(), x);
+    if( init_z )
+    {
+        std::copy(warm_z_L_.begin(), warm_z_L_.end(), z_L);
+        std::copy(warm_z_U_.begin(), warm_z_U_.end(), z_U);
+    }
+    if( init_lambda )
+    {
+        std::copy(warm_lambda_.begin(), warm_lambda_.end(), lambda);
+    }
+    return true;
+}
+
+bool HS071_HorizonNLP::eval_f(Index n, const Number *x, bool new_x, Number &obj_value) {
+    obj_value = objective(x);
+    return true;
+}
+
+bool HS071_HorizonNLP::eval_grad_f(Index n, const Number *x, bool new_x, Number *grad_f) {
+    for( Index t = 0; t < T_; t++ )
+    {
+        stages_[t]->eval_grad_f(STAGE_N, x + var(t, 0), new_x, grad_f + var(t, 0));
+    }
+    for( Index t = 0; t + 1 < T_; t++ )
+    {
+        for( Index i = 0; i < STAGE_N; i++ )
+        {
+            Number d = rho_ * (x[var(t + 1, i)] - x[var(t, i)]);
+            grad_f[var(t + 1, i)] += d;
+            grad_f[var(t, i)] -= d;
+        }
+    }
+    return true;
+}
+
+bool HS071_HorizonNLP::eval_g(Index n, const Number *x, bool new_x, Index m, Number *g) {
+    constraints(x, g);
+    return true;
+}
+
+bool HS071_HorizonNLP::eval_jac_g(Index n, const Number *x, bool new_x, Index m, Index nele_jac, Index *iRow,
+                                  Index *jCol, Number *values) {
+    // stage blocks first (8 entries each, in the order of HS071_NLP), then the move limits (x_{t+1,i}, x_{t,i})
+    const Index links = STAGE_NNZ_JAC * T_;
+    if( values == NULL )
+    {
+        for( Index t = 0; t < T_; t++ )
+        {
+            Index *rows = iRow + STAGE_NNZ_JAC * t;
+            Index *cols = jCol + STAGE_NNZ_JAC * t;
+            stages_[t]->eval_jac_g(STAGE_N, NULL, false, STAGE_M, STAGE_NNZ_JAC, rows, cols, NULL);
+            for( Index k = 0; k < STAGE_NNZ_JAC; k++ )
+            {
+                rows[k] += stage_con(t, 0);
+                cols[k] += var(t, 0);
+            }
+        }
+        for( Index t = 0; t + 1 < T_; t++ )
+        {
+            for( Index i = 0; i < STAGE_N; i++ )
+            {
+                Index k = links + 2 * (STAGE_N * t + i);
+                iRow[k] = iRow[k + 1] = link_con(t, i);
+                jCol[k] = var(t + 1, i);
+                jCol[k + 1] = var(t, i);
+            }
+        }
+    }
+    else
+    {
+        for( Index t = 0; t < T_; t++ )
+        {
+            stages_[t]->eval_jac_g(STAGE_N, x + var(t, 0), new_x, STAGE_M, STAGE_NNZ_JAC, NULL, NULL,
+                                   values + STAGE_NNZ_JAC * t);
+        }
+        for( Index k = links; k < nele_jac; k += 2 )
+        {
+            values[k] = 1.;
+            values[k + 1] = -1.;
+        }
+    }
+    return true;
+}
+
+bool HS071_HorizonNLP::eval_h(Index n, const Number *x, bool new_x, Number obj_factor, Index m, const Number *lambda,
+                              bool new_lambda, Index nele_hess, Index *iRow, Index *jCol, Number *values) {
+    // stage blocks first (10 entries each, lower triangle in the order of HS071_NLP), then the coupling entries
+    // (x_{t+1,i}, x_{t,i}) of the move suppression term
+    const Index links = STAGE_NNZ_H * T_;
+    if( values == NULL )
+    {
+        for( Index t = 0; t < T_; t++ )
+        {
+            Index *rows = iRow + STAGE_NNZ_H * t;
+            Index *cols = jCol + STAGE_NNZ_H * t;
+            stages_[t]->eval_h(STAGE_N, NULL, false, 0., STAGE_M, NULL, false, STAGE_NNZ_H, rows, cols, NULL);
+            for( Index k = 0; k < STAGE_NNZ_H; k++ )
+            {
+                rows[k] += var(t, 0);
+                cols[k] += var(t, 0);
+            }
+        }
+        for( Index t = 0; t + 1 < T_; t++ )
+        {
+            for( Index i = 0; i < STAGE_N; i++ )
+            {
+                iRow[links + STAGE_N * t + i] = var(t + 1, i);
+                jCol[links + STAGE_N * t + i] = var(t, i);
+            }
+        }
+    }
+    else
+    {
+        // positions of the diagonal entries in a stage block
+        static const Index diagonal[STAGE_N] = {0, 2, 5, 9};
+        for( Index t = 0; t < T_; t++ )
+        {
+            Number *block = values + STAGE_NNZ_H * t;
+            stages_[t]->eval_h(STAGE_N, x + var(t, 0), new_x, obj_factor, STAGE_M, lambda + stage_con(t, 0),
+                               new_lambda, STAGE_NNZ_H, NULL, NULL, block);
+            // rho per neighbouring stage on the diagonal
+            Number neighbours = (t > 0 ? 1. : 0.) + (t + 1 < T_ ? 1. : 0.);
+            for( Index i = 0; i < STAGE_N; i++ )
+            {
+                block[diagonal[i]] += obj_factor * rho_ * neighbours;
+            }
+        }
+        for( Index k = links; k < nele_hess; k++ )
+        {
+            values[k] = -obj_factor * rho_;
+        }
+    }
+    return true;
+}
+
+void HS071_HorizonNLP::finalize_solution(SolverReturn status, Index n, const Number *x, const Number *z_L,
+                                         const Number *z_U, Index m, const Number *g, const Number *lambda,
+                                         Number obj_value, const IpoptData *ip_data,
+                                         IpoptCalculatedQuantities *ip_cq) {
+    solution_.status = status;
+    solution_.obj_value = obj_value;
+    solution_.iter_count = ip_data != NULL ? ip_data->iter_count() : 0;
+    solution_.x.assign(x, x + n);
+    solution_.z_L.assign(z_L, z_L + n);
+    solution_.z_U.assign(z_U, z_U + n);
+    solution_.g.assign(g, g + m);
+    solution_.lambda.assign(lambda, lambda + m);
+}
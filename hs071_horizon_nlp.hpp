@@ -0,0 +1,124 @@
+//
+// Horizon-structured NLP built from T HS071 stage problems. Stage t has its own variables x_t in [1,5]^4 and the
+// two HS071 constraints with its own parameters; consecutive stages are linked by move limits
+//     -max_move <= x_{t+1,i} - x_{t,i} <= max_move
+// and a move suppression term rho/2 ||x_{t+1} - x_t||^2 in the objective. The first stage can be tied to a
+// measured initial state by the same move limit. Variables and multipliers are laid out stage by stage.
+//
+
+#ifndef __HS071_HORIZON_NLP_HPP
+#define __HS071_HORIZON_NLP_HPP
+
+#include "IpTNLP.hpp"
+#include "hs071_nlp.hpp"
+
+#include <vector>
+
+using namespace Ipopt;
+
+class HS071_HorizonNLP: public TNLP {
+
+public:
+    static const Index STAGE_N = 4;       // variables per stage
+    static const Index STAGE_M = 2;       // HS071 constraints per stage
+    static const Index STAGE_NNZ_JAC = 8;
+    static const Index STAGE_NNZ_H = 10;
+
+    HS071_HorizonNLP(Index horizon, Number rho = 1.0, Number max_move = 0.5);
+
+    Index horizon() const { return T_; }
+
+    // HS071_Parameter p of stage t
+    void set_stage_parameter(Index t, Index p, Number value);
+    Number get_stage_parameter(Index t, Index p) const;
+
+    // ties x_0 to within max_move of x_init; an empty vector leaves x_0 free in the box
+    void set_initial_state(const std::vector<Number> &x_init) { x_init_ = x_init; }
+
+    // positions of stage variables and constraints in x and in lambda
+    Index var(Index t, Index i) const { return STAGE_N * t + i; }
+    Index stage_con(Index t, Index j) const { return STAGE_M * t + j; }
+    Index link_con(Index t, Index i) const { return STAGE_M * T_ + STAGE_N * t + i; }  // links stage t and t + 1
+
+    // primal-dual point for get_starting_point, as in HS071_NLP
+    void set_warm_start(const std::vector<Number> &x, const std::vector<Number> &z_L, const std::vector<Number> &z_U,
+                        const std::vector<Number> &lambda);
+    void clear_warm_start() { warm_x_.clear(); }
+    bool has_warm_start() const { return !warm_x_.empty(); }
+
+    const HS071_Solution &solution() const { return solution_; }
+
+    // f and g for any scalar type with the arithmetic of Number, e.g. DependencyScalar to detect the sparsity;
+    // eval_f and eval_g are these with Number
+    template<class T>
+    T objective(const T *x) const;
+    template<class T>
+    void constraints(const T *x, T *g) const;
+
+    // methods from Ipopt::TNLP
+    bool get_nlp_info(Index &n, Index &m, Index &nnz_jac_g, Index &nnz_h_lag, IndexStyleEnum &index_style);
+    bool get_bounds_info(Index n, Number *x_l, Number *x_u, Index m, Number *g_l, Number *g_u);
+    bool get_starting_point(Index n, bool init_x, Number *x, bool init_z, Number *z_L, Number *z_U, Index m,
+                            bool init_lambda, Number *lambda);
+    bool eval_f(Index n, const Number *x, bool new_x, Number &obj_value);
+    bool eval_grad_f(Index n, const Number *x, bool new_x, Number *grad_f);
+    bool eval_g(Index n, const Number *x, bool new_x, Index m, Number *g);
+    bool eval_jac_g(Index n, const Number *x, bool new_x, Index m, Index nele_jac, Index *iRow, Index *jCol,
+                    Number *values);
+    bool eval_h(Index n, const Number *x, bool new_x, Number obj_factor, Index m, const Number *lambda, bool new_lambda,
+                Index nele_hess, Index *iRow, Index *jCol, Number *values);
+    void finalize_solution(SolverReturn status, Index n, const Number *x, const Number *z_L, const Number *z_U, Index m,
+                           const Number *g, const Number *lambda, Number obj_value, const IpoptData *ip_data,
+                           IpoptCalculatedQuantities *ip_cq);
+
+private:
+    Index T_;
+    Number rho_;
+    Number max_move_;
+    // the stage problems provide bounds, starting point and all stage derivatives
+    std::vector<SmartPtr<HS071_NLP> > stages_;
+    std::vector<Number> x_init_;
+
+    std::vector<Number> warm_x_;
+    std::vector<Number> warm_z_L_;
+    std::vector<Number> warm_z_U_;
+    std::vector<Number> warm_lambda_;
+
+    HS071_Solution solution_;
+
+};
+
+template<class T>
+T HS071_HorizonNLP::objective(const T *x) const {
+    T f = 0.;
+    for( Index t = 0; t < T_; t++ )
+    {
+        f += HS071_objective(x + var(t, 0));
+    }
+    for( Index t = 0; t + 1 < T_; t++ )
+    {
+        for( Index i = 0; i < STAGE_N; i++ )
+        {
+            T d = x[var(t + 1, i)] - x[var(t, i)];
+            f += 0.5 * rho_ * d * d;
+        }
+    }
+    return f;
+}
+
+template<class T>
+void HS071_HorizonNLP::constraints(const T *x, T *g) const {
+    for( Index t = 0; t < T_; t++ )
+    {
+        HS071_constraints(x + var(t, 0), g + stage_con(t, 0));
+    }
+    for( Index t = 0; t + 1 < T_; t++ )
+    {
+        for( Index i = 0; i < STAGE_N; i++ )
+        {
+            g[link_con(t, i)] = x[var(t + 1, i)] - x[var(t, i)];
+        }
+    }
+}
+
+#endif //__HS071_HORIZON_NLP_HPP
@@ -0,0 +1,93 @@
+//
+// Receding-horizon (MPC) driver over HS071_HorizonNLP, see hs071_mpc.hpp
+//
+
+#include "hs071_mpc.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+HS071_MPC::HS071_MPC(const SmartPtr<IpoptApplication> &app, Index horizon, bool shift_warm_start, Number rho,
+                     Number max_move)
+        : app_(app), nlp_(new HS071_HorizonNLP(horizon, rho, max_move)), shift_warm_start_(shift_warm_start) {
+}
+
+void HS071_MPC::shift() {
+    // stage t of the next cycle is stage t + 1 of this one; the last stage (and the last move limit) is repeated
+    const HS071_Solution &sol = nlp_->solution();
+    const Index T = nlp_->horizon();
+    const Index N = HS071_HorizonNLP::STAGE_N;
+    const Index M = HS071_HorizonNLP::STAGE_M;
+    x_ = sol.x;
+    z_L_ = sol.z_L;
+    z_U_ = sol.z_U;
+    lambda_ = sol.lambda;
+    for( Index t = 0; t + 1 < T; t++ )
+    {
+        std::copy(sol.x.begin() + nlp_->var(t + 1, 0), sol.x.begin() + nlp_->var(t + 2, 0), x_.begin() + nlp_->var(t, 0));
+        std::copy(sol.z_L.begin() + nlp_->var(t + 1, 0), sol.z_L.begin() + nlp_->var(t + 2, 0),
+                  z_L_.begin() + nlp_->var(t, 0));
+        std::copy(sol.z_U.begin() + nlp_->var(t + 1, 0), sol.z_U.begin() + nlp_->var(t + 2, 0),
+                  z_U_.begin() + nlp_->var(t, 0));
+        std::copy(sol.lambda.begin() + nlp_->stage_con(t + 1, 0), sol.lambda.begin() + nlp_->stage_con(t + 1, 0) + M,
+                  lambda_.begin() + nlp_->stage_con(t, 0));
+    }
+    for( Index t = 0; t + 2 < T; t++ )
+    {
+        std::copy(sol.lambda.begin() + nlp_->link_con(t + 1, 0), sol.lambda.begin() + nlp_->link_con(t + 1, 0) + N,
+                  lambda_.begin() + nlp_->link_con(t, 0));
+    }
+}
+
+HS071_MPCStep HS071_MPC::step(const std::vector<Number> &reference) {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const Index T = nlp_->horizon();
+    for( Index t = 0; t < T; t++ )
+    {
+        nlp_->set_stage_parameter(t, HS071_G1_RHS, reference[std::min(t, (Index) reference.size() - 1)]);
+    }
+    nlp_->set_initial_state(state_);
+
+    const bool warm = shift_warm_start_ && !x_.empty();
+    if( warm )
+    {
+        nlp_->set_warm_start(x_, z_L_, z_U_, lambda_);
+    }
+    else
+    {
+        nlp_->clear_warm_start();
+    }
+    HS071_set_warm_start_options(app_, warm);
+
+    HS071_MPCStep result;
+    result.status = app_->OptimizeTNLP(nlp_);
+    const HS071_Solution &sol = nlp_->solution();
+    result.iterations = sol.iter_count;
+    result.obj_value = sol.obj_value;
+    if( result.status == Solve_Succeeded || result.status == Solved_To_Acceptable_Level )
+    {
+        result.applied.assign(sol.x.begin(), sol.x.begin() + HS071_HorizonNLP::STAGE_N);
+        state_ = result.applied;
+        if( shift_warm_start_ )
+        {
+            shift();
+        }
+    }
+    else
+    {
+        // keep the state and start the next cycle cold
+        x_.clear();
+    }
+    result.cycle_time = std::chrono::duration<Number>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+std::vector<HS071_MPCStep> HS071_MPC::run(const std::vector<Number> &reference, Index cycles) {
+    std::vector<HS071_MPCStep> steps;
+    for( Index k = 0; k < cycles; k++ )
+    {
+        Index first = std::min(k, (Index) reference.size() - 1);
+        steps.push_back(step(std::vector<Number>(reference.begin() + first, reference.end())));
+    }
+    return steps;
+}
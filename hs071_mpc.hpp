@@ -0,0 +1,57 @@
+//
+// Receding-horizon (MPC) driver over HS071_HorizonNLP. Every control cycle solves the horizon problem for the
+// current window of the reference, applies the first stage and warm starts the next cycle from the previous
+// primal-dual trajectory shifted one stage forward (real-time iteration pattern).
+//
+
+#ifndef __HS071_MPC_HPP
+#define __HS071_MPC_HPP
+
+#include "IpIpoptApplication.hpp"
+#include "hs071_horizon_nlp.hpp"
+
+#include <vector>
+
+using namespace Ipopt;
+
+struct HS071_MPCStep {
+    ApplicationReturnStatus status;
+    Index iterations;
+    Number cycle_time;            // seconds for the whole cycle: shift, solve and extraction
+    Number obj_value;
+    std::vector<Number> applied;  // first stage of the solution, the new state
+};
+
+class HS071_MPC {
+
+public:
+    // app must be initialized; with shift_warm_start false every cycle starts cold from get_starting_point
+    HS071_MPC(const SmartPtr<IpoptApplication> &app, Index horizon, bool shift_warm_start = true, Number rho = 1.0,
+              Number max_move = 0.5);
+
+    // Runs one control cycle. reference[t] is the right hand side of g1 for stage t of this cycle's window (the
+    // last value is repeated if the window is shorter than the horizon).
+    HS071_MPCStep step(const std::vector<Number> &reference);
+
+    // Runs cycles control cycles over a reference trajectory, the window of cycle k starting at reference[k].
+    std::vector<HS071_MPCStep> run(const std::vector<Number> &reference, Index cycles);
+
+    const std::vector<Number> &state() const { return state_; }
+
+private:
+    void shift();
+
+    SmartPtr<IpoptApplication> app_;
+    SmartPtr<HS071_HorizonNLP> nlp_;
+    bool shift_warm_start_;
+    std::vector<Number> state_;
+
+    // shifted trajectory handed to the next cycle
+    std::vector<Number> x_;
+    std::vector<Number> z_L_;
+    std::vector<Number> z_U_;
+    std::vector<Number> lambda_;
+
+};
+
+#endif //__HS071_MPC_HPP
@@ -0,0 +1,122 @@
+//
+// Parallel multi-start search for HS071, see hs071_multistart.hpp
+//
+
+#include "hs071_multistart.hpp"
+#include "start_points.hpp"
+#include "work_stealing_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+HS071_MultiStart::HS071_MultiStart(const HS071_MultiStartOptions &options)
+        : options_(options), starts_solved_(0), starts_failed_(0), total_iterations_(0), since_new_(0), stop_(false) {
+    assert(options_.max_starts > 0);
+    assert(options_.stall_starts > 0);
+}
+
+void HS071_MultiStart::stall() {
+    if( ++since_new_ >= options_.stall_starts )
+    {
+        stop_ = true;
+    }
+}
+
+void HS071_MultiStart::record(Index k, const HS071_Solution &sol) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    total_iterations_ += sol.iter_count;
+    if( sol.status != SUCCESS && sol.status != STOP_AT_ACCEPTABLE_POINT )
+    {
+        starts_failed_++;
+        stall();
+        return;
+    }
+    starts_solved_++;
+    for( size_t i = 0; i < minima_.size(); i++ )
+    {
+        const std::vector<Number> &y = minima_[i].solution.x;
+        Number dist = 0., size = 1.;
+        for( size_t j = 0; j < y.size(); j++ )
+        {
+            dist = std::max(dist, std::fabs(sol.x[j] - y[j]));
+            size = std::max(size, std::fabs(y[j]));
+        }
+        if( dist <= options_.cluster_tol * size )
+        {
+            // a known minimum; keep the better representative
+            minima_[i].hits++;
+            if( sol.obj_value < minima_[i].solution.obj_value )
+            {
+                minima_[i].solution = sol;
+            }
+            stall();
+            return;
+        }
+    }
+    HS071_LocalMinimum minimum = {sol, 1, k};
+    minima_.push_back(minimum);
+    since_new_ = 0;
+}
+
+void HS071_MultiStart::solve_start(Index k, const std::vector<Number> &x0, SmartPtr<IpoptApplication> &app) {
+    if( stop_ )
+    {
+        return;
+    }
+    if( IsNull(app) )
+    {
+        // one application per worker thread, created on its first start
+        app = IpoptApplicationFactory();
+        app->Options()->SetIntegerValue("print_level", 0);
+        if( options_.configure )
+        {
+            options_.configure(app);
+        }
+        if( app->Initialize() != Solve_Succeeded )
+        {
+            app = NULL;
+            std::lock_guard<std::mutex> lock(mutex_);
+            starts_failed_++;
+            stall();
+            return;
+        }
+    }
+    SmartPtr<HS071_NLP> nlp = new HS071_NLP(options_.g0_lower, options_.g1_rhs);
+    nlp->set_verbose(false);
+    nlp->set_starting_point(x0);
+    optimize_timed(app, nlp, options_.latency);
+    record(k, nlp->solution());
+}
+
+Index HS071_MultiStart::run() {
+    minima_.clear();
+    starts_solved_ = starts_failed_ = total_iterations_ = since_new_ = 0;
+    stop_ = false;
+
+    // the box comes from the problem itself
+    HS071_NLP nlp(options_.g0_lower, options_.g1_rhs);
+    std::vector<Number> x_l(4), x_u(4), g_l(2), g_u(2);
+    nlp.get_bounds_info(4, x_l.data(), x_u.data(), 2, g_l.data(), g_u.data());
+    const Index n = (Index) x_l.size();
+    std::vector<Number> points = options_.sequence == HS071_SOBOL
+                                 ? sobol(options_.max_starts, x_l, x_u)
+                                 : latin_hypercube(options_.max_starts, x_l, x_u, options_.seed);
+
+    {
+        WorkStealingPool pool(options_.num_threads);
+        std::vector<SmartPtr<IpoptApplication> > apps(pool.size());
+        for( Index k = 0; k < options_.max_starts; k++ )
+        {
+            std::vector<Number> x0(points.begin() + (size_t) k * n, points.begin() + (size_t) (k + 1) * n);
+            pool.submit([this, k, x0, &pool, &apps]() {
+                solve_start(k, x0, apps[pool.worker_index()]);
+            });
+        }
+        pool.wait();
+    }
+
+    std::sort(minima_.begin(), minima_.end(), [](const HS071_LocalMinimum &a, const HS071_LocalMinimum &b) {
+        return a.solution.obj_value < b.solution.obj_value;
+    });
+    return (Index) minima_.size();
+}
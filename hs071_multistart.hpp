@@ -0,0 +1,81 @@
+//
+// Parallel multi-start search for HS071: local solves from space filling starting points in the variable box,
+// spread over a work stealing thread pool, with the resulting local minima clustered to drop duplicates.
+//
+
+#ifndef __HS071_MULTISTART_HPP
+#define __HS071_MULTISTART_HPP
+
+#include "IpIpoptApplication.hpp"
+#include "hs071_nlp.hpp"
+#include "solve_latency.hpp"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+using namespace Ipopt;
+
+enum HS071_StartSequence {
+    HS071_LATIN_HYPERCUBE,
+    HS071_SOBOL
+};
+
+struct HS071_MultiStartOptions {
+    Index max_starts = 64;
+    Index stall_starts = 16;        // stop once this many consecutive finished starts (failed ones included) found
+                                    // no new minimum
+    HS071_StartSequence sequence = HS071_SOBOL;
+    unsigned seed = 0;              // latin hypercube only
+    unsigned num_threads = 0;       // 0: one per hardware thread
+    Number cluster_tol = 1e-4;      // solutions closer than this (relative, max norm) are the same minimum
+    Number g0_lower = 25.0;         // HS071 parameters
+    Number g1_rhs = 40.0;
+    // called on every per-thread IpoptApplication before it is initialized, e.g. to set options
+    std::function<void(const SmartPtr<IpoptApplication> &)> configure;
+    // if set, the wall time of every local solve is recorded there
+    SolveLatencyRecorder *latency = NULL;
+};
+
+struct HS071_LocalMinimum {
+    HS071_Solution solution;
+    Index hits;          // number of starts that ended here
+    Index first_start;   // index of the first start that ended here
+};
+
+class HS071_MultiStart {
+
+public:
+    explicit HS071_MultiStart(const HS071_MultiStartOptions &options = HS071_MultiStartOptions());
+
+    // Solves from up to max_starts starting points and returns the number of distinct local minima found.
+    Index run();
+
+    // distinct local minima of the last run, best objective first
+    const std::vector<HS071_LocalMinimum> &minima() const { return minima_; }
+
+    Index starts_solved() const { return starts_solved_; }
+    Index starts_failed() const { return starts_failed_; }
+    Index total_iterations() const { return total_iterations_; }
+    bool stopped_early() const { return stop_; }
+
+private:
+    void solve_start(Index k, const std::vector<Number> &x0, SmartPtr<IpoptApplication> &app);
+    void record(Index k, const HS071_Solution &sol);
+    // counts a start that found no new minimum towards stall_starts; called with mutex_ held
+    void stall();
+
+    HS071_MultiStartOptions options_;
+
+    std::mutex mutex_;   // guards everything below but stop_
+    std::vector<HS071_LocalMinimum> minima_;
+    Index starts_solved_;
+    Index starts_failed_;
+    Index total_iterations_;
+    Index since_new_;
+    std::atomic<bool> stop_;
+
+};
+
+#endif //__HS071_MULTISTART_HPP
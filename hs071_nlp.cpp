@@ -4,6 +4,154 @@
 
 #include "hs071_nlp.hpp"
 
+#include "IpIpoptData.hpp"
+
+#include <algorithm>
+
+const Index HS071_FirstOrder::NNZ_JAC;
+const Index HS071_HessianComponents::NNZ;
+
+void HS071_eval_first_order(const Number *x, Number &f, Number *grad_f, Number *g, Number *jac) {
+    const Number x0 = x[0], x1 = x[1], x2 = x[2], x3 = x[3];
+    // f = x0 x3 (x0 + x1 + x2) + x2 and g0 = x0 x1 x2 x3 through the pairwise products
+    const Number sum = x0 + x1 + x2;
+    const Number p03 = x0 * x3, p01 = x0 * x1, p23 = x2 * x3;
+    f = p03 * sum + x2;
+    grad_f[0] = p03 + x3 * sum;
+    grad_f[1] = p03;
+    grad_f[2] = p03 + 1;
+    grad_f[3] = x0 * sum;
+    g[0] = p01 * p23;
+    g[1] = x0 * x0 + x1 * x1 + x2 * x2 + x3 * x3;
+    jac[0] = x1 * p23; // 0,0
+    jac[1] = x0 * p23; // 0,1
+    jac[2] = p01 * x3; // 0,2
+    jac[3] = p01 * x2; // 0,3
+    jac[4] = 2 * x0;   // 1,0
+    jac[5] = 2 * x1;   // 1,1
+    jac[6] = 2 * x2;   // 1,2
+    jac[7] = 2 * x3;   // 1,3
+}
+
+void HS071_FirstOrder::update(const Number *x, bool new_x) {
+    if( valid && !new_x )
+    {
+        return;
+    }
+    HS071_eval_first_order(x, f, grad_f, g, jac);
+    valid = true;
+}
+
+bool HS071_HessianComponents::update(const Number *x_new) {
+    if( valid && std::equal(x_new, x_new + 4, x) )
+    {
+        return false;
+    }
+    std::copy(x_new, x_new + 4, x);
+    valid = true;
+
+    // the objective portion
+    f[0] = 2 * x[3];                 // 0,0
+    f[1] = x[3];                     // 1,0
+    f[2] = 0.;                       // 1,1
+    f[3] = x[3];                     // 2,0
+    f[4] = 0.;                       // 2,1
+    f[5] = 0.;                       // 2,2
+    f[6] = 2 * x[0] + x[1] + x[2];   // 3,0
+    f[7] = x[0];                     // 3,1
+    f[8] = x[0];                     // 3,2
+    f[9] = 0.;                       // 3,3
+    // the first constraint
+    g0[0] = 0.;
+    g0[1] = x[2] * x[3]; // 1,0
+    g0[2] = 0.;
+    g0[3] = x[1] * x[3]; // 2,0
+    g0[4] = x[0] * x[3]; // 2,1
+    g0[5] = 0.;
+    g0[6] = x[1] * x[2]; // 3,0
+    g0[7] = x[0] * x[2]; // 3,1
+    g0[8] = x[0] * x[1]; // 3,2
+    g0[9] = 0.;
+    // the second constraint
+    for( Index k = 0; k < NNZ; k++ )
+    {
+        g1[k] = 0.;
+    }
+    g1[0] = g1[2] = g1[5] = g1[9] = 2.; // diagonal
+    return true;
+}
+
+void HS071_HessianComponents::combine(Number obj_factor, const Number *lambda, Number *values) const {
+    const Number l0 = lambda[0], l1 = lambda[1];
+    for( Index k = 0; k < NNZ; k++ )
+    {
+        values[k] = obj_factor * f[k] + l0 * g0[k] + l1 * g1[k];
+    }
+}
+
+HS071_NLP::HS071_NLP(Number g0_lower, Number g1_rhs) : stop_flag_(NULL), verbose_(true), fused_(false) {
+    params_[HS071_G0_LOWER] = g0_lower;
+    params_[HS071_G1_RHS] = g1_rhs;
+    for( Index i = 0; i < 4; i++ )
+    {
+        x_l_[i] = 1.0;
+        x_u_[i] = 5.0;
+    }
+}
+
+void HS071_NLP::set_parameter(Index p, Number value) {
+    assert(p >= 0 && p < HS071_NUM_PARAMETERS);
+    params_[p] = value;
+}
+
+Number HS071_NLP::get_parameter(Index p) const {
+    assert(p >= 0 && p < HS071_NUM_PARAMETERS);
+    return params_[p];
+}
+
+void HS071_NLP::set_variable_bounds(Index i, Number lower, Number upper) {
+    assert(i >= 0 && i < 4);
+    x_l_[i] = lower;
+    x_u_[i] = upper;
+}
+
+void HS071_NLP::set_warm_start(const std::vector<Number> &x, const std::vector<Number> &z_L, const std::vector<Number> &z_U,
+                               const std::vector<Number> &lambda) {
+    assert(x.size() == 4 && z_L.size() == 4 && z_U.size() == 4);
+    assert(lambda.size() == 2);
+    warm_x_ = x;
+    warm_z_L_ = z_L;
+    warm_z_U_ = z_U;
+    warm_lambda_ = lambda;
+}
+
+void HS071_NLP::set_warm_start(const HS071_Solution &sol) {
+    set_warm_start(sol.x, sol.z_L, sol.z_U, sol.lambda);
+}
+
+void HS071_NLP::set_starting_point(const std::vector<Number> &x) {
+    set_warm_start(x, std::vector<Number>(4, 0.), std::vector<Number>(4, 0.), std::vector<Number>(2, 0.));
+}
+
+void HS071_set_warm_start_options(const SmartPtr<IpoptApplication> &app, bool on) {
+    app->Options()->SetStringValue("warm_start_init_point", on ? "yes" : "no");
+    if( on )
+    {
+        app->Options()->SetNumericValue("warm_start_bound_push", 1e-9);
+        app->Options()->SetNumericValue("warm_start_bound_frac", 1e-9);
+        app->Options()->SetNumericValue("warm_start_slack_bound_push", 1e-9);
+        app->Options()->SetNumericValue("warm_start_slack_bound_frac", 1e-9);
+        app->Options()->SetNumericValue("warm_start_mult_bound_push", 1e-9);
+    }
+}
+
+void HS071_NLP::clear_warm_start() {
+    warm_x_.clear();
+    warm_z_L_.clear();
+    warm_z_U_.clear();
+    warm_lambda_.clear();
+}
+
 bool HS071_NLP::get_nlp_info(Index &n, Index &m, Index &nnz_jac_g, Index &nnz_h_lag, IndexStyleEnum &index_style) {
     // Method to request the initial information about the problem.
 
@@ -51,26 +199,22 @@ bool HS071_NLP::get_bounds_info(Index n, Number *x_l, Number *x_u, Index m, Numb
     // If desired, we could assert to make sure they are what we think they are.
     assert(n == 4);
     assert(m == 2);
-    // the variables have lower bounds of 1
+    // the variables have lower bounds of 1 and upper bounds of 5, unless set_variable_bounds changed them
     for( Index i = 0; i < 4; i++ )
     {
-        x_l[i] = 1.0;
+        x_l[i] = x_l_[i];
+        x_u[i] = x_u_[i];
     }
-    // the variables have upper bounds of 5
-    for( Index i = 0; i < 4; i++ )
-    {
-        x_u[i] = 5.0;
-    }
-    // the first constraint g1 has a lower bound of 25
-    g_l[0] = 25;
+    // the first constraint g1 has a lower bound of 25 (HS071_G0_LOWER)
+    g_l[0] = params_[HS071_G0_LOWER];
     // the first constraint g1 has NO upper bound, here we set it to 2e19.
     // Ipopt interprets any number greater than nlp_upper_bound_inf as
     // infinity. The default value of nlp_upper_bound_inf and nlp_lower_bound_inf
     // is 1e19 and can be changed through ipopt options.
     g_u[0] = 2e19;
     // the second constraint g2 is an equality constraint, so we set the
-    // upper and lower bound to the same value
-    g_l[1] = g_u[1] = 40.0;
+    // upper and lower bound to the same value, 40 by default (HS071_G1_RHS)
+    g_l[1] = g_u[1] = params_[HS071_G1_RHS];
     return true;
 
 };
@@ -92,17 +236,44 @@ bool HS071_NLP::get_starting_point(Index n, bool init_x, Number *x, bool init_z,
     // Returns
     // true if success, false otherwise.
 
-    // Here, we assume we only have starting values for x, if you code
-    // your own NLP, you can provide starting values for the dual variables
-    // if you wish
+    // Without a warm start we only have starting values for x; the dual
+    // variables can only be provided from a previous solution (set_warm_start),
+    // Ipopt asks for them when warm_start_init_point is set to yes
     assert(init_x == true);
-    assert(init_z == false);
-    assert(init_lambda == false);
-    // initialize to the given starting point
-    x[0] = 1.0;
-    x[1] = 5.0;
-    x[2] = 5.0;
-    x[3] = 1.0;
+    assert(n == 4);
+    assert(m == 2);
+    if( !has_warm_start() )
+    {
+        if( init_z || init_lambda )
+        {
+            return false;
+        }
+        // initialize to the given starting point
+        x[0] = 1.0;
+        x[1] = 5.0;
+        x[2] = 5.0;
+        x[3] = 1.0;
+        return true;
+    }
+    for( Index i = 0; i < n; i++ )
+    {
+        x[i] = warm_x_[i];
+    }
+    if( init_z )
+    {
+        for( Index i = 0; i < n; i++ )
+        {
+            z_L[i] = warm_z_L_[i];
+            z_U[i] = warm_z_U_[i];
+        }
+    }
+    if( init_lambda )
+    {
+        for( Index i = 0; i < m; i++ )
+        {
+            lambda[i] = warm_lambda_[i];
+        }
+    }
     return true;
 
 };
@@ -120,7 +291,13 @@ bool HS071_NLP::eval_f(Index n, const Number *x, bool new_x, Number &obj_value){
     // true if success, false otherwise.
 
     assert(n == 4);
-    obj_value = x[0] * x[3] * (x[0] + x[1] + x[2]) + x[2];
+    if( fused_ )
+    {
+        first_order_.update(x, new_x);
+        obj_value = first_order_.f;
+        return true;
+    }
+    obj_value = HS071_objective(x);
     return true;
 
 };
@@ -138,6 +315,12 @@ bool HS071_NLP::eval_grad_f(Index n, const Number *x, bool new_x, Number *grad_f
     // true if success, false otherwise.
 
     assert(n == 4);
+    if( fused_ )
+    {
+        first_order_.update(x, new_x);
+        std::copy(first_order_.grad_f, first_order_.grad_f + 4, grad_f);
+        return true;
+    }
     grad_f[0] = x[0] * x[3] + x[3] * (x[0] + x[1] + x[2]);
     grad_f[1] = x[0] * x[3];
     grad_f[2] = x[0] * x[3] + 1;
@@ -161,8 +344,14 @@ bool HS071_NLP::eval_g(Index n, const Number *x, bool new_x, Index m, Number *g)
 
     assert(n == 4);
     assert(m == 2);
-    g[0] = x[0] * x[1] * x[2] * x[3];
-    g[1] = x[0] * x[0] + x[1] * x[1] + x[2] * x[2] + x[3] * x[3];
+    if( fused_ )
+    {
+        first_order_.update(x, new_x);
+        g[0] = first_order_.g[0];
+        g[1] = first_order_.g[1];
+        return true;
+    }
+    HS071_constraints(x, g);
     return true;
 
 };
@@ -208,6 +397,11 @@ bool HS071_NLP::eval_jac_g(Index n, const Number *x, bool new_x, Index m, Index
         iRow[7] = 1;
         jCol[7] = 3;
     }
+    else if( fused_ )
+    {
+        first_order_.update(x, new_x);
+        std::copy(first_order_.jac, first_order_.jac + HS071_FirstOrder::NNZ_JAC, values);
+    }
     else
     {
         // return the values of the Jacobian of the constraints
@@ -260,7 +454,19 @@ void HS071_NLP::finalize_solution (SolverReturn status, Index n, const Number *x
 
     // here is where we would store the solution to variables, or write to a file, etc
     // so we could use the solution.
-    // For this example, we write the solution to the console
+    // We keep it in solution_ for the drivers and, unless told otherwise, write it to the console
+    solution_.status = status;
+    solution_.obj_value = obj_value;
+    solution_.iter_count = ip_data != NULL ? ip_data->iter_count() : 0;
+    solution_.x.assign(x, x + n);
+    solution_.z_L.assign(z_L, z_L + n);
+    solution_.z_U.assign(z_U, z_U + n);
+    solution_.g.assign(g, g + m);
+    solution_.lambda.assign(lambda, lambda + m);
+    if( !verbose_ )
+    {
+        return;
+    }
     std::cout << std::endl << std::endl << "Solution of the primal variables, x" << std::endl;
     for( Index i = 0; i < n; i++ )
     {
@@ -329,30 +535,30 @@ bool HS071_NLP::eval_h(Index n, const Number *x, bool new_x, Number obj_factor,
     {
         // return the values. This is a symmetric matrix, fill the lower left
         // triangle only
-        // fill the objective portion
-        values[0] = obj_factor * (2 * x[3]); // 0,0
-        values[1] = obj_factor * (x[3]);     // 1,0
-        values[2] = 0.;                      // 1,1
-        values[3] = obj_factor * (x[3]);     // 2,0
-        values[4] = 0.;                      // 2,1
-        values[5] = 0.;                      // 2,2
-        values[6] = obj_factor * (2 * x[0] + x[1] + x[2]); // 3,0
-        values[7] = obj_factor * (x[0]);                   // 3,1
-        values[8] = obj_factor * (x[0]);                   // 3,2
-        values[9] = 0.;                                    // 3,3
-        // add the portion for the first constraint
-        values[1] += lambda[0] * (x[2] * x[3]); // 1,0
-        values[3] += lambda[0] * (x[1] * x[3]); // 2,0
-        values[4] += lambda[0] * (x[0] * x[3]); // 2,1
-        values[6] += lambda[0] * (x[1] * x[2]); // 3,0
-        values[7] += lambda[0] * (x[0] * x[2]); // 3,1
-        values[8] += lambda[0] * (x[0] * x[1]); // 3,2
-        // add the portion for the second constraint
-        values[0] += lambda[1] * 2; // 0,0
-        values[2] += lambda[1] * 2; // 1,1
-        values[5] += lambda[1] * 2; // 2,2
-        values[9] += lambda[1] * 2; // 3,3
+        if( new_x )
+        {
+            // the first-order values are only reused while new_x is false, which refers to this x now
+            first_order_.valid = false;
+        }
+        hessian_.update(x);
+        hessian_.combine(obj_factor, lambda, values);
     }
     return true;
 
-};
\ No newline at end of file
+};
+
+bool HS071_NLP::intermediate_callback(AlgorithmMode mode, Index iter, Number obj_value, Number inf_pr, Number inf_du,
+                                      Number mu, Number d_norm, Number regularization_size, Number alpha_du,
+                                      Number alpha_pr, Index ls_trials, const IpoptData *ip_data,
+                                      IpoptCalculatedQuantities *ip_cq) {
+    // Intermediate Callback method for the user.
+
+    // This method is called once per iteration (during the convergence check), and can be used to obtain information
+    // about the optimization status while Ipopt solves the problem, and also to request a premature termination.
+
+    // Returns
+    // false if Ipopt should stop (USER_REQUESTED_STOP), true otherwise.
+
+    return stop_flag_ == NULL || !stop_flag_->load(std::memory_order_relaxed);
+
+};
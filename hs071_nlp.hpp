@@ -5,15 +5,125 @@
 #ifndef __HS071_NLP_HPP
 #define __HS071_NLP_HPP
 
+#include "IpIpoptApplication.hpp"
 #include "IpTNLP.hpp"
 
 #include <assert.h>
+#include <atomic>
 #include <iostream>
+#include <vector>
 
 using namespace Ipopt;
 
+// runtime parameters of the HS071 problem, used as indices into HS071_NLP::set_parameter / get_parameter
+enum HS071_Parameter {
+    HS071_G0_LOWER = 0, // lower bound of the product constraint g0 (25 in the original problem)
+    HS071_G1_RHS   = 1, // right hand side of the sum of squares equality g1 (40 in the original problem)
+    HS071_NUM_PARAMETERS
+};
+
+// everything finalize_solution hands back, kept so that drivers can inspect the solution and warm start from it
+struct HS071_Solution {
+    SolverReturn status = UNASSIGNED;
+    Number obj_value = 0.;
+    Index iter_count = 0;
+    std::vector<Number> x;
+    std::vector<Number> z_L;
+    std::vector<Number> z_U;
+    std::vector<Number> g;
+    std::vector<Number> lambda;
+};
+
+// f and g of HS071 for any scalar type with the arithmetic of Number, e.g. DependencyScalar to detect the sparsity
+template<class T>
+T HS071_objective(const T *x) {
+    return x[0] * x[3] * (x[0] + x[1] + x[2]) + x[2];
+}
+
+template<class T>
+void HS071_constraints(const T *x, T *g) {
+    g[0] = x[0] * x[1] * x[2] * x[3];
+    g[1] = x[0] * x[0] + x[1] * x[1] + x[2] * x[2] + x[3] * x[3];
+}
+
+// f, grad f, g and the Jacobian values (in the order of HS071_NLP::eval_jac_g) of HS071 at x in a single pass that
+// shares the products of x between them
+void HS071_eval_first_order(const Number *x, Number &f, Number *grad_f, Number *g, Number *jac);
+
+// The result of HS071_eval_first_order at the last x. Ipopt asks for the four parts in separate callbacks at the same
+// x; the first one evaluates, the others copy.
+struct HS071_FirstOrder {
+    static const Index NNZ_JAC = 8;
+
+    Number f;
+    Number grad_f[4];
+    Number g[2];
+    Number jac[NNZ_JAC];
+    bool valid = false;
+
+    // evaluates everything at x if new_x or nothing has been evaluated yet; otherwise x must be the last point, as
+    // promised by Ipopt's new_x
+    void update(const Number *x, bool new_x);
+};
+
+// Hessians of the objective, g0 and g1 at one x, kept apart so that the Hessian of the Lagrangian for new multipliers
+// is a weighted sum instead of a re-evaluation. Entries are the lower triangle in the order of HS071_NLP::eval_h.
+struct HS071_HessianComponents {
+    static const Index NNZ = 10;
+
+    Number x[4];
+    Number f[NNZ];
+    Number g0[NNZ];
+    Number g1[NNZ];
+    bool valid = false;
+
+    // evaluates the three Hessians unless they are already those at x; returns whether it did
+    bool update(const Number *x);
+    // values = obj_factor * f + lambda[0] * g0 + lambda[1] * g1
+    void combine(Number obj_factor, const Number *lambda, Number *values) const;
+};
+
 class HS071_NLP: public TNLP {
 
+public:
+    HS071_NLP(Number g0_lower = 25.0, Number g1_rhs = 40.0);
+
+    // runtime parameters, see HS071_Parameter
+    void set_parameter(Index p, Number value);
+    Number get_parameter(Index p) const;
+
+    // box of variable i, [1,5] in the original problem; branching tightens it
+    void set_variable_bounds(Index i, Number lower, Number upper);
+    Number get_variable_lower(Index i) const { return x_l_[i]; }
+    Number get_variable_upper(Index i) const { return x_u_[i]; }
+
+    // primal-dual point handed out by get_starting_point; x alone is used unless Ipopt asks for the multipliers
+    // (warm_start_init_point = yes)
+    void set_warm_start(const std::vector<Number> &x, const std::vector<Number> &z_L, const std::vector<Number> &z_U,
+                        const std::vector<Number> &lambda);
+    void set_warm_start(const HS071_Solution &sol);
+    // primal starting point only, the multipliers are set to zero
+    void set_starting_point(const std::vector<Number> &x);
+    void clear_warm_start();
+    bool has_warm_start() const { return !warm_x_.empty(); }
+
+    // once *flag becomes true, intermediate_callback asks Ipopt to stop (USER_REQUESTED_STOP); NULL disables it
+    void set_stop_flag(const std::atomic<bool> *flag) { stop_flag_ = flag; }
+
+    // whether finalize_solution writes the solution to the console
+    void set_verbose(bool verbose) { verbose_ = verbose; }
+
+    // whether eval_f, eval_grad_f, eval_g and eval_jac_g are served from one HS071_eval_first_order per x or each
+    // evaluate their own formulas (the default). The HS071 formulas are cheap enough that copying out of the fused
+    // result costs more than the shared products save, see EvalBench. With fusion the callbacks are not safe to call
+    // concurrently on one instance.
+    void set_fused_evaluation(bool fused) { fused_ = fused; }
+
+    // the outcome of the last solve; empty (UNASSIGNED, no x) after clear_solution until finalize_solution is reached
+    const HS071_Solution &solution() const { return solution_; }
+    // to be called before a solve, so that one aborted before finalize_solution does not leave the previous outcome
+    void clear_solution() { solution_ = HS071_Solution(); }
+
     // pure virtual methods from Ipopt::TNLP class to be implemented here
     bool get_nlp_info(Index &n, Index &m, Index &nnz_jac_g, Index &nnz_h_lag, IndexStyleEnum &index_style);
     bool get_bounds_info(Index n, Number *x_l, Number *x_u, Index m, Number *g_l, Number *g_u);
@@ -26,10 +136,38 @@ class HS071_NLP: public TNLP {
     void finalize_solution (SolverReturn status, Index n, const Number *x, const Number *z_L, const Number *z_U, Index m,
             const Number *g, const Number *lambda, Number obj_value, const IpoptData *ip_data, IpoptCalculatedQuantities *ip_cq);
 
-    // function for evaluting the Hessian of the Lagrangian
+    // function for evaluting the Hessian of the Lagrangian; the component Hessians are cached per x, so a call that
+    // only changes obj_factor or lambda (line search, restoration) only recombines them. Not safe to call
+    // concurrently on one instance.
     bool eval_h(Index n, const Number *x, bool new_x, Number obj_factor, Index m, const Number *lambda, bool new_lambda,
                     Index nele_hess, Index *iRow, Index *jCol, Number *values);
 
+    // called once per iteration, used to stop the solve on request
+    bool intermediate_callback(AlgorithmMode mode, Index iter, Number obj_value, Number inf_pr, Number inf_du, Number mu,
+                               Number d_norm, Number regularization_size, Number alpha_du, Number alpha_pr,
+                               Index ls_trials, const IpoptData *ip_data, IpoptCalculatedQuantities *ip_cq);
+
+private:
+    Number params_[HS071_NUM_PARAMETERS];
+    Number x_l_[4];
+    Number x_u_[4];
+
+    std::vector<Number> warm_x_;
+    std::vector<Number> warm_z_L_;
+    std::vector<Number> warm_z_U_;
+    std::vector<Number> warm_lambda_;
+
+    const std::atomic<bool> *stop_flag_;
+    bool verbose_;
+    bool fused_;
+    HS071_Solution solution_;
+    HS071_FirstOrder first_order_;
+    HS071_HessianComponents hessian_;
+
 };
 
+// Switches warm_start_init_point on app and, when on, shrinks the warm start bound pushes so that a primal-dual
+// warm start from a nearby solution is kept where it is instead of being pushed back into the interior
+void HS071_set_warm_start_options(const SmartPtr<IpoptApplication> &app, bool on);
+
 #endif //__HS071_NLP_HPP
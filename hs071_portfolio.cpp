@@ -0,0 +1,147 @@
+//
+// Solver configuration portfolio for HS071, see hs071_portfolio.hpp
+//
+
+#include "hs071_portfolio.hpp"
+
+#include "IpJournalist.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+HS071_Portfolio::HS071_Portfolio(const std::vector<HS071_SolverConfig> &configs)
+        : configs_(configs), apps_(configs.size()), stats_(configs.size()),
+          pool_(new WorkStealingPool((unsigned) configs.size())) {
+    for( size_t k = 0; k < configs_.size(); k++ )
+    {
+        apps_[k] = IpoptApplicationFactory();
+        apps_[k]->Options()->SetIntegerValue("print_level", 0);
+        std::istringstream options(configs_[k].options);
+        apps_[k]->Options()->ReadFromStream(*apps_[k]->Jnlst(), options, true);
+        if( apps_[k]->Initialize() != Solve_Succeeded )
+        {
+            // a configuration Ipopt does not accept (e.g. a linear solver that is not available) never races
+            apps_[k] = NULL;
+        }
+    }
+}
+
+std::vector<HS071_SolverConfig> HS071_Portfolio::default_portfolio() {
+    std::vector<HS071_SolverConfig> configs;
+    configs.push_back({"adaptive-exact", "mu_strategy adaptive\nhessian_approximation exact\n"});
+    configs.push_back({"monotone-exact", "mu_strategy monotone\nhessian_approximation exact\n"});
+    configs.push_back({"adaptive-lbfgs", "mu_strategy adaptive\nhessian_approximation limited-memory\n"});
+    configs.push_back({"monotone-noscaling", "mu_strategy monotone\nnlp_scaling_method none\n"});
+    return configs;
+}
+
+HS071_RaceResult HS071_Portfolio::race(Number g0_lower, Number g1_rhs) {
+    HS071_RaceResult result;
+    std::atomic<bool> cancel(false);
+    std::mutex mutex;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for( size_t k = 0; k < configs_.size(); k++ )
+    {
+        if( IsNull(apps_[k]) )
+        {
+            continue;
+        }
+        pool_->submit([this, k, g0_lower, g1_rhs, start, &cancel, &mutex, &result]() {
+            SmartPtr<HS071_NLP> nlp = new HS071_NLP(g0_lower, g1_rhs);
+            nlp->set_verbose(false);
+            nlp->set_stop_flag(&cancel);
+            ApplicationReturnStatus status = apps_[k]->OptimizeTNLP(nlp);
+            const Number elapsed = std::chrono::duration<Number>(std::chrono::steady_clock::now() - start).count();
+            const bool success = status == Solve_Succeeded || status == Solved_To_Acceptable_Level;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            stats_[k].races++;
+            if( success && !result.solved )
+            {
+                // first successful finisher wins and stops the others at their next iteration
+                cancel = true;
+                result.solved = true;
+                result.winner = (Index) k;
+                result.wall_time = elapsed;
+                result.solution = nlp->solution();
+                stats_[k].wins++;
+                stats_[k].win_wall_time += elapsed;
+            }
+            else if( status == User_Requested_Stop )
+            {
+                stats_[k].cancelled++;
+            }
+            else if( !success )
+            {
+                stats_[k].failures++;
+                if( !result.solved )
+                {
+                    result.wall_time = elapsed;
+                }
+            }
+        });
+    }
+    pool_->wait();
+    return result;
+}
+
+bool HS071_Portfolio::write_statistics(const std::string &path) const {
+    std::ofstream out(path.c_str());
+    for( size_t k = 0; k < configs_.size() && out; k++ )
+    {
+        out << configs_[k].name << " " << stats_[k].races << " " << stats_[k].wins << " " << stats_[k].failures << " "
+            << stats_[k].cancelled << " " << stats_[k].win_wall_time << "\n";
+    }
+    return (bool) out;
+}
+
+bool HS071_Portfolio::read_statistics(const std::string &path) {
+    std::ifstream in(path.c_str());
+    if( !in )
+    {
+        return false;
+    }
+    std::string name;
+    HS071_ConfigStats s;
+    while( in >> name >> s.races >> s.wins >> s.failures >> s.cancelled >> s.win_wall_time )
+    {
+        for( size_t k = 0; k < configs_.size(); k++ )
+        {
+            if( configs_[k].name == name )
+            {
+                stats_[k].races += s.races;
+                stats_[k].wins += s.wins;
+                stats_[k].failures += s.failures;
+                stats_[k].cancelled += s.cancelled;
+                stats_[k].win_wall_time += s.win_wall_time;
+            }
+        }
+    }
+    return in.eof();
+}
+
+std::vector<HS071_SolverConfig> HS071_Portfolio::ranked(Index k) const {
+    std::vector<size_t> order(configs_.size());
+    for( size_t i = 0; i < order.size(); i++ )
+    {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        if( stats_[a].wins != stats_[b].wins )
+        {
+            return stats_[a].wins > stats_[b].wins;
+        }
+        return stats_[a].wins > 0 && stats_[a].win_wall_time / stats_[a].wins < stats_[b].win_wall_time / stats_[b].wins;
+    });
+    std::vector<HS071_SolverConfig> best;
+    for( size_t i = 0; i < order.size() && (Index) i < k; i++ )
+    {
+        best.push_back(configs_[order[i]]);
+    }
+    return best;
+}
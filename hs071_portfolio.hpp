@@ -0,0 +1,72 @@
+//
+// Solver configuration portfolio for HS071: races K differently configured solves of the same instance on K
+// threads, keeps the first successful result and cancels the others through intermediate_callback. Win statistics
+// per configuration are kept so that a default portfolio can be learned from a workload.
+//
+
+#ifndef __HS071_PORTFOLIO_HPP
+#define __HS071_PORTFOLIO_HPP
+
+#include "IpIpoptApplication.hpp"
+#include "hs071_nlp.hpp"
+#include "work_stealing_pool.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Ipopt;
+
+// a named set of Ipopt options in the syntax of an ipopt.opt file ("name value" per line)
+struct HS071_SolverConfig {
+    std::string name;
+    std::string options;
+};
+
+struct HS071_ConfigStats {
+    Index races = 0;
+    Index wins = 0;
+    Index failures = 0;           // finished without success before being cancelled
+    Index cancelled = 0;
+    Number win_wall_time = 0.;    // summed wall clock time of the won races, in seconds
+};
+
+struct HS071_RaceResult {
+    bool solved = false;
+    Index winner = -1;            // index of the winning configuration, -1 if none succeeded
+    Number wall_time = 0.;        // seconds until the winner finished (or the last solve failed)
+    HS071_Solution solution;
+};
+
+class HS071_Portfolio {
+
+public:
+    // one thread and one IpoptApplication per configuration, set up once and reused by every race
+    explicit HS071_Portfolio(const std::vector<HS071_SolverConfig> &configs);
+
+    // mu strategy, Hessian approximation and scaling variants
+    static std::vector<HS071_SolverConfig> default_portfolio();
+
+    // Races all configurations on the HS071 instance with the given parameters.
+    HS071_RaceResult race(Number g0_lower = 25.0, Number g1_rhs = 40.0);
+
+    const std::vector<HS071_SolverConfig> &configs() const { return configs_; }
+    const std::vector<HS071_ConfigStats> &statistics() const { return stats_; }
+
+    // Statistics are kept as one "name races wins failures cancelled win_wall_time" line per configuration.
+    // read_statistics adds the counts of configurations with a matching name.
+    bool write_statistics(const std::string &path) const;
+    bool read_statistics(const std::string &path);
+
+    // the k configurations with the most wins (ties broken by the mean winning time), best first
+    std::vector<HS071_SolverConfig> ranked(Index k) const;
+
+private:
+    std::vector<HS071_SolverConfig> configs_;
+    std::vector<SmartPtr<IpoptApplication> > apps_;
+    std::vector<HS071_ConfigStats> stats_;
+    std::unique_ptr<WorkStealingPool> pool_;
+
+};
+
+#endif //__HS071_PORTFOLIO_HPP
@@ -0,0 +1,152 @@
+//
+// Interval presolve for HS071, see hs071_presolve.hpp
+//
+
+#include "hs071_presolve.hpp"
+
+// One forward-backward sweep over g0 and g1 on the box x; returns false if some interval became empty.
+static bool revise(Interval x[4], const Interval &g0_bounds, const Interval &g1_bounds) {
+    // forward: evaluate every node of the expression trees and clip the roots to the constraint bounds
+    Interval p01 = x[0] * x[1], p23 = x[2] * x[3];
+    const Interval g0 = intersect(p01 * p23, g0_bounds);
+    Interval s[4];
+    for( Index i = 0; i < 4; i++ )
+    {
+        s[i] = sqr(x[i]);
+    }
+    Interval a = s[0] + s[1], b = s[2] + s[3];
+    const Interval g1 = intersect(a + b, g1_bounds);
+    if( g0.empty() || g1.empty() )
+    {
+        return false;
+    }
+
+    // backward: solve every node for each of its children and intersect
+    p01 = intersect(p01, g0 / p23);
+    p23 = intersect(p23, g0 / p01);
+    x[0] = intersect(x[0], p01 / x[1]);
+    x[1] = intersect(x[1], p01 / x[0]);
+    x[2] = intersect(x[2], p23 / x[3]);
+    x[3] = intersect(x[3], p23 / x[2]);
+
+    a = intersect(a, g1 - b);
+    b = intersect(b, g1 - a);
+    s[0] = intersect(s[0], a - s[1]);
+    s[1] = intersect(s[1], a - s[0]);
+    s[2] = intersect(s[2], b - s[3]);
+    s[3] = intersect(s[3], b - s[2]);
+    for( Index i = 0; i < 4; i++ )
+    {
+        x[i] = sqr_inverse(s[i], x[i]);
+        if( x[i].empty() )
+        {
+            return false;
+        }
+    }
+    return !p01.empty() && !p23.empty() && !a.empty() && !b.empty();
+}
+
+// propagates the constraint bounds of nlp on the box x, counting the sweeps
+static bool propagate(HS071_NLP &nlp, Interval x[4], const HS071_PresolveOptions &options, Index &sweeps) {
+    Number x_l[4], x_u[4], g_l[2], g_u[2];
+    nlp.get_bounds_info(4, x_l, x_u, 2, g_l, g_u);
+    // Ipopt's default nlp_upper_bound_inf and nlp_lower_bound_inf
+    const Number inf = std::numeric_limits<Number>::infinity();
+    Interval bounds[2];
+    for( Index j = 0; j < 2; j++ )
+    {
+        const Number lower = g_l[j] - options.feasibility_tol * std::max(1., std::fabs(g_l[j]));
+        const Number upper = g_u[j] + options.feasibility_tol * std::max(1., std::fabs(g_u[j]));
+        bounds[j] = Interval(g_l[j] <= -1e19 ? -inf : lower, g_u[j] >= 1e19 ? inf : upper);
+    }
+
+    for( sweeps = 1; sweeps <= options.max_sweeps; sweeps++ )
+    {
+        Interval before[4];
+        std::copy(x, x + 4, before);
+        if( !revise(x, bounds[0], bounds[1]) )
+        {
+            return false;
+        }
+        Number shrink = 0.;
+        for( Index i = 0; i < 4; i++ )
+        {
+            if( before[i].width() > 0. && std::isfinite(before[i].width()) )
+            {
+                shrink = std::max(shrink, 1. - x[i].width() / before[i].width());
+            }
+        }
+        if( shrink <= options.min_shrink )
+        {
+            break;
+        }
+    }
+    sweeps = std::min(sweeps, options.max_sweeps);
+    return true;
+}
+
+HS071_PresolveResult HS071_presolve(HS071_NLP &nlp, const HS071_PresolveOptions &options) {
+    HS071_PresolveResult result;
+    Number x_l[4], x_u[4], g_l[2], g_u[2];
+    nlp.get_bounds_info(4, x_l, x_u, 2, g_l, g_u);
+    for( Index i = 0; i < 4; i++ )
+    {
+        result.x[i] = Interval(x_l[i], x_u[i]);
+    }
+    result.infeasible = !propagate(nlp, result.x, options, result.sweeps);
+    if( !result.infeasible )
+    {
+        for( Index i = 0; i < 4; i++ )
+        {
+            result.tightened += (result.x[i].lo > x_l[i]) + (result.x[i].hi < x_u[i]);
+        }
+    }
+    return result;
+}
+
+bool HS071_contract_box(HS071_NLP &nlp, Number *x_l, Number *x_u, const HS071_PresolveOptions &options) {
+    Interval x[4];
+    for( Index i = 0; i < 4; i++ )
+    {
+        x[i] = Interval(x_l[i], x_u[i]);
+    }
+    Index sweeps;
+    if( !propagate(nlp, x, options, sweeps) )
+    {
+        return false;
+    }
+    for( Index i = 0; i < 4; i++ )
+    {
+        // outward rounding can leave the contracted interval a hair outside the original one
+        x_l[i] = std::max(x_l[i], x[i].lo);
+        x_u[i] = std::min(x_u[i], x[i].hi);
+    }
+    return true;
+}
+
+ApplicationReturnStatus HS071_presolve_and_solve(const SmartPtr<IpoptApplication> &app, const SmartPtr<HS071_NLP> &nlp,
+                                                 HS071_PresolveResult *result, const HS071_PresolveOptions &options) {
+    HS071_PresolveResult presolve = HS071_presolve(*nlp, options);
+    if( result != NULL )
+    {
+        *result = presolve;
+    }
+    if( presolve.infeasible )
+    {
+        return Infeasible_Problem_Detected;
+    }
+    // the tightened box is for this solve only, the caller's bounds come back afterwards
+    Number lower[4], upper[4];
+    for( Index i = 0; i < 4; i++ )
+    {
+        lower[i] = nlp->get_variable_lower(i);
+        upper[i] = nlp->get_variable_upper(i);
+        nlp->set_variable_bounds(i, std::max(presolve.x[i].lo, lower[i]), std::min(presolve.x[i].hi, upper[i]));
+    }
+    const ApplicationReturnStatus status = app->OptimizeTNLP(nlp);
+    for( Index i = 0; i < 4; i++ )
+    {
+        nlp->set_variable_bounds(i, lower[i], upper[i]);
+    }
+    return status;
+}
@@ -0,0 +1,46 @@
+//
+// Interval presolve for HS071. The variable box is propagated forward through the expression trees of
+//     g0 = (x0 x1) (x2 x3) >= g0_lower,    g1 = x0^2 + x1^2 + x2^2 + x3^2 = g1_rhs
+// the constraint ranges are intersected with their bounds, and the result is propagated backward to the variables
+// (HC4 revise). Sweeps repeat until the box stops shrinking. An empty interval anywhere proves the parameter set
+// infeasible before Ipopt is called; otherwise the tightened box replaces the variable bounds.
+//
+
+#ifndef __HS071_PRESOLVE_HPP
+#define __HS071_PRESOLVE_HPP
+
+#include "IpIpoptApplication.hpp"
+#include "hs071_nlp.hpp"
+#include "interval.hpp"
+
+using namespace Ipopt;
+
+struct HS071_PresolveOptions {
+    Index max_sweeps = 20;
+    Number min_shrink = 1e-3;        // stop once a sweep shrinks no side by more than this fraction of its width
+    Number feasibility_tol = 1e-8;   // constraint bounds are relaxed by this (relative) before propagation
+};
+
+struct HS071_PresolveResult {
+    bool infeasible = false;
+    Index sweeps = 0;
+    Index tightened = 0;   // variable bounds that moved
+    Interval x[4];         // the tightened box, meaningless if infeasible
+};
+
+// Propagates the variable box and constraint bounds of nlp; nlp is not changed.
+HS071_PresolveResult HS071_presolve(HS071_NLP &nlp, const HS071_PresolveOptions &options = HS071_PresolveOptions());
+
+// Tightens the box [x_l, x_u] in place for the constraint bounds of nlp; returns false if it is proven infeasible.
+// Used by the branch-and-bound searches for their root boxes.
+bool HS071_contract_box(HS071_NLP &nlp, Number *x_l, Number *x_u,
+                        const HS071_PresolveOptions &options = HS071_PresolveOptions());
+
+// Presolves nlp and solves it with app within the tightened variable bounds, which are restored to those of nlp
+// before returning; returns Infeasible_Problem_Detected without calling Ipopt if the presolve proves infeasibility.
+// The result of the presolve is stored in *result if given.
+ApplicationReturnStatus HS071_presolve_and_solve(const SmartPtr<IpoptApplication> &app, const SmartPtr<HS071_NLP> &nlp,
+                                                 HS071_PresolveResult *result = NULL,
+                                                 const HS071_PresolveOptions &options = HS071_PresolveOptions());
+
+#endif //__HS071_PRESOLVE_HPP
@@ -0,0 +1,97 @@
+//
+// Deadline-aware real-time solves of HS071, see hs071_realtime.hpp
+//
+
+#include "hs071_realtime.hpp"
+
+#include "IpSolveStatistics.hpp"
+
+#include <algorithm>
+
+HS071_RealTimeNLP::HS071_RealTimeNLP(Number g0_lower, Number g1_rhs, Number feasibility_tol)
+        : HS071_NLP(g0_lower, g1_rhs), feasibility_tol_(feasibility_tol), deadline_(HS071_Clock::time_point::max()),
+          deadline_hit_(false), has_best_(false), best_obj_(0.), best_inf_pr_(0.), best_x_(4), best_lambda_(2),
+          z_L_(4), z_U_(4), g_(2) {
+}
+
+void HS071_RealTimeNLP::arm(HS071_Clock::time_point deadline) {
+    deadline_ = deadline;
+    deadline_hit_ = false;
+    has_best_ = false;
+    // a solve that stops before finalize_solution must not hand out the previous one's iterate
+    clear_solution();
+}
+
+bool HS071_RealTimeNLP::intermediate_callback(AlgorithmMode mode, Index iter, Number obj_value, Number inf_pr,
+                                              Number inf_du, Number mu, Number d_norm, Number regularization_size,
+                                              Number alpha_du, Number alpha_pr, Index ls_trials,
+                                              const IpoptData *ip_data, IpoptCalculatedQuantities *ip_cq) {
+    // Iterates of the restoration phase belong to a different problem, only regular iterates are candidates.
+    // The iterate is only fetched when it improves on the best one, so most calls cost a clock read.
+    if( mode == RegularMode && inf_pr <= feasibility_tol_ && (!has_best_ || obj_value < best_obj_) )
+    {
+        if( get_curr_iterate(ip_data, ip_cq, false, 4, best_x_.data(), z_L_.data(), z_U_.data(), 2, g_.data(),
+                             best_lambda_.data()) )
+        {
+            has_best_ = true;
+            best_obj_ = obj_value;
+            best_inf_pr_ = inf_pr;
+        }
+    }
+    if( HS071_Clock::now() >= deadline_ )
+    {
+        deadline_hit_ = true;
+        return false;
+    }
+    return HS071_NLP::intermediate_callback(mode, iter, obj_value, inf_pr, inf_du, mu, d_norm, regularization_size,
+                                            alpha_du, alpha_pr, ls_trials, ip_data, ip_cq);
+}
+
+HS071_RealTimeResult HS071_solve_with_deadline(const SmartPtr<IpoptApplication> &app,
+                                               const SmartPtr<HS071_RealTimeNLP> &nlp,
+                                               HS071_Clock::time_point deadline,
+                                               SolveLatencyRecorder *latency) {
+    HS071_RealTimeResult result;
+    const HS071_Clock::time_point start = HS071_Clock::now();
+    // Ipopt checks max_wall_time once per iteration as well; it catches a deadline missed by a restoration phase
+    // that does not call back in regular mode
+    app->Options()->SetNumericValue("max_wall_time",
+                                    std::max(1e-6, std::chrono::duration<Number>(deadline - start).count()));
+    nlp->arm(deadline);
+    result.ipopt_status = app->OptimizeTNLP(nlp);
+    result.wall_time = std::chrono::duration<Number>(HS071_Clock::now() - start).count();
+
+    const HS071_Solution &sol = nlp->solution();
+    // from the application, as optimize_timed does: a solve that stops before finalize_solution has none in sol
+    SmartPtr<SolveStatistics> statistics = app->Statistics();
+    result.iterations = IsValid(statistics) ? statistics->IterationCount() : 0;
+    if( latency != NULL )
+    {
+        latency->record(result.ipopt_status, result.iterations, result.wall_time);
+    }
+    const bool timed_out = nlp->deadline_hit() || result.ipopt_status == Maximum_WallTime_Exceeded;
+    if( result.ipopt_status == Solve_Succeeded || result.ipopt_status == Solved_To_Acceptable_Level )
+    {
+        result.status = HS071_RT_CONVERGED;
+        result.x = sol.x;
+        result.lambda = sol.lambda;
+        result.obj_value = sol.obj_value;
+    }
+    else if( timed_out && nlp->has_best() )
+    {
+        result.status = HS071_RT_BEST_ITERATE;
+        result.x = nlp->best_x();
+        result.lambda = nlp->best_lambda();
+        result.obj_value = nlp->best_obj_value();
+        result.constraint_violation = nlp->best_constraint_violation();
+    }
+    else
+    {
+        // the last iterate as handed to finalize_solution, if the solve got that far
+        result.status = timed_out ? HS071_RT_INFEASIBLE_ITERATE : HS071_RT_FAILED;
+        result.x = sol.x;
+        result.lambda = sol.lambda;
+        result.obj_value = sol.obj_value;
+    }
+    return result;
+}
@@ -0,0 +1,82 @@
+//
+// Deadline-aware real-time solves of HS071: the solve is stopped from intermediate_callback once a wall clock
+// deadline has passed, and the best feasible iterate seen so far is returned instead of waiting for convergence.
+//
+
+#ifndef __HS071_REALTIME_HPP
+#define __HS071_REALTIME_HPP
+
+#include "IpIpoptApplication.hpp"
+#include "hs071_nlp.hpp"
+#include "solve_latency.hpp"
+
+#include <chrono>
+#include <vector>
+
+using namespace Ipopt;
+
+typedef std::chrono::steady_clock HS071_Clock;
+
+enum HS071_RealTimeStatus {
+    HS071_RT_CONVERGED,           // Ipopt converged before the deadline
+    HS071_RT_BEST_ITERATE,        // deadline hit, x is the best feasible iterate seen
+    HS071_RT_INFEASIBLE_ITERATE,  // deadline hit before any feasible iterate, x is the last iterate (if any)
+    HS071_RT_FAILED               // Ipopt stopped for another reason before the deadline
+};
+
+struct HS071_RealTimeResult {
+    HS071_RealTimeStatus status = HS071_RT_FAILED;
+    ApplicationReturnStatus ipopt_status = Internal_Error;
+    Number obj_value = 0.;
+    Number constraint_violation = 0.;
+    Index iterations = 0;
+    Number wall_time = 0.;        // seconds spent in OptimizeTNLP
+    std::vector<Number> x;
+    std::vector<Number> lambda;
+};
+
+class HS071_RealTimeNLP: public HS071_NLP {
+
+public:
+    // iterates whose constraint violation (max norm, unscaled) is at most feasibility_tol count as feasible
+    HS071_RealTimeNLP(Number g0_lower = 25.0, Number g1_rhs = 40.0, Number feasibility_tol = 1e-6);
+
+    // Sets the deadline of the next solve and forgets the best iterate and the solution of the previous one.
+    void arm(HS071_Clock::time_point deadline);
+
+    bool deadline_hit() const { return deadline_hit_; }
+    bool has_best() const { return has_best_; }
+    Number best_obj_value() const { return best_obj_; }
+    Number best_constraint_violation() const { return best_inf_pr_; }
+    const std::vector<Number> &best_x() const { return best_x_; }
+    const std::vector<Number> &best_lambda() const { return best_lambda_; }
+
+    // checks the deadline and records the iterate if it is the best feasible one so far
+    bool intermediate_callback(AlgorithmMode mode, Index iter, Number obj_value, Number inf_pr, Number inf_du, Number mu,
+                               Number d_norm, Number regularization_size, Number alpha_du, Number alpha_pr,
+                               Index ls_trials, const IpoptData *ip_data, IpoptCalculatedQuantities *ip_cq);
+
+private:
+    Number feasibility_tol_;
+    HS071_Clock::time_point deadline_;
+    bool deadline_hit_;
+    bool has_best_;
+    Number best_obj_;
+    Number best_inf_pr_;
+    // preallocated so that the callback does not allocate
+    std::vector<Number> best_x_;
+    std::vector<Number> best_lambda_;
+    std::vector<Number> z_L_;
+    std::vector<Number> z_U_;
+    std::vector<Number> g_;
+
+};
+
+// Solves nlp with app, returning no later than about one Ipopt iteration after deadline. app must be initialized;
+// its max_wall_time is set to the remaining budget as a backstop. The solve is recorded in latency if that is set.
+HS071_RealTimeResult HS071_solve_with_deadline(const SmartPtr<IpoptApplication> &app,
+                                               const SmartPtr<HS071_RealTimeNLP> &nlp,
+                                               HS071_Clock::time_point deadline,
+                                               SolveLatencyRecorder *latency = NULL);
+
+#endif //__HS071_REALTIME_HPP
@@ -0,0 +1,198 @@
+//
+// Parametric sensitivities of the HS071 solution, see hs071_sensitivity.hpp
+//
+// At a solution with active constraints A and free variables F the KKT conditions
+//     grad_F f(x) + J_AF(x)^T lambda_A = 0,    g_A(x) = b_A(p)
+// hold with the variables at an active bound fixed. Differentiating w.r.t. p gives
+//     [ H_FF  J_AF^T ] [ dx_F      ]   [ 0        ]
+//     [ J_AF  0      ] [ dlambda_A ] = [ db_A/dp  ]
+// with H the Hessian of the Lagrangian. Fixed variables and inactive multipliers do not move.
+//
+
+#include "hs071_sensitivity.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+HS071_Sensitivity::HS071_Sensitivity() : n_(0), m_(0), factored_(false) {
+}
+
+bool HS071_Sensitivity::factorize(HS071_NLP &nlp) {
+    factored_ = false;
+    const HS071_Solution &sol = nlp.solution();
+    if( sol.status != SUCCESS && sol.status != STOP_AT_ACCEPTABLE_POINT )
+    {
+        return false;
+    }
+
+    Index n, m, nnz_jac_g, nnz_h_lag;
+    TNLP::IndexStyleEnum index_style;
+    nlp.get_nlp_info(n, m, nnz_jac_g, nnz_h_lag, index_style);
+    n_ = n;
+    m_ = m;
+    std::vector<Number> x_l(n), x_u(n), g_l(m), g_u(m);
+    nlp.get_bounds_info(n, x_l.data(), x_u.data(), m, g_l.data(), g_u.data());
+
+    // A bound is active when its multiplier exceeds the distance to it. At an interior point solution the products
+    // of the two are of the order of mu, so this needs no tolerance as long as strict complementarity holds.
+    free_.clear();
+    for( Index i = 0; i < n; i++ )
+    {
+        if( sol.z_L[i] <= sol.x[i] - x_l[i] && sol.z_U[i] <= x_u[i] - sol.x[i] )
+        {
+            free_.push_back(i);
+        }
+    }
+    active_g_.clear();
+    for( Index i = 0; i < m; i++ )
+    {
+        Number dist = std::min(sol.g[i] - g_l[i], g_u[i] - sol.g[i]);
+        if( g_l[i] == g_u[i] || std::fabs(sol.lambda[i]) > dist )
+        {
+            active_g_.push_back(i);
+        }
+    }
+
+    // The parameters enter HS071 only through the constraint bounds: HS071_G0_LOWER is the lower bound of g0 and
+    // HS071_G1_RHS both bounds of g1.
+    const Index nf = (Index) free_.size();
+    const Index na = (Index) active_g_.size();
+    db_dp_.assign((size_t) na * HS071_NUM_PARAMETERS, 0.);
+    for( Index a = 0; a < na; a++ )
+    {
+        if( active_g_[a] == 0 )
+        {
+            db_dp_[(size_t) HS071_G0_LOWER * na + a] = 1.;
+        }
+        else if( active_g_[a] == 1 )
+        {
+            db_dp_[(size_t) HS071_G1_RHS * na + a] = 1.;
+        }
+    }
+
+    // Hessian of the Lagrangian and constraint Jacobian at the solution, expanded to dense storage
+    std::vector<Index> iRow(std::max(nnz_jac_g, nnz_h_lag)), jCol(std::max(nnz_jac_g, nnz_h_lag));
+    std::vector<Number> values(std::max(nnz_jac_g, nnz_h_lag));
+    const Index offset = index_style == TNLP::FORTRAN_STYLE ? 1 : 0;
+    std::vector<Number> H((size_t) n * n, 0.), J((size_t) m * n, 0.);
+    nlp.eval_h(n, NULL, false, 0., m, NULL, false, nnz_h_lag, iRow.data(), jCol.data(), NULL);
+    if( !nlp.eval_h(n, sol.x.data(), true, 1., m, sol.lambda.data(), true, nnz_h_lag, NULL, NULL, values.data()) )
+    {
+        return false;
+    }
+    for( Index k = 0; k < nnz_h_lag; k++ )
+    {
+        Index r = iRow[k] - offset, c = jCol[k] - offset;
+        H[(size_t) c * n + r] += values[k];
+        if( r != c )
+        {
+            H[(size_t) r * n + c] += values[k];
+        }
+    }
+    nlp.eval_jac_g(n, NULL, false, m, nnz_jac_g, iRow.data(), jCol.data(), NULL);
+    if( !nlp.eval_jac_g(n, sol.x.data(), false, m, nnz_jac_g, NULL, NULL, values.data()) )
+    {
+        return false;
+    }
+    for( Index k = 0; k < nnz_jac_g; k++ )
+    {
+        J[(size_t) (jCol[k] - offset) * m + (iRow[k] - offset)] += values[k];
+    }
+
+    // reduced KKT matrix [H_FF J_AF^T; J_AF 0], lower triangle is enough
+    const Index dim = nf + na;
+    std::vector<Number> K((size_t) dim * dim, 0.);
+    for( Index c = 0; c < nf; c++ )
+    {
+        for( Index r = c; r < nf; r++ )
+        {
+            K[(size_t) c * dim + r] = H[(size_t) free_[c] * n + free_[r]];
+        }
+        for( Index a = 0; a < na; a++ )
+        {
+            K[(size_t) c * dim + nf + a] = J[(size_t) free_[c] * m + active_g_[a]];
+        }
+    }
+    factored_ = kkt_.factor(dim, K.data());
+    return factored_;
+}
+
+bool HS071_Sensitivity::second_order_sufficient() const {
+    return factored_ && kkt_.num_positive() == (Index) free_.size() && kkt_.num_negative() == (Index) active_g_.size();
+}
+
+void HS071_Sensitivity::directional(Index ndir, const Number *dp, Number *dx, Number *dlambda) const {
+    assert(factored_);
+    const Index nf = (Index) free_.size();
+    const Index na = (Index) active_g_.size();
+    const Index dim = nf + na;
+    std::vector<Number> rhs((size_t) dim * ndir, 0.);
+    for( Index d = 0; d < ndir; d++ )
+    {
+        for( Index a = 0; a < na; a++ )
+        {
+            Number s = 0.;
+            for( Index p = 0; p < HS071_NUM_PARAMETERS; p++ )
+            {
+                s += db_dp_[(size_t) p * na + a] * dp[(size_t) d * HS071_NUM_PARAMETERS + p];
+            }
+            rhs[(size_t) d * dim + nf + a] = s;
+        }
+    }
+    kkt_.solve(ndir, rhs.data());
+    for( Index d = 0; d < ndir; d++ )
+    {
+        std::fill(dx + (size_t) d * n_, dx + (size_t) (d + 1) * n_, 0.);
+        std::fill(dlambda + (size_t) d * m_, dlambda + (size_t) (d + 1) * m_, 0.);
+        for( Index f = 0; f < nf; f++ )
+        {
+            dx[(size_t) d * n_ + free_[f]] = rhs[(size_t) d * dim + f];
+        }
+        for( Index a = 0; a < na; a++ )
+        {
+            dlambda[(size_t) d * m_ + active_g_[a]] = rhs[(size_t) d * dim + nf + a];
+        }
+    }
+}
+
+void HS071_Sensitivity::jacobian(Number *dx_dp, Number *dlambda_dp) const {
+    Number identity[HS071_NUM_PARAMETERS * HS071_NUM_PARAMETERS] = {};
+    for( Index p = 0; p < HS071_NUM_PARAMETERS; p++ )
+    {
+        identity[p * HS071_NUM_PARAMETERS + p] = 1.;
+    }
+    directional(HS071_NUM_PARAMETERS, identity, dx_dp, dlambda_dp);
+}
+
+void HS071_Sensitivity::vjp(Index nvec, const Number *w_x, const Number *w_lambda, Number *w_p) const {
+    // the KKT matrix is symmetric, so w^T K^{-1} R = (K^{-1} w)^T R with R = [0; db_A/dp]
+    assert(factored_);
+    const Index nf = (Index) free_.size();
+    const Index na = (Index) active_g_.size();
+    const Index dim = nf + na;
+    std::vector<Number> rhs((size_t) dim * nvec, 0.);
+    for( Index v = 0; v < nvec; v++ )
+    {
+        for( Index f = 0; f < nf; f++ )
+        {
+            rhs[(size_t) v * dim + f] = w_x[(size_t) v * n_ + free_[f]];
+        }
+        for( Index a = 0; w_lambda != NULL && a < na; a++ )
+        {
+            rhs[(size_t) v * dim + nf + a] = w_lambda[(size_t) v * m_ + active_g_[a]];
+        }
+    }
+    kkt_.solve(nvec, rhs.data());
+    for( Index v = 0; v < nvec; v++ )
+    {
+        for( Index p = 0; p < HS071_NUM_PARAMETERS; p++ )
+        {
+            Number s = 0.;
+            for( Index a = 0; a < na; a++ )
+            {
+                s += db_dp_[(size_t) p * na + a] * rhs[(size_t) v * dim + nf + a];
+            }
+            w_p[(size_t) v * HS071_NUM_PARAMETERS + p] = s;
+        }
+    }
+}
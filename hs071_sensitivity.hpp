@@ -0,0 +1,54 @@
+//
+// Parametric sensitivities of the HS071 solution: d(x*, lambda*)/dp by implicit differentiation of the KKT
+// conditions at the solution reported to HS071_NLP::finalize_solution.
+//
+
+#ifndef __HS071_SENSITIVITY_HPP
+#define __HS071_SENSITIVITY_HPP
+
+#include "dense_ldlt.hpp"
+#include "hs071_nlp.hpp"
+
+#include <vector>
+
+using namespace Ipopt;
+
+class HS071_Sensitivity {
+
+public:
+    HS071_Sensitivity();
+
+    // Identifies the active set at nlp.solution() and factors the KKT matrix of the active constraints and free
+    // variables once; every call below reuses that factorization. Returns false if the last solve did not succeed or
+    // the KKT matrix is singular there (LICQ or strict complementarity fails).
+    bool factorize(HS071_NLP &nlp);
+
+    // true if the factored KKT matrix has the inertia of a strict local minimizer (second order sufficient conditions)
+    bool second_order_sufficient() const;
+
+    // Forward mode: ndir parameter directions dp (HS071_NUM_PARAMETERS x ndir, column major) to the directional
+    // derivatives dx (n x ndir) and dlambda (m x ndir). All directions are solved with one batched solve.
+    void directional(Index ndir, const Number *dp, Number *dx, Number *dlambda) const;
+
+    // dx*/dp (n x HS071_NUM_PARAMETERS) and dlambda*/dp (m x HS071_NUM_PARAMETERS), column major
+    void jacobian(Number *dx_dp, Number *dlambda_dp) const;
+
+    // Reverse mode: nvec cotangents w_x (n x nvec) and w_lambda (m x nvec, may be NULL) to
+    // w_p = (dx*/dp)^T w_x + (dlambda*/dp)^T w_lambda (HS071_NUM_PARAMETERS x nvec), with one batched solve.
+    void vjp(Index nvec, const Number *w_x, const Number *w_lambda, Number *w_p) const;
+
+    const std::vector<Index> &free_variables() const { return free_; }
+    const std::vector<Index> &active_constraints() const { return active_g_; }
+
+private:
+    Index n_;
+    Index m_;
+    std::vector<Index> free_;      // variables not held at a bound
+    std::vector<Index> active_g_;  // constraints held at a bound
+    std::vector<Number> db_dp_;    // derivative of the bound of each active constraint w.r.t. p (|active| x P, column major)
+    DenseLDLT kkt_;
+    bool factored_;
+
+};
+
+#endif //__HS071_SENSITIVITY_HPP
@@ -0,0 +1,259 @@
+//
+// Scenario-based stochastic HS071, see hs071_stochastic_nlp.hpp
+//
+
+#include "hs071_stochastic_nlp.hpp"
+
+#include "IpIpoptData.hpp"
+
+#include <algorithm>
+#include <random>
+
+const Index HS071_StochasticNLP::FIRST_N;
+const Index HS071_StochasticNLP::SCENARIO_N;
+const Index HS071_StochasticNLP::SCENARIO_M;
+const Index HS071_StochasticNLP::SCENARIO_CHUNK;
+
+// Jacobian entries per scenario: x and y_s in the g0 row, x, u_s and v_s in the g1 row
+static const Index SCENARIO_NNZ_JAC = 11;
+// the Hessian is the dense lower triangle of the x block
+static const Index NNZ_H = 10;
+
+HS071_StochasticNLP::HS071_StochasticNLP(Index num_scenarios, const std::shared_ptr<WorkStealingPool> &pool,
+                                         Number recourse_cost_g0, Number recourse_cost_g1)
+        : S_(num_scenarios), pool_(pool), q0_(recourse_cost_g0), q1_(recourse_cost_g1), stage_(new HS071_NLP()) {
+    assert(num_scenarios > 0);
+    b0_.assign(S_, stage_->get_parameter(HS071_G0_LOWER));
+    b1_.assign(S_, stage_->get_parameter(HS071_G1_RHS));
+}
+
+void HS071_StochasticNLP::set_scenario_parameter(Index s, Index p, Number value) {
+    assert(p == HS071_G0_LOWER || p == HS071_G1_RHS);
+    (p == HS071_G0_LOWER ? b0_ : b1_)[s] = value;
+}
+
+Number HS071_StochasticNLP::get_scenario_parameter(Index s, Index p) const {
+    assert(p == HS071_G0_LOWER || p == HS071_G1_RHS);
+    return (p == HS071_G0_LOWER ? b0_ : b1_)[s];
+}
+
+void HS071_StochasticNLP::sample_scenarios(unsigned seed, Number sigma_g0, Number sigma_g1) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<Number> normal(0., 1.);
+    const Number b0 = stage_->get_parameter(HS071_G0_LOWER);
+    const Number b1 = stage_->get_parameter(HS071_G1_RHS);
+    for( Index s = 0; s < S_; s++ )
+    {
+        b0_[s] = b0 + sigma_g0 * normal(rng);
+        b1_[s] = b1 + sigma_g1 * normal(rng);
+    }
+}
+
+void HS071_StochasticNLP::for_each_chunk(const std::function<void(Index, Index, Index)> &body) {
+    const Index chunks = num_chunks();
+    for( Index c = 0; c < chunks; c++ )
+    {
+        const Index first = c * SCENARIO_CHUNK;
+        const Index last = std::min(S_, first + SCENARIO_CHUNK);
+        if( pool_ )
+        {
+            pool_->submit([&body, c, first, last]() { body(c, first, last); });
+        }
+        else
+        {
+            body(c, first, last);
+        }
+    }
+    if( pool_ )
+    {
+        pool_->wait();
+    }
+}
+
+bool HS071_StochasticNLP::get_nlp_info(Index &n, Index &m, Index &nnz_jac_g, Index &nnz_h_lag,
+                                       IndexStyleEnum &index_style) {
+    n = FIRST_N + SCENARIO_N * S_;
+    m = SCENARIO_M * S_;
+    nnz_jac_g = SCENARIO_NNZ_JAC * S_;
+    nnz_h_lag = NNZ_H;
+    index_style = TNLP::C_STYLE;
+    return true;
+}
+
+bool HS071_StochasticNLP::get_bounds_info(Index n, Number *x_l, Number *x_u, Index m, Number *g_l, Number *g_u) {
+    assert(n == FIRST_N + SCENARIO_N * S_);
+    assert(m == SCENARIO_M * S_);
+    // the box of x from HS071; the scenario bounds replace its constraint bounds
+    Number g_l_stage[SCENARIO_M], g_u_stage[SCENARIO_M];
+    stage_->get_bounds_info(FIRST_N, x_l, x_u, SCENARIO_M, g_l_stage, g_u_stage);
+    for( Index s = 0; s < S_; s++ )
+    {
+        for( Index i = 0; i < SCENARIO_N; i++ )
+        {
+            x_l[recourse(s, i)] = 0.;
+            x_u[recourse(s, i)] = 2e19;
+        }
+        g_l[scenario_con(s, 0)] = b0_[s];
+        g_u[scenario_con(s, 0)] = g_u_stage[0];
+        g_l[scenario_con(s, 1)] = g_u[scenario_con(s, 1)] = b1_[s];
+    }
+    return true;
+}
+
+bool HS071_StochasticNLP::get_starting_point(Index n, bool init_x, Number *x, bool init_z, Number *z_L, Number *z_U,
+                                             Index m, bool init_lambda, Number *lambda) {
+    assert(init_x == true);
+    if( init_z || init_lambda )
+    {
+        return false;
+    }
+    // x from HS071, the recourse variables just absorb the violation there
+    stage_->get_starting_point(FIRST_N, true, x, false, NULL, NULL, SCENARIO_M, false, NULL);
+    Number g[SCENARIO_M];
+    stage_->eval_g(FIRST_N, x, true, SCENARIO_M, g);
+    for( Index s = 0; s < S_; s++ )
+    {
+        x[recourse(s, 0)] = std::max(0., b0_[s] - g[0]);
+        x[recourse(s, 1)] = std::max(0., b1_[s] - g[1]);
+        x[recourse(s, 2)] = std::max(0., g[1] - b1_[s]);
+    }
+    return true;
+}
+
+bool HS071_StochasticNLP::eval_f(Index n, const Number *x, bool new_x, Number &obj_value) {
+    std::vector<Number> partial(num_chunks());
+    for_each_chunk([this, x, &partial](Index c, Index first, Index last) {
+        Number sum = 0.;
+        for( Index s = first; s < last; s++ )
+        {
+            sum += q0_ * x[recourse(s, 0)] + q1_ * (x[recourse(s, 1)] + x[recourse(s, 2)]);
+        }
+        partial[c] = sum;
+    });
+    Number recourse_cost = 0.;
+    for( size_t c = 0; c < partial.size(); c++ )
+    {
+        recourse_cost += partial[c];
+    }
+    stage_->eval_f(FIRST_N, x, new_x, obj_value);
+    obj_value += recourse_cost / S_;
+    return true;
+}
+
+bool HS071_StochasticNLP::eval_grad_f(Index n, const Number *x, bool new_x, Number *grad_f) {
+    stage_->eval_grad_f(FIRST_N, x, new_x, grad_f);
+    const Number g0 = q0_ / S_, g1 = q1_ / S_;
+    for_each_chunk([this, grad_f, g0, g1](Index c, Index first, Index last) {
+        for( Index s = first; s < last; s++ )
+        {
+            grad_f[recourse(s, 0)] = g0;
+            grad_f[recourse(s, 1)] = g1;
+            grad_f[recourse(s, 2)] = g1;
+        }
+    });
+    return true;
+}
+
+bool HS071_StochasticNLP::eval_g(Index n, const Number *x, bool new_x, Index m, Number *g) {
+    // the x part is the same for every scenario
+    Number gx[SCENARIO_M];
+    stage_->eval_g(FIRST_N, x, new_x, SCENARIO_M, gx);
+    for_each_chunk([this, x, g, &gx](Index c, Index first, Index last) {
+        for( Index s = first; s < last; s++ )
+        {
+            g[scenario_con(s, 0)] = gx[0] + x[recourse(s, 0)];
+            g[scenario_con(s, 1)] = gx[1] + x[recourse(s, 1)] - x[recourse(s, 2)];
+        }
+    });
+    return true;
+}
+
+bool HS071_StochasticNLP::eval_jac_g(Index n, const Number *x, bool new_x, Index m, Index nele_jac, Index *iRow,
+                                     Index *jCol, Number *values) {
+    // per scenario: the g0 row (x in the order of HS071_NLP, y_s), then the g1 row (x, u_s, v_s)
+    if( values == NULL )
+    {
+        for_each_chunk([this, iRow, jCol](Index c, Index first, Index last) {
+            for( Index s = first; s < last; s++ )
+            {
+                Index *rows = iRow + SCENARIO_NNZ_JAC * s;
+                Index *cols = jCol + SCENARIO_NNZ_JAC * s;
+                for( Index i = 0; i < FIRST_N; i++ )
+                {
+                    rows[i] = scenario_con(s, 0);
+                    cols[i] = i;
+                    rows[FIRST_N + 1 + i] = scenario_con(s, 1);
+                    cols[FIRST_N + 1 + i] = i;
+                }
+                rows[FIRST_N] = scenario_con(s, 0);
+                cols[FIRST_N] = recourse(s, 0);
+                rows[2 * FIRST_N + 1] = rows[2 * FIRST_N + 2] = scenario_con(s, 1);
+                cols[2 * FIRST_N + 1] = recourse(s, 1);
+                cols[2 * FIRST_N + 2] = recourse(s, 2);
+            }
+        });
+    }
+    else
+    {
+        Number jx[SCENARIO_M * FIRST_N];
+        stage_->eval_jac_g(FIRST_N, x, new_x, SCENARIO_M, SCENARIO_M * FIRST_N, NULL, NULL, jx);
+        for_each_chunk([values, &jx](Index c, Index first, Index last) {
+            for( Index s = first; s < last; s++ )
+            {
+                Number *v = values + SCENARIO_NNZ_JAC * s;
+                std::copy(jx, jx + FIRST_N, v);
+                v[FIRST_N] = 1.;
+                std::copy(jx + FIRST_N, jx + 2 * FIRST_N, v + FIRST_N + 1);
+                v[2 * FIRST_N + 1] = 1.;
+                v[2 * FIRST_N + 2] = -1.;
+            }
+        });
+    }
+    return true;
+}
+
+bool HS071_StochasticNLP::eval_h(Index n, const Number *x, bool new_x, Number obj_factor, Index m,
+                                 const Number *lambda, bool new_lambda, Index nele_hess, Index *iRow, Index *jCol,
+                                 Number *values) {
+    // the recourse variables enter linearly, only the x block (in the order of HS071_NLP) is nonzero
+    if( values == NULL )
+    {
+        stage_->eval_h(FIRST_N, NULL, false, 0., SCENARIO_M, NULL, false, NNZ_H, iRow, jCol, NULL);
+        return true;
+    }
+
+    // every chunk sums the multipliers of its scenarios; the scenario constraints all have the Hessians of g0 and g1
+    std::vector<Number> partial((size_t) num_chunks() * SCENARIO_M, 0.);
+    for_each_chunk([this, lambda, &partial](Index c, Index first, Index last) {
+        Number *acc = partial.data() + (size_t) c * SCENARIO_M;
+        for( Index s = first; s < last; s++ )
+        {
+            acc[0] += lambda[scenario_con(s, 0)];
+            acc[1] += lambda[scenario_con(s, 1)];
+        }
+    });
+
+    Number lambda_sum[SCENARIO_M] = {0., 0.};
+    for( Index c = 0; c < num_chunks(); c++ )
+    {
+        lambda_sum[0] += partial[(size_t) c * SCENARIO_M];
+        lambda_sum[1] += partial[(size_t) c * SCENARIO_M + 1];
+    }
+    hessian_.update(x);
+    hessian_.combine(obj_factor, lambda_sum, values);
+    return true;
+}
+
+void HS071_StochasticNLP::finalize_solution(SolverReturn status, Index n, const Number *x, const Number *z_L,
+                                            const Number *z_U, Index m, const Number *g, const Number *lambda,
+                                            Number obj_value, const IpoptData *ip_data,
+                                            IpoptCalculatedQuantities *ip_cq) {
+    solution_.status = status;
+    solution_.obj_value = obj_value;
+    solution_.iter_count = ip_data != NULL ? ip_data->iter_count() : 0;
+    solution_.x.assign(x, x + n);
+    solution_.z_L.assign(z_L, z_L + n);
+    solution_.z_U.assign(z_U, z_U + n);
+    solution_.g.assign(g, g + m);
+    solution_.lambda.assign(lambda, lambda + m);
+}
@@ -0,0 +1,120 @@
+//
+// Sample average approximation of HS071 with uncertain constraint right hand sides. The first-stage variables
+// x in [1,5]^4 are shared by S scenarios; scenario s has its own right hand sides (b0_s, b1_s) and recourse
+// variables that absorb the violation at a linear cost:
+//     min  f(x) + 1/S sum_s [ q0 y_s + q1 (u_s + v_s) ]
+//     s.t. x1 x2 x3 x4 + y_s >= b0_s
+//          x1^2 + x2^2 + x3^2 + x4^2 + u_s - v_s = b1_s,      y_s, u_s, v_s >= 0
+// Variables are laid out as x followed by (y_s, u_s, v_s) per scenario, constraints as two per scenario.
+//
+// eval_f, eval_grad_f, eval_g, eval_jac_g and eval_h run over the scenarios in parallel on a WorkStealingPool. The
+// scenarios are cut into chunks of a fixed size independent of the number of threads; sums over scenarios (the
+// objective and the multipliers weighting the constraint Hessians, which only live in the x block) are accumulated per
+// chunk and the chunk sums are added in chunk order, so the results are bitwise identical for any number of threads
+// and any schedule.
+//
+
+#ifndef __HS071_STOCHASTIC_NLP_HPP
+#define __HS071_STOCHASTIC_NLP_HPP
+
+#include "IpTNLP.hpp"
+#include "hs071_nlp.hpp"
+#include "work_stealing_pool.hpp"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+using namespace Ipopt;
+
+class HS071_StochasticNLP: public TNLP {
+
+public:
+    static const Index FIRST_N = 4;            // first-stage variables
+    static const Index SCENARIO_N = 3;         // recourse variables per scenario
+    static const Index SCENARIO_M = 2;         // constraints per scenario
+    static const Index SCENARIO_CHUNK = 1024;  // scenarios per task, fixes the order of all sums
+
+    // all scenarios start at the nominal right hand sides (25, 40); pool == NULL evaluates serially
+    HS071_StochasticNLP(Index num_scenarios, const std::shared_ptr<WorkStealingPool> &pool,
+                        Number recourse_cost_g0 = 100., Number recourse_cost_g1 = 100.);
+
+    Index num_scenarios() const { return S_; }
+
+    // HS071_Parameter p of scenario s
+    void set_scenario_parameter(Index s, Index p, Number value);
+    Number get_scenario_parameter(Index s, Index p) const;
+    // draws the right hand sides of every scenario from normal distributions around the nominal values
+    void sample_scenarios(unsigned seed, Number sigma_g0, Number sigma_g1);
+
+    // positions of the variables and constraints
+    Index recourse(Index s, Index i) const { return FIRST_N + SCENARIO_N * s + i; }
+    Index scenario_con(Index s, Index j) const { return SCENARIO_M * s + j; }
+
+    const HS071_Solution &solution() const { return solution_; }
+
+    // f and g for any scalar type with the arithmetic of Number, e.g. DependencyScalar to trace the structure;
+    // eval_f and eval_g compute the same over the scenarios in parallel
+    template<class T>
+    T objective(const T *x) const;
+    template<class T>
+    void constraints(const T *x, T *g) const;
+
+    // methods from Ipopt::TNLP
+    bool get_nlp_info(Index &n, Index &m, Index &nnz_jac_g, Index &nnz_h_lag, IndexStyleEnum &index_style);
+    bool get_bounds_info(Index n, Number *x_l, Number *x_u, Index m, Number *g_l, Number *g_u);
+    bool get_starting_point(Index n, bool init_x, Number *x, bool init_z, Number *z_L, Number *z_U, Index m,
+                            bool init_lambda, Number *lambda);
+    bool eval_f(Index n, const Number *x, bool new_x, Number &obj_value);
+    bool eval_grad_f(Index n, const Number *x, bool new_x, Number *grad_f);
+    bool eval_g(Index n, const Number *x, bool new_x, Index m, Number *g);
+    bool eval_jac_g(Index n, const Number *x, bool new_x, Index m, Index nele_jac, Index *iRow, Index *jCol,
+                    Number *values);
+    bool eval_h(Index n, const Number *x, bool new_x, Number obj_factor, Index m, const Number *lambda, bool new_lambda,
+                Index nele_hess, Index *iRow, Index *jCol, Number *values);
+    void finalize_solution(SolverReturn status, Index n, const Number *x, const Number *z_L, const Number *z_U, Index m,
+                           const Number *g, const Number *lambda, Number obj_value, const IpoptData *ip_data,
+                           IpoptCalculatedQuantities *ip_cq);
+
+private:
+    // calls body(chunk, first, last) for the scenario range of every chunk, on the pool if there is one
+    void for_each_chunk(const std::function<void(Index, Index, Index)> &body);
+    Index num_chunks() const { return (S_ + SCENARIO_CHUNK - 1) / SCENARIO_CHUNK; }
+
+    Index S_;
+    std::shared_ptr<WorkStealingPool> pool_;
+    Number q0_;
+    Number q1_;
+    std::vector<Number> b0_;
+    std::vector<Number> b1_;
+    // evaluates the HS071 functions of x; its callbacks cache per x, so they are only called outside the chunk tasks
+    SmartPtr<HS071_NLP> stage_;
+    // the x block of the Hessian is obj_factor * f + (sum_s lambda0_s) g0 + (sum_s lambda1_s) g1
+    HS071_HessianComponents hessian_;
+
+    HS071_Solution solution_;
+
+};
+
+template<class T>
+T HS071_StochasticNLP::objective(const T *x) const {
+    T recourse_cost = 0.;
+    for( Index s = 0; s < S_; s++ )
+    {
+        recourse_cost += q0_ * x[recourse(s, 0)] + q1_ * (x[recourse(s, 1)] + x[recourse(s, 2)]);
+    }
+    return HS071_objective(x) + recourse_cost / (Number) S_;
+}
+
+template<class T>
+void HS071_StochasticNLP::constraints(const T *x, T *g) const {
+    T gx[SCENARIO_M];
+    HS071_constraints(x, gx);
+    for( Index s = 0; s < S_; s++ )
+    {
+        g[scenario_con(s, 0)] = gx[0] + x[recourse(s, 0)];
+        g[scenario_con(s, 1)] = gx[1] + x[recourse(s, 1)] - x[recourse(s, 2)];
+    }
+}
+
+#endif //__HS071_STOCHASTIC_NLP_HPP
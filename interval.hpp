@@ -0,0 +1,95 @@
+//
+// Closed intervals of Numbers with outward rounded arithmetic: every result is widened by one ulp at each end, so it
+// contains the exact result of the operation on any points of the operands. Used for bound propagation; the
+// batched kernels in hs071_global.cpp use the same rules on arrays.
+//
+
+#ifndef __INTERVAL_HPP
+#define __INTERVAL_HPP
+
+#include "IpTypes.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace Ipopt;
+
+struct Interval {
+    Number lo;
+    Number hi;
+
+    Interval() : lo(-std::numeric_limits<Number>::infinity()), hi(std::numeric_limits<Number>::infinity()) {}
+    Interval(Number lower, Number upper) : lo(lower), hi(upper) {}
+    explicit Interval(Number value) : lo(value), hi(value) {}
+
+    bool empty() const { return lo > hi; }
+    bool contains(Number value) const { return lo <= value && value <= hi; }
+    Number width() const { return hi - lo; }
+};
+
+inline Interval outward(Number lo, Number hi) {
+    return Interval(std::nextafter(lo, -std::numeric_limits<Number>::infinity()),
+                    std::nextafter(hi, std::numeric_limits<Number>::infinity()));
+}
+
+inline Interval intersect(const Interval &a, const Interval &b) {
+    return Interval(std::max(a.lo, b.lo), std::min(a.hi, b.hi));
+}
+
+inline Interval operator+(const Interval &a, const Interval &b) {
+    return outward(a.lo + b.lo, a.hi + b.hi);
+}
+
+inline Interval operator-(const Interval &a, const Interval &b) {
+    return outward(a.lo - b.hi, a.hi - b.lo);
+}
+
+inline Interval operator*(const Interval &a, const Interval &b) {
+    // 0 * inf is taken as 0, the limit from the finite points of the operands
+    const Number p[4] = {a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi};
+    Number lo = std::numeric_limits<Number>::infinity(), hi = -lo;
+    for( Index k = 0; k < 4; k++ )
+    {
+        const Number v = std::isnan(p[k]) ? 0. : p[k];
+        lo = std::min(lo, v);
+        hi = std::max(hi, v);
+    }
+    return outward(lo, hi);
+}
+
+// a / b; the whole line if b contains 0, since the quotient is then unbounded
+inline Interval operator/(const Interval &a, const Interval &b) {
+    if( b.contains(0.) )
+    {
+        return Interval();
+    }
+    return a * outward(1. / b.hi, 1. / b.lo);
+}
+
+inline Interval sqr(const Interval &a) {
+    const Number m = std::max(0., std::max(a.lo, -a.hi));
+    return outward(m * m, std::max(a.lo * a.lo, a.hi * a.hi));
+}
+
+// the hull of { x in x : x^2 in s }, or an empty interval if there is no such x
+inline Interval sqr_inverse(const Interval &s, const Interval &x) {
+    if( s.hi < 0. )
+    {
+        return Interval(1., 0.);
+    }
+    const Interval root = outward(std::sqrt(std::max(0., s.lo)), std::sqrt(s.hi));
+    const Interval pos = intersect(x, root);
+    const Interval neg = intersect(x, Interval(-root.hi, -root.lo));
+    if( pos.empty() )
+    {
+        return neg;
+    }
+    if( neg.empty() )
+    {
+        return pos;
+    }
+    return Interval(neg.lo, pos.hi);
+}
+
+#endif //__INTERVAL_HPP
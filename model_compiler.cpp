@@ -0,0 +1,650 @@
+//
+// Native code for an ExpressionModel, see model_compiler.hpp
+//
+
+#include "model_compiler.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// a double literal that reads back as number
+static std::string literal(Number number) {
+    if( std::isnan(number) )
+    {
+        return "std::numeric_limits<double>::quiet_NaN()";
+    }
+    if( std::isinf(number) )
+    {
+        return number > 0. ? "std::numeric_limits<double>::infinity()" : "(-std::numeric_limits<double>::infinity())";
+    }
+    std::ostringstream os;
+    os << std::setprecision(17) << number;
+    std::string text = os.str();
+    if( text.find_first_of(".e") == std::string::npos )
+    {
+        text += ".";
+    }
+    return number < 0. ? "(" + text + ")" : text;
+}
+
+// Expression building where "" is a structural zero and "1." a structural one. Factors are names or products; sums
+// and differences are only used whole.
+static std::string times(const std::string &a, const std::string &b) {
+    if( a.empty() || b.empty() )
+    {
+        return "";
+    }
+    if( a == "1." )
+    {
+        return b;
+    }
+    if( b == "1." )
+    {
+        return a;
+    }
+    return a + " * " + b;
+}
+
+static std::string plus(const std::string &a, const std::string &b) {
+    if( a.empty() )
+    {
+        return b;
+    }
+    return b.empty() ? a : a + " + " + b;
+}
+
+static std::string minus(const std::string &a, const std::string &b) {
+    if( b.empty() )
+    {
+        return a;
+    }
+    return a.empty() ? "-(" + b + ")" : a + " - (" + b + ")";
+}
+
+// Writes the sweeps of function k, one C++ statement per instruction and direction, named by the position of the
+// instruction in the segment: v values, d and e first and second derivatives of unary operations, i inverse divisors,
+// a adjoints, t tangents, at adjoint tangents. Adjoints are declared by their first contribution.
+class SegmentWriter {
+
+public:
+    SegmentWriter(const ExpressionModel &model, Index k, std::ostream &os)
+            : model_(model), tape_(model.tape()), os_(os), k_(k), begin_(model.segment_begin(k)),
+              end_(model.segment_end(k)), D_(model.hessian_directions(k)), adjoint_(end_ - begin_, 0),
+              tangent_((size_t) (end_ - begin_) * D_, 0), adjoint_tangent_((size_t) (end_ - begin_) * D_, 0) {}
+
+    std::string value(Index i) const { return "v" + std::to_string(i - begin_); }
+    // "" if structurally zero
+    std::string adjoint(Index i) const { return adjoint_[i - begin_] ? "a" + std::to_string(i - begin_) : ""; }
+    std::string tangent(Index i, Index d) const;
+    std::string adjoint_tangent(Index i, Index d) const;
+    Index directions() const { return D_; }
+
+    void values();
+    void derivatives(bool second);
+    void adjoints();
+    void tangents();
+    void adjoint_tangents();
+
+private:
+    // a statement name (+|-)= expr, or the declaration of name on its first contribution
+    void accumulate(std::vector<char> &declared, size_t slot, const std::string &name, const std::string &expr,
+                    bool negative);
+    std::string d(Index i) const { return "d" + std::to_string(i - begin_); }
+    std::string e(Index i) const { return "e" + std::to_string(i - begin_); }
+    std::string inv(Index i) const { return "i" + std::to_string(i - begin_); }
+    bool binary(Index op) const {
+        return op == ExpressionModel::OP_ADD || op == ExpressionModel::OP_SUB || op == ExpressionModel::OP_MUL
+               || op == ExpressionModel::OP_DIV;
+    }
+
+    const ExpressionModel &model_;
+    const std::vector<ExpressionModel::Instruction> &tape_;
+    std::ostream &os_;
+    const Index k_, begin_, end_, D_;
+    std::vector<char> adjoint_;
+    std::vector<char> tangent_;
+    std::vector<char> adjoint_tangent_;
+
+};
+
+std::string SegmentWriter::tangent(Index i, Index d) const {
+    if( tape_[i].op == ExpressionModel::OP_VAR )
+    {
+        return model_.hessian_seed(i) == d ? "1." : "";
+    }
+    if( !tangent_[(size_t) (i - begin_) * D_ + d] )
+    {
+        return "";
+    }
+    return "t" + std::to_string(i - begin_) + "_" + std::to_string(d);
+}
+
+std::string SegmentWriter::adjoint_tangent(Index i, Index d) const {
+    if( !adjoint_tangent_[(size_t) (i - begin_) * D_ + d] )
+    {
+        return "";
+    }
+    return "at" + std::to_string(i - begin_) + "_" + std::to_string(d);
+}
+
+void SegmentWriter::accumulate(std::vector<char> &declared, size_t slot, const std::string &name,
+                               const std::string &expr, bool negative) {
+    if( expr.empty() )
+    {
+        return;
+    }
+    if( !declared[slot] )
+    {
+        declared[slot] = 1;
+        os_ << "        double " << name << " = " << (negative ? "-(" + expr + ")" : expr) << ";\n";
+    }
+    else
+    {
+        os_ << "        " << name << (negative ? " -= " : " += ") << expr << ";\n";
+    }
+}
+
+void SegmentWriter::values() {
+    const std::vector<Number> &constants = model_.constants();
+    for( Index i = begin_; i < end_; i++ )
+    {
+        const ExpressionModel::Instruction &in = tape_[i];
+        const std::string a = value(in.a), b = binary(in.op) ? value(in.b) : "";
+        os_ << "        const double " << value(i) << " = ";
+        switch( in.op )
+        {
+            case ExpressionModel::OP_CONST:
+                os_ << literal(constants[in.a]);
+                break;
+            case ExpressionModel::OP_PARAM:
+                os_ << "p[" << in.a << "]";
+                break;
+            case ExpressionModel::OP_VAR:
+                os_ << "x[" << in.a << "]";
+                break;
+            case ExpressionModel::OP_ADD:
+                os_ << a << " + " << b;
+                break;
+            case ExpressionModel::OP_SUB:
+                os_ << a << " - " << b;
+                break;
+            case ExpressionModel::OP_MUL:
+                os_ << a << " * " << b;
+                break;
+            case ExpressionModel::OP_DIV:
+                os_ << a << " / " << b;
+                break;
+            case ExpressionModel::OP_NEG:
+                os_ << "-" << a;
+                break;
+            case ExpressionModel::OP_SQR:
+                os_ << a << " * " << a;
+                break;
+            case ExpressionModel::OP_POW:
+                os_ << "std::pow(" << a << ", " << literal(constants[in.b]) << ")";
+                break;
+            case ExpressionModel::OP_SQRT:
+                os_ << "std::sqrt(" << a << ")";
+                break;
+            case ExpressionModel::OP_EXP:
+                os_ << "std::exp(" << a << ")";
+                break;
+            case ExpressionModel::OP_LOG:
+                os_ << "std::log(" << a << ")";
+                break;
+            case ExpressionModel::OP_SIN:
+                os_ << "std::sin(" << a << ")";
+                break;
+            case ExpressionModel::OP_COS:
+                os_ << "std::cos(" << a << ")";
+                break;
+        }
+        os_ << ";\n";
+    }
+}
+
+void SegmentWriter::derivatives(bool second) {
+    for( Index i = model_.operation_begin(k_); i < end_; i++ )
+    {
+        const ExpressionModel::Instruction &in = tape_[i];
+        const std::string a = value(in.a), c = value(i);
+        std::string first, next;
+        switch( in.op )
+        {
+            case ExpressionModel::OP_DIV:
+                if( second )
+                {
+                    os_ << "        const double " << inv(i) << " = 1. / " << value(in.b) << ";\n";
+                }
+                continue;
+            case ExpressionModel::OP_SQR:
+                first = "2. * " + a;
+                next = "2.";
+                break;
+            case ExpressionModel::OP_POW:
+            {
+                const Number p = model_.constants()[in.b];
+                first = literal(p) + " * std::pow(" + a + ", " + literal(p - 1.) + ")";
+                next = literal(p * (p - 1.)) + " * std::pow(" + a + ", " + literal(p - 2.) + ")";
+                break;
+            }
+            case ExpressionModel::OP_SQRT:
+                first = "0.5 / " + c;
+                next = "-0.25 / (" + c + " * " + a + ")";
+                break;
+            case ExpressionModel::OP_EXP:
+                first = next = c;
+                break;
+            case ExpressionModel::OP_LOG:
+                first = "1. / " + a;
+                next = "-" + d(i) + " * " + d(i);
+                break;
+            case ExpressionModel::OP_SIN:
+                first = "std::cos(" + a + ")";
+                next = "-" + c;
+                break;
+            case ExpressionModel::OP_COS:
+                first = "-std::sin(" + a + ")";
+                next = "-" + c;
+                break;
+            default:
+                continue;
+        }
+        os_ << "        const double " << d(i) << " = " << first << ";\n";
+        if( second )
+        {
+            os_ << "        const double " << e(i) << " = " << next << ";\n";
+        }
+    }
+}
+
+void SegmentWriter::adjoints() {
+    adjoint_[end_ - 1 - begin_] = 1;
+    os_ << "        const double " << adjoint(end_ - 1) << " = 1.;\n";
+    for( Index i = end_ - 1; i >= model_.operation_begin(k_); i-- )
+    {
+        const ExpressionModel::Instruction &in = tape_[i];
+        const std::string ai = adjoint(i);
+        if( ai.empty() )
+        {
+            continue;
+        }
+        const size_t a = in.a - begin_, b = in.b - begin_;
+        const std::string na = "a" + std::to_string(a), nb = "a" + std::to_string(b);
+        switch( in.op )
+        {
+            case ExpressionModel::OP_ADD:
+                accumulate(adjoint_, a, na, ai, false);
+                accumulate(adjoint_, b, nb, ai, false);
+                break;
+            case ExpressionModel::OP_SUB:
+                accumulate(adjoint_, a, na, ai, false);
+                accumulate(adjoint_, b, nb, ai, true);
+                break;
+            case ExpressionModel::OP_MUL:
+                accumulate(adjoint_, a, na, times(ai, value(in.b)), false);
+                accumulate(adjoint_, b, nb, times(ai, value(in.a)), false);
+                break;
+            case ExpressionModel::OP_DIV:
+                accumulate(adjoint_, a, na, ai + " / " + value(in.b), false);
+                accumulate(adjoint_, b, nb, times(ai, value(i)) + " / " + value(in.b), true);
+                break;
+            case ExpressionModel::OP_NEG:
+                accumulate(adjoint_, a, na, ai, true);
+                break;
+            default:
+                accumulate(adjoint_, a, na, times(ai, d(i)), false);
+        }
+    }
+}
+
+void SegmentWriter::tangents() {
+    for( Index i = model_.operation_begin(k_); i < end_; i++ )
+    {
+        const ExpressionModel::Instruction &in = tape_[i];
+        for( Index dir = 0; dir < D_; dir++ )
+        {
+            const std::string ta = tangent(in.a, dir), tb = binary(in.op) ? tangent(in.b, dir) : "";
+            std::string expr;
+            switch( in.op )
+            {
+                case ExpressionModel::OP_ADD:
+                    expr = plus(ta, tb);
+                    break;
+                case ExpressionModel::OP_SUB:
+                    expr = minus(ta, tb);
+                    break;
+                case ExpressionModel::OP_MUL:
+                    expr = plus(times(ta, value(in.b)), times(value(in.a), tb));
+                    break;
+                case ExpressionModel::OP_DIV:
+                {
+                    const std::string numerator = minus(ta, times(value(i), tb));
+                    expr = numerator.empty() ? "" : "(" + numerator + ") / " + value(in.b);
+                    break;
+                }
+                case ExpressionModel::OP_NEG:
+                    expr = ta.empty() ? "" : "-" + ta;
+                    break;
+                default:
+                    expr = times(d(i), ta);
+            }
+            if( !expr.empty() )
+            {
+                tangent_[(size_t) (i - begin_) * D_ + dir] = 1;
+                os_ << "        const double " << tangent(i, dir) << " = " << expr << ";\n";
+            }
+        }
+    }
+}
+
+void SegmentWriter::adjoint_tangents() {
+    for( Index i = end_ - 1; i >= model_.operation_begin(k_); i-- )
+    {
+        const ExpressionModel::Instruction &in = tape_[i];
+        const std::string ai = adjoint(i);
+        for( Index dir = 0; dir < D_; dir++ )
+        {
+            const std::string ati = adjoint_tangent(i, dir);
+            const std::string ta = tangent(in.a, dir), tb = binary(in.op) ? tangent(in.b, dir) : "";
+            const size_t a = (size_t) (in.a - begin_) * D_ + dir, b = (size_t) (in.b - begin_) * D_ + dir;
+            const std::string suffix = "_" + std::to_string(dir);
+            const std::string na = "at" + std::to_string(in.a - begin_) + suffix;
+            const std::string nb = "at" + std::to_string(in.b - begin_) + suffix;
+            switch( in.op )
+            {
+                case ExpressionModel::OP_ADD:
+                    accumulate(adjoint_tangent_, a, na, ati, false);
+                    accumulate(adjoint_tangent_, b, nb, ati, false);
+                    break;
+                case ExpressionModel::OP_SUB:
+                    accumulate(adjoint_tangent_, a, na, ati, false);
+                    accumulate(adjoint_tangent_, b, nb, ati, true);
+                    break;
+                case ExpressionModel::OP_MUL:
+                    accumulate(adjoint_tangent_, a, na, plus(times(ati, value(in.b)), times(ai, tb)), false);
+                    accumulate(adjoint_tangent_, b, nb, plus(times(ati, value(in.a)), times(ai, ta)), false);
+                    break;
+                case ExpressionModel::OP_DIV:
+                {
+                    // d/da = 1 / b, d/db = -c / b
+                    const std::string w = inv(i);
+                    accumulate(adjoint_tangent_, a, na, minus(times(ati, w), times(ai, times(tb, w + " * " + w))),
+                               false);
+                    const std::string tc = tangent(i, dir);
+                    const std::string dc = minus(tc, times(value(i), times(tb, w)));
+                    accumulate(adjoint_tangent_, b, nb,
+                               plus(times(ati, times(value(i), w)), dc.empty() ? "" : ai + " * (" + dc + ") * " + w),
+                               true);
+                    break;
+                }
+                case ExpressionModel::OP_NEG:
+                    accumulate(adjoint_tangent_, a, na, ati, true);
+                    break;
+                default:
+                    accumulate(adjoint_tangent_, a, na, plus(times(ati, d(i)), times(ai, times(e(i), ta))), false);
+            }
+        }
+    }
+}
+
+std::string generate_model_source(const ExpressionModel &model) {
+    const Index n = model.num_variables(), m = model.num_constraints();
+    const std::vector<Index> &h_rows = model.hessian_rows(), &h_cols = model.hessian_cols();
+    std::ostringstream os;
+    os << "// generated from an ExpressionModel by generate_model_source\n"
+          "#include <cmath>\n"
+          "#include <limits>\n\n"
+          "extern \"C\" {\n\n";
+
+    os << "void model_info(int *n, int *m, int *nnz_jac_g, int *nnz_h_lag) {\n"
+       << "    *n = " << n << ";\n    *m = " << m << ";\n    *nnz_jac_g = " << model.jacobian_nonzeros()
+       << ";\n    *nnz_h_lag = " << h_rows.size() << ";\n}\n\n";
+
+    os << "void model_jac_g_structure(int *iRow, int *jCol) {\n";
+    for( Index j = 0, k = 0; j < m; j++ )
+    {
+        const std::vector<Index> &vars = model.variables(1 + j);
+        for( size_t s = 0; s < vars.size(); s++, k++ )
+        {
+            os << "    iRow[" << k << "] = " << j << "; jCol[" << k << "] = " << vars[s] << ";\n";
+        }
+    }
+    os << "}\n\n";
+
+    os << "void model_h_structure(int *iRow, int *jCol) {\n";
+    for( size_t k = 0; k < h_rows.size(); k++ )
+    {
+        os << "    iRow[" << k << "] = " << h_rows[k] << "; jCol[" << k << "] = " << h_cols[k] << ";\n";
+    }
+    os << "}\n\n";
+
+    os << "void model_f(const double *x, const double *p, double *f) {\n    {\n";
+    {
+        SegmentWriter writer(model, 0, os);
+        writer.values();
+        os << "        *f = " << writer.value(model.segment_end(0) - 1) << ";\n";
+    }
+    os << "    }\n}\n\n";
+
+    os << "void model_g(const double *x, const double *p, double *g) {\n";
+    for( Index j = 0; j < m; j++ )
+    {
+        SegmentWriter writer(model, 1 + j, os);
+        os << "    {\n";
+        writer.values();
+        os << "        g[" << j << "] = " << writer.value(model.segment_end(1 + j) - 1) << ";\n    }\n";
+    }
+    os << "}\n\n";
+
+    // gradients: forward and reverse sweep, the adjoints of the variables are the entries
+    os << "void model_grad_f(const double *x, const double *p, double *grad) {\n"
+       << "    for( int i = 0; i < " << n << "; i++ )\n    {\n        grad[i] = 0.;\n    }\n    {\n";
+    {
+        SegmentWriter writer(model, 0, os);
+        writer.values();
+        writer.derivatives(false);
+        writer.adjoints();
+        for( Index i = model.variable_begin(0); i < model.operation_begin(0); i++ )
+        {
+            const std::string a = writer.adjoint(i);
+            os << "        grad[" << model.tape()[i].a << "] = " << (a.empty() ? "0." : a) << ";\n";
+        }
+    }
+    os << "    }\n}\n\n";
+
+    os << "void model_jac_g(const double *x, const double *p, double *values) {\n";
+    for( Index j = 0, k = 0; j < m; j++ )
+    {
+        SegmentWriter writer(model, 1 + j, os);
+        os << "    {\n";
+        writer.values();
+        writer.derivatives(false);
+        writer.adjoints();
+        for( Index i = model.variable_begin(1 + j); i < model.operation_begin(1 + j); i++, k++ )
+        {
+            const std::string a = writer.adjoint(i);
+            os << "        values[" << k << "] = " << (a.empty() ? "0." : a) << ";\n";
+        }
+        os << "    }\n";
+    }
+    os << "}\n\n";
+
+    // Hessian of the Lagrangian: forward over reverse per function, skipped for a zero weight
+    os << "void model_h(const double *x, const double *p, double obj_factor, const double *lambda, double *values) {\n"
+       << "    for( int s = 0; s < " << h_rows.size() << "; s++ )\n    {\n        values[s] = 0.;\n    }\n";
+    const std::vector<ExpressionModel::HessianRead> &reads = model.hessian_reads();
+    for( Index k = 0; k <= m; k++ )
+    {
+        if( model.hessian_directions(k) == 0 )
+        {
+            continue;
+        }
+        const std::string weight = k == 0 ? "obj_factor" : "lambda[" + std::to_string(k - 1) + "]";
+        SegmentWriter writer(model, k, os);
+        os << "    if( " << weight << " != 0. )\n    {\n";
+        writer.values();
+        writer.derivatives(true);
+        writer.adjoints();
+        writer.tangents();
+        writer.adjoint_tangents();
+        for( Index r = model.hessian_read_begin(k); r < model.hessian_read_end(k); r++ )
+        {
+            const std::string at = writer.adjoint_tangent(reads[r].instr, reads[r].direction);
+            if( !at.empty() )
+            {
+                os << "        values[" << reads[r].slot << "] += " << weight << " * " << at << ";\n";
+            }
+        }
+        os << "    }\n";
+    }
+    os << "}\n\n}\n";
+    return os.str();
+}
+
+// 64 bit FNV-1a
+static unsigned long long fnv1a(const std::string &text) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for( size_t i = 0; i < text.size(); i++ )
+    {
+        hash ^= (unsigned char) text[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+CompiledModel::CompiledModel()
+        : handle_(NULL), f_(NULL), grad_f_(NULL), g_(NULL), jac_g_(NULL), h_(NULL), cache_hit_(false),
+          compile_time_(0.) {
+}
+
+CompiledModel::~CompiledModel() {
+    close();
+}
+
+void CompiledModel::close() {
+    if( handle_ != NULL )
+    {
+        dlclose(handle_);
+        handle_ = NULL;
+    }
+}
+
+bool CompiledModel::open(const std::string &path, const ExpressionModel &model, std::string &error) {
+    handle_ = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if( handle_ == NULL )
+    {
+        error = dlerror();
+        return false;
+    }
+    typedef void (*InfoFunction)(int *, int *, int *, int *);
+    InfoFunction info = reinterpret_cast<InfoFunction>(dlsym(handle_, "model_info"));
+    f_ = reinterpret_cast<Function>(dlsym(handle_, "model_f"));
+    grad_f_ = reinterpret_cast<Function>(dlsym(handle_, "model_grad_f"));
+    g_ = reinterpret_cast<Function>(dlsym(handle_, "model_g"));
+    jac_g_ = reinterpret_cast<Function>(dlsym(handle_, "model_jac_g"));
+    h_ = reinterpret_cast<HessianFunction>(dlsym(handle_, "model_h"));
+    if( info == NULL || f_ == NULL || grad_f_ == NULL || g_ == NULL || jac_g_ == NULL || h_ == NULL )
+    {
+        error = path + ": missing model functions";
+        close();
+        return false;
+    }
+    int n, m, nnz_jac, nnz_h;
+    info(&n, &m, &nnz_jac, &nnz_h);
+    if( n != model.num_variables() || m != model.num_constraints() || nnz_jac != model.jacobian_nonzeros()
+        || nnz_h != (int) model.hessian_rows().size() )
+    {
+        error = path + ": compiled for another model";
+        close();
+        return false;
+    }
+    return true;
+}
+
+// suffix of the temporary files of this process
+static std::atomic<unsigned long> next_temporary(0);
+
+// s as a single word of the shell
+static std::string shell_quote(const std::string &s) {
+    std::string quoted = "'";
+    for( size_t k = 0; k < s.size(); k++ )
+    {
+        quoted += s[k] == '\'' ? std::string("'\\''") : std::string(1, s[k]);
+    }
+    return quoted + "'";
+}
+
+bool CompiledModel::compile(const ExpressionModel &model, const ModelCompilerOptions &options, std::string &error) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    close();
+    cache_hit_ = false;
+
+    const std::string source = generate_model_source(model);
+    std::string compiler = options.compiler;
+    if( compiler.empty() )
+    {
+        const char *cxx = std::getenv("CXX");
+        compiler = cxx != NULL && *cxx != '\0' ? cxx : "c++";
+    }
+    const std::string command = compiler + " " + options.flags + " -fPIC -shared";
+    std::ostringstream name;
+    name << options.cache_dir << "/model_" << std::hex << std::setw(16) << std::setfill('0')
+         << fnv1a(source + "\n" + command);
+    path_ = name.str() + ".so";
+
+    mkdir(options.cache_dir.c_str(), 0755);
+    if( access(path_.c_str(), R_OK) == 0 && open(path_, model, error) )
+    {
+        cache_hit_ = true;
+        compile_time_ = std::chrono::duration<Number>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    // every file is written under a name of its own, unique over processes (pid) and the threads of this one
+    // (counter), and only renamed into place once complete
+    const std::string unique = name.str() + "." + std::to_string(getpid()) + "." + std::to_string(next_temporary++);
+    const std::string source_path = unique + ".cpp", log_path = unique + ".log", temporary = unique + ".so";
+    {
+        std::ofstream file(source_path.c_str());
+        file << source;
+        if( !file )
+        {
+            error = "cannot write " + source_path;
+            return false;
+        }
+    }
+    const std::string line = command + " -o " + shell_quote(temporary) + " " + shell_quote(source_path) + " > "
+                             + shell_quote(log_path) + " 2>&1";
+    if( std::system(line.c_str()) != 0 )
+    {
+        std::remove(temporary.c_str());
+        error = "compiler failed, see " + log_path;
+        return false;
+    }
+    if( std::rename(temporary.c_str(), path_.c_str()) != 0 )
+    {
+        std::remove(temporary.c_str());
+        error = "cannot create " + path_;
+        return false;
+    }
+    // the source and the log stay next to the object
+    std::rename(source_path.c_str(), (name.str() + ".cpp").c_str());
+    std::rename(log_path.c_str(), (name.str() + ".log").c_str());
+    if( !open(path_, model, error) )
+    {
+        return false;
+    }
+    compile_time_ = std::chrono::duration<Number>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
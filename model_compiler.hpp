@@ -0,0 +1,80 @@
+//
+// Native code for an ExpressionModel. generate_model_source writes the tape of every function out as straight-line
+// C++: f and g as the forward sweep, grad f and the Jacobian as the forward and reverse sweeps, and the Hessian of the
+// Lagrangian as forward over reverse over the colored directions of ExpressionModel, with every tangent and adjoint
+// tangent that is structurally zero left out. The sparsity patterns are written out as constants, as HS071_NLP does.
+// Parameters stay runtime arguments, so one compiled model serves every parameter value.
+//
+// CompiledModel compiles that source with the local compiler into a shared object and loads it with dlopen. Objects
+// are cached in a directory, named by a 64 bit FNV-1a hash of the source and the compile command, so loading the same
+// model again (in this or another process) skips the compiler. The source, the object and the compiler log are written
+// under names unique to the process and the call and renamed into place, so concurrent compiles of one model, from any
+// threads and processes, do not see each other's partial files.
+// The generated code grows with the tape and the Hessian directions; it is meant for models of moderate size.
+//
+
+#ifndef __MODEL_COMPILER_HPP
+#define __MODEL_COMPILER_HPP
+
+#include "expression_model.hpp"
+
+#include <string>
+
+using namespace Ipopt;
+
+struct ModelCompilerOptions {
+    std::string cache_dir = "model_cache";
+    // empty for $CXX, or c++ if that is not set
+    std::string compiler;
+    std::string flags = "-O2";
+};
+
+// C++ source with extern "C" functions model_info, model_f, model_grad_f, model_g, model_jac_g, model_h,
+// model_jac_g_structure and model_h_structure; the layouts are those of ExpressionNLP
+std::string generate_model_source(const ExpressionModel &model);
+
+class CompiledModel {
+
+public:
+    CompiledModel();
+    ~CompiledModel();
+    CompiledModel(const CompiledModel &) = delete;
+    CompiledModel &operator=(const CompiledModel &) = delete;
+
+    // generates, compiles (unless cached) and loads model; returns false with the reason in error
+    bool compile(const ExpressionModel &model, const ModelCompilerOptions &options, std::string &error);
+
+    bool loaded() const { return handle_ != NULL; }
+    // whether the last compile found the object in the cache, and its time in seconds including the compiler
+    bool cache_hit() const { return cache_hit_; }
+    Number compile_time() const { return compile_time_; }
+    const std::string &library_path() const { return path_; }
+
+    // p are the parameters of the model; grad_f is dense, the Jacobian and the Hessian values are in the order of
+    // ExpressionNLP
+    void eval_f(const Number *x, const Number *p, Number &f) const { f_(x, p, &f); }
+    void eval_grad_f(const Number *x, const Number *p, Number *grad_f) const { grad_f_(x, p, grad_f); }
+    void eval_g(const Number *x, const Number *p, Number *g) const { g_(x, p, g); }
+    void eval_jac_g(const Number *x, const Number *p, Number *values) const { jac_g_(x, p, values); }
+    void eval_h(const Number *x, const Number *p, Number obj_factor, const Number *lambda, Number *values) const {
+        h_(x, p, obj_factor, lambda, values);
+    }
+
+private:
+    typedef void (*Function)(const double *, const double *, double *);
+    typedef void (*HessianFunction)(const double *, const double *, double, const double *, double *);
+
+    // dlopens path and looks up the functions, checking the dimensions against model
+    bool open(const std::string &path, const ExpressionModel &model, std::string &error);
+    void close();
+
+    void *handle_;
+    Function f_, grad_f_, g_, jac_g_;
+    HessianFunction h_;
+    bool cache_hit_;
+    Number compile_time_;
+    std::string path_;
+
+};
+
+#endif //__MODEL_COMPILER_HPP
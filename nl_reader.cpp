@@ -0,0 +1,629 @@
+//
+// Reader for AMPL .nl files, see nl_reader.hpp
+//
+
+#include "nl_reader.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// infinite bounds, as Ipopt's nlp_lower_bound_inf and nlp_upper_bound_inf take them
+static const Number NL_INFINITY = 2e19;
+
+// AMPL operator codes
+enum {
+    NL_PLUS = 0, NL_MINUS = 1, NL_MULT = 2, NL_DIV = 3, NL_POW = 5, NL_UMINUS = 16, NL_TANH = 37, NL_TAN = 38,
+    NL_SQRT = 39, NL_SINH = 40, NL_SIN = 41, NL_LOG10 = 42, NL_LOG = 43, NL_EXP = 44, NL_COSH = 45, NL_COS = 46,
+    NL_SUMLIST = 54, NL_1POW = 76, NL_2POW = 77, NL_CPOW = 78
+};
+
+class NlReader {
+
+public:
+    NlReader(const char *begin, const char *end) : p_(begin), end_(end), line_(1) {}
+
+    bool read(ExpressionModel &model, std::string &error);
+
+private:
+    // a place in the file to come back to
+    struct Position {
+        const char *p;
+        Index line;
+    };
+    // a segment with a count of lines after its header, e.g. the linear part of a function
+    struct Segment {
+        Position start;
+        Index count;
+    };
+
+    bool fail(const std::string &reason);
+    bool at_end() const { return p_ >= end_; }
+    // moves to the start of the next line
+    void next_line();
+    bool read_index(Index &value);
+    bool read_number(Number &value);
+    // at a segment header: skips the lines up to the next one
+    void skip_lines(Index count);
+    void skip_expression();
+    // a bounds segment (r or b) of count lines
+    bool read_bounds(Index count, std::vector<Number> &lower, std::vector<Number> &upper);
+
+    // the expression tree at the current line; the instruction or -1 with error_ set
+    Index expression();
+    Index defined_variable(Index d);
+    // adds the count lines "variable coefficient" at the current line to value
+    Index linear(Index value, Index count);
+
+    const char *p_;
+    const char *end_;
+    Index line_;
+    std::string error_;
+
+    Index n_;
+    ExpressionBuilder *builder_;
+    // V segments, and their instruction in the current function or -1
+    std::vector<Segment> defined_;
+    std::vector<Index> defined_instr_;
+    std::vector<Index> defined_used_;
+
+};
+
+bool NlReader::fail(const std::string &reason) {
+    if( error_.empty() )
+    {
+        std::ostringstream os;
+        os << "line " << line_ << ": " << reason;
+        error_ = os.str();
+    }
+    return false;
+}
+
+void NlReader::next_line() {
+    const char *newline = (const char *) std::memchr(p_, '\n', end_ - p_);
+    p_ = newline != NULL ? newline + 1 : end_;
+    line_++;
+}
+
+bool NlReader::read_index(Index &value) {
+    while( p_ < end_ && (*p_ == ' ' || *p_ == '\t') )
+    {
+        p_++;
+    }
+    bool negative = false;
+    if( p_ < end_ && *p_ == '-' )
+    {
+        negative = true;
+        p_++;
+    }
+    if( p_ >= end_ || *p_ < '0' || *p_ > '9' )
+    {
+        return fail("expected an integer");
+    }
+    long v = 0;
+    while( p_ < end_ && *p_ >= '0' && *p_ <= '9' )
+    {
+        v = 10 * v + (*p_++ - '0');
+    }
+    value = (Index) (negative ? -v : v);
+    return true;
+}
+
+bool NlReader::read_number(Number &value) {
+    while( p_ < end_ && (*p_ == ' ' || *p_ == '\t') )
+    {
+        p_++;
+    }
+    // strtod needs a terminated string, the mapping is not; numbers are short
+    char buffer[64];
+    size_t length = 0;
+    while( p_ + length < end_ && length < sizeof(buffer) - 1 && p_[length] != '\0'
+           && std::strchr("0123456789+-.eEinfINFaty", p_[length]) != NULL )
+    {
+        length++;
+    }
+    std::memcpy(buffer, p_, length);
+    buffer[length] = '\0';
+    char *stop;
+    value = std::strtod(buffer, &stop);
+    if( length == 0 || stop != buffer + length )
+    {
+        return fail("expected a number");
+    }
+    p_ += length;
+    return true;
+}
+
+void NlReader::skip_lines(Index count) {
+    next_line();
+    for( Index k = 0; k < count && !at_end(); k++ )
+    {
+        next_line();
+    }
+}
+
+void NlReader::skip_expression() {
+    // expression lines start with o, n, v, f, h or a digit (operand counts), segment headers with none of them
+    while( !at_end() && std::strchr("CObVxdrkJGSF", *p_) == NULL )
+    {
+        next_line();
+    }
+}
+
+bool NlReader::read_bounds(Index count, std::vector<Number> &lower, std::vector<Number> &upper) {
+    next_line();
+    for( Index k = 0; k < count; k++ )
+    {
+        Index code;
+        Number a = 0., b = 0.;
+        if( !read_index(code) )
+        {
+            return false;
+        }
+        bool ok = true;
+        switch( code )
+        {
+            case 0:
+                ok = read_number(a) && read_number(b);
+                lower[k] = a;
+                upper[k] = b;
+                break;
+            case 1:
+                ok = read_number(b);
+                lower[k] = -NL_INFINITY;
+                upper[k] = b;
+                break;
+            case 2:
+                ok = read_number(a);
+                lower[k] = a;
+                upper[k] = NL_INFINITY;
+                break;
+            case 3:
+                lower[k] = -NL_INFINITY;
+                upper[k] = NL_INFINITY;
+                break;
+            case 4:
+                ok = read_number(a);
+                lower[k] = upper[k] = a;
+                break;
+            default:
+                return fail("complementarity constraints are not supported");
+        }
+        if( !ok )
+        {
+            return false;
+        }
+        next_line();
+    }
+    return true;
+}
+
+Index NlReader::linear(Index value, Index count) {
+    for( Index k = 0; k < count; k++ )
+    {
+        Index j;
+        Number coefficient;
+        if( !read_index(j) || !read_number(coefficient) )
+        {
+            return -1;
+        }
+        next_line();
+        if( j < 0 || j >= n_ )
+        {
+            fail("variable out of range");
+            return -1;
+        }
+        if( coefficient != 0. )
+        {
+            const Index term = builder_->emit(ExpressionModel::OP_MUL, builder_->constant(coefficient),
+                                              builder_->variable(j));
+            value = builder_->emit(ExpressionModel::OP_ADD, value, term);
+        }
+    }
+    return value;
+}
+
+Index NlReader::defined_variable(Index d) {
+    if( d < 0 || d >= (Index) defined_.size() || defined_[d].start.p == NULL )
+    {
+        fail("undefined variable");
+        return -1;
+    }
+    if( defined_instr_[d] >= 0 )
+    {
+        return defined_instr_[d];
+    }
+    // the V segment: its linear part, then its expression
+    const Position back = {p_, line_};
+    p_ = defined_[d].start.p;
+    line_ = defined_[d].start.line;
+    const Index terms = builder_->constant(0.);
+    Index value = linear(terms, defined_[d].count);
+    const Index nonlinear = value < 0 ? -1 : expression();
+    value = nonlinear < 0 ? -1 : builder_->emit(ExpressionModel::OP_ADD, nonlinear, value);
+    p_ = back.p;
+    line_ = back.line;
+    if( value >= 0 )
+    {
+        defined_instr_[d] = value;
+        defined_used_.push_back(d);
+    }
+    return value;
+}
+
+Index NlReader::expression() {
+    if( at_end() )
+    {
+        fail("unexpected end of file");
+        return -1;
+    }
+    const char kind = *p_++;
+    Index code;
+    if( kind == 'n' )
+    {
+        Number value;
+        if( !read_number(value) )
+        {
+            return -1;
+        }
+        next_line();
+        return builder_->constant(value);
+    }
+    if( kind == 'v' )
+    {
+        if( !read_index(code) )
+        {
+            return -1;
+        }
+        next_line();
+        return code < n_ ? builder_->variable(code) : defined_variable(code - n_);
+    }
+    if( kind != 'o' )
+    {
+        fail(std::string("unsupported expression '") + kind + "'");
+        return -1;
+    }
+    if( !read_index(code) )
+    {
+        return -1;
+    }
+    next_line();
+
+    if( code == NL_SUMLIST )
+    {
+        Index count;
+        if( !read_index(count) )
+        {
+            return -1;
+        }
+        next_line();
+        Index sum = builder_->constant(0.);
+        for( Index k = 0; k < count && sum >= 0; k++ )
+        {
+            const Index term = expression();
+            sum = term < 0 ? -1 : builder_->emit(ExpressionModel::OP_ADD, sum, term);
+        }
+        return sum;
+    }
+
+    const bool binary = code == NL_PLUS || code == NL_MINUS || code == NL_MULT || code == NL_DIV || code == NL_POW
+                        || code == NL_1POW || code == NL_CPOW;
+    const bool unary = code == NL_UMINUS || code == NL_2POW || (code >= NL_TANH && code <= NL_COS);
+    if( !binary && !unary )
+    {
+        std::ostringstream os;
+        os << "unsupported operator o" << code;
+        fail(os.str());
+        return -1;
+    }
+    const Index a = expression();
+    const Index b = a >= 0 && binary ? expression() : 0;
+    if( a < 0 || b < 0 )
+    {
+        return -1;
+    }
+    ExpressionBuilder &e = *builder_;
+    switch( code )
+    {
+        case NL_PLUS:
+            return e.emit(ExpressionModel::OP_ADD, a, b);
+        case NL_MINUS:
+            return e.emit(ExpressionModel::OP_SUB, a, b);
+        case NL_MULT:
+            return e.emit(ExpressionModel::OP_MUL, a, b);
+        case NL_DIV:
+            return e.emit(ExpressionModel::OP_DIV, a, b);
+        case NL_POW:
+        case NL_1POW:
+        case NL_CPOW:
+            if( e.is_constant(b) )
+            {
+                return e.power(a, e.constant_value(b));
+            }
+            // a^b = exp(b log a), for a > 0
+            return e.emit(ExpressionModel::OP_EXP, e.emit(ExpressionModel::OP_MUL, b, e.emit(ExpressionModel::OP_LOG, a)));
+        case NL_UMINUS:
+            return e.emit(ExpressionModel::OP_NEG, a);
+        case NL_2POW:
+            return e.emit(ExpressionModel::OP_SQR, a);
+        case NL_SQRT:
+            return e.emit(ExpressionModel::OP_SQRT, a);
+        case NL_SIN:
+            return e.emit(ExpressionModel::OP_SIN, a);
+        case NL_COS:
+            return e.emit(ExpressionModel::OP_COS, a);
+        case NL_LOG:
+            return e.emit(ExpressionModel::OP_LOG, a);
+        case NL_EXP:
+            return e.emit(ExpressionModel::OP_EXP, a);
+        case NL_LOG10:
+            return e.emit(ExpressionModel::OP_MUL, e.emit(ExpressionModel::OP_LOG, a), e.constant(1. / std::log(10.)));
+        case NL_TAN:
+            return e.emit(ExpressionModel::OP_DIV, e.emit(ExpressionModel::OP_SIN, a), e.emit(ExpressionModel::OP_COS, a));
+    }
+    // sinh, cosh and tanh from exp(a) and exp(-a)
+    const Index plus = e.emit(ExpressionModel::OP_EXP, a);
+    const Index minus = e.emit(ExpressionModel::OP_EXP, e.emit(ExpressionModel::OP_NEG, a));
+    const Index half = e.constant(0.5);
+    if( code == NL_SINH )
+    {
+        return e.emit(ExpressionModel::OP_MUL, half, e.emit(ExpressionModel::OP_SUB, plus, minus));
+    }
+    if( code == NL_COSH )
+    {
+        return e.emit(ExpressionModel::OP_MUL, half, e.emit(ExpressionModel::OP_ADD, plus, minus));
+    }
+    return e.emit(ExpressionModel::OP_DIV, e.emit(ExpressionModel::OP_SUB, plus, minus),
+                  e.emit(ExpressionModel::OP_ADD, plus, minus));
+}
+
+bool NlReader::read(ExpressionModel &model, std::string &error) {
+    // header: ten lines, the first telling the format
+    if( at_end() || *p_ != 'g' )
+    {
+        error = at_end() || *p_ != 'b' ? "not an .nl file" : "binary .nl files are not supported, write them with -og";
+        return false;
+    }
+    Index header[10][6] = {{0}};
+    for( Index row = 0; row < 10; row++ )
+    {
+        if( row == 0 )
+        {
+            p_++;
+        }
+        for( Index k = 0; k < 6 && !at_end() && *p_ != '#' && *p_ != '\n' && *p_ != '\r'; k++ )
+        {
+            if( !read_index(header[row][k]) )
+            {
+                error = error_;
+                return false;
+            }
+            while( p_ < end_ && (*p_ == ' ' || *p_ == '\t') )
+            {
+                p_++;
+            }
+        }
+        next_line();
+    }
+    n_ = header[1][0];
+    const Index m = header[1][1], num_obj = header[1][2];
+    const Index num_defined = header[9][0] + header[9][1] + header[9][2] + header[9][3] + header[9][4];
+    if( header[3][0] != 0 || header[3][1] != 0 )
+    {
+        error = "network constraints are not supported";
+        return false;
+    }
+
+    // first pass: where every segment is, the bounds and the starting point
+    std::vector<Number> x_l(n_, -NL_INFINITY), x_u(n_, NL_INFINITY), start(n_, 0.);
+    std::vector<Number> g_l(m, -NL_INFINITY), g_u(m, NL_INFINITY);
+    std::vector<Position> constraints(m, Position());
+    std::vector<Segment> jacobian(m, Segment());
+    Segment gradient = Segment();
+    Position objective = Position();
+    Index sense = 0;
+    defined_.assign(num_defined, Segment());
+    while( !at_end() )
+    {
+        const char kind = *p_++;
+        Index i = 0, k = 0;
+        bool ok = true;
+        switch( kind )
+        {
+            case 'C':
+                ok = read_index(i) && i >= 0 && i < m;
+                next_line();
+                if( ok )
+                {
+                    constraints[i].p = p_;
+                    constraints[i].line = line_;
+                }
+                skip_expression();
+                break;
+            case 'O':
+                ok = read_index(i) && read_index(k);
+                next_line();
+                if( ok && i == 0 )
+                {
+                    objective.p = p_;
+                    objective.line = line_;
+                    sense = k;
+                }
+                skip_expression();
+                break;
+            case 'V':
+            {
+                ok = read_index(i) && read_index(k) && i >= n_ && i < n_ + num_defined;
+                next_line();
+                if( ok )
+                {
+                    defined_[i - n_].start.p = p_;
+                    defined_[i - n_].start.line = line_;
+                    defined_[i - n_].count = k;
+                }
+                for( Index t = 0; t < k; t++ )
+                {
+                    next_line();
+                }
+                skip_expression();
+                break;
+            }
+            case 'x':
+                ok = read_index(k);
+                next_line();
+                for( Index t = 0; ok && t < k; t++ )
+                {
+                    Number value;
+                    ok = read_index(i) && read_number(value) && i >= 0 && i < n_;
+                    if( ok )
+                    {
+                        start[i] = value;
+                    }
+                    next_line();
+                }
+                break;
+            case 'r':
+                ok = read_bounds(m, g_l, g_u);
+                break;
+            case 'b':
+                ok = read_bounds(n_, x_l, x_u);
+                break;
+            case 'J':
+            case 'G':
+                ok = read_index(i) && read_index(k) && i >= 0 && (kind == 'G' || i < m);
+                next_line();
+                if( ok && (kind == 'J' || i == 0) )
+                {
+                    Segment &segment = kind == 'J' ? jacobian[i] : gradient;
+                    segment.start.p = p_;
+                    segment.start.line = line_;
+                    segment.count = k;
+                }
+                for( Index t = 0; t < k; t++ )
+                {
+                    next_line();
+                }
+                break;
+            case 'd':
+            case 'k':
+                ok = read_index(k);
+                skip_lines(k);
+                break;
+            case 'S':
+                // suffix: S<kind> <count> <name>
+                ok = read_index(i) && read_index(k);
+                skip_lines(k);
+                break;
+            case 'F':
+                ok = fail("imported functions are not supported");
+                break;
+            default:
+                ok = fail(std::string("unexpected segment '") + kind + "'");
+        }
+        if( !ok )
+        {
+            fail("malformed segment");
+            error = error_;
+            return false;
+        }
+    }
+
+    // second pass: the functions in order
+    model = ExpressionModel();
+    for( Index i = 0; i < n_; i++ )
+    {
+        model.add_variable("x[" + std::to_string(i) + "]", x_l[i], x_u[i], start[i]);
+    }
+    for( Index j = 0; j < m; j++ )
+    {
+        model.add_constraint(g_l[j], g_u[j]);
+    }
+    ExpressionBuilder builder(model);
+    builder_ = &builder;
+    defined_instr_.assign(num_defined, -1);
+    for( Index k = 0; k <= m; k++ )
+    {
+        const Position &position = k == 0 ? objective : constraints[k - 1];
+        const Segment &linear_part = k == 0 ? gradient : jacobian[k - 1];
+        Index value;
+        if( position.p != NULL )
+        {
+            p_ = position.p;
+            line_ = position.line;
+            value = expression();
+        }
+        else if( k == 0 && num_obj == 0 )
+        {
+            value = builder.constant(0.);
+        }
+        else
+        {
+            fail(k == 0 ? "missing objective" : "missing constraint");
+            error = error_;
+            return false;
+        }
+        if( value >= 0 && linear_part.start.p != NULL )
+        {
+            p_ = linear_part.start.p;
+            line_ = linear_part.start.line;
+            value = linear(value, linear_part.count);
+        }
+        if( value < 0 )
+        {
+            error = error_;
+            return false;
+        }
+        if( k == 0 && sense == 1 )
+        {
+            value = builder.emit(ExpressionModel::OP_NEG, value);
+        }
+        builder.end_function(value);
+        // defined variables are expanded once per function
+        for( size_t d = 0; d < defined_used_.size(); d++ )
+        {
+            defined_instr_[defined_used_[d]] = -1;
+        }
+        defined_used_.clear();
+    }
+    builder.finish();
+    return true;
+}
+
+bool read_nl_model(const std::string &path, ExpressionModel &model, std::string &error) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if( fd < 0 )
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    struct stat info;
+    if( fstat(fd, &info) != 0 || info.st_size == 0 )
+    {
+        close(fd);
+        error = path + ": empty file";
+        return false;
+    }
+    void *data = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if( data == MAP_FAILED )
+    {
+        error = "cannot map " + path;
+        return false;
+    }
+    const char *begin = (const char *) data;
+    NlReader reader(begin, begin + info.st_size);
+    const bool ok = reader.read(model, error);
+    munmap(data, (size_t) info.st_size);
+    if( !ok )
+    {
+        error = path + ": " + error;
+    }
+    return ok;
+}
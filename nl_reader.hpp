@@ -0,0 +1,25 @@
+//
+// Reader for AMPL .nl files (the text format, written by ampl with -og) into an ExpressionModel, so that ExpressionNLP
+// solves them; this is how standard test sets such as the HS and CUTE ports are run. The file is memory-mapped and
+// parsed in place: a first pass records where every segment starts and reads the bounds and the starting point, a
+// second builds the objective and the constraints in order from their expression trees (C, O segments), defined
+// variables (V, expanded into every function that uses them) and linear parts (J, G).
+// Supported operators are + - * /, unary minus, powers, sums, sqrt, exp, log, log10, sin, cos, tan, sinh, cosh and
+// tanh. Imported functions, logical and nonsmooth operators, complementarity constraints and network constraints are
+// rejected. Only the first objective is used, a maximized one is negated; integrality is ignored. Variables are named
+// x[i] since the names are not in the .nl file.
+//
+
+#ifndef __NL_READER_HPP
+#define __NL_READER_HPP
+
+#include "expression_model.hpp"
+
+#include <string>
+
+using namespace Ipopt;
+
+// replaces model by the problem in the .nl file at path; returns false with the line and reason in error
+bool read_nl_model(const std::string &path, ExpressionModel &model, std::string &error);
+
+#endif //__NL_READER_HPP
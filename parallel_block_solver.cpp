@@ -0,0 +1,284 @@
+//
+// Parallel-in-time Schur complement KKT solver, see parallel_block_solver.hpp
+//
+
+#include "parallel_block_solver.hpp"
+
+#include "IpTSymLinearSolver.hpp"
+
+#include <algorithm>
+
+ParallelBlockSolverInterface::ParallelBlockSolverInterface(const std::shared_ptr<WorkStealingPool> &pool,
+                                                           Index num_segments, Index min_block_size,
+                                                           Number pivot_tol)
+        : BlockTridiagSolverInterface(min_block_size, pivot_tol), pool_(pool), requested_segments_(num_segments),
+          serial_(true) {
+}
+
+ESymSolverStatus ParallelBlockSolverInterface::InitializeStructure(Index dim, Index nonzeros, const Index *ia,
+                                                                   const Index *ja) {
+    ESymSolverStatus status = BlockTridiagSolverInterface::InitializeStructure(dim, nonzeros, ia, ja);
+    if( status != SYMSOLVER_SUCCESS )
+    {
+        return status;
+    }
+
+    // P segments and P - 1 separators need at least 2 P - 1 blocks
+    const Index K = num_blocks();
+    Index P = requested_segments_ > 0 ? requested_segments_ : (Index) pool_->size();
+    P = std::max(1, std::min(P, (K + 1) / 2));
+
+    segments_.assign(P, Segment());
+    separators_.clear();
+    separator_pos_.assign(1, 0);
+    const Index interior = K - (P - 1);
+    Index first = 0;
+    for( Index i = 0; i < P; i++ )
+    {
+        Segment &segment = segments_[i];
+        segment.first = first;
+        segment.last = first + interior * (i + 1) / P - interior * i / P;
+        segment.left = i > 0 ? first - 1 : -1;
+        segment.right = i + 1 < P ? segment.last : -1;
+        segment.left_size = i > 0 ? block_start_[first] - block_start_[first - 1] : 0;
+        segment.right_size = i + 1 < P ? block_start_[segment.last + 1] - block_start_[segment.last] : 0;
+        if( i + 1 < P )
+        {
+            separators_.push_back(segment.last);
+            separator_pos_.push_back(separator_pos_.back() + segment.right_size);
+        }
+        first = segment.last + 1;
+    }
+    return SYMSOLVER_SUCCESS;
+}
+
+void ParallelBlockSolverInterface::factor_segment(Segment &segment) {
+    segment.status = factor_chain(segment.first, segment.last, segment.pivots, segment.neg_evals);
+    if( segment.status != SYMSOLVER_SUCCESS )
+    {
+        return;
+    }
+
+    // C couples the segment to its separators: B_first in the rows of the first block for the left one,
+    // B_right^T in the rows of the last block for the right one
+    const Index start = block_start_[segment.first];
+    const Index n = block_start_[segment.last] - start;
+    const Index ncol = segment.left_size + segment.right_size;
+    const Index first_size = block_start_[segment.first + 1] - start;
+    const Index last_start = block_start_[segment.last - 1] - start;
+    const Index last_size = n - last_start;
+    std::vector<Number> C((size_t) n * ncol, 0.);
+    for( Index j = 0; j < segment.left_size; j++ )
+    {
+        for( Index i = 0; i < first_size; i++ )
+        {
+            C[(size_t) j * n + i] = blocks_[coupling_offset_[segment.first] + j * first_size + i];
+        }
+    }
+    for( Index r = 0; r < segment.right_size; r++ )
+    {
+        for( Index c = 0; c < last_size; c++ )
+        {
+            C[(size_t) (segment.left_size + r) * n + last_start + c]
+                    = blocks_[coupling_offset_[segment.right] + c * segment.right_size + r];
+        }
+    }
+
+    segment.W = C;
+    solve_chain(segment.pivots, ncol, segment.W.data(), n, start);
+    segment.CtW.assign((size_t) ncol * ncol, 0.);
+    for( Index b = 0; b < ncol; b++ )
+    {
+        for( Index a = 0; a < ncol; a++ )
+        {
+            Number s = 0.;
+            for( Index i = 0; i < n; i++ )
+            {
+                s += C[(size_t) a * n + i] * segment.W[(size_t) b * n + i];
+            }
+            segment.CtW[(size_t) b * ncol + a] = s;
+        }
+    }
+}
+
+ESymSolverStatus ParallelBlockSolverInterface::factor() {
+    if( segments_.size() < 2 )
+    {
+        serial_ = true;
+        return BlockTridiagSolverInterface::factor();
+    }
+
+    assemble();
+    for( size_t i = 0; i < segments_.size(); i++ )
+    {
+        Segment *segment = &segments_[i];
+        pool_->submit([this, segment]() { factor_segment(*segment); });
+    }
+    pool_->wait();
+
+    neg_evals_ = 0;
+    for( size_t i = 0; i < segments_.size(); i++ )
+    {
+        if( segments_[i].status != SYMSOLVER_SUCCESS )
+        {
+            // a segment is singular on its own although the whole matrix need not be; the serial recursion can
+            // merge across the cut
+            serial_ = true;
+            return BlockTridiagSolverInterface::factor();
+        }
+        neg_evals_ += segments_[i].neg_evals;
+    }
+    serial_ = false;
+
+    // separator Schur complement: A_ss minus the contributions of the segments on both sides
+    const Index ns = separator_pos_.back();
+    std::vector<Number> S((size_t) ns * ns, 0.);
+    for( size_t q = 0; q < separators_.size(); q++ )
+    {
+        const Index size = separator_pos_[q + 1] - separator_pos_[q];
+        const Index offset = block_offset_[separators_[q]];
+        for( Index j = 0; j < size; j++ )
+        {
+            for( Index i = 0; i < size; i++ )
+            {
+                S[(size_t) (separator_pos_[q] + j) * ns + separator_pos_[q] + i] = blocks_[offset + j * size + i];
+            }
+        }
+    }
+    for( size_t k = 0; k < segments_.size(); k++ )
+    {
+        const Segment &segment = segments_[k];
+        // the separators of segment k are q = k - 1 and q = k, adjacent in the Schur complement
+        const Index base = k > 0 ? separator_pos_[k - 1] : 0;
+        const Index ncol = segment.left_size + segment.right_size;
+        for( Index b = 0; b < ncol; b++ )
+        {
+            for( Index a = 0; a < ncol; a++ )
+            {
+                S[(size_t) (base + b) * ns + base + a] -= segment.CtW[(size_t) b * ncol + a];
+            }
+        }
+    }
+    const bool regular = schur_.factor(ns, S.data());
+    neg_evals_ += schur_.num_negative();
+    return regular ? SYMSOLVER_SUCCESS : SYMSOLVER_SINGULAR;
+}
+
+void ParallelBlockSolverInterface::solve(Index nrhs, Number *rhs) {
+    if( serial_ )
+    {
+        BlockTridiagSolverInterface::solve(nrhs, rhs);
+        return;
+    }
+
+    work_.resize((size_t) dim_ * nrhs);
+    for( Index r = 0; r < nrhs; r++ )
+    {
+        for( Index p = 0; p < dim_; p++ )
+        {
+            work_[(size_t) r * dim_ + p] = rhs[(size_t) r * dim_ + perm_[p]];
+        }
+    }
+
+    // y_seg = A_seg^{-1} b_seg
+    for( size_t i = 0; i < segments_.size(); i++ )
+    {
+        const Segment *segment = &segments_[i];
+        pool_->submit([this, segment, nrhs]() {
+            const Index start = block_start_[segment->first];
+            solve_chain(segment->pivots, nrhs, work_.data() + start, dim_, start);
+        });
+    }
+    pool_->wait();
+
+    // x_sep = S^{-1} (b_sep - sum C^T y_seg)
+    const Index ns = separator_pos_.back();
+    std::vector<Number> xs((size_t) ns * nrhs);
+    for( Index r = 0; r < nrhs; r++ )
+    {
+        const Number *w = work_.data() + (size_t) r * dim_;
+        Number *x = xs.data() + (size_t) r * ns;
+        for( size_t q = 0; q < separators_.size(); q++ )
+        {
+            std::copy(w + block_start_[separators_[q]], w + block_start_[separators_[q] + 1], x + separator_pos_[q]);
+        }
+        for( size_t k = 0; k < segments_.size(); k++ )
+        {
+            const Segment &segment = segments_[k];
+            const Index base = k > 0 ? separator_pos_[k - 1] : 0;
+            const Index start = block_start_[segment.first];
+            const Index n = block_start_[segment.last] - start;
+            const Index first_size = block_start_[segment.first + 1] - start;
+            const Index last_start = block_start_[segment.last - 1] - start;
+            for( Index j = 0; j < segment.left_size; j++ )
+            {
+                for( Index i = 0; i < first_size; i++ )
+                {
+                    x[base + j] -= blocks_[coupling_offset_[segment.first] + j * first_size + i] * w[start + i];
+                }
+            }
+            for( Index c = 0; c < n - last_start; c++ )
+            {
+                for( Index j = 0; j < segment.right_size; j++ )
+                {
+                    x[base + segment.left_size + j] -= blocks_[coupling_offset_[segment.right]
+                                                               + c * segment.right_size + j] * w[start + last_start + c];
+                }
+            }
+        }
+    }
+    schur_.solve(nrhs, xs.data());
+
+    // x_seg = y_seg - W x_sep
+    for( size_t k = 0; k < segments_.size(); k++ )
+    {
+        const Segment *segment = &segments_[k];
+        const Index base = k > 0 ? separator_pos_[k - 1] : 0;
+        pool_->submit([this, segment, base, nrhs, ns, &xs]() {
+            const Index start = block_start_[segment->first];
+            const Index n = block_start_[segment->last] - start;
+            const Index ncol = segment->left_size + segment->right_size;
+            for( Index r = 0; r < nrhs; r++ )
+            {
+                Number *w = work_.data() + (size_t) r * dim_ + start;
+                const Number *x = xs.data() + (size_t) r * ns + base;
+                for( Index j = 0; j < ncol; j++ )
+                {
+                    for( Index i = 0; i < n; i++ )
+                    {
+                        w[i] -= segment->W[(size_t) j * n + i] * x[j];
+                    }
+                }
+            }
+        });
+    }
+    pool_->wait();
+
+    for( Index r = 0; r < nrhs; r++ )
+    {
+        Number *w = work_.data() + (size_t) r * dim_;
+        const Number *x = xs.data() + (size_t) r * ns;
+        for( size_t q = 0; q < separators_.size(); q++ )
+        {
+            std::copy(x + separator_pos_[q], x + separator_pos_[q + 1], w + block_start_[separators_[q]]);
+        }
+        for( Index p = 0; p < dim_; p++ )
+        {
+            rhs[(size_t) r * dim_ + perm_[p]] = w[p];
+        }
+    }
+}
+
+ParallelBlockAlgorithmBuilder::ParallelBlockAlgorithmBuilder(unsigned num_threads, Index num_segments,
+                                                             Index min_block_size, Number pivot_tol)
+        : AlgorithmBuilder(), pool_(std::make_shared<WorkStealingPool>(num_threads)), num_segments_(num_segments),
+          min_block_size_(min_block_size), pivot_tol_(pivot_tol) {
+}
+
+SmartPtr<SymLinearSolver> ParallelBlockAlgorithmBuilder::SymLinearSolverFactory(const Journalist &jnlst,
+                                                                                const OptionsList &options,
+                                                                                const std::string &prefix) {
+    SmartPtr<SparseSymLinearSolverInterface> solver
+            = new ParallelBlockSolverInterface(pool_, num_segments_, min_block_size_, pivot_tol_);
+    return new TSymLinearSolver(solver, NULL);
+}
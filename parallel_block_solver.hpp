@@ -0,0 +1,86 @@
+//
+// Parallel-in-time variant of BlockTridiagSolverInterface. The chain of blocks is cut into P segments separated by
+// single separator blocks,
+//     segment 0 | sep 1 | segment 1 | sep 2 | ... | segment P-1
+// Each segment only couples to its neighbouring separators, so the segments are factored independently on a
+// WorkStealingPool, each computing its contribution C^T A_seg^{-1} C to the separator Schur complement. The
+// separator Schur complement is small (P - 1 blocks) and is factored serially. The inertia is the sum of the
+// inertias of the segments and of the Schur complement.
+// Falls back to the serial recursion for a matrix on which a segment turns out singular.
+//
+
+#ifndef __PARALLEL_BLOCK_SOLVER_HPP
+#define __PARALLEL_BLOCK_SOLVER_HPP
+
+#include "block_tridiag_solver.hpp"
+#include "work_stealing_pool.hpp"
+
+#include <memory>
+
+class ParallelBlockSolverInterface: public BlockTridiagSolverInterface {
+
+public:
+    // num_segments == 0 uses one segment per worker of the pool; the pool is shared between the linear solvers
+    // created by one ParallelBlockAlgorithmBuilder
+    ParallelBlockSolverInterface(const std::shared_ptr<WorkStealingPool> &pool, Index num_segments = 0,
+                                 Index min_block_size = 8, Number pivot_tol = 1e-10);
+
+    ESymSolverStatus InitializeStructure(Index dim, Index nonzeros, const Index *ia, const Index *ja);
+
+    // segments used for the current structure, 1 if the chain is too short to be split
+    Index num_segments() const { return (Index) segments_.size(); }
+    // whether the last factorization fell back to the serial recursion
+    bool serial_fallback() const { return serial_; }
+
+protected:
+    ESymSolverStatus factor();
+    void solve(Index nrhs, Number *rhs);
+
+private:
+    struct Segment {
+        Index first;                 // blocks [first, last)
+        Index last;
+        Index left;                  // separator blocks, -1 if none
+        Index right;
+        Index left_size;
+        Index right_size;
+        std::vector<Pivot> pivots;
+        Index neg_evals;
+        ESymSolverStatus status;
+        std::vector<Number> W;       // A_seg^{-1} C, (segment size x left_size + right_size)
+        std::vector<Number> CtW;     // C^T A_seg^{-1} C
+    };
+
+    void factor_segment(Segment &segment);
+
+    std::shared_ptr<WorkStealingPool> pool_;
+    Index requested_segments_;
+
+    std::vector<Segment> segments_;
+    std::vector<Index> separators_;       // separator blocks in order
+    std::vector<Index> separator_pos_;    // offset of every separator in the Schur complement, plus its size
+    DenseLDLT schur_;
+    bool serial_;
+
+};
+
+// AlgorithmBuilder that hands Ipopt a ParallelBlockSolverInterface for every symmetric linear system
+class ParallelBlockAlgorithmBuilder: public AlgorithmBuilder {
+
+public:
+    // num_threads == 0 uses one worker per hardware thread
+    explicit ParallelBlockAlgorithmBuilder(unsigned num_threads = 0, Index num_segments = 0,
+                                           Index min_block_size = 8, Number pivot_tol = 1e-10);
+
+    SmartPtr<SymLinearSolver> SymLinearSolverFactory(const Journalist &jnlst, const OptionsList &options,
+                                                     const std::string &prefix);
+
+private:
+    std::shared_ptr<WorkStealingPool> pool_;
+    Index num_segments_;
+    Index min_block_size_;
+    Number pivot_tol_;
+
+};
+
+#endif //__PARALLEL_BLOCK_SOLVER_HPP
@@ -0,0 +1,107 @@
+//
+// Resettable per-thread solve arena, see solve_arena.hpp
+//
+
+#include "solve_arena.hpp"
+
+#include <algorithm>
+#include <assert.h>
+#include <cstdlib>
+
+namespace {
+thread_local SolveArena *current_arena = NULL;
+std::atomic<std::size_t> system_allocations(0);
+std::atomic<std::size_t> overflows(0);
+
+// header in front of every block handed out by solve_arena_operator_new; 16 bytes keep the default new alignment
+struct BlockHeader {
+    SolveArena *owner;   // NULL: system heap
+    std::size_t pad;
+};
+const std::size_t ALIGNMENT = 16;
+}
+
+SolveArena::SolveArena(std::size_t capacity)
+        : buffer_((char *) std::malloc(capacity)), capacity_(buffer_ != NULL ? capacity : 0), used_(0),
+          high_water_(0), live_(0) {
+}
+
+SolveArena::~SolveArena() {
+    assert(live() == 0);
+    std::free(buffer_);
+}
+
+void *SolveArena::allocate(std::size_t size) {
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if( size > capacity_ - used_ )
+    {
+        return NULL;
+    }
+    void *ptr = buffer_ + used_;
+    used_ += size;
+    high_water_ = std::max(high_water_, used_);
+    live_.fetch_add(1, std::memory_order_relaxed);
+    return ptr;
+}
+
+bool SolveArena::reset() {
+    if( live() != 0 )
+    {
+        return false;
+    }
+    used_ = 0;
+    return true;
+}
+
+SolveArena *SolveArena::current() {
+    return current_arena;
+}
+
+void SolveArena::set_current(SolveArena *arena) {
+    current_arena = arena;
+}
+
+void *solve_arena_operator_new(std::size_t size) {
+    BlockHeader *header = NULL;
+    if( current_arena != NULL )
+    {
+        header = (BlockHeader *) current_arena->allocate(sizeof(BlockHeader) + size);
+        if( header != NULL )
+        {
+            header->owner = current_arena;
+            return header + 1;
+        }
+        overflows.fetch_add(1, std::memory_order_relaxed);
+    }
+    header = (BlockHeader *) std::malloc(sizeof(BlockHeader) + size);
+    if( header == NULL )
+    {
+        return NULL;
+    }
+    system_allocations.fetch_add(1, std::memory_order_relaxed);
+    header->owner = NULL;
+    return header + 1;
+}
+
+void solve_arena_operator_delete(void *ptr) {
+    if( ptr == NULL )
+    {
+        return;
+    }
+    BlockHeader *header = (BlockHeader *) ptr - 1;
+    if( header->owner != NULL )
+    {
+        // arena memory comes back with the next reset
+        header->owner->release();
+        return;
+    }
+    std::free(header);
+}
+
+std::size_t solve_arena_system_allocations() {
+    return system_allocations.load(std::memory_order_relaxed);
+}
+
+std::size_t solve_arena_overflows() {
+    return overflows.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,70 @@
+//
+// Resettable bump allocator that the global operator new of the calling thread can be routed to for the
+// duration of a solve (see arena_operator_new.cpp), so that a steady-state solve loop does not touch the system heap.
+//
+
+#ifndef __SOLVE_ARENA_HPP
+#define __SOLVE_ARENA_HPP
+
+#include <atomic>
+#include <cstddef>
+
+class SolveArena {
+
+public:
+    // the buffer is taken from the system heap once, here
+    explicit SolveArena(std::size_t capacity);
+    // every block must have been released: a block deleted later would release into a dead arena
+    ~SolveArena();
+
+    // NULL when the arena is full
+    void *allocate(std::size_t size);
+    void release() { live_.fetch_sub(1, std::memory_order_relaxed); }
+
+    // Makes the whole buffer available again. Refuses (returns false) while allocations are still alive.
+    bool reset();
+
+    std::size_t capacity() const { return capacity_; }
+    std::size_t used() const { return used_; }
+    std::size_t high_water() const { return high_water_; }
+    std::size_t live() const { return live_.load(std::memory_order_relaxed); }
+
+    // arena the replacement operator new of the calling thread allocates from, NULL for the system heap
+    static SolveArena *current();
+    static void set_current(SolveArena *arena);
+
+private:
+    SolveArena(const SolveArena &);
+    SolveArena &operator=(const SolveArena &);
+
+    char *buffer_;
+    std::size_t capacity_;
+    std::size_t used_;
+    std::size_t high_water_;
+    std::atomic<std::size_t> live_;
+
+};
+
+// routes the calling thread's operator new to arena while in scope
+class SolveArenaScope {
+
+public:
+    explicit SolveArenaScope(SolveArena &arena) : previous_(SolveArena::current()) { SolveArena::set_current(&arena); }
+    ~SolveArenaScope() { SolveArena::set_current(previous_); }
+
+private:
+    SolveArena *previous_;
+
+};
+
+// Allocation functions behind the replacement operator new / delete. Every block carries a small header naming
+// the arena it came from, so blocks can be deleted from any thread, after the scope ended or after an overflow.
+void *solve_arena_operator_new(std::size_t size);
+void solve_arena_operator_delete(void *ptr);
+
+// blocks taken from the system heap by the replacement operator new (arena overflows included)
+std::size_t solve_arena_system_allocations();
+// blocks that fell back to the system heap because the current arena was full
+std::size_t solve_arena_overflows();
+
+#endif //__SOLVE_ARENA_HPP
@@ -0,0 +1,370 @@
+//
+// Solve latency histograms, see solve_latency.hpp
+//
+
+#include "solve_latency.hpp"
+
+#include "IpSolveStatistics.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <unistd.h>
+
+LatencyHistogram::LatencyHistogram() : counts_(NUM_BUCKETS, 0), count_(0), sum_(0), max_(0) {}
+
+Index LatencyHistogram::bucket(uint64_t nanoseconds) {
+    const uint64_t linear = (uint64_t) 1 << SUB_BUCKET_BITS;
+    if( nanoseconds < linear )
+    {
+        return (Index) nanoseconds;
+    }
+    Index exponent = SUB_BUCKET_BITS;
+    while( exponent < 63 && (nanoseconds >> (exponent + 1)) != 0 )
+    {
+        exponent++;
+    }
+    if( exponent >= MAX_EXPONENT )
+    {
+        return NUM_BUCKETS - 1;
+    }
+    // the top SUB_BUCKET_BITS + 1 bits of the value, of which the first is always set
+    const Index shift = exponent - SUB_BUCKET_BITS;
+    return ((shift + 1) << SUB_BUCKET_BITS) + (Index) ((nanoseconds >> shift) - linear);
+}
+
+uint64_t LatencyHistogram::bucket_upper(Index b) {
+    const Index linear = 1 << SUB_BUCKET_BITS;
+    if( b < linear )
+    {
+        return (uint64_t) b;
+    }
+    const Index shift = (b >> SUB_BUCKET_BITS) - 1;
+    const uint64_t sub = (uint64_t) ((b & (linear - 1)) + linear);
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds) {
+    counts_[bucket(nanoseconds)]++;
+    count_++;
+    sum_ += nanoseconds;
+    max_ = std::max(max_, nanoseconds);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+    for( Index b = 0; b < NUM_BUCKETS; b++ )
+    {
+        counts_[b] += other.counts_[b];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    max_ = std::max(max_, other.max_);
+}
+
+Number LatencyHistogram::quantile(Number q) const {
+    if( count_ == 0 )
+    {
+        return 0.;
+    }
+    const uint64_t rank = std::max((uint64_t) 1, (uint64_t) std::ceil(q * (Number) count_));
+    uint64_t seen = 0;
+    for( Index b = 0; b < NUM_BUCKETS; b++ )
+    {
+        seen += counts_[b];
+        if( seen >= rank )
+        {
+            return 1e-9 * (Number) std::min(bucket_upper(b), max_);
+        }
+    }
+    return 1e-9 * (Number) max_;
+}
+
+// ApplicationReturnStatus values in the order of their slot index; anything else goes to the slot after them
+static const Index STATUS_CODES[] = {
+    Solve_Succeeded, Solved_To_Acceptable_Level, Infeasible_Problem_Detected, Search_Direction_Becomes_Too_Small,
+    Diverging_Iterates, User_Requested_Stop, Feasible_Point_Found, Maximum_Iterations_Exceeded, Restoration_Failed,
+    Error_In_Step_Computation, Maximum_CpuTime_Exceeded, Maximum_WallTime_Exceeded, Not_Enough_Degrees_Of_Freedom,
+    Invalid_Problem_Definition, Invalid_Option, Invalid_Number_Detected, Unrecoverable_Exception,
+    NonIpopt_Exception_Thrown, Insufficient_Memory, Internal_Error
+};
+static const char *STATUS_NAMES[] = {
+    "Solve_Succeeded", "Solved_To_Acceptable_Level", "Infeasible_Problem_Detected",
+    "Search_Direction_Becomes_Too_Small", "Diverging_Iterates", "User_Requested_Stop", "Feasible_Point_Found",
+    "Maximum_Iterations_Exceeded", "Restoration_Failed", "Error_In_Step_Computation", "Maximum_CpuTime_Exceeded",
+    "Maximum_WallTime_Exceeded", "Not_Enough_Degrees_Of_Freedom", "Invalid_Problem_Definition", "Invalid_Option",
+    "Invalid_Number_Detected", "Unrecoverable_Exception", "NonIpopt_Exception_Thrown", "Insufficient_Memory",
+    "Internal_Error"
+};
+static const Index NUM_STATUS_CODES = sizeof(STATUS_CODES) / sizeof(STATUS_CODES[0]);
+// the slot of unknown codes, reported under this code
+static const Index OTHER_STATUS = -1000;
+
+static Index status_slot(Index status) {
+    for( Index s = 0; s < NUM_STATUS_CODES; s++ )
+    {
+        if( STATUS_CODES[s] == status )
+        {
+            return s;
+        }
+    }
+    return NUM_STATUS_CODES;
+}
+
+const char *SolveLatencyRecorder::status_name(Index status) {
+    const Index s = status_slot(status);
+    return s < NUM_STATUS_CODES ? STATUS_NAMES[s] : "other";
+}
+
+Index SolveLatencyRecorder::iteration_class(Index iterations) {
+    Index c = 0;
+    while( iterations > 0 && c < NUM_ITERATION_CLASSES - 1 )
+    {
+        iterations >>= 1;
+        c++;
+    }
+    return c;
+}
+
+std::string SolveLatencyRecorder::iteration_class_label(Index c) {
+    std::ostringstream label;
+    if( c <= 1 )
+    {
+        label << c;
+    }
+    else if( c == NUM_ITERATION_CLASSES - 1 )
+    {
+        label << (1 << (c - 1)) << "+";
+    }
+    else
+    {
+        label << (1 << (c - 1)) << "-" << (1 << c) - 1;
+    }
+    return label.str();
+}
+
+// the atomic counterpart of LatencyHistogram, for one thread's solves of one outcome
+struct SolveLatencyRecorder::Counts {
+    std::atomic<uint64_t> buckets[LatencyHistogram::NUM_BUCKETS];
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> max;
+
+    Counts() : sum(0), max(0) {
+        for( Index b = 0; b < LatencyHistogram::NUM_BUCKETS; b++ )
+        {
+            buckets[b].store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+struct SolveLatencyRecorder::Slot {
+    std::thread::id owner;
+    std::atomic<Counts *> outcomes[NUM_STATUS_CODES + 1][NUM_ITERATION_CLASSES];
+
+    Slot() : owner(std::this_thread::get_id()) {
+        for( Index s = 0; s <= NUM_STATUS_CODES; s++ )
+        {
+            for( Index c = 0; c < NUM_ITERATION_CLASSES; c++ )
+            {
+                outcomes[s][c].store(NULL, std::memory_order_relaxed);
+            }
+        }
+    }
+    ~Slot() {
+        for( Index s = 0; s <= NUM_STATUS_CODES; s++ )
+        {
+            for( Index c = 0; c < NUM_ITERATION_CLASSES; c++ )
+            {
+                delete outcomes[s][c].load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+static std::atomic<uint64_t> next_recorder_id(1);
+
+SolveLatencyRecorder::SolveLatencyRecorder(Index max_threads)
+        : id_(next_recorder_id.fetch_add(1)), slots_((size_t) std::max(max_threads, (Index) 1)), claimed_(0) {
+    for( size_t k = 0; k < slots_.size(); k++ )
+    {
+        slots_[k].store(NULL, std::memory_order_relaxed);
+    }
+}
+
+SolveLatencyRecorder::~SolveLatencyRecorder() {
+    for( size_t k = 0; k < slots_.size(); k++ )
+    {
+        delete slots_[k].load(std::memory_order_relaxed);
+    }
+}
+
+// publishes a new object in p unless another thread was first; returns the object in p
+template<class T>
+static T *publish(std::atomic<T *> &p) {
+    T *current = p.load(std::memory_order_acquire);
+    if( current == NULL )
+    {
+        T *created = new T();
+        if( p.compare_exchange_strong(current, created, std::memory_order_acq_rel) )
+        {
+            return created;
+        }
+        delete created;
+    }
+    return current;
+}
+
+SolveLatencyRecorder::Slot *SolveLatencyRecorder::slot() {
+    // the slot of the last recorder this thread used; ids are never reused, unlike addresses
+    thread_local uint64_t cached_id = 0;
+    thread_local Slot *cached_slot = NULL;
+    if( cached_id == id_ )
+    {
+        return cached_slot;
+    }
+    const std::thread::id self = std::this_thread::get_id();
+    const Index size = (Index) slots_.size();
+    Slot *found = NULL;
+    const Index claimed = std::min(claimed_.load(std::memory_order_acquire), size);
+    for( Index k = 0; k < claimed && found == NULL; k++ )
+    {
+        Slot *s = slots_[k].load(std::memory_order_acquire);
+        if( s != NULL && s->owner == self )
+        {
+            found = s;
+        }
+    }
+    if( found == NULL )
+    {
+        const Index k = std::min(claimed_.fetch_add(1, std::memory_order_acq_rel), size - 1);
+        found = publish(slots_[k]);
+    }
+    cached_id = id_;
+    cached_slot = found;
+    return found;
+}
+
+void SolveLatencyRecorder::record(ApplicationReturnStatus status, Index iterations, Number seconds) {
+    const uint64_t nanoseconds = (uint64_t) std::max(0., std::round(1e9 * seconds));
+    Counts *counts = publish(slot()->outcomes[status_slot(status)][iteration_class(iterations)]);
+    counts->buckets[LatencyHistogram::bucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    counts->sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+    uint64_t max = counts->max.load(std::memory_order_relaxed);
+    while( nanoseconds > max && !counts->max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed) )
+    {
+    }
+}
+
+SolveLatencyReport SolveLatencyRecorder::report() const {
+    SolveLatencyReport report;
+    const Index claimed = std::min(claimed_.load(std::memory_order_acquire), (Index) slots_.size());
+    LatencyHistogram h;
+    for( Index k = 0; k < claimed; k++ )
+    {
+        const Slot *s = slots_[k].load(std::memory_order_acquire);
+        for( Index status = 0; s != NULL && status <= NUM_STATUS_CODES; status++ )
+        {
+            for( Index c = 0; c < NUM_ITERATION_CLASSES; c++ )
+            {
+                const Counts *counts = s->outcomes[status][c].load(std::memory_order_acquire);
+                if( counts == NULL )
+                {
+                    continue;
+                }
+                // the count from the buckets, so that it matches them
+                h.count_ = 0;
+                for( Index b = 0; b < LatencyHistogram::NUM_BUCKETS; b++ )
+                {
+                    h.counts_[b] = counts->buckets[b].load(std::memory_order_relaxed);
+                    h.count_ += h.counts_[b];
+                }
+                h.sum_ = counts->sum.load(std::memory_order_relaxed);
+                h.max_ = counts->max.load(std::memory_order_relaxed);
+                const Index code = status < NUM_STATUS_CODES ? STATUS_CODES[status] : OTHER_STATUS;
+                report.by_outcome[std::make_pair(code, c)].merge(h);
+                report.all.merge(h);
+            }
+        }
+    }
+    return report;
+}
+
+// the summary lines of one histogram, labels either empty or ending in a comma
+static void write_summary(std::ostream &out, const std::string &name, const std::string &labels,
+                          const LatencyHistogram &h) {
+    static const char *quantiles[] = {"0.5", "0.9", "0.99", "0.999"};
+    for( Index q = 0; q < 4; q++ )
+    {
+        out << name << "{" << labels << "quantile=\"" << quantiles[q] << "\"} " << h.quantile(std::atof(quantiles[q]))
+            << "\n";
+    }
+    const std::string braces = labels.empty() ? "" : "{" + labels.substr(0, labels.size() - 1) + "}";
+    out << name << "_sum" << braces << " " << h.sum_seconds() << "\n";
+    out << name << "_count" << braces << " " << h.count() << "\n";
+}
+
+std::string SolveLatencyRecorder::prometheus_text(const std::string &name) const {
+    const SolveLatencyReport r = report();
+    std::ostringstream out;
+    out.precision(9);
+    out << "# HELP " << name << " Wall time of OptimizeTNLP calls; without labels over all solves, otherwise by "
+        << "return status and iteration count.\n";
+    out << "# TYPE " << name << " summary\n";
+    write_summary(out, name, "", r.all);
+    for( std::map<std::pair<Index, Index>, LatencyHistogram>::const_iterator it = r.by_outcome.begin();
+         it != r.by_outcome.end(); ++it )
+    {
+        write_summary(out, name, std::string("status=\"") + status_name(it->first.first) + "\",iterations=\""
+                                 + iteration_class_label(it->first.second) + "\",", it->second);
+    }
+    out << "# HELP " << name << "_max Longest OptimizeTNLP call.\n";
+    out << "# TYPE " << name << "_max gauge\n";
+    out << name << "_max " << 1e-9 * (Number) r.all.max() << "\n";
+    for( std::map<std::pair<Index, Index>, LatencyHistogram>::const_iterator it = r.by_outcome.begin();
+         it != r.by_outcome.end(); ++it )
+    {
+        out << name << "_max{status=\"" << status_name(it->first.first) << "\",iterations=\""
+            << iteration_class_label(it->first.second) << "\"} " << 1e-9 * (Number) it->second.max() << "\n";
+    }
+    return out.str();
+}
+
+// suffix of the temporary files of this process
+static std::atomic<unsigned long> next_temporary(0);
+
+bool SolveLatencyRecorder::write_prometheus(const std::string &path, const std::string &name) const {
+    // the collector must never see a partial file; the temporary name is unique, so that processes or threads
+    // writing the same path do not write into each other's temporary
+    const std::string temporary =
+            path + "." + std::to_string(getpid()) + "." + std::to_string(next_temporary++) + ".tmp";
+    bool written;
+    {
+        std::ofstream out(temporary.c_str());
+        out << prometheus_text(name);
+        out.close();
+        written = (bool) out;
+    }
+    if( !written || std::rename(temporary.c_str(), path.c_str()) != 0 )
+    {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+ApplicationReturnStatus optimize_timed(const SmartPtr<IpoptApplication> &app, const SmartPtr<TNLP> &nlp,
+                                       SolveLatencyRecorder *recorder) {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const ApplicationReturnStatus status = app->OptimizeTNLP(nlp);
+    const Number seconds = std::chrono::duration<Number>(std::chrono::steady_clock::now() - start).count();
+    if( recorder != NULL )
+    {
+        SmartPtr<SolveStatistics> statistics = app->Statistics();
+        recorder->record(status, IsValid(statistics) ? statistics->IterationCount() : 0, seconds);
+    }
+    return status;
+}
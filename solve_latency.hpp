@@ -0,0 +1,115 @@
+//
+// Solve latency histograms: the wall time of every OptimizeTNLP call, kept in HDR-style log-linear histograms so that
+// the tail (p99, p999, max) is reported and not just the mean. A value v in nanoseconds falls into one of 128 linear
+// sub-buckets of its power of two, so every bucket is within 1/128 (0.8%) of the values in it, from 1 ns to 2^40 ns
+// (18 minutes, larger values are counted in the last bucket; the max is kept exactly).
+//
+// SolveLatencyRecorder is shared by the threads that solve: each thread records into a slot of its own, claimed on
+// its first record, with relaxed atomic increments and no lock; the slots are merged only when a report is taken,
+// which may happen while others record. Inside a slot there is one histogram per return status and iteration class
+// (0, 1, 2-3, 4-7, ..., 1024+), created on first use, so the report breaks the latency down by both.
+// The report can be written as a Prometheus text file (summaries with quantiles, sum and count, plus the max), for a
+// node_exporter style textfile collector; the file is replaced atomically.
+//
+
+#ifndef __SOLVE_LATENCY_HPP
+#define __SOLVE_LATENCY_HPP
+
+#include "IpIpoptApplication.hpp"
+#include "IpTNLP.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Ipopt;
+
+// plain log-linear histogram of nanosecond values, the merged form the reports work on
+class LatencyHistogram {
+
+public:
+    static const Index SUB_BUCKET_BITS = 7;
+    static const Index MAX_EXPONENT = 40;
+    static const Index NUM_BUCKETS = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS;
+
+    LatencyHistogram();
+
+    static Index bucket(uint64_t nanoseconds);
+    // largest value that falls into bucket b
+    static uint64_t bucket_upper(Index b);
+
+    void record(uint64_t nanoseconds);
+    void merge(const LatencyHistogram &other);
+
+    uint64_t count() const { return count_; }
+    uint64_t max() const { return max_; }
+    Number sum_seconds() const { return 1e-9 * (Number) sum_; }
+    // smallest bucket bound below which at least the fraction q of the values lie, in seconds (the max for q = 1)
+    Number quantile(Number q) const;
+
+private:
+    friend class SolveLatencyRecorder;
+
+    std::vector<uint64_t> counts_;
+    uint64_t count_;
+    uint64_t sum_;
+    uint64_t max_;
+
+};
+
+struct SolveLatencyReport {
+    LatencyHistogram all;
+    // by return status of OptimizeTNLP, then iteration class (see iteration_class)
+    std::map<std::pair<Index, Index>, LatencyHistogram> by_outcome;
+};
+
+class SolveLatencyRecorder {
+
+public:
+    static const Index NUM_ITERATION_CLASSES = 12;
+
+    // max_threads slots are available; threads beyond that share the last one, which stays correct but contended
+    explicit SolveLatencyRecorder(Index max_threads = 256);
+    ~SolveLatencyRecorder();
+    SolveLatencyRecorder(const SolveLatencyRecorder &) = delete;
+    SolveLatencyRecorder &operator=(const SolveLatencyRecorder &) = delete;
+
+    // records one solve of the calling thread; lock-free, allocates only on the first solve of a thread with a status
+    // and iteration class
+    void record(ApplicationReturnStatus status, Index iterations, Number seconds);
+
+    // merge of every slot; consistent per bucket, not across buckets while solves are being recorded
+    SolveLatencyReport report() const;
+
+    // Prometheus text format of report() under the metric name (e.g. hs071_solve_latency_seconds), labelled by
+    // status and iteration class; write_prometheus writes it to path through a temporary file and a rename
+    std::string prometheus_text(const std::string &name) const;
+    bool write_prometheus(const std::string &path, const std::string &name) const;
+
+    // 0 for 0 iterations, k for [2^(k-1), 2^k), the last class for everything above
+    static Index iteration_class(Index iterations);
+    // "0", "1", "2-3", ..., "1024+"
+    static std::string iteration_class_label(Index c);
+    // name of an ApplicationReturnStatus, e.g. "Solve_Succeeded"
+    static const char *status_name(Index status);
+
+private:
+    struct Counts;
+    struct Slot;
+
+    Slot *slot();
+
+    const uint64_t id_;
+    std::vector<std::atomic<Slot *> > slots_;
+    std::atomic<Index> claimed_;
+
+};
+
+// OptimizeTNLP timed into recorder (if not NULL), with the iteration count from the application's statistics
+ApplicationReturnStatus optimize_timed(const SmartPtr<IpoptApplication> &app, const SmartPtr<TNLP> &nlp,
+                                       SolveLatencyRecorder *recorder);
+
+#endif //__SOLVE_LATENCY_HPP
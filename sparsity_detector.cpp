@@ -0,0 +1,202 @@
+//
+// Sparsity detection by tracing, see sparsity_detector.hpp
+//
+
+#include "sparsity_detector.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+void DependencyRecorder::couple(const std::vector<Index> &a, const std::vector<Index> &b) {
+    for( size_t p = 0; p < a.size(); p++ )
+    {
+        for( size_t q = 0; q < b.size(); q++ )
+        {
+            pairs.push_back(std::make_pair(std::max(a[p], b[q]), std::min(a[p], b[q])));
+        }
+    }
+}
+
+void DependencyScalar::merge(const DependencyScalar &b) {
+    if( !recorder_ )
+    {
+        recorder_ = b.recorder_;
+    }
+    if( b.deps_.empty() )
+    {
+        return;
+    }
+    if( deps_.empty() || deps_.back() < b.deps_.front() )
+    {
+        // running sums over the variables in order append
+        deps_.insert(deps_.end(), b.deps_.begin(), b.deps_.end());
+        return;
+    }
+    if( b.deps_.size() < deps_.size() )
+    {
+        // a small term added to a long sum often brings nothing new
+        bool contained = true;
+        for( size_t k = 0; contained && k < b.deps_.size(); k++ )
+        {
+            contained = std::binary_search(deps_.begin(), deps_.end(), b.deps_[k]);
+        }
+        if( contained )
+        {
+            return;
+        }
+    }
+    std::vector<Index> merged;
+    merged.reserve(deps_.size() + b.deps_.size());
+    std::set_union(deps_.begin(), deps_.end(), b.deps_.begin(), b.deps_.end(), std::back_inserter(merged));
+    deps_.swap(merged);
+}
+
+// degrees above quadratic are not told apart
+static Index capped(Index degree) {
+    return degree < DependencyScalar::NONQUADRATIC ? degree : DependencyScalar::NONQUADRATIC;
+}
+
+void DependencyScalar::note_branch() const {
+    if( !deps_.empty() )
+    {
+        recorder_->branched = true;
+    }
+}
+
+DependencyScalar &DependencyScalar::operator+=(const DependencyScalar &b) {
+    value_ += b.value_;
+    degree_ = std::max(degree_, b.degree_);
+    merge(b);
+    return *this;
+}
+
+DependencyScalar &DependencyScalar::operator-=(const DependencyScalar &b) {
+    value_ -= b.value_;
+    degree_ = std::max(degree_, b.degree_);
+    merge(b);
+    return *this;
+}
+
+DependencyScalar &DependencyScalar::operator*=(const DependencyScalar &b) {
+    value_ *= b.value_;
+    if( !deps_.empty() && !b.deps_.empty() )
+    {
+        (recorder_ ? recorder_ : b.recorder_)->couple(deps_, b.deps_);
+    }
+    degree_ = capped(degree_ + b.degree_);
+    merge(b);
+    return *this;
+}
+
+DependencyScalar &DependencyScalar::operator/=(const DependencyScalar &b) {
+    value_ /= b.value_;
+    if( !b.deps_.empty() )
+    {
+        // u / v = u * (1 / v), and 1 / v couples v with itself
+        b.recorder_->couple(b.deps_, b.deps_);
+        b.recorder_->couple(deps_, b.deps_);
+        degree_ = NONQUADRATIC;
+    }
+    merge(b);
+    return *this;
+}
+
+DependencyScalar DependencyScalar::nonlinear(Number value) const {
+    return nonlinear(value, NONQUADRATIC);
+}
+
+DependencyScalar DependencyScalar::nonlinear(Number value, Index degree) const {
+    DependencyScalar result(*this);
+    result.value_ = value;
+    if( !deps_.empty() )
+    {
+        recorder_->couple(deps_, deps_);
+        result.degree_ = degree;
+    }
+    return result;
+}
+
+DependencyScalar sqrt(const DependencyScalar &a) {
+    return a.nonlinear(std::sqrt(a.value()));
+}
+
+DependencyScalar exp(const DependencyScalar &a) {
+    return a.nonlinear(std::exp(a.value()));
+}
+
+DependencyScalar log(const DependencyScalar &a) {
+    return a.nonlinear(std::log(a.value()));
+}
+
+DependencyScalar sin(const DependencyScalar &a) {
+    return a.nonlinear(std::sin(a.value()));
+}
+
+DependencyScalar cos(const DependencyScalar &a) {
+    return a.nonlinear(std::cos(a.value()));
+}
+
+DependencyScalar pow(const DependencyScalar &a, Number p) {
+    if( p == 1. )
+    {
+        return a;
+    }
+    // a polynomial for the natural powers
+    const bool natural = p >= 0. && p == std::floor(p) && p < (Number) DependencyScalar::NONQUADRATIC;
+    const Index degree = natural ? capped(a.degree() * (Index) p) : (Index) DependencyScalar::NONQUADRATIC;
+    return a.nonlinear(std::pow(a.value(), p), degree);
+}
+
+DependencyScalar fabs(const DependencyScalar &a) {
+    // the kink is a branch: the result is only affine in a on the side of the traced point
+    a.note_branch();
+    DependencyScalar result(a);
+    return result.value() < 0. ? -result : result;
+}
+
+// sorts (row, col) pairs and drops duplicates
+static void compact(std::vector<std::pair<Index, Index> > &entries, std::vector<Index> &rows, std::vector<Index> &cols) {
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+    rows.resize(entries.size());
+    cols.resize(entries.size());
+    for( size_t k = 0; k < entries.size(); k++ )
+    {
+        rows[k] = entries[k].first;
+        cols[k] = entries[k].second;
+    }
+}
+
+SparsityPattern detect_sparsity(Index n, Index m, const Number *x, const TracedObjective &f,
+                                const TracedConstraints &g) {
+    DependencyRecorder recorder;
+    std::vector<DependencyScalar> vars;
+    vars.reserve(n);
+    for( Index i = 0; i < n; i++ )
+    {
+        vars.push_back(DependencyScalar(x[i], i, &recorder));
+    }
+
+    SparsityPattern pattern;
+    const DependencyScalar objective = f(vars.data());
+    pattern.grad_vars = objective.dependencies();
+    pattern.f_degree = objective.degree();
+
+    std::vector<DependencyScalar> cons(m);
+    g(vars.data(), cons.data());
+    std::vector<std::pair<Index, Index> > entries;
+    pattern.g_degrees.resize(m);
+    for( Index j = 0; j < m; j++ )
+    {
+        pattern.g_degrees[j] = cons[j].degree();
+        const std::vector<Index> &deps = cons[j].dependencies();
+        for( size_t k = 0; k < deps.size(); k++ )
+        {
+            entries.push_back(std::make_pair(j, deps[k]));
+        }
+    }
+    compact(entries, pattern.jac_rows, pattern.jac_cols);
+    compact(recorder.pairs, pattern.h_rows, pattern.h_cols);
+    pattern.branched = recorder.branched;
+    return pattern;
+}
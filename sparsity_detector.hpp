@@ -0,0 +1,118 @@
+//
+// Sparsity detection by tracing. DependencyScalar carries a value and the sorted set of variables it depends on;
+// evaluating f and g with it gives the gradient and Jacobian patterns as the dependency sets of the results. Every
+// nonlinear operation records the variable pairs it couples in a DependencyRecorder (u * v couples deps(u) x deps(v),
+// u / v and unary functions also deps(v) x deps(v) or deps(u) x deps(u)), and the union of the recorded pairs is the
+// pattern of the Hessian of the Lagrangian. The polynomial degree of every value is tracked as well, so that linear
+// and quadratic functions are recognized.
+// The patterns are those of the branch the values take at the traced point: a comparison of values that depend on the
+// variables (fabs included) is noted in the recorder, and a trace that took such a branch may not hold elsewhere.
+//
+// The traced functions are templates on the scalar type, with math functions called unqualified (sqrt(x), not
+// std::sqrt(x)) so that the overloads here are found.
+//
+
+#ifndef __SPARSITY_DETECTOR_HPP
+#define __SPARSITY_DETECTOR_HPP
+
+#include "IpTypes.hpp"
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+using namespace Ipopt;
+
+// variable pairs (i, j), i >= j, coupled by nonlinear operations
+struct DependencyRecorder {
+    std::vector<std::pair<Index, Index> > pairs;
+    // a comparison involved a value that depends on the variables
+    bool branched = false;
+
+    // records a x b
+    void couple(const std::vector<Index> &a, const std::vector<Index> &b);
+};
+
+class DependencyScalar {
+
+public:
+    // degree of everything that is neither constant, affine nor quadratic in the variables
+    static const Index NONQUADRATIC = 3;
+
+    // a constant
+    DependencyScalar(Number value = 0.) : value_(value), degree_(0), recorder_(NULL) {}
+    // the independent variable var
+    DependencyScalar(Number value, Index var, DependencyRecorder *recorder)
+            : value_(value), deps_(1, var), degree_(1), recorder_(recorder) {}
+
+    Number value() const { return value_; }
+    const std::vector<Index> &dependencies() const { return deps_; }
+    // polynomial degree in the variables: 0 constant, 1 affine, 2 quadratic, NONQUADRATIC for anything else
+    Index degree() const { return degree_; }
+
+    // notes in the recorder that a branch is taken on this value, if it depends on the variables
+    void note_branch() const;
+
+    DependencyScalar &operator+=(const DependencyScalar &b);
+    DependencyScalar &operator-=(const DependencyScalar &b);
+    DependencyScalar &operator*=(const DependencyScalar &b);
+    DependencyScalar &operator/=(const DependencyScalar &b);
+
+    // the result of a nonlinear unary function with value value
+    DependencyScalar nonlinear(Number value) const;
+    // the result of a nonlinear unary function with value value and the given degree
+    DependencyScalar nonlinear(Number value, Index degree) const;
+
+private:
+    void merge(const DependencyScalar &b);
+
+    Number value_;
+    std::vector<Index> deps_;
+    Index degree_;
+    DependencyRecorder *recorder_;
+
+};
+
+inline DependencyScalar operator+(DependencyScalar a, const DependencyScalar &b) { return a += b; }
+inline DependencyScalar operator-(DependencyScalar a, const DependencyScalar &b) { return a -= b; }
+inline DependencyScalar operator*(DependencyScalar a, const DependencyScalar &b) { return a *= b; }
+inline DependencyScalar operator/(DependencyScalar a, const DependencyScalar &b) { return a /= b; }
+inline DependencyScalar operator-(const DependencyScalar &a) { return DependencyScalar(0.) - a; }
+
+inline bool operator<(const DependencyScalar &a, const DependencyScalar &b) {
+    a.note_branch();
+    b.note_branch();
+    return a.value() < b.value();
+}
+inline bool operator>(const DependencyScalar &a, const DependencyScalar &b) { return b < a; }
+inline bool operator<=(const DependencyScalar &a, const DependencyScalar &b) { return !(b < a); }
+inline bool operator>=(const DependencyScalar &a, const DependencyScalar &b) { return !(a < b); }
+
+DependencyScalar sqrt(const DependencyScalar &a);
+DependencyScalar exp(const DependencyScalar &a);
+DependencyScalar log(const DependencyScalar &a);
+DependencyScalar sin(const DependencyScalar &a);
+DependencyScalar cos(const DependencyScalar &a);
+DependencyScalar pow(const DependencyScalar &a, Number p);
+// piecewise linear, so it couples nothing
+DependencyScalar fabs(const DependencyScalar &a);
+
+// compact patterns in C_STYLE, without duplicates
+struct SparsityPattern {
+    std::vector<Index> grad_vars;                   // variables f depends on, ascending
+    std::vector<Index> jac_rows, jac_cols;          // sorted by row, then column
+    std::vector<Index> h_rows, h_cols;              // lower triangle, sorted by row, then column
+    Index f_degree = 0;                             // see DependencyScalar::degree
+    std::vector<Index> g_degrees;
+    bool branched = false;                          // see DependencyRecorder::branched
+};
+
+// f and g of a problem, traced with DependencyScalar
+typedef std::function<DependencyScalar(const DependencyScalar *)> TracedObjective;
+typedef std::function<void(const DependencyScalar *, DependencyScalar *)> TracedConstraints;
+
+// Traces f and g of a problem with n variables and m constraints at x.
+SparsityPattern detect_sparsity(Index n, Index m, const Number *x, const TracedObjective &f,
+                                const TracedConstraints &g);
+
+#endif //__SPARSITY_DETECTOR_HPP
@@ -0,0 +1,113 @@
+//
+// Space filling starting points, see start_points.hpp
+//
+
+#include "start_points.hpp"
+
+#include <algorithm>
+#include <assert.h>
+#include <random>
+
+std::vector<Number> latin_hypercube(Index num_points, const std::vector<Number> &lower, const std::vector<Number> &upper,
+                                    unsigned seed) {
+    assert(lower.size() == upper.size());
+    const Index dim = (Index) lower.size();
+    std::vector<Number> points((size_t) num_points * dim);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<Number> jitter(0., 1.);
+    std::vector<Index> slice(num_points);
+    for( Index d = 0; d < dim; d++ )
+    {
+        for( Index k = 0; k < num_points; k++ )
+        {
+            slice[k] = k;
+        }
+        std::shuffle(slice.begin(), slice.end(), rng);
+        const Number width = (upper[d] - lower[d]) / num_points;
+        for( Index k = 0; k < num_points; k++ )
+        {
+            points[(size_t) k * dim + d] = lower[d] + width * (slice[k] + jitter(rng));
+        }
+    }
+    return points;
+}
+
+namespace {
+// primitive polynomial degree s, its coefficients a and the initial direction numbers m of dimensions 2..8
+// (the first dimension is the van der Corput sequence)
+struct SobolDirection {
+    unsigned s;
+    unsigned a;
+    unsigned m[5];
+};
+const SobolDirection sobol_directions[SOBOL_MAX_DIM - 1] = {
+        {1, 0, {1}},
+        {2, 1, {1, 3}},
+        {3, 1, {1, 3, 1}},
+        {3, 2, {1, 1, 1}},
+        {4, 1, {1, 1, 3, 3}},
+        {4, 4, {1, 3, 5, 13}},
+        {5, 2, {1, 1, 5, 5, 17}},
+};
+const unsigned SOBOL_BITS = 32;
+}
+
+std::vector<Number> sobol(Index num_points, const std::vector<Number> &lower, const std::vector<Number> &upper,
+                          Index skip) {
+    assert(lower.size() == upper.size());
+    const Index dim = (Index) lower.size();
+    assert(dim <= SOBOL_MAX_DIM);
+
+    // direction numbers v[d][b], scaled to SOBOL_BITS bits
+    std::vector<std::vector<unsigned> > v(dim, std::vector<unsigned>(SOBOL_BITS));
+    for( unsigned b = 0; b < SOBOL_BITS; b++ )
+    {
+        v[0][b] = 1u << (SOBOL_BITS - 1 - b);
+    }
+    for( Index d = 1; d < dim; d++ )
+    {
+        const SobolDirection &dir = sobol_directions[d - 1];
+        for( unsigned b = 0; b < SOBOL_BITS; b++ )
+        {
+            if( b < dir.s )
+            {
+                v[d][b] = dir.m[b] << (SOBOL_BITS - 1 - b);
+                continue;
+            }
+            unsigned value = v[d][b - dir.s] ^ (v[d][b - dir.s] >> dir.s);
+            for( unsigned k = 1; k < dir.s; k++ )
+            {
+                if( (dir.a >> (dir.s - 1 - k)) & 1u )
+                {
+                    value ^= v[d][b - k];
+                }
+            }
+            v[d][b] = value;
+        }
+    }
+
+    // Gray code construction: point i+1 differs from point i in the direction of the lowest zero bit of i
+    std::vector<unsigned> state(dim, 0u);
+    std::vector<Number> points((size_t) num_points * dim);
+    const Number scale = 1. / 4294967296.;
+    for( Index i = 0; i < skip + num_points; i++ )
+    {
+        if( i >= skip )
+        {
+            for( Index d = 0; d < dim; d++ )
+            {
+                points[(size_t) (i - skip) * dim + d] = lower[d] + (upper[d] - lower[d]) * (state[d] * scale);
+            }
+        }
+        unsigned c = 0;
+        for( unsigned value = (unsigned) i; value & 1u; value >>= 1 )
+        {
+            c++;
+        }
+        for( Index d = 0; d < dim; d++ )
+        {
+            state[d] ^= v[d][c];
+        }
+    }
+    return points;
+}
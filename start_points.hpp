@@ -0,0 +1,25 @@
+//
+// Space filling starting points for multi-start searches over a box.
+//
+
+#ifndef __START_POINTS_HPP
+#define __START_POINTS_HPP
+
+#include "IpTypes.hpp"
+
+#include <vector>
+
+using namespace Ipopt;
+
+// Latin hypercube sample of num_points points in the box [lower, upper]: every coordinate hits each of the
+// num_points equal slices of its interval exactly once. Points are returned row by row (num_points x dim).
+std::vector<Number> latin_hypercube(Index num_points, const std::vector<Number> &lower, const std::vector<Number> &upper,
+                                    unsigned seed);
+
+// Sobol sequence (Joe-Kuo direction numbers, up to SOBOL_MAX_DIM dimensions) scaled to the box [lower, upper],
+// skipping the first skip points of the sequence. Points are returned row by row (num_points x dim).
+const Index SOBOL_MAX_DIM = 8;
+std::vector<Number> sobol(Index num_points, const std::vector<Number> &lower, const std::vector<Number> &upper,
+                          Index skip = 1);
+
+#endif //__START_POINTS_HPP
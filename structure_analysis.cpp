@@ -0,0 +1,507 @@
+//
+// Structure analysis for any TNLP, see structure_analysis.hpp
+//
+
+#include "structure_analysis.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+// A point of [lo, up] around x0, t in [-1, 1]; sides at infinity are cut at distance 1 + |x0|.
+static Number probe_value(Number x0, Number lo, Number up, Number t) {
+    x0 = std::min(std::max(x0, lo), up);
+    const Number width = 1. + std::fabs(x0);
+    const Number a = std::max(lo, x0 - width);
+    const Number b = std::min(up, x0 + width);
+    return 0.5 * (a + b) + 0.5 * (b - a) * t;
+}
+
+std::ostream &operator<<(std::ostream &os, const TNLPStructure &structure) {
+    os << "structure:   " << (structure.traced ? "traced" : "probed, a hint only") << std::endl;
+    os << "variables:   " << structure.num_vars << ", " << structure.nonlinear_vars.size() << " nonlinear" << std::endl;
+    os << "constraints: " << structure.num_cons << ", " << structure.linear_constraints << " linear" << std::endl;
+    os << "gradient:    " << (structure.grad_f_constant ? "constant" : "varying") << std::endl;
+    os << "Jacobian:    " << structure.jac_entries << " entries, " << structure.jac_constant_entries << " constant, "
+       << structure.jac_zero_entries << " zero" << (structure.jac_c_constant ? ", equalities constant" : "")
+       << (structure.jac_d_constant ? ", inequalities constant" : "") << std::endl;
+    os << "Hessian:     " << structure.h_entries << " entries, " << structure.h_zero_entries << " zero"
+       << (structure.hessian_constant ? ", constant" : "") << std::endl;
+    return os;
+}
+
+StructureAnalyzedTNLP::StructureAnalyzedTNLP(const SmartPtr<TNLP> &nlp, Index num_probes, unsigned seed)
+        : nlp_(nlp), num_probes_(num_probes), seed_(seed), analyzed_(false), valid_(false), has_hessian_(false),
+          pending_new_x_(false), n_(0), m_(0), nnz_jac_(0), nnz_h_(0), index_style_(TNLP::C_STYLE) {
+    assert(num_probes >= 2);
+}
+
+StructureAnalyzedTNLP::StructureAnalyzedTNLP(const SmartPtr<TNLP> &nlp, const TracedObjective &f,
+                                             const TracedConstraints &g, Index num_probes, unsigned seed)
+        : nlp_(nlp), traced_f_(f), traced_g_(g), num_probes_(num_probes), seed_(seed), analyzed_(false),
+          valid_(false), has_hessian_(false), pending_new_x_(false), n_(0), m_(0), nnz_jac_(0), nnz_h_(0),
+          index_style_(TNLP::C_STYLE) {
+    assert(num_probes >= 2);
+}
+
+bool StructureAnalyzedTNLP::analyze() {
+    analyzed_ = true;
+    valid_ = false;
+    structure_ = TNLPStructure();
+    if( !nlp_->get_nlp_info(n_, m_, nnz_jac_, nnz_h_, index_style_) )
+    {
+        return false;
+    }
+    structure_.num_vars = n_;
+    structure_.num_cons = m_;
+    structure_.jac_entries = nnz_jac_;
+    structure_.h_entries = nnz_h_;
+
+    std::vector<Number> x_l(n_), x_u(n_), g_l(m_), g_u(m_), x0(n_);
+    std::vector<Index> jac_row(nnz_jac_), jac_col(nnz_jac_), h_row(nnz_h_), h_col(nnz_h_);
+    if( !nlp_->get_bounds_info(n_, x_l.data(), x_u.data(), m_, g_l.data(), g_u.data())
+        || !nlp_->get_starting_point(n_, true, x0.data(), false, NULL, NULL, m_, false, NULL)
+        || !nlp_->eval_jac_g(n_, NULL, false, m_, nnz_jac_, jac_row.data(), jac_col.data(), NULL) )
+    {
+        return false;
+    }
+    has_hessian_ = nlp_->eval_h(n_, NULL, false, 1., m_, NULL, false, nnz_h_, h_row.data(), h_col.data(), NULL);
+    for( Index i = 0; i < n_; i++ )
+    {
+        x0[i] = std::min(std::max(x0[i], x_l[i]), x_u[i]);
+    }
+
+    std::vector<bool> jac_nonzero(nnz_jac_, true), h_nonzero(nnz_h_, true), nonlinear(n_, true);
+    linear_con_.assign(m_, false);
+    structure_.traced = traced_f_ && traced_g_
+                        && trace(x0.data(), jac_row, jac_col, h_row, h_col, jac_nonzero, h_nonzero, nonlinear);
+    if( !structure_.traced
+        && !probe(x0.data(), x_l.data(), x_u.data(), jac_row, h_row, h_col, jac_nonzero, h_nonzero, nonlinear) )
+    {
+        return false;
+    }
+
+    structure_.jac_c_constant = structure_.jac_d_constant = true;
+    for( Index j = 0; j < m_; j++ )
+    {
+        if( linear_con_[j] )
+        {
+            structure_.linear_constraints++;
+        }
+        else if( g_l[j] == g_u[j] )
+        {
+            structure_.jac_c_constant = false;
+        }
+        else
+        {
+            structure_.jac_d_constant = false;
+        }
+    }
+    structure_.jac_zero_entries = (Index) std::count(jac_nonzero.begin(), jac_nonzero.end(), false);
+    structure_.h_zero_entries = has_hessian_ ? (Index) std::count(h_nonzero.begin(), h_nonzero.end(), false) : 0;
+    for( Index i = 0; i < n_; i++ )
+    {
+        if( nonlinear[i] )
+        {
+            structure_.nonlinear_vars.push_back(i);
+        }
+    }
+    if( !structure_.traced )
+    {
+        return true;
+    }
+
+    // the reduced structures, without the structural zeros
+    jac_keep_.clear();
+    jac_row_.clear();
+    jac_col_.clear();
+    for( Index k = 0; k < nnz_jac_; k++ )
+    {
+        if( jac_nonzero[k] )
+        {
+            jac_keep_.push_back(k);
+            jac_row_.push_back(jac_row[k]);
+            jac_col_.push_back(jac_col[k]);
+        }
+    }
+    h_keep_.clear();
+    h_row_.clear();
+    h_col_.clear();
+    for( Index k = 0; has_hessian_ && k < nnz_h_; k++ )
+    {
+        if( h_nonzero[k] )
+        {
+            h_keep_.push_back(k);
+            h_row_.push_back(h_row[k]);
+            h_col_.push_back(h_col[k]);
+        }
+    }
+
+    // the constant parts are the same everywhere; the Hessian only has the objective's part then
+    buffer_.resize(std::max(nnz_jac_, nnz_h_));
+    const std::vector<Number> lambda(m_, 0.);
+    bool new_x = true;
+    if( structure_.grad_f_constant )
+    {
+        grad_f_.resize(n_);
+        if( !nlp_->eval_grad_f(n_, x0.data(), new_x, grad_f_.data()) )
+        {
+            return false;
+        }
+        new_x = false;
+    }
+    if( structure_.jac_c_constant && structure_.jac_d_constant )
+    {
+        if( !nlp_->eval_jac_g(n_, x0.data(), new_x, m_, nnz_jac_, NULL, NULL, buffer_.data()) )
+        {
+            return false;
+        }
+        new_x = false;
+        jac_.resize(jac_keep_.size());
+        for( size_t k = 0; k < jac_keep_.size(); k++ )
+        {
+            jac_[k] = buffer_[jac_keep_[k]];
+        }
+    }
+    if( structure_.hessian_constant )
+    {
+        if( !nlp_->eval_h(n_, x0.data(), new_x, 1., m_, lambda.data(), true, nnz_h_, NULL, NULL, buffer_.data()) )
+        {
+            return false;
+        }
+        h_.resize(h_keep_.size());
+        for( size_t k = 0; k < h_keep_.size(); k++ )
+        {
+            h_[k] = buffer_[h_keep_[k]];
+        }
+    }
+    // the wrapped problem last saw x0, Ipopt's first point has to reach it as a new one
+    pending_new_x_ = true;
+    valid_ = true;
+    return true;
+}
+
+bool StructureAnalyzedTNLP::trace(const Number *x, const std::vector<Index> &jac_row,
+                                  const std::vector<Index> &jac_col, const std::vector<Index> &h_row,
+                                  const std::vector<Index> &h_col, std::vector<bool> &jac_nonzero,
+                                  std::vector<bool> &h_nonzero, std::vector<bool> &nonlinear) {
+    const SparsityPattern pattern = detect_sparsity(n_, m_, x, traced_f_, traced_g_);
+    if( pattern.branched )
+    {
+        return false;
+    }
+    const Index offset = index_style_ == TNLP::FORTRAN_STYLE ? 1 : 0;
+
+    structure_.grad_f_constant = pattern.f_degree <= 1;
+    bool constraints_linear = true;
+    for( Index j = 0; j < m_; j++ )
+    {
+        linear_con_[j] = pattern.g_degrees[j] <= 1;
+        constraints_linear = constraints_linear && linear_con_[j];
+    }
+    // the multipliers only drop out of the Hessian if no constraint contributes to it
+    structure_.hessian_constant = has_hessian_ && pattern.f_degree <= 2 && constraints_linear;
+
+    // the traced patterns are sorted, the declared entries are looked up in them
+    std::vector<std::pair<Index, Index> > jac(pattern.jac_rows.size()), h(pattern.h_rows.size());
+    for( size_t k = 0; k < jac.size(); k++ )
+    {
+        jac[k] = std::make_pair(pattern.jac_rows[k], pattern.jac_cols[k]);
+    }
+    for( size_t k = 0; k < h.size(); k++ )
+    {
+        h[k] = std::make_pair(pattern.h_rows[k], pattern.h_cols[k]);
+    }
+    for( Index k = 0; k < nnz_jac_; k++ )
+    {
+        jac_nonzero[k] = std::binary_search(jac.begin(), jac.end(),
+                                            std::make_pair(jac_row[k] - offset, jac_col[k] - offset));
+        structure_.jac_constant_entries += linear_con_[jac_row[k] - offset] ? 1 : 0;
+    }
+    for( Index k = 0; has_hessian_ && k < nnz_h_; k++ )
+    {
+        const Index r = h_row[k] - offset, c = h_col[k] - offset;
+        h_nonzero[k] = std::binary_search(h.begin(), h.end(), std::make_pair(std::max(r, c), std::min(r, c)));
+    }
+    nonlinear.assign(n_, false);
+    for( size_t k = 0; k < h.size(); k++ )
+    {
+        nonlinear[h[k].first] = nonlinear[h[k].second] = true;
+    }
+    return true;
+}
+
+bool StructureAnalyzedTNLP::probe(const Number *x0, const Number *x_l, const Number *x_u,
+                                  const std::vector<Index> &jac_row, const std::vector<Index> &h_row,
+                                  const std::vector<Index> &h_col, std::vector<bool> &jac_nonzero,
+                                  std::vector<bool> &h_nonzero, std::vector<bool> &nonlinear) {
+    const Index offset = index_style_ == TNLP::FORTRAN_STYLE ? 1 : 0;
+    // the Hessian is probed with obj_factor 1 and random multipliers: it stays the same only if the constraints do
+    // not contribute to it, so a constant Hessian is the objective's alone
+    std::mt19937 rng(seed_);
+    std::uniform_real_distribution<Number> uniform(-1., 1.);
+    std::vector<Number> x(n_), lambda(m_), grad(n_), jac(nnz_jac_), h(nnz_h_);
+    std::vector<Number> grad0, jac0, h0;
+    std::vector<bool> grad_varies(n_, false), jac_varies(nnz_jac_, false), h_varies(nnz_h_, false);
+    jac_nonzero.assign(nnz_jac_, false);
+    h_nonzero.assign(nnz_h_, false);
+    for( Index p = 0; p < num_probes_; p++ )
+    {
+        for( Index i = 0; i < n_; i++ )
+        {
+            x[i] = probe_value(x0[i], x_l[i], x_u[i], uniform(rng));
+        }
+        for( Index j = 0; j < m_; j++ )
+        {
+            lambda[j] = uniform(rng);
+        }
+        if( !nlp_->eval_grad_f(n_, x.data(), true, grad.data())
+            || !nlp_->eval_jac_g(n_, x.data(), false, m_, nnz_jac_, NULL, NULL, jac.data())
+            || (has_hessian_
+                && !nlp_->eval_h(n_, x.data(), false, 1., m_, lambda.data(), true, nnz_h_, NULL, NULL, h.data())) )
+        {
+            return false;
+        }
+        if( p == 0 )
+        {
+            grad0 = grad;
+            jac0 = jac;
+            h0 = h;
+        }
+        for( Index i = 0; i < n_; i++ )
+        {
+            grad_varies[i] = grad_varies[i] || grad[i] != grad0[i];
+        }
+        for( Index k = 0; k < nnz_jac_; k++ )
+        {
+            jac_varies[k] = jac_varies[k] || jac[k] != jac0[k];
+            jac_nonzero[k] = jac_nonzero[k] || jac[k] != 0.;
+        }
+        for( Index k = 0; has_hessian_ && k < nnz_h_; k++ )
+        {
+            h_varies[k] = h_varies[k] || h[k] != h0[k];
+            h_nonzero[k] = h_nonzero[k] || h[k] != 0.;
+        }
+    }
+
+    structure_.grad_f_constant = std::find(grad_varies.begin(), grad_varies.end(), true) == grad_varies.end();
+    linear_con_.assign(m_, true);
+    for( Index k = 0; k < nnz_jac_; k++ )
+    {
+        if( jac_varies[k] )
+        {
+            linear_con_[jac_row[k] - offset] = false;
+        }
+        else
+        {
+            structure_.jac_constant_entries++;
+        }
+    }
+    if( has_hessian_ )
+    {
+        structure_.hessian_constant = std::find(h_varies.begin(), h_varies.end(), true) == h_varies.end();
+        nonlinear.assign(n_, false);
+        for( Index k = 0; k < nnz_h_; k++ )
+        {
+            if( h_nonzero[k] )
+            {
+                nonlinear[h_row[k] - offset] = nonlinear[h_col[k] - offset] = true;
+            }
+        }
+    }
+    return true;
+}
+
+void StructureAnalyzedTNLP::set_options(const SmartPtr<IpoptApplication> &app) {
+    if( !analyzed_ )
+    {
+        analyze();
+    }
+    app->Options()->SetStringValue("grad_f_constant", valid_ && structure_.grad_f_constant ? "yes" : "no");
+    app->Options()->SetStringValue("jac_c_constant", valid_ && structure_.jac_c_constant ? "yes" : "no");
+    app->Options()->SetStringValue("jac_d_constant", valid_ && structure_.jac_d_constant ? "yes" : "no");
+    app->Options()->SetStringValue("hessian_constant", valid_ && structure_.hessian_constant ? "yes" : "no");
+}
+
+bool StructureAnalyzedTNLP::get_nlp_info(Index &n, Index &m, Index &nnz_jac_g, Index &nnz_h_lag,
+                                         IndexStyleEnum &index_style) {
+    if( !analyzed_ )
+    {
+        analyze();
+    }
+    if( !valid_ )
+    {
+        return nlp_->get_nlp_info(n, m, nnz_jac_g, nnz_h_lag, index_style);
+    }
+    n = n_;
+    m = m_;
+    nnz_jac_g = (Index) jac_keep_.size();
+    nnz_h_lag = has_hessian_ ? (Index) h_keep_.size() : nnz_h_;
+    index_style = index_style_;
+    return true;
+}
+
+bool StructureAnalyzedTNLP::get_bounds_info(Index n, Number *x_l, Number *x_u, Index m, Number *g_l, Number *g_u) {
+    return nlp_->get_bounds_info(n, x_l, x_u, m, g_l, g_u);
+}
+
+bool StructureAnalyzedTNLP::get_scaling_parameters(Number &obj_scaling, bool &use_x_scaling, Index n,
+                                                   Number *x_scaling, bool &use_g_scaling, Index m,
+                                                   Number *g_scaling) {
+    return nlp_->get_scaling_parameters(obj_scaling, use_x_scaling, n, x_scaling, use_g_scaling, m, g_scaling);
+}
+
+bool StructureAnalyzedTNLP::get_variables_linearity(Index n, LinearityType *var_types) {
+    if( !valid_ )
+    {
+        return nlp_->get_variables_linearity(n, var_types);
+    }
+    std::fill(var_types, var_types + n, TNLP::LINEAR);
+    for( size_t k = 0; k < structure_.nonlinear_vars.size(); k++ )
+    {
+        var_types[structure_.nonlinear_vars[k]] = TNLP::NON_LINEAR;
+    }
+    return true;
+}
+
+bool StructureAnalyzedTNLP::get_constraints_linearity(Index m, LinearityType *const_types) {
+    if( !valid_ )
+    {
+        return nlp_->get_constraints_linearity(m, const_types);
+    }
+    for( Index j = 0; j < m; j++ )
+    {
+        const_types[j] = linear_con_[j] ? TNLP::LINEAR : TNLP::NON_LINEAR;
+    }
+    return true;
+}
+
+bool StructureAnalyzedTNLP::get_starting_point(Index n, bool init_x, Number *x, bool init_z, Number *z_L,
+                                               Number *z_U, Index m, bool init_lambda, Number *lambda) {
+    return nlp_->get_starting_point(n, init_x, x, init_z, z_L, z_U, m, init_lambda, lambda);
+}
+
+bool StructureAnalyzedTNLP::forward_new_x(bool new_x) {
+    new_x = new_x || pending_new_x_;
+    pending_new_x_ = false;
+    return new_x;
+}
+
+bool StructureAnalyzedTNLP::eval_f(Index n, const Number *x, bool new_x, Number &obj_value) {
+    return nlp_->eval_f(n, x, forward_new_x(new_x), obj_value);
+}
+
+bool StructureAnalyzedTNLP::eval_grad_f(Index n, const Number *x, bool new_x, Number *grad_f) {
+    if( valid_ && structure_.grad_f_constant )
+    {
+        pending_new_x_ = pending_new_x_ || new_x;
+        std::copy(grad_f_.begin(), grad_f_.end(), grad_f);
+        return true;
+    }
+    return nlp_->eval_grad_f(n, x, forward_new_x(new_x), grad_f);
+}
+
+bool StructureAnalyzedTNLP::eval_g(Index n, const Number *x, bool new_x, Index m, Number *g) {
+    return nlp_->eval_g(n, x, forward_new_x(new_x), m, g);
+}
+
+bool StructureAnalyzedTNLP::eval_jac_g(Index n, const Number *x, bool new_x, Index m, Index nele_jac, Index *iRow,
+                                       Index *jCol, Number *values) {
+    if( !valid_ )
+    {
+        return nlp_->eval_jac_g(n, x, values != NULL ? forward_new_x(new_x) : new_x, m, nele_jac, iRow, jCol, values);
+    }
+    if( values == NULL )
+    {
+        std::copy(jac_row_.begin(), jac_row_.end(), iRow);
+        std::copy(jac_col_.begin(), jac_col_.end(), jCol);
+        return true;
+    }
+    if( structure_.jac_c_constant && structure_.jac_d_constant )
+    {
+        pending_new_x_ = pending_new_x_ || new_x;
+        std::copy(jac_.begin(), jac_.end(), values);
+        return true;
+    }
+    if( !nlp_->eval_jac_g(n, x, forward_new_x(new_x), m, nnz_jac_, NULL, NULL, buffer_.data()) )
+    {
+        return false;
+    }
+    for( Index k = 0; k < nele_jac; k++ )
+    {
+        values[k] = buffer_[jac_keep_[k]];
+    }
+    return true;
+}
+
+bool StructureAnalyzedTNLP::eval_h(Index n, const Number *x, bool new_x, Number obj_factor, Index m,
+                                   const Number *lambda, bool new_lambda, Index nele_hess, Index *iRow, Index *jCol,
+                                   Number *values) {
+    if( !valid_ || !has_hessian_ )
+    {
+        return nlp_->eval_h(n, x, values != NULL ? forward_new_x(new_x) : new_x, obj_factor, m, lambda, new_lambda,
+                            nele_hess, iRow, jCol, values);
+    }
+    if( values == NULL )
+    {
+        std::copy(h_row_.begin(), h_row_.end(), iRow);
+        std::copy(h_col_.begin(), h_col_.end(), jCol);
+        return true;
+    }
+    if( structure_.hessian_constant )
+    {
+        pending_new_x_ = pending_new_x_ || new_x;
+        for( Index k = 0; k < nele_hess; k++ )
+        {
+            values[k] = obj_factor * h_[k];
+        }
+        return true;
+    }
+    if( !nlp_->eval_h(n, x, forward_new_x(new_x), obj_factor, m, lambda, new_lambda, nnz_h_, NULL, NULL,
+                      buffer_.data()) )
+    {
+        return false;
+    }
+    for( Index k = 0; k < nele_hess; k++ )
+    {
+        values[k] = buffer_[h_keep_[k]];
+    }
+    return true;
+}
+
+Index StructureAnalyzedTNLP::get_number_of_nonlinear_variables() {
+    if( !valid_ )
+    {
+        return nlp_->get_number_of_nonlinear_variables();
+    }
+    return (Index) structure_.nonlinear_vars.size();
+}
+
+bool StructureAnalyzedTNLP::get_list_of_nonlinear_variables(Index num_nonlin_vars, Index *pos_nonlin_vars) {
+    if( !valid_ )
+    {
+        return nlp_->get_list_of_nonlinear_variables(num_nonlin_vars, pos_nonlin_vars);
+    }
+    const Index offset = index_style_ == TNLP::FORTRAN_STYLE ? 1 : 0;
+    for( Index k = 0; k < num_nonlin_vars; k++ )
+    {
+        pos_nonlin_vars[k] = structure_.nonlinear_vars[k] + offset;
+    }
+    return true;
+}
+
+void StructureAnalyzedTNLP::finalize_solution(SolverReturn status, Index n, const Number *x, const Number *z_L,
+                                              const Number *z_U, Index m, const Number *g, const Number *lambda,
+                                              Number obj_value, const IpoptData *ip_data,
+                                              IpoptCalculatedQuantities *ip_cq) {
+    nlp_->finalize_solution(status, n, x, z_L, z_U, m, g, lambda, obj_value, ip_data, ip_cq);
+}
+
+bool StructureAnalyzedTNLP::intermediate_callback(AlgorithmMode mode, Index iter, Number obj_value, Number inf_pr,
+                                                  Number inf_du, Number mu, Number d_norm,
+                                                  Number regularization_size, Number alpha_du, Number alpha_pr,
+                                                  Index ls_trials, const IpoptData *ip_data,
+                                                  IpoptCalculatedQuantities *ip_cq) {
+    return nlp_->intermediate_callback(mode, iter, obj_value, inf_pr, inf_du, mu, d_norm, regularization_size,
+                                       alpha_du, alpha_pr, ls_trials, ip_data, ip_cq);
+}
@@ -0,0 +1,134 @@
+//
+// Structure analysis for any TNLP. StructureAnalyzedTNLP wraps a problem and, before the first solve, traces its f
+// and g with DependencyScalar (see sparsity_detector.hpp) to find
+//  - a linear objective (constant gradient) and the linear constraints (constant Jacobian rows),
+//  - declared Jacobian and Hessian entries that are structurally zero, which are dropped from the structures,
+//  - a Hessian that is constant in x and the multipliers: a quadratic objective and linear constraints (a QP),
+//  - the variables that enter nonlinearly, i.e. have a nonzero Hessian row.
+// Ipopt learns the result through get_list_of_nonlinear_variables, get_variables_linearity,
+// get_constraints_linearity and set_options, which sets grad_f_constant, jac_c_constant, jac_d_constant and
+// hessian_constant; constant gradient, Jacobian and Hessian values are evaluated once and served without calling the
+// problem again. Everything is forwarded to the wrapped problem unchanged otherwise.
+//
+// The trace holds for the branch taken at the traced point, so a trace that compared values depending on the
+// variables (fabs included) is not used. Without a usable trace the callbacks are only probed at a few random points
+// in the variable box, with random multipliers for the Hessian. Probes cannot prove structure, only fail to refute
+// it (a kink they miss looks constant), so what they find is reported in structure() as a hint and nothing is declared
+// to Ipopt: the problem is passed through unchanged.
+//
+
+#ifndef __STRUCTURE_ANALYSIS_HPP
+#define __STRUCTURE_ANALYSIS_HPP
+
+#include "IpIpoptApplication.hpp"
+#include "IpTNLP.hpp"
+#include "sparsity_detector.hpp"
+
+#include <assert.h>
+#include <iostream>
+#include <vector>
+
+using namespace Ipopt;
+
+struct TNLPStructure {
+    bool traced = false;               // proven by a trace and declared to Ipopt, a probe hint otherwise
+    bool grad_f_constant = false;
+    bool jac_c_constant = false;       // every equality constraint is linear
+    bool jac_d_constant = false;       // every inequality constraint is linear
+    bool hessian_constant = false;
+    Index linear_constraints = 0;
+    Index jac_entries = 0;             // as declared by the problem
+    Index jac_constant_entries = 0;
+    Index jac_zero_entries = 0;        // dropped
+    Index h_entries = 0;               // as declared by the problem
+    Index h_zero_entries = 0;          // dropped
+    std::vector<Index> nonlinear_vars;  // zero based; untraced, all variables if the problem has no eval_h
+    Index num_vars = 0;
+    Index num_cons = 0;
+};
+
+std::ostream &operator<<(std::ostream &os, const TNLPStructure &structure);
+
+class StructureAnalyzedTNLP: public TNLP {
+
+public:
+    // only probes nlp, whose structure is then a hint and not declared
+    explicit StructureAnalyzedTNLP(const SmartPtr<TNLP> &nlp, Index num_probes = 3, unsigned seed = 1);
+    // traces f and g, which must compute what eval_f and eval_g of nlp do; probes if the trace branched
+    StructureAnalyzedTNLP(const SmartPtr<TNLP> &nlp, const TracedObjective &f, const TracedConstraints &g,
+                          Index num_probes = 3, unsigned seed = 1);
+
+    // Traces or probes the wrapped problem; runs on the first get_nlp_info if not called before. Returns false if a
+    // callback failed, in which case the problem is passed through unchanged.
+    bool analyze();
+    const TNLPStructure &structure() const { return structure_; }
+
+    // sets the *_constant options on app according to the analysis
+    void set_options(const SmartPtr<IpoptApplication> &app);
+
+    // methods from Ipopt::TNLP
+    bool get_nlp_info(Index &n, Index &m, Index &nnz_jac_g, Index &nnz_h_lag, IndexStyleEnum &index_style);
+    bool get_bounds_info(Index n, Number *x_l, Number *x_u, Index m, Number *g_l, Number *g_u);
+    bool get_scaling_parameters(Number &obj_scaling, bool &use_x_scaling, Index n, Number *x_scaling,
+                                bool &use_g_scaling, Index m, Number *g_scaling);
+    bool get_variables_linearity(Index n, LinearityType *var_types);
+    bool get_constraints_linearity(Index m, LinearityType *const_types);
+    bool get_starting_point(Index n, bool init_x, Number *x, bool init_z, Number *z_L, Number *z_U, Index m,
+                            bool init_lambda, Number *lambda);
+    bool eval_f(Index n, const Number *x, bool new_x, Number &obj_value);
+    bool eval_grad_f(Index n, const Number *x, bool new_x, Number *grad_f);
+    bool eval_g(Index n, const Number *x, bool new_x, Index m, Number *g);
+    bool eval_jac_g(Index n, const Number *x, bool new_x, Index m, Index nele_jac, Index *iRow, Index *jCol,
+                    Number *values);
+    bool eval_h(Index n, const Number *x, bool new_x, Number obj_factor, Index m, const Number *lambda, bool new_lambda,
+                Index nele_hess, Index *iRow, Index *jCol, Number *values);
+    Index get_number_of_nonlinear_variables();
+    bool get_list_of_nonlinear_variables(Index num_nonlin_vars, Index *pos_nonlin_vars);
+    void finalize_solution(SolverReturn status, Index n, const Number *x, const Number *z_L, const Number *z_U, Index m,
+                           const Number *g, const Number *lambda, Number obj_value, const IpoptData *ip_data,
+                           IpoptCalculatedQuantities *ip_cq);
+    bool intermediate_callback(AlgorithmMode mode, Index iter, Number obj_value, Number inf_pr, Number inf_du, Number mu,
+                               Number d_norm, Number regularization_size, Number alpha_du, Number alpha_pr,
+                               Index ls_trials, const IpoptData *ip_data, IpoptCalculatedQuantities *ip_cq);
+
+private:
+    // new_x for a call forwarded to the wrapped problem, which also has to learn of a new x that was only seen by
+    // calls served from the constant values
+    bool forward_new_x(bool new_x);
+
+    // Find the entries of the declared structures that can be nonzero, the linear constraints (linear_con_), the
+    // variables that enter nonlinearly and the constant parts, by a trace at x or by probes around it. trace returns
+    // false if the trace branched, probe if a callback failed.
+    bool trace(const Number *x, const std::vector<Index> &jac_row, const std::vector<Index> &jac_col,
+               const std::vector<Index> &h_row, const std::vector<Index> &h_col, std::vector<bool> &jac_nonzero,
+               std::vector<bool> &h_nonzero, std::vector<bool> &nonlinear);
+    bool probe(const Number *x0, const Number *x_l, const Number *x_u, const std::vector<Index> &jac_row,
+               const std::vector<Index> &h_row, const std::vector<Index> &h_col, std::vector<bool> &jac_nonzero,
+               std::vector<bool> &h_nonzero, std::vector<bool> &nonlinear);
+
+    SmartPtr<TNLP> nlp_;
+    TracedObjective traced_f_;
+    TracedConstraints traced_g_;
+    Index num_probes_;
+    unsigned seed_;
+    bool analyzed_;
+    bool valid_;           // traced, the reduced structures and constant values are in use
+    bool has_hessian_;     // the wrapped problem implements eval_h
+    bool pending_new_x_;   // a new x has not been passed on to the wrapped problem yet
+
+    Index n_, m_, nnz_jac_, nnz_h_;
+    IndexStyleEnum index_style_;
+    TNLPStructure structure_;
+    std::vector<bool> linear_con_;
+    std::vector<Index> jac_keep_;     // positions of the kept entries in the wrapped problem's arrays
+    std::vector<Index> jac_row_, jac_col_;
+    std::vector<Index> h_keep_;
+    std::vector<Index> h_row_, h_col_;
+    std::vector<Number> grad_f_;      // served when constant
+    std::vector<Number> jac_;
+    std::vector<Number> h_;           // objective Hessian, obj_factor = 1
+    std::vector<Number> buffer_;      // full-size values of the wrapped problem
+
+};
+
+#endif //__STRUCTURE_ANALYSIS_HPP
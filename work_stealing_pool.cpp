@@ -0,0 +1,123 @@
+//
+// Work stealing thread pool, see work_stealing_pool.hpp
+//
+
+#include "work_stealing_pool.hpp"
+
+#include <algorithm>
+#include <assert.h>
+
+namespace {
+// the pool the current thread works for and its index there
+thread_local const WorkStealingPool *current_pool = NULL;
+thread_local int current_index = -1;
+}
+
+WorkStealingPool::WorkStealingPool(unsigned num_threads) : queued_(0), pending_(0), stop_(false), next_(0) {
+    if( num_threads == 0 )
+    {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for( unsigned i = 0; i < num_threads; i++ )
+    {
+        queues_.emplace_back(new Queue());
+    }
+    for( unsigned i = 0; i < num_threads; i++ )
+    {
+        threads_.emplace_back(&WorkStealingPool::run, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    for( size_t i = 0; i < threads_.size(); i++ )
+    {
+        threads_[i].join();
+    }
+}
+
+int WorkStealingPool::worker_index() const {
+    return current_pool == this ? current_index : -1;
+}
+
+void WorkStealingPool::submit(Task task) {
+    int self = worker_index();
+    unsigned q = self >= 0 ? (unsigned) self : next_++ % size();
+    // counted before it is published: once in a deque, the task may be taken and finished by another worker before
+    // this one gets on, and a task submitted from a running task must never take pending_ to zero
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued_++;
+        pending_++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues_[q]->mutex);
+        queues_[q]->tasks.push_back(std::move(task));
+    }
+    work_cv_.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    assert(worker_index() < 0);
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return pending_ == 0; });
+}
+
+bool WorkStealingPool::pop(unsigned index, Task &task) {
+    // newest task of our own deque first, it is the most likely to be warm in cache
+    {
+        Queue &own = *queues_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if( !own.tasks.empty() )
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued_--;
+            return true;
+        }
+    }
+    // then the oldest task of somebody else
+    for( unsigned k = 1; k < size(); k++ )
+    {
+        Queue &victim = *queues_[(index + k) % size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if( !victim.tasks.empty() )
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued_--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run(unsigned index) {
+    current_pool = this;
+    current_index = (int) index;
+    for( ;; )
+    {
+        Task task;
+        if( pop(index, task) )
+        {
+            task();
+            std::lock_guard<std::mutex> lock(mutex_);
+            if( --pending_ == 0 )
+            {
+                done_cv_.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        work_cv_.wait(lock, [this] { return stop_ || queued_ > 0; });
+        if( stop_ && queued_ == 0 )
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,62 @@
+//
+// Fixed size thread pool with one task deque per worker. A worker pops its own deque from the back and steals
+// from the front of the others when it runs dry, which keeps the load balanced when task durations vary widely.
+//
+
+#ifndef __WORK_STEALING_POOL_HPP
+#define __WORK_STEALING_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool {
+
+public:
+    typedef std::function<void()> Task;
+
+    // num_threads == 0 uses one worker per hardware thread
+    explicit WorkStealingPool(unsigned num_threads = 0);
+    // waits for the submitted tasks to finish
+    ~WorkStealingPool();
+
+    // Queues a task. Tasks submitted from a worker of this pool go to that worker's own deque, the others are
+    // distributed round robin. Tasks must not throw.
+    void submit(Task task);
+
+    // blocks until every submitted task has finished; must not be called from a worker of this pool
+    void wait();
+
+    unsigned size() const { return (unsigned) queues_.size(); }
+
+    // index in [0, size()) of the calling thread if it is a worker of this pool, -1 otherwise
+    int worker_index() const;
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void run(unsigned index);
+    bool pop(unsigned index, Task &task);
+
+    std::vector<std::unique_ptr<Queue> > queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    std::atomic<size_t> queued_;   // tasks sitting in the deques
+    size_t pending_;               // tasks submitted but not finished, guarded by mutex_
+    bool stop_;
+    std::atomic<unsigned> next_;
+
+};
+
+#endif //__WORK_STEALING_POOL_HPP